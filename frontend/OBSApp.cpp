@@ -353,6 +353,9 @@ void OBSApp::InitUserConfigDefaults()
 
 	config_set_default_string(userConfig, "General", "HotkeyFocusType", "NeverDisableHotkeys");
 
+	config_set_default_int(userConfig, "General", "RemuxMaxJobs", 2);
+	config_set_default_bool(userConfig, "General", "RemuxFastStart", false);
+
 	config_set_default_bool(userConfig, "BasicWindow", "PreviewEnabled", true);
 	config_set_default_bool(userConfig, "BasicWindow", "PreviewProgramMode", false);
 	config_set_default_bool(userConfig, "BasicWindow", "SceneDuplicationMode", true);
@@ -384,6 +387,8 @@ void OBSApp::InitUserConfigDefaults()
 
 	config_set_default_bool(userConfig, "BasicWindow", "MultiviewDrawAreas", true);
 
+	config_set_default_uint(userConfig, "BasicWindow", "MultiviewThumbnailFPS", 0);
+
 	config_set_default_bool(userConfig, "BasicWindow", "MediaControlsCountdownTimer", true);
 
 	config_set_default_bool(App()->GetUserConfig(), "BasicWindow", "MixerShowInactive", false);
@@ -391,6 +396,8 @@ void OBSApp::InitUserConfigDefaults()
 	config_set_default_bool(App()->GetUserConfig(), "BasicWindow", "MixerShowHidden", false);
 	config_set_default_bool(App()->GetUserConfig(), "BasicWindow", "MixerKeepHiddenLast", false);
 
+	config_set_default_uint(userConfig, "Audio", "MeterUpdateRate", 60);
+
 	config_set_default_int(userConfig, "Appearance", "FontScale", 10);
 	config_set_default_int(userConfig, "Appearance", "Density", 1);
 }
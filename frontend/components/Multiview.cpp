@@ -4,6 +4,9 @@
 #include <widgets/OBSBasic.hpp>
 
 #include <obs-frontend-api.h>
+#include <util/platform.h>
+
+#include <algorithm>
 
 Multiview::Multiview()
 {
@@ -20,6 +23,7 @@ Multiview::~Multiview()
 	}
 
 	obs_enter_graphics();
+	DestroyThumbnails();
 	gs_vertexbuffer_destroy(actionSafeMargin);
 	gs_vertexbuffer_destroy(graphicsSafeMargin);
 	gs_vertexbuffer_destroy(fourByThreeSafeMargin);
@@ -29,6 +33,16 @@ Multiview::~Multiview()
 	obs_leave_graphics();
 }
 
+void Multiview::DestroyThumbnails()
+{
+	for (Thumbnail &thumbnail : thumbnails)
+		gs_texrender_destroy(thumbnail.texrender);
+	thumbnails.clear();
+
+	gs_texrender_destroy(previewTexrender);
+	previewTexrender = nullptr;
+}
+
 static OBSSource CreateLabel(const char *name, size_t h)
 {
 	OBSDataAutoRelease settings = obs_data_create();
@@ -65,7 +79,7 @@ static OBSSource CreateLabel(const char *name, size_t h)
 	return txtSource.Get();
 }
 
-void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea)
+void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea, uint32_t thumbnailFPS)
 {
 	this->multiviewLayout = multiviewLayout;
 	this->drawLabel = drawLabel;
@@ -183,6 +197,15 @@ void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool dra
 
 	multiviewScenes = std::move(updatedScenes);
 	multiviewLabels = std::move(updatedLabels);
+
+	obs_enter_graphics();
+	DestroyThumbnails();
+	thumbnails.resize(multiviewScenes.size());
+	this->thumbnailFPS = thumbnailFPS;
+	nextThumbnail = 0;
+	thumbnailBudget = 0.0;
+	lastRenderTime = 0;
+	obs_leave_graphics();
 }
 
 static inline uint32_t labelOffset(MultiviewLayout multiviewLayout, obs_source_t *label, uint32_t cx)
@@ -215,6 +238,78 @@ static inline uint32_t labelOffset(MultiviewLayout multiviewLayout, obs_source_t
 	return (cx / 2) - w;
 }
 
+/* Renders a scene at base resolution into a texture of cx by cy pixels */
+static gs_texture_t *RenderToTexture(gs_texrender_t *&texrender, obs_source_t *source, float fw, float fh,
+				     uint32_t cx, uint32_t cy)
+{
+	if (!texrender)
+		texrender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+
+	gs_texrender_reset(texrender);
+	if (gs_texrender_begin_with_color_space(texrender, cx, cy, GS_CS_SRGB)) {
+		vec4 zero;
+		vec4_zero(&zero);
+
+		gs_clear(GS_CLEAR_COLOR, &zero, 0.0f, 0);
+		gs_ortho(0.0f, fw, 0.0f, fh, -100.0f, 100.0f);
+		obs_source_video_render(source);
+		gs_texrender_end(texrender);
+	}
+
+	return gs_texrender_get_texture(texrender);
+}
+
+/* Draws a texture from RenderToTexture over cx by cy base pixels.  It was
+ * cleared to black, so it's copied as is, the same as rendering the scene
+ * over the black background. */
+static void DrawTexture(gs_texture_t *tex, float cx, float cy)
+{
+	if (!tex)
+		return;
+
+	const char *tech_name = "Draw";
+	float multiplier = 1.0f;
+	if (gs_get_color_space() == GS_CS_709_SCRGB) {
+		tech_name = "DrawMultiply";
+		multiplier = obs_get_video_sdr_white_level() / 80.0f;
+	}
+
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(true);
+
+	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture_srgb(gs_effect_get_param_by_name(effect, "image"), tex);
+	gs_effect_set_float(gs_effect_get_param_by_name(effect, "multiplier"), multiplier);
+
+	gs_blend_state_push();
+	gs_enable_blending(false);
+	while (gs_effect_loop(effect, tech_name))
+		gs_draw_sprite(tex, 0, (uint32_t)cx, (uint32_t)cy);
+	gs_blend_state_pop();
+
+	gs_enable_framebuffer_srgb(previous);
+}
+
+/* Round robin: returns how many thumbnails are due this frame, starting at
+ * nextThumbnail, for each to be refreshed thumbnailFPS times per second */
+size_t Multiview::ThumbnailsToRefresh(size_t count)
+{
+	uint64_t now = os_gettime_ns();
+	uint64_t elapsed = lastRenderTime ? now - lastRenderTime : 0;
+	lastRenderTime = now;
+
+	if (!count)
+		return 0;
+
+	thumbnailBudget += double(elapsed) / 1000000000.0 * double(thumbnailFPS) * double(count);
+	if (thumbnailBudget > double(count))
+		thumbnailBudget = double(count);
+
+	size_t refresh = size_t(thumbnailBudget);
+	thumbnailBudget -= double(refresh);
+	return refresh;
+}
+
 void Multiview::Render(uint32_t cx, uint32_t cy)
 {
 	OBSBasic *main = (OBSBasic *)obs_frontend_get_main_window();
@@ -231,6 +326,26 @@ void Multiview::Render(uint32_t cx, uint32_t cy)
 	OBSSource previewSrc = main->GetCurrentSceneSource();
 	OBSSource programSrc = main->GetProgramSource();
 	bool studioMode = main->IsPreviewProgramMode();
+	bool scenesOnly = multiviewLayout == MultiviewLayout::SCENES_ONLY_4_SCENES ||
+			  multiviewLayout == MultiviewLayout::SCENES_ONLY_9_SCENES ||
+			  multiviewLayout == MultiviewLayout::SCENES_ONLY_16_SCENES ||
+			  multiviewLayout == MultiviewLayout::SCENES_ONLY_25_SCENES;
+
+	auto pixels = [&](float size) {
+		return std::max((uint32_t)(size * scale), 1u);
+	};
+
+	// The preview scene is only rendered once, its thumbnail reuses it
+	gs_texture_t *previewTex = nullptr;
+	if (studioMode && !scenesOnly)
+		previewTex = RenderToTexture(previewTexrender, previewSrc, fw, fh, pixels(ppiCX), pixels(ppiCY));
+
+	size_t refreshStart = nextThumbnail;
+	size_t refreshCount = 0;
+	if (thumbnailFPS && thumbnails.size()) {
+		refreshCount = ThumbnailsToRefresh(thumbnails.size());
+		nextThumbnail = (nextThumbnail + refreshCount) % thumbnails.size();
+	}
 
 	auto drawBox = [&](float cx, float cy, uint32_t colorVal) {
 		gs_effect_t *solid = obs_get_base_effect(OBS_EFFECT_SOLID);
@@ -422,12 +537,35 @@ void Multiview::Render(uint32_t cx, uint32_t cy)
 
 		/* ----------- */
 
-		// Render the source
+		// Render the source.  The program and preview are already
+		// rendered this frame, so those are reused.
+		gs_texture_t *thumbnailTex = nullptr;
+		bool useMainTexture = src == programSrc;
+
+		if (!useMainTexture && previewTex && src == previewSrc) {
+			thumbnailTex = previewTex;
+		} else if (!useMainTexture && thumbnailFPS && i < thumbnails.size()) {
+			Thumbnail &thumbnail = thumbnails[i];
+			bool due = (i + thumbnails.size() - refreshStart) % thumbnails.size() < refreshCount;
+
+			if (due || !thumbnail.rendered) {
+				RenderToTexture(thumbnail.texrender, src, fw, fh, pixels(siCX), pixels(siCY));
+				thumbnail.rendered = true;
+			}
+
+			thumbnailTex = gs_texrender_get_texture(thumbnail.texrender);
+		}
+
 		gs_matrix_push();
 		gs_matrix_translate3f(siX, siY, 0.0f);
 		gs_matrix_scale3f(siScaleX, siScaleY, 1.0f);
 		setRegion(siX, siY, siCX, siCY);
-		obs_source_video_render(src);
+		if (useMainTexture)
+			obs_render_main_texture();
+		else if (thumbnailTex)
+			DrawTexture(thumbnailTex, fw, fh);
+		else
+			obs_source_video_render(src);
 		endRegion();
 		gs_matrix_pop();
 
@@ -456,10 +594,7 @@ void Multiview::Render(uint32_t cx, uint32_t cy)
 		gs_matrix_pop();
 	}
 
-	if (multiviewLayout == MultiviewLayout::SCENES_ONLY_4_SCENES ||
-	    multiviewLayout == MultiviewLayout::SCENES_ONLY_9_SCENES ||
-	    multiviewLayout == MultiviewLayout::SCENES_ONLY_16_SCENES ||
-	    multiviewLayout == MultiviewLayout::SCENES_ONLY_25_SCENES) {
+	if (scenesOnly) {
 		endRegion();
 		return;
 	}
@@ -480,7 +615,7 @@ void Multiview::Render(uint32_t cx, uint32_t cy)
 	gs_matrix_scale3f(ppiScaleX, ppiScaleY, 1.0f);
 	setRegion(sourceX, sourceY, ppiCX, ppiCY);
 	if (studioMode) {
-		obs_source_video_render(previewSrc);
+		DrawTexture(previewTex, fw, fh);
 	} else {
 		obs_render_main_texture();
 	}
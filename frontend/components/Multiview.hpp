@@ -21,7 +21,7 @@ class Multiview {
 public:
 	Multiview();
 	~Multiview();
-	void Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea);
+	void Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea, uint32_t thumbnailFPS);
 	void Render(uint32_t cx, uint32_t cy);
 	OBSSource GetSourceByPosition(int x, int y);
 
@@ -39,6 +39,26 @@ private:
 	std::vector<OBSWeakSource> multiviewScenes;
 	std::vector<OBSSource> multiviewLabels;
 
+	// Scene thumbnails are cached in textures, a few of them re-rendered
+	// each frame so each is refreshed thumbnailFPS times per second.
+	// 0 renders them all every frame.
+	struct Thumbnail {
+		gs_texrender_t *texrender = nullptr;
+		bool rendered = false;
+	};
+	std::vector<Thumbnail> thumbnails;
+	uint32_t thumbnailFPS = 0;
+	size_t nextThumbnail = 0;
+	double thumbnailBudget = 0.0;
+	uint64_t lastRenderTime = 0;
+
+	// The studio mode preview, rendered once per frame and reused as the
+	// preview scene's thumbnail
+	gs_texrender_t *previewTexrender = nullptr;
+
+	void DestroyThumbnails();
+	size_t ThumbnailsToRefresh(size_t count);
+
 	// Multiview position helpers
 	float thickness = 6;
 	float offset, thicknessx2 = thickness * 2, pvwprgCX, pvwprgCY, sourceX, sourceY, labelX, labelY, scenesCX,
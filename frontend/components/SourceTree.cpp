@@ -4,6 +4,7 @@
 #include <widgets/OBSBasic.hpp>
 
 #include <QPainter>
+#include <QScrollBar>
 
 #include "moc_SourceTree.cpp"
 
@@ -39,6 +40,12 @@ SourceTree::SourceTree(QWidget *parent_) : QListView(parent_)
 	connect(App(), &OBSApp::StyleChanged, this, &SourceTree::UpdateIcons);
 
 	setItemDelegate(new SourceTreeDelegate(this));
+
+	connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &SourceTree::ScheduleVisibleWidgets);
+	connect(stm_, &QAbstractItemModel::modelReset, this, &SourceTree::ScheduleVisibleWidgets);
+	connect(stm_, &QAbstractItemModel::rowsInserted, this, &SourceTree::ScheduleVisibleWidgets);
+	connect(stm_, &QAbstractItemModel::rowsRemoved, this, &SourceTree::ScheduleVisibleWidgets);
+	connect(stm_, &QAbstractItemModel::rowsMoved, this, &SourceTree::ScheduleVisibleWidgets);
 }
 
 void SourceTree::UpdateIcons()
@@ -57,38 +64,93 @@ void SourceTree::SetIconsVisible(bool visible)
 
 void SourceTree::ResetWidgets()
 {
-	OBSScene scene = GetCurrentScene();
-
 	SourceTreeModel *stm = GetStm();
 	stm->UpdateGroupState(false);
 
-	for (int i = 0; i < stm->items.count(); i++) {
-		QModelIndex index = stm->createIndex(i, 0, nullptr);
-		setIndexWidget(index, new SourceTreeItem(this, stm->items[i]));
-	}
+	CreateVisibleWidgets();
 }
 
 void SourceTree::UpdateWidget(const QModelIndex &idx, obs_sceneitem_t *item)
 {
-	setIndexWidget(idx, new SourceTreeItem(this, item));
+	SourceTreeItem *widget = new SourceTreeItem(this, item);
+	setIndexWidget(idx, widget);
+
+	rowHeightHint = widget->sizeHint().height();
 }
 
+/* widgets that don't exist yet are created up to date when they are needed */
 void SourceTree::UpdateWidgets(bool force)
 {
 	SourceTreeModel *stm = GetStm();
 
 	for (int i = 0; i < stm->items.size(); i++) {
-		obs_sceneitem_t *item = stm->items[i];
-		SourceTreeItem *widget = GetItemWidget(i);
+		QWidget *widget = indexWidget(stm->createIndex(i, 0));
+		if (widget) {
+			reinterpret_cast<SourceTreeItem *>(widget)->Update(force);
+		}
+	}
+}
 
-		if (!widget) {
-			UpdateWidget(stm->createIndex(i, 0), item);
-		} else {
-			widget->Update(force);
+SourceTreeItem *SourceTree::GetItemWidget(int idx)
+{
+	SourceTreeModel *stm = GetStm();
+	if (idx < 0 || idx >= stm->items.count()) {
+		return nullptr;
+	}
+
+	QModelIndex index = stm->createIndex(idx, 0);
+	QWidget *widget = indexWidget(index);
+	if (!widget) {
+		UpdateWidget(index, stm->items[idx]);
+		widget = indexWidget(index);
+	}
+
+	return reinterpret_cast<SourceTreeItem *>(widget);
+}
+
+void SourceTree::ScheduleVisibleWidgets()
+{
+	if (visibleWidgetsPending) {
+		return;
+	}
+
+	visibleWidgetsPending = true;
+	QMetaObject::invokeMethod(this, &SourceTree::CreateVisibleWidgets, Qt::QueuedConnection);
+}
+
+void SourceTree::CreateVisibleWidgets()
+{
+	visibleWidgetsPending = false;
+
+	SourceTreeModel *stm = GetStm();
+	QRect area = viewport()->rect();
+
+	QModelIndex first = indexAt(area.topLeft());
+	int row = first.isValid() ? first.row() : 0;
+
+	for (; row < stm->items.count(); row++) {
+		QModelIndex index = stm->createIndex(row, 0);
+		QRect rect = visualRect(index);
+
+		if (rect.top() > area.bottom()) {
+			break;
+		}
+		if (rect.bottom() < area.top()) {
+			continue;
+		}
+
+		if (!indexWidget(index)) {
+			UpdateWidget(index, stm->items[row]);
 		}
 	}
 }
 
+void SourceTree::resizeEvent(QResizeEvent *event)
+{
+	QListView::resizeEvent(event);
+	ScheduleVisibleWidgets();
+}
+
 void SourceTree::SelectItem(obs_sceneitem_t *sceneitem, bool select)
 {
 	SourceTreeModel *stm = GetStm();
@@ -499,8 +561,7 @@ bool SourceTree::Edit(int row)
 	}
 
 	QModelIndex index = stm->createIndex(row, 0);
-	QWidget *widget = indexWidget(index);
-	SourceTreeItem *itemWidget = reinterpret_cast<SourceTreeItem *>(widget);
+	SourceTreeItem *itemWidget = GetItemWidget(row);
 	if (itemWidget->IsEditing()) {
 #ifdef __APPLE__
 		itemWidget->ExitEditMode(true);
@@ -23,20 +23,23 @@ class SourceTree : public QListView {
 
 	bool iconsVisible = true;
 
+	/* item widgets are only created for rows that have been on screen */
+	int rowHeightHint = 0;
+	bool visibleWidgetsPending = false;
+
 	void UpdateNoSourcesMessage();
 
 	void ResetWidgets();
 	void UpdateWidget(const QModelIndex &idx, obs_sceneitem_t *item);
 	void UpdateWidgets(bool force = false);
+	void ScheduleVisibleWidgets();
+	void CreateVisibleWidgets();
 
 	inline SourceTreeModel *GetStm() const { return reinterpret_cast<SourceTreeModel *>(model()); }
 
 public:
-	inline SourceTreeItem *GetItemWidget(int idx)
-	{
-		QWidget *widget = indexWidget(GetStm()->createIndex(idx, 0));
-		return reinterpret_cast<SourceTreeItem *>(widget);
-	}
+	SourceTreeItem *GetItemWidget(int idx);
+	inline int RowHeightHint() const { return rowHeightHint; }
 
 	explicit SourceTree(QWidget *parent = nullptr);
 
@@ -58,7 +61,7 @@ public:
 
 public slots:
 	inline void ReorderItems() { GetStm()->ReorderItems(); }
-	inline void RefreshItems() { GetStm()->SceneChanged(); }
+	inline void RefreshItems() { GetStm()->Refresh(); }
 	void Remove(OBSSceneItem item, OBSScene scene);
 	void GroupSelectedItems();
 	void UngroupSelectedGroups();
@@ -70,6 +73,7 @@ protected:
 	virtual void mouseDoubleClickEvent(QMouseEvent *event) override;
 	virtual void dropEvent(QDropEvent *event) override;
 	virtual void paintEvent(QPaintEvent *event) override;
+	virtual void resizeEvent(QResizeEvent *event) override;
 
 	virtual void selectionChanged(const QItemSelection &selected, const QItemSelection &deselected) override;
 };
@@ -10,7 +10,12 @@ QSize SourceTreeDelegate::sizeHint(const QStyleOptionViewItem &option, const QMo
 	QWidget *item = tree->indexWidget(index);
 
 	if (!item) {
-		return QStyledItemDelegate::sizeHint(option, index);
+		/* rows are sized like the item widgets they will get */
+		QSize size = QStyledItemDelegate::sizeHint(option, index);
+		if (tree->RowHeightHint() > 0) {
+			size.setHeight(tree->RowHeightHint());
+		}
+		return size;
 	}
 
 	return (QSize(item->sizeHint()));
@@ -193,19 +193,11 @@ void SourceTreeItem::ReconnectSignals()
 
 	/* --------------------------------------------------------- */
 
-	auto removeItem = [](void *data, calldata_t *cd) {
+	/* removals, selection and reordering are handled by the model, as
+	 * widgets are only created for rows that have been on screen */
+	auto removeScene = [](void *data, calldata_t *) {
 		SourceTreeItem *this_ = static_cast<SourceTreeItem *>(data);
-		obs_sceneitem_t *curItem = (obs_sceneitem_t *)calldata_ptr(cd, "item");
-		obs_scene_t *curScene = (obs_scene_t *)calldata_ptr(cd, "scene");
-
-		if (curItem == this_->sceneitem) {
-			QMetaObject::invokeMethod(this_->tree, "Remove", Q_ARG(OBSSceneItem, curItem),
-						  Q_ARG(OBSScene, curScene));
-			curItem = nullptr;
-		}
-		if (!curItem) {
-			QMetaObject::invokeMethod(this_, "Clear");
-		}
+		QMetaObject::invokeMethod(this_, "Clear");
 	};
 
 	auto itemVisible = [](void *data, calldata_t *cd) {
@@ -228,59 +220,13 @@ void SourceTreeItem::ReconnectSignals()
 		}
 	};
 
-	auto itemSelect = [](void *data, calldata_t *cd) {
-		SourceTreeItem *this_ = static_cast<SourceTreeItem *>(data);
-		obs_sceneitem_t *curItem = (obs_sceneitem_t *)calldata_ptr(cd, "item");
-
-		if (curItem == this_->sceneitem) {
-			QMetaObject::invokeMethod(this_, "Select");
-		}
-	};
-
-	auto itemDeselect = [](void *data, calldata_t *cd) {
-		SourceTreeItem *this_ = static_cast<SourceTreeItem *>(data);
-		obs_sceneitem_t *curItem = (obs_sceneitem_t *)calldata_ptr(cd, "item");
-
-		if (curItem == this_->sceneitem) {
-			QMetaObject::invokeMethod(this_, "Deselect");
-		}
-	};
-
-	auto reorderGroup = [](void *data, calldata_t *) {
-		SourceTreeItem *this_ = static_cast<SourceTreeItem *>(data);
-		QMetaObject::invokeMethod(this_->tree, "ReorderItems");
-	};
-
 	obs_scene_t *scene = obs_sceneitem_get_scene(sceneitem);
 	obs_source_t *sceneSource = obs_scene_get_source(scene);
 	signal_handler_t *signal = obs_source_get_signal_handler(sceneSource);
 
-	sigs.emplace_back(signal, "remove", removeItem, this);
-	sigs.emplace_back(signal, "item_remove", removeItem, this);
+	sigs.emplace_back(signal, "remove", removeScene, this);
 	sigs.emplace_back(signal, "item_visible", itemVisible, this);
 	sigs.emplace_back(signal, "item_locked", itemLocked, this);
-	sigs.emplace_back(signal, "item_select", itemSelect, this);
-	sigs.emplace_back(signal, "item_deselect", itemDeselect, this);
-
-	if (obs_sceneitem_is_group(sceneitem)) {
-		obs_source_t *source = obs_sceneitem_get_source(sceneitem);
-		signal = obs_source_get_signal_handler(source);
-
-		sigs.emplace_back(signal, "reorder", reorderGroup, this);
-	}
-
-	/* --------------------------------------------------------- */
-
-	auto removeSource = [](void *data, calldata_t *) {
-		SourceTreeItem *this_ = static_cast<SourceTreeItem *>(data);
-		this_->DisconnectSignals();
-		this_->sceneitem = nullptr;
-		QMetaObject::invokeMethod(this_->tree, "RefreshItems");
-	};
-
-	obs_source_t *source = obs_sceneitem_get_source(sceneitem);
-	signal = obs_source_get_signal_handler(source);
-	sigs.emplace_back(signal, "remove", removeSource, this);
 }
 
 void SourceTreeItem::mouseDoubleClickEvent(QMouseEvent *event)
@@ -571,13 +517,3 @@ void SourceTreeItem::ExpandClicked(bool checked)
 		tree->GetStm()->CollapseGroup(sceneitem);
 	}
 }
-
-void SourceTreeItem::Select()
-{
-	tree->SelectItem(sceneitem, true);
-}
-
-void SourceTreeItem::Deselect()
-{
-	tree->SelectItem(sceneitem, false);
-}
@@ -74,7 +74,4 @@ private slots:
 	void LockedChanged(bool locked);
 
 	void ExpandClicked(bool checked);
-
-	void Select();
-	void Deselect();
 };
@@ -4,6 +4,8 @@
 
 #include <qt-wrappers.hpp>
 
+#include <QSet>
+
 #include "moc_SourceTreeModel.cpp"
 
 static inline OBSScene GetCurrentScene()
@@ -22,6 +24,7 @@ void SourceTreeModel::OBSFrontendEvent(enum obs_frontend_event event, void *ptr)
 		break;
 	case OBS_FRONTEND_EVENT_EXIT:
 		stm->Clear();
+		stm->removeSignal.Disconnect();
 		obs_frontend_remove_event_callback(OBSFrontendEvent, stm);
 		break;
 	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP:
@@ -34,6 +37,8 @@ void SourceTreeModel::OBSFrontendEvent(enum obs_frontend_event event, void *ptr)
 
 void SourceTreeModel::Clear()
 {
+	sigs.clear();
+
 	beginResetModel();
 	items.clear();
 	endResetModel();
@@ -41,6 +46,91 @@ void SourceTreeModel::Clear()
 	hasGroups = false;
 }
 
+void SourceTreeModel::ConnectSceneSignals(obs_source_t *sceneSource)
+{
+	auto removeItem = [](void *data, calldata_t *cd) {
+		SourceTreeModel *stm = static_cast<SourceTreeModel *>(data);
+		obs_sceneitem_t *item = (obs_sceneitem_t *)calldata_ptr(cd, "item");
+		obs_scene_t *scene = (obs_scene_t *)calldata_ptr(cd, "scene");
+
+		QMetaObject::invokeMethod(stm, "ItemRemoved", Q_ARG(OBSSceneItem, item), Q_ARG(OBSScene, scene));
+	};
+
+	auto selectItem = [](void *data, calldata_t *cd) {
+		SourceTreeModel *stm = static_cast<SourceTreeModel *>(data);
+		obs_sceneitem_t *item = (obs_sceneitem_t *)calldata_ptr(cd, "item");
+
+		QMetaObject::invokeMethod(stm, "ItemSelected", Q_ARG(OBSSceneItem, item), Q_ARG(bool, true));
+	};
+
+	auto deselectItem = [](void *data, calldata_t *cd) {
+		SourceTreeModel *stm = static_cast<SourceTreeModel *>(data);
+		obs_sceneitem_t *item = (obs_sceneitem_t *)calldata_ptr(cd, "item");
+
+		QMetaObject::invokeMethod(stm, "ItemSelected", Q_ARG(OBSSceneItem, item), Q_ARG(bool, false));
+	};
+
+	signal_handler_t *signal = obs_source_get_signal_handler(sceneSource);
+
+	sigs.emplace_back(signal, "item_remove", removeItem, this);
+	sigs.emplace_back(signal, "item_select", selectItem, this);
+	sigs.emplace_back(signal, "item_deselect", deselectItem, this);
+}
+
+void SourceTreeModel::ConnectGroupSignals(obs_sceneitem_t *group)
+{
+	auto reorderGroup = [](void *data, calldata_t *) {
+		SourceTreeModel *stm = static_cast<SourceTreeModel *>(data);
+		QMetaObject::invokeMethod(stm->st, "ReorderItems");
+	};
+
+	obs_source_t *source = obs_sceneitem_get_source(group);
+	signal_handler_t *signal = obs_source_get_signal_handler(source);
+
+	sigs.emplace_back(signal, "reorder", reorderGroup, this);
+	ConnectSceneSignals(source);
+}
+
+void SourceTreeModel::ReconnectSignals()
+{
+	sigs.clear();
+
+	OBSScene scene = GetCurrentScene();
+	if (!scene) {
+		return;
+	}
+
+	ConnectSceneSignals(obs_scene_get_source(scene));
+
+	for (obs_sceneitem_t *item : items) {
+		if (obs_sceneitem_is_group(item)) {
+			ConnectGroupSignals(item);
+		}
+	}
+}
+
+void SourceTreeModel::ItemRemoved(OBSSceneItem item, OBSScene scene)
+{
+	if (items.contains(item)) {
+		st->Remove(item, scene);
+	}
+}
+
+void SourceTreeModel::ItemSelected(OBSSceneItem item, bool select)
+{
+	st->SelectItem(item, select);
+}
+
+void SourceTreeModel::SourceRemoved(OBSSource source)
+{
+	for (obs_sceneitem_t *item : items) {
+		if (obs_sceneitem_get_source(item) == source) {
+			st->RefreshItems();
+			return;
+		}
+	}
+}
+
 static bool enumItem(obs_scene_t *, obs_sceneitem_t *item, void *ptr)
 {
 	QVector<OBSSceneItem> &items = *static_cast<QVector<OBSSceneItem> *>(ptr);
@@ -74,6 +164,7 @@ void SourceTreeModel::SceneChanged()
 	obs_scene_enum_items(scene, enumItem, &items);
 	endResetModel();
 
+	ReconnectSignals();
 	UpdateGroupState(false);
 	st->ResetWidgets();
 
@@ -102,9 +193,9 @@ void SourceTreeModel::ReorderItems()
 	QVector<OBSSceneItem> newitems;
 	obs_scene_enum_items(scene, enumItem, &newitems);
 
-	/* if item list has changed size, do full reset */
+	/* if items were added or removed, apply those as well */
 	if (newitems.count() != items.count()) {
-		SceneChanged();
+		SyncItems(newitems);
 		return;
 	}
 
@@ -140,9 +231,9 @@ void SourceTreeModel::ReorderItems()
 			}
 		}
 
-		/* if item could not be found, do full reset */
+		/* if item could not be found, the item set has changed */
 		if (i == newitems.count()) {
-			SceneChanged();
+			SyncItems(newitems);
 			return;
 		}
 
@@ -172,16 +263,101 @@ void SourceTreeModel::ReorderItems()
 	}
 }
 
+void SourceTreeModel::Refresh()
+{
+	OBSScene scene = GetCurrentScene();
+
+	QVector<OBSSceneItem> newitems;
+	obs_scene_enum_items(scene, enumItem, &newitems);
+
+	SyncItems(newitems);
+}
+
+/* applies the differences to the new item list as removed, moved and inserted
+ * rows, so that the view keeps the widgets and selection of unchanged items */
+void SourceTreeModel::SyncItems(const QVector<OBSSceneItem> &newitems)
+{
+	QSet<obs_sceneitem_t *> newSet;
+	newSet.reserve(newitems.count());
+	for (obs_sceneitem_t *item : newitems) {
+		newSet.insert(item);
+	}
+
+	bool anyKept = false;
+	for (obs_sceneitem_t *item : items) {
+		if (newSet.contains(item)) {
+			anyKept = true;
+			break;
+		}
+	}
+
+	/* if nothing is kept, a reset is cheaper than row by row changes */
+	if (!anyKept) {
+		SceneChanged();
+		return;
+	}
+
+	/* remove items that are gone, one contiguous run at a time */
+	for (int end = items.count() - 1; end >= 0; end--) {
+		if (newSet.contains(items[end])) {
+			continue;
+		}
+
+		int start = end;
+		while (start > 0 && !newSet.contains(items[start - 1])) {
+			start--;
+		}
+
+		beginRemoveRows(QModelIndex(), start, end);
+		items.remove(start, end - start + 1);
+		endRemoveRows();
+
+		end = start;
+	}
+
+	/* move the remaining items into place, inserting new ones */
+	for (int i = 0; i < newitems.count(); i++) {
+		obs_sceneitem_t *item = newitems[i];
+		if (i < items.count() && items[i] == item) {
+			continue;
+		}
+
+		int oldIdx = -1;
+		for (int j = i + 1; j < items.count(); j++) {
+			if (items[j] == item) {
+				oldIdx = j;
+				break;
+			}
+		}
+
+		if (oldIdx != -1) {
+			beginMoveRows(QModelIndex(), oldIdx, oldIdx, QModelIndex(), i);
+			MoveItem(items, oldIdx, i);
+			endMoveRows();
+		} else {
+			beginInsertRows(QModelIndex(), i, i);
+			items.insert(i, item);
+			endInsertRows();
+
+			if (obs_sceneitem_selected(item)) {
+				st->selectionModel()->select(createIndex(i, 0), QItemSelectionModel::Select);
+			}
+		}
+	}
+
+	ReconnectSignals();
+	UpdateGroupState(true);
+	st->UpdateWidgets();
+}
+
 void SourceTreeModel::Add(obs_sceneitem_t *item)
 {
 	if (obs_sceneitem_is_group(item)) {
-		SceneChanged();
+		Refresh();
 	} else {
 		beginInsertRows(QModelIndex(), 0, 0);
 		items.insert(0, item);
 		endInsertRows();
-
-		st->UpdateWidget(createIndex(0, 0, nullptr), item);
 	}
 }
 
@@ -239,7 +415,15 @@ OBSSceneItem SourceTreeModel::Get(int idx)
 
 SourceTreeModel::SourceTreeModel(SourceTree *st_) : QAbstractListModel(st_), st(st_)
 {
+	auto removeSource = [](void *data, calldata_t *cd) {
+		SourceTreeModel *stm = static_cast<SourceTreeModel *>(data);
+		obs_source_t *source = (obs_source_t *)calldata_ptr(cd, "source");
+
+		QMetaObject::invokeMethod(stm, "SourceRemoved", Q_ARG(OBSSource, OBSSource(source)));
+	};
+
 	obs_frontend_add_event_callback(OBSFrontendEvent, this);
+	removeSignal.Connect(obs_get_signal_handler(), "source_remove", removeSource, this);
 }
 
 int SourceTreeModel::rowCount(const QModelIndex &parent) const
@@ -305,7 +489,7 @@ void SourceTreeModel::AddGroup()
 	items.insert(0, group);
 	endInsertRows();
 
-	st->UpdateWidget(createIndex(0, 0, nullptr), group);
+	ConnectGroupSignals(group);
 	UpdateGroupState(true);
 
 	QMetaObject::invokeMethod(st, "Edit", Qt::QueuedConnection, Q_ARG(int, 0));
@@ -371,7 +555,7 @@ void SourceTreeModel::UngroupSelectedGroups(QModelIndexList &indices)
 		obs_sceneitem_group_ungroup(item);
 	}
 
-	SceneChanged();
+	Refresh();
 
 	OBSData redoData = main->BackupScene(scene);
 	main->CreateSceneUndoRedoAction(QTStr("Basic.Main.Ungroup"), undoData, redoData);
@@ -401,6 +585,8 @@ void SourceTreeModel::ExpandGroup(obs_sceneitem_t *item)
 	}
 	endInsertRows();
 
+	ReconnectSignals();
+
 	st->UpdateWidgets();
 }
 
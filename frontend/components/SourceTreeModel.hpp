@@ -17,10 +17,23 @@ class SourceTreeModel : public QAbstractListModel {
 	QVector<OBSSceneItem> items;
 	bool hasGroups = false;
 
+	/* signals of the listed scene and groups, connected here rather than
+	 * by the item widgets, which only exist for some rows.  removals of
+	 * listed sources are caught by a single core signal instead of one
+	 * connection per row. */
+	std::vector<OBSSignal> sigs;
+	OBSSignal removeSignal;
+
 	static void OBSFrontendEvent(enum obs_frontend_event event, void *ptr);
 	void Clear();
 	void SceneChanged();
 	void ReorderItems();
+	void Refresh();
+	void SyncItems(const QVector<OBSSceneItem> &newitems);
+
+	void ConnectSceneSignals(obs_source_t *sceneSource);
+	void ConnectGroupSignals(obs_sceneitem_t *group);
+	void ReconnectSignals();
 
 	void Add(obs_sceneitem_t *item);
 	void Remove(obs_sceneitem_t *item);
@@ -44,4 +57,9 @@ public:
 
 	virtual Qt::ItemFlags flags(const QModelIndex &index) const override;
 	virtual Qt::DropActions supportedDropActions() const override;
+
+private slots:
+	void ItemRemoved(OBSSceneItem item, OBSScene scene);
+	void ItemSelected(OBSSceneItem item, bool select);
+	void SourceRemoved(OBSSource source);
 };
@@ -10,6 +10,7 @@
 #include "moc_VolumeMeter.cpp"
 
 QPointer<QTimer> VolumeMeter::updateTimer = nullptr;
+QList<VolumeMeter *> VolumeMeter::meters;
 
 namespace {
 constexpr int INDICATOR_THICKNESS = 3;
@@ -21,6 +22,19 @@ constexpr const char *TICK_LABEL_TOKEN = "-88";
 constexpr float TICK_LABEL_HEIGHT_SCALE_FACTOR = 0.8f;
 } // namespace
 
+static inline void atomic_max(std::atomic<float> &target, float value)
+{
+	float prev = target.load(std::memory_order_relaxed);
+	while ((isnan(prev) || prev < value) && !target.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+		;
+}
+
+static inline float take_level(std::atomic<float> &pending, float current)
+{
+	float level = pending.exchange(NAN, std::memory_order_relaxed);
+	return isnan(level) ? current : level;
+}
+
 static inline QColor color_from_int(long long val)
 {
 	QColor color(val & 0xff, (val >> 8) & 0xff, (val >> 16) & 0xff, (val >> 24) & 0xff);
@@ -323,6 +337,8 @@ VolumeMeter::VolumeMeter(QWidget *parent, obs_source_t *source)
 	meterThickness = 3;                      // Bar thickness in pixels
 	channels = (int)audio_output_get_channels(obs_get_audio());
 
+	resetLevels();
+
 	obs_volmeter_add_callback(obsVolumeMeter, obsVolMeterChanged, this);
 	obs_volmeter_attach_source(obsVolumeMeter, source);
 
@@ -332,17 +348,11 @@ VolumeMeter::VolumeMeter(QWidget *parent, obs_source_t *source)
 	if (!updateTimer) {
 		updateTimer = new QTimer(qApp);
 		updateTimer->setTimerType(Qt::PreciseTimer);
-		updateTimer->start(16);
+		connect(updateTimer, &QTimer::timeout, &VolumeMeter::updateMeters);
+		setUpdateRate((int)config_get_uint(App()->GetUserConfig(), "Audio", "MeterUpdateRate"));
 	}
 
-	connect(updateTimer, &QTimer::timeout, this, [this]() {
-		if (needLayoutChange()) {
-			doLayout();
-			update();
-		} else {
-			update(getBarRect());
-		}
-	});
+	meters.append(this);
 
 	connect(App(), &OBSApp::StyleChanged, this, [this]() {
 		updateTickLabelTokenSize();
@@ -357,10 +367,38 @@ VolumeMeter::VolumeMeter(QWidget *parent, obs_source_t *source)
 
 VolumeMeter::~VolumeMeter()
 {
+	meters.removeOne(this);
+
 	obs_volmeter_remove_callback(obsVolumeMeter, obsVolMeterChanged, this);
 	obs_volmeter_detach_source(obsVolumeMeter);
 }
 
+void VolumeMeter::setUpdateRate(int fps)
+{
+	if (updateTimer) {
+		updateTimer->start(1000 / std::clamp(fps, 10, 144));
+	}
+}
+
+void VolumeMeter::updateMeters()
+{
+	for (VolumeMeter *meter : meters) {
+		// Meters in hidden docks or scrolled out of view are not
+		// painted; the levels they missed are folded into the peaks
+		// taken on their next paint.
+		if (!meter->isVisible() || meter->visibleRegion().isEmpty()) {
+			continue;
+		}
+
+		if (meter->needLayoutChange()) {
+			meter->doLayout();
+			meter->update();
+		} else {
+			meter->update(meter->getBarRect());
+		}
+	}
+}
+
 void VolumeMeter::obsSourceDestroyed(void *data, calldata_t *)
 {
 	VolumeMeter *self = static_cast<VolumeMeter *>(data);
@@ -371,19 +409,16 @@ void VolumeMeter::setLevels(const float magnitude[MAX_AUDIO_CHANNELS], const flo
 			    const float inputPeak[MAX_AUDIO_CHANNELS])
 {
 	uint64_t ts = os_gettime_ns();
-	QMutexLocker locker(&dataMutex);
 
-	currentLastUpdateTime = ts;
+	// In case there are more updates than redraws the peaks are kept
+	// until the next redraw takes them.
 	for (int channelNr = 0; channelNr < MAX_AUDIO_CHANNELS; channelNr++) {
-		currentMagnitude[channelNr] = magnitude[channelNr];
-		currentPeak[channelNr] = peak[channelNr];
-		currentInputPeak[channelNr] = inputPeak[channelNr];
+		pendingMagnitude[channelNr].store(magnitude[channelNr], std::memory_order_relaxed);
+		atomic_max(pendingPeak[channelNr], peak[channelNr]);
+		atomic_max(pendingInputPeak[channelNr], inputPeak[channelNr]);
 	}
 
-	// In case there are more updates then redraws we must make sure
-	// that the ballistics of peak and hold are recalculated.
-	locker.unlock();
-	calculateBallistics(ts);
+	currentLastUpdateTime.store(ts, std::memory_order_release);
 }
 
 void VolumeMeter::obsVolMeterChanged(void *data, const float magnitude[MAX_AUDIO_CHANNELS],
@@ -398,6 +433,10 @@ inline void VolumeMeter::resetLevels()
 {
 	currentLastUpdateTime = 0;
 	for (int channelNr = 0; channelNr < MAX_AUDIO_CHANNELS; channelNr++) {
+		pendingMagnitude[channelNr] = NAN;
+		pendingPeak[channelNr] = NAN;
+		pendingInputPeak[channelNr] = NAN;
+
 		currentMagnitude[channelNr] = -M_INFINITE;
 		currentPeak[channelNr] = -M_INFINITE;
 		currentInputPeak[channelNr] = -M_INFINITE;
@@ -411,6 +450,15 @@ inline void VolumeMeter::resetLevels()
 	}
 }
 
+inline void VolumeMeter::takeLevels()
+{
+	for (int channelNr = 0; channelNr < MAX_AUDIO_CHANNELS; channelNr++) {
+		currentMagnitude[channelNr] = take_level(pendingMagnitude[channelNr], currentMagnitude[channelNr]);
+		currentPeak[channelNr] = take_level(pendingPeak[channelNr], currentPeak[channelNr]);
+		currentInputPeak[channelNr] = take_level(pendingInputPeak[channelNr], currentInputPeak[channelNr]);
+	}
+}
+
 bool VolumeMeter::needLayoutChange()
 {
 	int currentNrAudioChannels = obs_volmeter_get_nr_channels(obsVolumeMeter);
@@ -490,14 +538,13 @@ QRect VolumeMeter::getBarRect() const
 // stylesheet.
 inline void VolumeMeter::doLayout()
 {
-	QMutexLocker locker(&dataMutex);
-
 	if (displayNrAudioChannels) {
 		int meterSize = std::floor(22 / displayNrAudioChannels);
 		meterThickness = std::clamp(meterSize, 3, 6);
 	}
 
 	updateBackgroundCache();
+	foregroundCache = QPixmap();
 	resetLevels();
 
 	updateGeometry();
@@ -575,8 +622,6 @@ inline void VolumeMeter::calculateBallisticsForChannel(int channelNr, uint64_t t
 
 inline void VolumeMeter::calculateBallistics(uint64_t ts, qreal timeSinceLastRedraw)
 {
-	QMutexLocker locker(&dataMutex);
-
 	for (int channelNr = 0; channelNr < MAX_AUDIO_CHANNELS; channelNr++) {
 		calculateBallisticsForChannel(channelNr, ts, timeSinceLastRedraw);
 	}
@@ -676,6 +721,8 @@ void VolumeMeter::updateBackgroundCache(bool force)
 		return;
 	}
 
+	foregroundCache = QPixmap();
+
 	QColor backgroundColor = palette().color(QPalette::Window);
 
 	backgroundCache = QPixmap(size() * devicePixelRatioF());
@@ -727,6 +774,51 @@ void VolumeMeter::updateBackgroundCache(bool force)
 	}
 }
 
+// The foreground bars are drawn at full length once, and the peak bars are
+// painted by copying the part of them that is lit.
+void VolumeMeter::updateForegroundCache(const QColor &nominal, const QColor &warning, const QColor &error)
+{
+	if (size().isEmpty()) {
+		return;
+	}
+
+	foregroundCacheNominalColor = nominal;
+	foregroundCacheWarningColor = warning;
+	foregroundCacheErrorColor = error;
+
+	foregroundCache = QPixmap(size() * devicePixelRatioF());
+	foregroundCache.setDevicePixelRatio(devicePixelRatioF());
+	foregroundCache.fill(Qt::transparent);
+
+	QPainter fg{&foregroundCache};
+
+	int meterStart = INDICATOR_THICKNESS + 2;
+	int meterLength = vertical ? rect().height() - (INDICATOR_THICKNESS + 2)
+				   : rect().width() - (INDICATOR_THICKNESS + 2);
+
+	qreal scale = meterLength / minimumLevel;
+
+	int warningPosition = meterLength - convertToInt(warningLevel * scale);
+	int errorPosition = meterLength - convertToInt(errorLevel * scale);
+
+	int nominalLength = warningPosition;
+	int warningLength = nominalLength + (errorPosition - warningPosition);
+
+	for (int channelNr = 0; channelNr < displayNrAudioChannels; channelNr++) {
+		int channelOffset = channelNr * (meterThickness + 1);
+
+		if (vertical) {
+			fg.fillRect(channelOffset, meterLength, meterThickness, -meterLength, error);
+			fg.fillRect(channelOffset, meterLength, meterThickness, -warningLength, warning);
+			fg.fillRect(channelOffset, meterLength, meterThickness, -nominalLength, nominal);
+		} else {
+			fg.fillRect(meterStart, channelOffset, meterLength, meterThickness, error);
+			fg.fillRect(meterStart, channelOffset, warningLength, meterThickness, warning);
+			fg.fillRect(meterStart, channelOffset, nominalLength, meterThickness, nominal);
+		}
+	}
+}
+
 inline int VolumeMeter::convertToInt(float number)
 {
 	constexpr int min = std::numeric_limits<int>::min();
@@ -745,7 +837,11 @@ inline int VolumeMeter::convertToInt(float number)
 void VolumeMeter::paintEvent(QPaintEvent *)
 {
 	uint64_t ts = os_gettime_ns();
-	qreal timeSinceLastRedraw = (ts - lastRedrawTime) * 0.000000001;
+
+	// Meters that were off screen have not been painted for a while,
+	// don't let the ballistics overshoot when they come back.
+	qreal timeSinceLastRedraw = std::min((ts - lastRedrawTime) * 0.000000001, magnitudeIntegrationTime);
+	takeLevels();
 	calculateBallistics(ts, timeSinceLastRedraw);
 	bool idle = detectIdle(ts);
 
@@ -765,18 +861,19 @@ void VolumeMeter::paintEvent(QPaintEvent *)
 	// Paint cached background pixmap
 	painter.drawPixmap(0, 0, backgroundCache);
 
+	if (foregroundCache.isNull() || foregroundCacheNominalColor != nominal || foregroundCacheWarningColor != warning ||
+	    foregroundCacheErrorColor != error) {
+		updateForegroundCache(nominal, warning, error);
+	}
+
 	// Draw dynamic audio meter bars
 	int warningPosition = meterLength - convertToInt(warningLevel * scale);
 	int errorPosition = meterLength - convertToInt(errorLevel * scale);
 	int clipPosition = meterLength - convertToInt(clipLevel * scale);
 
-	int nominalLength = warningPosition;
-	int warningLength = nominalLength + (errorPosition - warningPosition);
-
 	for (int channelNr = 0; channelNr < displayNrAudioChannels; channelNr++) {
 		int channelNrFixed = (displayNrAudioChannels == 1 && channels > 2) ? 2 : channelNr;
 
-		QMutexLocker locker(&dataMutex);
 		float peak = displayPeak[channelNrFixed];
 		float peakHold = displayPeakHold[channelNrFixed];
 		float magnitude = displayMagnitude[channelNrFixed];
@@ -784,22 +881,16 @@ void VolumeMeter::paintEvent(QPaintEvent *)
 		int peakPosition = meterLength - convertToInt(peak * scale);
 		int peakHoldPosition = meterLength - convertToInt(peakHold * scale);
 		int magnitudePosition = meterLength - convertToInt(magnitude * scale);
-		locker.unlock();
 
 		if (clipping) {
 			peakPosition = meterLength;
 		}
 
-		auto fill = [&](int pos, int length, const QColor &color) {
-			if (vertical) {
-				painter.fillRect(pos, meterLength, meterThickness, -length, color);
-			} else {
-				painter.fillRect(meterStart, pos, length, meterThickness, color);
-			}
-		};
-
 		int channelOffset = channelNr * (meterThickness + 1);
 
+		QRectF barRect = vertical ? QRectF(channelOffset, 0, meterThickness, meterLength)
+					  : QRectF(meterStart, channelOffset, meterLength, meterThickness);
+
 		// Draw audio meter peak bars
 		if (peakPosition >= clipPosition) {
 			if (!clipping) {
@@ -807,17 +898,18 @@ void VolumeMeter::paintEvent(QPaintEvent *)
 				clipping = true;
 			}
 
-			fill(channelOffset, meterLength, error);
-		} else {
-			if (peakPosition > errorPosition) {
-				fill(channelOffset, std::min(peakPosition, meterLength), error);
-			}
-			if (peakPosition > warningPosition) {
-				fill(channelOffset, std::min(peakPosition, warningLength), warning);
-			}
-			if (peakPosition > meterStart) {
-				fill(channelOffset, std::min(peakPosition, nominalLength), nominal);
+			painter.fillRect(barRect, error);
+		} else if (peakPosition > meterStart) {
+			int length = std::min(peakPosition, meterLength);
+			if (vertical) {
+				barRect.setTop(meterLength - length);
+			} else {
+				barRect.setWidth(length);
 			}
+
+			qreal dpr = foregroundCache.devicePixelRatio();
+			QRectF source(barRect.topLeft() * dpr, barRect.size() * dpr);
+			painter.drawPixmap(barRect, foregroundCache, source);
 		}
 
 		// Draw peak hold indicators
@@ -2,10 +2,11 @@
 
 #include <obs.hpp>
 
-#include <QMutex>
 #include <QPixmap>
 #include <QWidget>
 
+#include <atomic>
+
 #define FADER_PRECISION 4096.0
 
 class VolumeMeter : public QWidget {
@@ -47,7 +48,11 @@ private:
 	OBSWeakSource weakSource;
 	OBSVolMeter obsVolumeMeter;
 
+	// All meters are driven by one timer, which walks the list once per
+	// tick and only schedules repaints for meters that are on screen.
 	static QPointer<QTimer> updateTimer;
+	static QList<VolumeMeter *> meters;
+	static void updateMeters();
 
 	static void obsVolMeterChanged(void *data, const float magnitude[MAX_AUDIO_CHANNELS],
 				       const float peak[MAX_AUDIO_CHANNELS], const float inputPeak[MAX_AUDIO_CHANNELS]);
@@ -56,6 +61,7 @@ private:
 	static void obsSourceDestroyed(void *data, calldata_t *);
 
 	inline void resetLevels();
+	inline void takeLevels();
 	inline void doLayout();
 	inline bool detectIdle(uint64_t ts);
 	inline void calculateBallistics(uint64_t ts, qreal timeSinceLastRedraw = 0.0);
@@ -67,9 +73,14 @@ private:
 	void paintHTicks(QPainter &painter, int x, int y, int width);
 	void paintVTicks(QPainter &painter, int x, int y, int height);
 
-	QMutex dataMutex;
+	// Written by the audio thread, taken by the UI thread when painting.
+	// Peaks are the maximum since they were last taken, NaN if there has
+	// been no update since.
+	std::atomic<uint64_t> currentLastUpdateTime{0};
+	std::atomic<float> pendingMagnitude[MAX_AUDIO_CHANNELS];
+	std::atomic<float> pendingPeak[MAX_AUDIO_CHANNELS];
+	std::atomic<float> pendingInputPeak[MAX_AUDIO_CHANNELS];
 
-	uint64_t currentLastUpdateTime{0};
 	float currentMagnitude[MAX_AUDIO_CHANNELS];
 	float currentPeak[MAX_AUDIO_CHANNELS];
 	float currentInputPeak[MAX_AUDIO_CHANNELS];
@@ -87,6 +98,12 @@ private:
 	QPixmap backgroundCache;
 	void updateBackgroundCache(bool force = false);
 
+	QPixmap foregroundCache;
+	QColor foregroundCacheNominalColor;
+	QColor foregroundCacheWarningColor;
+	QColor foregroundCacheErrorColor;
+	void updateForegroundCache(const QColor &nominal, const QColor &warning, const QColor &error);
+
 	QSize tickTextTokenRect;
 
 	QColor backgroundNominalColor;
@@ -142,6 +159,7 @@ public:
 
 	void setLevels(const float magnitude[MAX_AUDIO_CHANNELS], const float peak[MAX_AUDIO_CHANNELS],
 		       const float inputPeak[MAX_AUDIO_CHANNELS]);
+	static void setUpdateRate(int fps);
 	bool needLayoutChange();
 
 	void setVertical(bool vertical = true);
@@ -26,6 +26,7 @@
 
 #include <QDirIterator>
 #include <QDropEvent>
+#include <QLocale>
 #include <QMimeData>
 #include <QPushButton>
 
@@ -34,7 +35,6 @@
 OBSRemux::OBSRemux(const char *path, QWidget *parent, bool autoRemux_)
 	: QDialog(parent),
 	  queueModel(new RemuxQueueModel),
-	  worker(new RemuxWorker()),
 	  ui(new Ui::OBSRemux),
 	  recPath(path),
 	  autoRemux(autoRemux_)
@@ -49,11 +49,17 @@ OBSRemux::OBSRemux(const char *path, QWidget *parent, bool autoRemux_)
 	ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
 	ui->buttonBox->button(QDialogButtonBox::RestoreDefaults)->setEnabled(false);
 
+	ui->maxJobs->setValue(config_get_int(App()->GetUserConfig(), "General", "RemuxMaxJobs"));
+	ui->fastStart->setChecked(config_get_bool(App()->GetUserConfig(), "General", "RemuxFastStart"));
+
 	if (autoRemux) {
 		resize(280, 40);
 		ui->tableView->hide();
 		ui->buttonBox->hide();
 		ui->label->hide();
+		ui->maxJobsLabel->hide();
+		ui->maxJobs->hide();
+		ui->fastStart->hide();
 	}
 
 	ui->progressBar->setMinimum(0);
@@ -85,13 +91,10 @@ OBSRemux::OBSRemux(const char *path, QWidget *parent, bool autoRemux_)
 		&OBSRemux::clearAll);
 	connect(ui->buttonBox->button(QDialogButtonBox::Close), &QPushButton::clicked, this, &OBSRemux::close);
 
-	worker->moveToThread(&remuxer);
-	remuxer.start();
-
-	connect(worker.data(), &RemuxWorker::updateProgress, this, &OBSRemux::updateProgress);
-	connect(&remuxer, &QThread::finished, worker.data(), &QObject::deleteLater);
-	connect(worker.data(), &RemuxWorker::remuxFinished, this, &OBSRemux::remuxFinished);
-	connect(this, &OBSRemux::remux, worker.data(), &RemuxWorker::remux);
+	connect(ui->maxJobs, &QSpinBox::valueChanged, this,
+		[](int value) { config_set_int(App()->GetUserConfig(), "General", "RemuxMaxJobs", value); });
+	connect(ui->fastStart, &QCheckBox::toggled, this,
+		[](bool checked) { config_set_bool(App()->GetUserConfig(), "General", "RemuxFastStart", checked); });
 
 	connect(queueModel.data(), &RemuxQueueModel::rowsInserted, this, &OBSRemux::rowCountChanged);
 	connect(queueModel.data(), &RemuxQueueModel::rowsRemoved, this, &OBSRemux::rowCountChanged);
@@ -101,16 +104,76 @@ OBSRemux::OBSRemux(const char *path, QWidget *parent, bool autoRemux_)
 				  Q_ARG(const QModelIndex &, index));
 }
 
+RemuxWorker *OBSRemux::IdleWorker()
+{
+	for (RemuxWorker *worker : workers) {
+		if (!worker->busy) {
+			return worker;
+		}
+	}
+
+	if ((int)workers.size() >= maxJobs) {
+		return nullptr;
+	}
+
+	// Workers are created as they are needed, each on its own thread,
+	// and are kept around until the dialog is closed.
+	QThread *remuxer = new QThread();
+	RemuxWorker *worker = new RemuxWorker();
+	worker->moveToThread(remuxer);
+	remuxer->start();
+
+	connect(worker, &RemuxWorker::updateProgress, this,
+		[this, worker](float percent, quint64 bytesPerSec) { UpdateProgress(worker, percent, bytesPerSec); });
+	connect(remuxer, &QThread::finished, worker, &QObject::deleteLater);
+	connect(worker, &RemuxWorker::remuxFinished, this,
+		[this, worker](bool success) { RemuxFinished(worker, success); });
+
+	remuxers.emplace_back(remuxer);
+	workers.push_back(worker);
+	return worker;
+}
+
+void OBSRemux::StartJob(RemuxWorker *worker, quint64 entryId, const QString &source, const QString &target)
+{
+	{
+		QMutexLocker lock(&worker->updateMutex);
+		worker->isWorking = true;
+	}
+
+	worker->busy = true;
+	worker->entryId = entryId;
+	worker->percent = 0.0f;
+	worker->bytesPerSec = 0;
+	worker->fastStart = ui->fastStart->isChecked();
+
+	QMetaObject::invokeMethod(worker, [worker, source, target]() { worker->remux(source, target); });
+}
+
+bool OBSRemux::IsWorking() const
+{
+	for (RemuxWorker *worker : workers) {
+		if (worker->busy) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool OBSRemux::stopRemux()
 {
-	if (!worker->isWorking) {
+	if (!IsWorking()) {
 		return true;
 	}
 
-	// By locking the worker thread's mutex, we ensure that its
-	// update poll will be blocked as long as we're in here with
+	// By locking the worker threads' mutexes, we ensure that their
+	// update polls will be blocked as long as we're in here with
 	// the popup open.
-	QMutexLocker lock(&worker->updateMutex);
+	std::vector<std::unique_ptr<QMutexLocker<QMutex>>> locks;
+	for (RemuxWorker *worker : workers) {
+		locks.emplace_back(new QMutexLocker(&worker->updateMutex));
+	}
 
 	bool exit = false;
 
@@ -120,10 +183,14 @@ bool OBSRemux::stopRemux()
 	}
 
 	if (exit) {
-		// Inform the worker it should no longer be
-		// working. It will interrupt accordingly in
-		// its next update callback.
-		worker->isWorking = false;
+		// Inform the workers they should no longer be
+		// working. They will interrupt accordingly in
+		// their next update callback, and no new jobs
+		// will be started.
+		for (RemuxWorker *worker : workers) {
+			worker->isWorking = false;
+		}
+		stopping = true;
 	}
 
 	return exit;
@@ -132,8 +199,10 @@ bool OBSRemux::stopRemux()
 OBSRemux::~OBSRemux()
 {
 	stopRemux();
-	remuxer.quit();
-	remuxer.wait();
+	for (std::unique_ptr<QThread> &remuxer : remuxers) {
+		remuxer->quit();
+		remuxer->wait();
+	}
 }
 
 void OBSRemux::rowCountChanged(const QModelIndex &, int, int)
@@ -144,7 +213,7 @@ void OBSRemux::rowCountChanged(const QModelIndex &, int, int)
 	// at least one row for the empty insertion point.
 	if (queueModel->rowCount() > 1) {
 		ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(true);
-		ui->buttonBox->button(QDialogButtonBox::RestoreDefaults)->setEnabled(true);
+		ui->buttonBox->button(QDialogButtonBox::RestoreDefaults)->setEnabled(!queueModel->isProcessing);
 		ui->buttonBox->button(QDialogButtonBox::Reset)->setEnabled(queueModel->canClearFinished());
 	} else {
 		ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
@@ -191,14 +260,14 @@ void OBSRemux::dropEvent(QDropEvent *ev)
 
 void OBSRemux::dragEnterEvent(QDragEnterEvent *ev)
 {
-	if (ev->mimeData()->hasUrls() && !worker->isWorking) {
+	if (ev->mimeData()->hasUrls() && !IsWorking()) {
 		ev->accept();
 	}
 }
 
 void OBSRemux::beginRemux()
 {
-	if (worker->isWorking) {
+	if (IsWorking()) {
 		stopRemux();
 		return;
 	}
@@ -226,6 +295,17 @@ void OBSRemux::beginRemux()
 	// Set all jobs to "pending" first.
 	queueModel->beginProcessing();
 
+	// Clearing everything would drop the entries that are still being
+	// remuxed. Finished entries can still be cleared.
+	ui->buttonBox->button(QDialogButtonBox::RestoreDefaults)->setEnabled(false);
+
+	maxJobs = ui->maxJobs->value();
+	jobsDone = 0;
+	stopping = false;
+
+	ui->progressBar->setValue(0);
+	ui->progressBar->setFormat("%p%");
+
 	ui->progressBar->setVisible(true);
 	ui->buttonBox->button(QDialogButtonBox::Ok)->setText(QTStr("Remux.Stop"));
 	setAcceptDrops(false);
@@ -237,19 +317,29 @@ void OBSRemux::AutoRemux(QString inFile, QString outFile)
 {
 	if (inFile != "" && outFile != "" && autoRemux) {
 		ui->progressBar->setVisible(true);
-		emit remux(inFile, outFile);
+		StartJob(IdleWorker(), 0, inFile, outFile);
 		autoRemuxFile = outFile;
 	}
 }
 
 void OBSRemux::remuxNextEntry()
 {
-	worker->lastProgress = 0.f;
+	while (!stopping) {
+		RemuxWorker *worker = IdleWorker();
+		if (!worker) {
+			break;
+		}
 
-	QString inputPath, outputPath;
-	if (queueModel->beginNextEntry(inputPath, outputPath)) {
-		emit remux(inputPath, outputPath);
-	} else {
+		quint64 entryId;
+		QString inputPath, outputPath;
+		if (!queueModel->beginNextEntry(entryId, inputPath, outputPath)) {
+			break;
+		}
+
+		StartJob(worker, entryId, inputPath, outputPath);
+	}
+
+	if (!IsWorking()) {
 		queueModel->autoRemux = autoRemux;
 		queueModel->endProcessing();
 
@@ -285,16 +375,44 @@ void OBSRemux::reject()
 	QDialog::reject();
 }
 
-void OBSRemux::updateProgress(float percent)
+void OBSRemux::UpdateProgress(RemuxWorker *worker, float percent, quint64 bytesPerSec)
 {
-	ui->progressBar->setValue(percent * 10);
+	if (!worker->busy) {
+		return;
+	}
+
+	worker->percent = percent;
+	worker->bytesPerSec = bytesPerSec;
+
+	// The bar shows the whole batch, with every running job
+	// contributing its share.
+	int jobs = jobsDone + queueModel->pendingCount();
+	float total = jobsDone * 100.0f;
+	quint64 totalBytesPerSec = 0;
+
+	for (RemuxWorker *cur : workers) {
+		if (cur->busy) {
+			jobs++;
+			total += cur->percent;
+			totalBytesPerSec += cur->bytesPerSec;
+		}
+	}
+
+	ui->progressBar->setValue(total * 10 / jobs);
+	QString speed = QLocale().formattedDataSize(totalBytesPerSec, 1, QLocale::DataSizeSIFormat);
+	ui->progressBar->setFormat(QTStr("Remux.Progress").arg(speed));
 }
 
-void OBSRemux::remuxFinished(bool success)
+void OBSRemux::RemuxFinished(RemuxWorker *worker, bool success)
 {
 	ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(true);
 
-	queueModel->finishEntry(success);
+	worker->busy = false;
+	jobsDone++;
+
+	queueModel->finishEntry(worker->entryId, success);
+	worker->entryId = 0;
+	ui->buttonBox->button(QDialogButtonBox::Reset)->setEnabled(queueModel->canClearFinished());
 
 	if (autoRemux && autoRemuxFile != "") {
 		QTimer::singleShot(3000, this, &OBSRemux::close);
@@ -22,6 +22,9 @@
 #include <QPointer>
 #include <QThread>
 
+#include <memory>
+#include <vector>
+
 class RemuxQueueModel;
 class RemuxWorker;
 
@@ -29,8 +32,11 @@ class OBSRemux : public QDialog {
 	Q_OBJECT
 
 	QPointer<RemuxQueueModel> queueModel;
-	QThread remuxer;
-	QPointer<RemuxWorker> worker;
+	std::vector<std::unique_ptr<QThread>> remuxers;
+	std::vector<QPointer<RemuxWorker>> workers;
+	int maxJobs = 1;
+	int jobsDone = 0;
+	bool stopping = false;
 
 	std::unique_ptr<Ui::OBSRemux> ui;
 
@@ -42,6 +48,12 @@ class OBSRemux : public QDialog {
 	bool autoRemux;
 	QString autoRemuxFile;
 
+	RemuxWorker *IdleWorker();
+	void StartJob(RemuxWorker *worker, quint64 entryId, const QString &source, const QString &target);
+	bool IsWorking() const;
+	void UpdateProgress(RemuxWorker *worker, float percent, quint64 bytesPerSec);
+	void RemuxFinished(RemuxWorker *worker, bool success);
+
 public:
 	explicit OBSRemux(const char *recPath, QWidget *parent = nullptr, bool autoRemux = false);
 	virtual ~OBSRemux() override;
@@ -60,13 +72,8 @@ private slots:
 	void rowCountChanged(const QModelIndex &parent, int first, int last);
 
 public slots:
-	void updateProgress(float percent);
-	void remuxFinished(bool success);
 	void beginRemux();
 	bool stopRemux();
 	void clearFinished();
 	void clearAll();
-
-signals:
-	void remux(const QString &source, const QString &target);
 };
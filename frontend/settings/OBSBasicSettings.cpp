@@ -24,6 +24,7 @@
 #include <components/OBSSourceLabel.hpp>
 #include <components/SilentUpdateCheckBox.hpp>
 #include <components/SilentUpdateSpinBox.hpp>
+#include <components/VolumeMeter.hpp>
 #ifdef YOUTUBE_ENABLED
 #include <docks/YouTubeAppDock.hpp>
 #endif
@@ -391,6 +392,7 @@ OBSBasicSettings::OBSBasicSettings(QWidget *parent)
 	HookWidget(ui->multiviewDrawNames,   CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->multiviewDrawAreas,   CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->multiviewLayout,      COMBO_CHANGED,  GENERAL_CHANGED);
+	HookWidget(ui->multiviewThumbnailFPS,SCROLL_CHANGED, GENERAL_CHANGED);
 	HookWidget(ui->theme, 		     COMBO_CHANGED,  APPEAR_CHANGED);
 	HookWidget(ui->themeVariant,	     COMBO_CHANGED,  APPEAR_CHANGED);
 	HookWidget(ui->appearanceFontScale,  SLIDER_CHANGED, APPEAR_CHANGED);
@@ -525,6 +527,7 @@ OBSBasicSettings::OBSBasicSettings(QWidget *parent)
 	HookWidget(ui->sampleRate,           COMBO_CHANGED,  AUDIO_RESTART);
 	HookWidget(ui->meterDecayRate,       COMBO_CHANGED,  AUDIO_CHANGED);
 	HookWidget(ui->peakMeterType,        COMBO_CHANGED,  AUDIO_CHANGED);
+	HookWidget(ui->meterUpdateRate,      SCROLL_CHANGED, AUDIO_CHANGED);
 	HookWidget(ui->desktopAudioDevice1,  COMBO_CHANGED,  AUDIO_CHANGED);
 	HookWidget(ui->desktopAudioDevice2,  COMBO_CHANGED,  AUDIO_CHANGED);
 	HookWidget(ui->auxAudioDevice1,      COMBO_CHANGED,  AUDIO_CHANGED);
@@ -1428,6 +1431,11 @@ void OBSBasicSettings::LoadGeneralSettings()
 	ui->multiviewLayout->setCurrentIndex(ui->multiviewLayout->findData(
 		QVariant::fromValue(config_get_int(App()->GetUserConfig(), "BasicWindow", "MultiviewLayout"))));
 
+	ui->multiviewThumbnailFPS->setSpecialValueText(
+		QTStr("Basic.Settings.General.Multiview.ThumbnailFPS.EveryFrame"));
+	ui->multiviewThumbnailFPS->setValue(
+		(int)config_get_uint(App()->GetUserConfig(), "BasicWindow", "MultiviewThumbnailFPS"));
+
 	prevLangIndex = ui->language->currentIndex();
 
 	if (obs_video_active()) {
@@ -2548,6 +2556,7 @@ void OBSBasicSettings::LoadAudioSettings()
 	}
 
 	ui->peakMeterType->setCurrentIndex(peakMeterTypeIdx);
+	ui->meterUpdateRate->setValue((int)config_get_uint(App()->GetUserConfig(), "Audio", "MeterUpdateRate"));
 	ui->lowLatencyBuffering->setChecked(enableLLAudioBuffering);
 
 	LoadAudioDevices();
@@ -3230,6 +3239,12 @@ void OBSBasicSettings::SaveGeneralSettings()
 		multiviewChanged = true;
 	}
 
+	if (WidgetChanged(ui->multiviewThumbnailFPS)) {
+		config_set_uint(App()->GetUserConfig(), "BasicWindow", "MultiviewThumbnailFPS",
+				ui->multiviewThumbnailFPS->value());
+		multiviewChanged = true;
+	}
+
 	if (multiviewChanged) {
 		OBSProjector::UpdateMultiviewProjectors();
 	}
@@ -3683,6 +3698,11 @@ void OBSBasicSettings::SaveAudioSettings()
 		emit main->profileSettingChanged("Audio", "PeakMeterType");
 	}
 
+	if (WidgetChanged(ui->meterUpdateRate)) {
+		config_set_uint(App()->GetUserConfig(), "Audio", "MeterUpdateRate", ui->meterUpdateRate->value());
+		VolumeMeter::setUpdateRate(ui->meterUpdateRate->value());
+	}
+
 	if (WidgetChanged(ui->lowLatencyBuffering)) {
 		bool enableLLAudioBuffering = ui->lowLatencyBuffering->isChecked();
 		config_set_bool(App()->GetUserConfig(), "Audio", "LowLatencyAudioBuffering", enableLLAudioBuffering);
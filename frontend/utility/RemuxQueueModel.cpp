@@ -344,14 +344,14 @@ void RemuxQueueModel::endProcessing()
 	emit dataChanged(index(0, RemuxEntryColumn::State), index(queue.length(), RemuxEntryColumn::State));
 }
 
-bool RemuxQueueModel::beginNextEntry(QString &inputPath, QString &outputPath)
+bool RemuxQueueModel::beginNextEntry(quint64 &id, QString &inputPath, QString &outputPath)
 {
-	bool anyStarted = false;
-
 	for (int row = 0; row < queue.length(); row++) {
 		RemuxQueueEntry &entry = queue[row];
 		if (entry.state == RemuxEntryState::Pending) {
 			entry.state = RemuxEntryState::InProgress;
+			entry.id = nextEntryId++;
+			id = entry.id;
 
 			inputPath = entry.sourcePath;
 			outputPath = entry.targetPath;
@@ -359,18 +359,27 @@ bool RemuxQueueModel::beginNextEntry(QString &inputPath, QString &outputPath)
 			QModelIndex index = this->index(row, RemuxEntryColumn::State);
 			emit dataChanged(index, index);
 
-			anyStarted = true;
-			break;
+			return true;
 		}
 	}
 
-	return anyStarted;
+	id = 0;
+	return false;
 }
 
-void RemuxQueueModel::finishEntry(bool success)
+void RemuxQueueModel::finishEntry(quint64 id, bool success)
 {
+	if (!id) {
+		return;
+	}
+
 	for (int row = 0; row < queue.length(); row++) {
 		RemuxQueueEntry &entry = queue[row];
+		if (entry.id != id) {
+			continue;
+		}
+
+		entry.id = 0;
 		if (entry.state == RemuxEntryState::InProgress) {
 			if (success) {
 				entry.state = RemuxEntryState::Complete;
@@ -380,8 +389,19 @@ void RemuxQueueModel::finishEntry(bool success)
 
 			QModelIndex index = this->index(row, RemuxEntryColumn::State);
 			emit dataChanged(index, index);
+		}
+		break;
+	}
+}
 
-			break;
+int RemuxQueueModel::pendingCount() const
+{
+	int count = 0;
+	for (const RemuxQueueEntry &entry : queue) {
+		if (entry.state == RemuxEntryState::Pending) {
+			count++;
 		}
 	}
+
+	return count;
 }
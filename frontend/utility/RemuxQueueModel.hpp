@@ -53,8 +53,9 @@ public:
 	bool checkForErrors() const;
 	void beginProcessing();
 	void endProcessing();
-	bool beginNextEntry(QString &inputPath, QString &outputPath);
-	void finishEntry(bool success);
+	bool beginNextEntry(quint64 &id, QString &inputPath, QString &outputPath);
+	void finishEntry(quint64 id, bool success);
+	int pendingCount() const;
 	bool canClearFinished() const;
 	void clearFinished();
 	void clearAll();
@@ -67,10 +68,15 @@ private:
 
 		QString sourcePath;
 		QString targetPath;
+
+		/* identifies the entry while it is being remuxed, rows
+		 * shift when finished entries are cleared */
+		quint64 id = 0;
 	};
 
 	QList<RemuxQueueEntry> queue;
 	bool isProcessing;
+	quint64 nextEntryId = 1;
 
 	static QVariant getIcon(RemuxEntryState state);
 
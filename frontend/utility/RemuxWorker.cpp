@@ -20,37 +20,40 @@
 #include <media-io/media-remux.h>
 #include <qt-wrappers.hpp>
 
-void RemuxWorker::UpdateProgress(float percent)
+void RemuxWorker::UpdateProgress(float percent, quint64 bytesPerSec)
 {
 	if (abs(lastProgress - percent) < 0.1f) {
 		return;
 	}
 
-	emit updateProgress(percent);
+	emit updateProgress(percent, bytesPerSec);
 	lastProgress = percent;
 }
 
 void RemuxWorker::remux(const QString &source, const QString &target)
 {
-	isWorking = true;
+	/* isWorking is set by the dialog when the job is queued, so that a
+	 * stop request can't be missed before the job starts */
+	lastProgress = 0.0f;
 
-	auto callback = [](void *data, float percent) {
+	auto callback = [](void *data, const struct media_remux_progress *progress) {
 		RemuxWorker *rw = static_cast<RemuxWorker *>(data);
 
 		QMutexLocker lock(&rw->updateMutex);
 
-		rw->UpdateProgress(percent);
+		rw->UpdateProgress(progress->percent, progress->bytes_per_sec);
 
 		return rw->isWorking;
 	};
 
 	bool stopped = false;
 	bool success = false;
+	uint32_t flags = fastStart ? MEDIA_REMUX_FAST_START : 0;
 
 	media_remux_job_t mr_job = nullptr;
-	if (media_remux_job_create(&mr_job, QT_TO_UTF8(source), QT_TO_UTF8(target))) {
+	if (media_remux_job_create2(&mr_job, QT_TO_UTF8(source), QT_TO_UTF8(target), flags)) {
 
-		success = media_remux_job_process(mr_job, callback, this);
+		success = media_remux_job_process2(mr_job, callback, this);
 
 		media_remux_job_destroy(mr_job);
 
@@ -27,8 +27,16 @@ class RemuxWorker : public QObject {
 
 	bool isWorking;
 
+	/* owned by the dialog's thread */
+	bool busy = false;
+	quint64 entryId = 0;
+	float percent = 0.0f;
+	quint64 bytesPerSec = 0;
+
+	bool fastStart = false;
+
 	float lastProgress;
-	void UpdateProgress(float percent);
+	void UpdateProgress(float percent, quint64 bytesPerSec);
 
 	explicit RemuxWorker() : isWorking(false) {}
 	virtual ~RemuxWorker() {};
@@ -37,7 +45,7 @@ private slots:
 	void remux(const QString &source, const QString &target);
 
 signals:
-	void updateProgress(float percent);
+	void updateProgress(float percent, quint64 bytesPerSec);
 	void remuxFinished(bool success);
 
 	friend class OBSRemux;
@@ -0,0 +1,566 @@
+#include "SceneCollectionIndex.hpp"
+
+#include <obs.hpp>
+
+#include <charconv>
+#include <fstream>
+#include <vector>
+
+namespace {
+constexpr std::size_t scanChunkSize = 64 * 1024;
+constexpr std::size_t maxCapturedLength = 4096;
+constexpr long long indexFormatVersion = 1;
+
+enum class TopLevelKey { None, Name, Version, Resolution, MigrationResolution };
+enum class NestedKey { None, X, Y };
+
+TopLevelKey getTopLevelKey(const std::string &key)
+{
+	if (key == "name") {
+		return TopLevelKey::Name;
+	} else if (key == "version") {
+		return TopLevelKey::Version;
+	} else if (key == "resolution") {
+		return TopLevelKey::Resolution;
+	} else if (key == "migration_resolution") {
+		return TopLevelKey::MigrationResolution;
+	}
+
+	return TopLevelKey::None;
+}
+
+NestedKey getNestedKey(const std::string &key)
+{
+	if (key == "x") {
+		return NestedKey::X;
+	} else if (key == "y") {
+		return NestedKey::Y;
+	}
+
+	return NestedKey::None;
+}
+
+void appendUtf8(std::string &output, std::uint32_t codePoint)
+{
+	if (codePoint < 0x80) {
+		output.push_back(static_cast<char>(codePoint));
+	} else if (codePoint < 0x800) {
+		output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+		output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	} else if (codePoint < 0x10000) {
+		output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+		output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	} else {
+		output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+		output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+		output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+}
+
+bool parseHexQuad(const std::string &input, std::size_t offset, std::uint32_t &value)
+{
+	if (offset + 4 > input.size()) {
+		return false;
+	}
+
+	const char *begin = input.data() + offset;
+	auto [end, error] = std::from_chars(begin, begin + 4, value, 16);
+
+	return error == std::errc() && end == begin + 4;
+}
+
+/* Decodes the escape sequences of a raw JSON string body (without quotes) */
+std::string decodeJsonString(const std::string &raw)
+{
+	std::string decoded;
+	decoded.reserve(raw.size());
+
+	for (std::size_t i = 0; i < raw.size(); i++) {
+		char character = raw[i];
+
+		if (character != '\\' || i + 1 >= raw.size()) {
+			decoded.push_back(character);
+			continue;
+		}
+
+		char escape = raw[++i];
+
+		switch (escape) {
+		case 'b':
+			decoded.push_back('\b');
+			break;
+		case 'f':
+			decoded.push_back('\f');
+			break;
+		case 'n':
+			decoded.push_back('\n');
+			break;
+		case 'r':
+			decoded.push_back('\r');
+			break;
+		case 't':
+			decoded.push_back('\t');
+			break;
+		case 'u': {
+			std::uint32_t codePoint = 0;
+
+			if (!parseHexQuad(raw, i + 1, codePoint)) {
+				break;
+			}
+
+			i += 4;
+
+			if (codePoint >= 0xD800 && codePoint < 0xDC00 && i + 2 < raw.size() && raw[i + 1] == '\\' &&
+			    raw[i + 2] == 'u') {
+				std::uint32_t lowSurrogate = 0;
+
+				if (parseHexQuad(raw, i + 3, lowSurrogate) && lowSurrogate >= 0xDC00 &&
+				    lowSurrogate < 0xE000) {
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+					i += 6;
+				}
+			}
+
+			appendUtf8(decoded, codePoint);
+			break;
+		}
+		default:
+			decoded.push_back(escape);
+			break;
+		}
+	}
+
+	return decoded;
+}
+
+long long parseInteger(const std::string &token)
+{
+	long long value = 0;
+	std::from_chars(token.data(), token.data() + token.size(), value);
+
+	return value;
+}
+
+void getFileStatus(const std::filesystem::path &filePath, std::int64_t &modifiedTime, std::uintmax_t &fileSize)
+{
+	std::error_code error;
+
+	auto lastWriteTime = std::filesystem::last_write_time(filePath, error);
+	modifiedTime = error ? 0 : static_cast<std::int64_t>(lastWriteTime.time_since_epoch().count());
+
+	std::uintmax_t size = std::filesystem::file_size(filePath, error);
+	fileSize = error ? 0 : size;
+}
+
+/* Byte-wise scanner that follows the structure of a JSON document and only
+ * captures the top-level keys needed for the scene collection index. Nested
+ * containers are skipped without being materialized. */
+class TopLevelScanner {
+private:
+	int depth_ = 0;
+	bool sawRoot_ = false;
+	bool complete_ = false;
+	bool failed_ = false;
+
+	bool inString_ = false;
+	bool escaped_ = false;
+	bool expectKey_ = false;
+	bool inNestedObject_ = false;
+
+	bool capturingKey_ = false;
+	bool capturingString_ = false;
+	bool capturingScalar_ = false;
+	std::string captured_;
+
+	TopLevelKey topLevelKey_ = TopLevelKey::None;
+	NestedKey nestedKey_ = NestedKey::None;
+
+	bool isTrackedDepth() const { return depth_ == 1 || (depth_ == 2 && inNestedObject_); }
+
+	bool wantsValue() const
+	{
+		if (depth_ == 1) {
+			return topLevelKey_ == TopLevelKey::Name || topLevelKey_ == TopLevelKey::Version;
+		}
+
+		return depth_ == 2 && inNestedObject_ && nestedKey_ != NestedKey::None;
+	}
+
+	void capture(char character)
+	{
+		if (captured_.size() < maxCapturedLength) {
+			captured_.push_back(character);
+		}
+	}
+
+	void finishString()
+	{
+		if (capturingKey_) {
+			if (depth_ == 1) {
+				topLevelKey_ = getTopLevelKey(captured_);
+			} else {
+				nestedKey_ = getNestedKey(captured_);
+			}
+		} else if (capturingString_ && depth_ == 1 && topLevelKey_ == TopLevelKey::Name) {
+			name = decodeJsonString(captured_);
+		}
+
+		capturingKey_ = false;
+		capturingString_ = false;
+		captured_.clear();
+	}
+
+	void finishScalar()
+	{
+		if (!capturingScalar_) {
+			return;
+		}
+
+		long long value = parseInteger(captured_);
+
+		if (depth_ == 1 && topLevelKey_ == TopLevelKey::Version) {
+			version = value;
+		} else if (depth_ == 2 && inNestedObject_) {
+			OBS::Rect &target = topLevelKey_ == TopLevelKey::Resolution ? resolution : migrationResolution;
+
+			if (nestedKey_ == NestedKey::X) {
+				target.setWidth(value);
+			} else if (nestedKey_ == NestedKey::Y) {
+				target.setHeight(value);
+			}
+		}
+
+		capturingScalar_ = false;
+		captured_.clear();
+	}
+
+	void consumeString(char character)
+	{
+		if (escaped_) {
+			escaped_ = false;
+		} else if (character == '\\') {
+			escaped_ = true;
+		} else if (character == '"') {
+			inString_ = false;
+			finishString();
+			return;
+		}
+
+		if (capturingKey_ || capturingString_) {
+			capture(character);
+		}
+	}
+
+	void consumeStructure(char character)
+	{
+		switch (character) {
+		case ' ':
+		case '\t':
+		case '\r':
+		case '\n':
+			finishScalar();
+			break;
+		case '"':
+			finishScalar();
+			inString_ = true;
+
+			if (isTrackedDepth()) {
+				capturingKey_ = expectKey_;
+				capturingString_ = !expectKey_ && wantsValue();
+			}
+			break;
+		case '{':
+		case '[':
+			finishScalar();
+
+			if (depth_ == 0) {
+				if (character != '{' || sawRoot_) {
+					failed_ = true;
+					return;
+				}
+
+				sawRoot_ = true;
+				expectKey_ = true;
+			} else if (depth_ == 1 && character == '{' &&
+				   (topLevelKey_ == TopLevelKey::Resolution ||
+				    topLevelKey_ == TopLevelKey::MigrationResolution)) {
+				inNestedObject_ = true;
+				nestedKey_ = NestedKey::None;
+				expectKey_ = true;
+			}
+
+			depth_++;
+			break;
+		case '}':
+		case ']':
+			finishScalar();
+
+			if (depth_ == 0) {
+				failed_ = true;
+				return;
+			}
+
+			if (depth_ == 2 && inNestedObject_) {
+				inNestedObject_ = false;
+				expectKey_ = false;
+			}
+
+			depth_--;
+
+			if (depth_ == 0) {
+				complete_ = true;
+			}
+			break;
+		case ':':
+			if (isTrackedDepth()) {
+				expectKey_ = false;
+			}
+			break;
+		case ',':
+			finishScalar();
+
+			if (isTrackedDepth()) {
+				expectKey_ = true;
+			}
+			break;
+		default:
+			if (depth_ == 0) {
+				failed_ = true;
+				return;
+			}
+
+			if (!capturingScalar_ && isTrackedDepth() && !expectKey_ && wantsValue()) {
+				capturingScalar_ = true;
+			}
+
+			if (capturingScalar_) {
+				capture(character);
+			}
+			break;
+		}
+	}
+
+public:
+	std::string name;
+	long long version = 0;
+	OBS::Rect resolution;
+	OBS::Rect migrationResolution;
+
+	bool consume(const char *data, std::size_t size)
+	{
+		for (std::size_t i = 0; i < size && !failed_; i++) {
+			if (complete_) {
+				char character = data[i];
+
+				/* Only trailing whitespace is valid after the root object */
+				if (character != ' ' && character != '\t' && character != '\r' && character != '\n') {
+					failed_ = true;
+				}
+			} else if (inString_) {
+				consumeString(data[i]);
+			} else {
+				consumeStructure(data[i]);
+			}
+		}
+
+		return !failed_;
+	}
+
+	bool isValid() const { return complete_ && !failed_; }
+};
+} // namespace
+
+namespace OBS {
+std::optional<SceneCollectionIndexEntry> SceneCollectionIndex::scanFile(const std::filesystem::path &filePath)
+{
+	std::ifstream fileStream(filePath, std::ios::binary);
+
+	if (!fileStream.is_open()) {
+		return {};
+	}
+
+	TopLevelScanner scanner;
+	std::vector<char> buffer(scanChunkSize);
+
+	while (fileStream) {
+		fileStream.read(buffer.data(), buffer.size());
+		std::streamsize bytesRead = fileStream.gcount();
+
+		if (bytesRead <= 0) {
+			break;
+		}
+
+		if (!scanner.consume(buffer.data(), static_cast<std::size_t>(bytesRead))) {
+			return {};
+		}
+	}
+
+	if (!scanner.isValid()) {
+		return {};
+	}
+
+	SceneCollectionIndexEntry entry{};
+	entry.name = std::move(scanner.name);
+
+	if (scanner.version < 2) {
+		entry.coordinateMode = SceneCoordinateMode::Absolute;
+		entry.migrationResolution = scanner.resolution;
+	} else {
+		entry.coordinateMode = SceneCoordinateMode::Relative;
+		entry.migrationResolution = scanner.migrationResolution;
+	}
+
+	return entry;
+}
+
+const SceneCollectionIndexEntry &SceneCollectionIndex::getEntry(const std::filesystem::path &filePath)
+{
+	std::int64_t modifiedTime = 0;
+	std::uintmax_t fileSize = 0;
+
+	getFileStatus(filePath, modifiedTime, fileSize);
+
+	const std::string key = filePath.u8string();
+	auto foundEntry = entries_.find(key);
+
+	if (foundEntry != entries_.end() && foundEntry->second.modifiedTime == modifiedTime &&
+	    foundEntry->second.fileSize == fileSize) {
+		return foundEntry->second;
+	}
+
+	std::optional<SceneCollectionIndexEntry> scannedEntry = scanFile(filePath);
+
+	if (!scannedEntry) {
+		std::filesystem::path backupPath = filePath;
+		backupPath += ".bak";
+
+		scannedEntry = scanFile(backupPath);
+	}
+
+	SceneCollectionIndexEntry entry = scannedEntry.value_or(SceneCollectionIndexEntry{});
+
+	if (entry.name.empty()) {
+		entry.name = filePath.stem().u8string();
+	}
+
+	entry.modifiedTime = modifiedTime;
+	entry.fileSize = fileSize;
+
+	dirty_ = true;
+
+	return entries_.insert_or_assign(key, std::move(entry)).first->second;
+}
+
+void SceneCollectionIndex::record(const SceneCollection &collection)
+{
+	const std::filesystem::path filePath = collection.getFilePath();
+
+	SceneCollectionIndexEntry entry{};
+	entry.name = collection.getName();
+	entry.coordinateMode = collection.getCoordinateMode();
+	entry.migrationResolution = collection.getMigrationResolution();
+
+	getFileStatus(filePath, entry.modifiedTime, entry.fileSize);
+
+	entries_.insert_or_assign(filePath.u8string(), std::move(entry));
+	dirty_ = true;
+}
+
+void SceneCollectionIndex::prune(const std::unordered_set<std::string> &seenFiles)
+{
+	for (auto iterator = entries_.begin(); iterator != entries_.end();) {
+		if (seenFiles.find(iterator->first) == seenFiles.end()) {
+			iterator = entries_.erase(iterator);
+			dirty_ = true;
+		} else {
+			++iterator;
+		}
+	}
+}
+
+void SceneCollectionIndex::invalidate(const std::filesystem::path &filePath)
+{
+	if (entries_.erase(filePath.u8string()) > 0) {
+		dirty_ = true;
+	}
+}
+
+void SceneCollectionIndex::clear()
+{
+	entries_.clear();
+	dirty_ = true;
+}
+
+bool SceneCollectionIndex::load(const std::filesystem::path &indexPath)
+{
+	OBSDataAutoRelease indexData = obs_data_create_from_json_file(indexPath.u8string().c_str());
+
+	if (!indexData || obs_data_get_int(indexData, "version") != indexFormatVersion) {
+		return false;
+	}
+
+	OBSDataArrayAutoRelease collectionArray = obs_data_get_array(indexData, "collections");
+	std::size_t numCollections = obs_data_array_count(collectionArray);
+
+	entries_.clear();
+	entries_.reserve(numCollections);
+
+	for (std::size_t i = 0; i < numCollections; i++) {
+		OBSDataAutoRelease collectionData = obs_data_array_item(collectionArray, i);
+
+		std::string filePath = obs_data_get_string(collectionData, "file");
+
+		if (filePath.empty()) {
+			continue;
+		}
+
+		SceneCollectionIndexEntry entry{};
+		entry.name = obs_data_get_string(collectionData, "name");
+		entry.modifiedTime = obs_data_get_int(collectionData, "modified");
+		entry.fileSize = static_cast<std::uintmax_t>(obs_data_get_int(collectionData, "size"));
+		entry.coordinateMode = obs_data_get_bool(collectionData, "absolute") ? SceneCoordinateMode::Absolute
+										     : SceneCoordinateMode::Relative;
+		entry.migrationResolution.setWidth(obs_data_get_int(collectionData, "migration_width"));
+		entry.migrationResolution.setHeight(obs_data_get_int(collectionData, "migration_height"));
+
+		entries_.insert_or_assign(std::move(filePath), std::move(entry));
+	}
+
+	dirty_ = false;
+
+	return true;
+}
+
+bool SceneCollectionIndex::save(const std::filesystem::path &indexPath)
+{
+	OBSDataAutoRelease indexData = obs_data_create();
+	OBSDataArrayAutoRelease collectionArray = obs_data_array_create();
+
+	for (const auto &[filePath, entry] : entries_) {
+		OBSDataAutoRelease collectionData = obs_data_create();
+
+		obs_data_set_string(collectionData, "file", filePath.c_str());
+		obs_data_set_string(collectionData, "name", entry.name.c_str());
+		obs_data_set_int(collectionData, "modified", entry.modifiedTime);
+		obs_data_set_int(collectionData, "size", static_cast<long long>(entry.fileSize));
+		obs_data_set_bool(collectionData, "absolute", entry.coordinateMode == SceneCoordinateMode::Absolute);
+		obs_data_set_int(collectionData, "migration_width", entry.migrationResolution.getWidth<long long>());
+		obs_data_set_int(collectionData, "migration_height", entry.migrationResolution.getHeight<long long>());
+
+		obs_data_array_push_back(collectionArray, collectionData);
+	}
+
+	obs_data_set_int(indexData, "version", indexFormatVersion);
+	obs_data_set_array(indexData, "collections", collectionArray);
+
+	bool success = obs_data_save_json_safe(indexData, indexPath.u8string().c_str(), "tmp", nullptr);
+
+	if (success) {
+		dirty_ = false;
+	}
+
+	return success;
+}
+} // namespace OBS
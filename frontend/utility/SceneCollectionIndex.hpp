@@ -0,0 +1,52 @@
+#pragma once
+
+#include <models/SceneCollection.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace OBS {
+
+struct SceneCollectionIndexEntry {
+	std::string name;
+	std::int64_t modifiedTime = 0;
+	std::uintmax_t fileSize = 0;
+
+	SceneCoordinateMode coordinateMode = SceneCoordinateMode::Relative;
+	Rect migrationResolution;
+};
+
+/* Keeps the metadata required to list scene collections (name, coordinate
+ * mode) without parsing each collection file into an obs_data tree.
+ *
+ * Entries are keyed by file path and revalidated against the file's
+ * modification time and size, so only new or changed files are rescanned.
+ * Scanning only looks at top-level keys and never allocates nested data. */
+class SceneCollectionIndex {
+private:
+	std::unordered_map<std::string, SceneCollectionIndexEntry> entries_;
+	bool dirty_ = false;
+
+public:
+	SceneCollectionIndex() = default;
+
+	const SceneCollectionIndexEntry &getEntry(const std::filesystem::path &filePath);
+	void record(const SceneCollection &collection);
+	void prune(const std::unordered_set<std::string> &seenFiles);
+
+	void invalidate(const std::filesystem::path &filePath);
+	void clear();
+
+	bool load(const std::filesystem::path &indexPath);
+	bool save(const std::filesystem::path &indexPath);
+
+	bool isDirty() const { return dirty_; }
+	std::size_t size() const { return entries_.size(); }
+
+	static std::optional<SceneCollectionIndexEntry> scanFile(const std::filesystem::path &filePath);
+};
+} // namespace OBS
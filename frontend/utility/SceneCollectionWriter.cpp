@@ -0,0 +1,91 @@
+#include "SceneCollectionWriter.hpp"
+
+#include <util/threading.h>
+
+#include <algorithm>
+
+namespace OBS {
+
+SceneCollectionWriter::~SceneCollectionWriter()
+{
+	{
+		std::lock_guard lock(mutex_);
+		stopping_ = true;
+	}
+
+	jobAvailable_.notify_one();
+
+	if (thread_.joinable()) {
+		thread_.join();
+	}
+}
+
+void SceneCollectionWriter::queue(const std::string &filePath, obs_data_t *data, WriteCallback callback)
+{
+	{
+		std::lock_guard lock(mutex_);
+
+		auto pendingJob = std::find_if(jobs_.begin(), jobs_.end(),
+					       [&filePath](const WriteJob &job) { return job.filePath == filePath; });
+
+		if (pendingJob != jobs_.end()) {
+			pendingJob->data = data;
+			pendingJob->callback = std::move(callback);
+		} else {
+			jobs_.push_back({filePath, data, std::move(callback)});
+		}
+
+		if (!thread_.joinable()) {
+			thread_ = std::thread(&SceneCollectionWriter::run, this);
+		}
+	}
+
+	jobAvailable_.notify_one();
+}
+
+void SceneCollectionWriter::flush()
+{
+	std::unique_lock lock(mutex_);
+	jobsFinished_.wait(lock, [this] { return jobs_.empty() && !writing_; });
+}
+
+void SceneCollectionWriter::run()
+{
+	os_set_thread_name("scene collection writer");
+
+	std::unique_lock lock(mutex_);
+
+	for (;;) {
+		jobAvailable_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+
+		if (jobs_.empty()) {
+			break;
+		}
+
+		WriteJob job = std::move(jobs_.front());
+		jobs_.pop_front();
+		writing_ = true;
+
+		lock.unlock();
+
+		bool success = obs_data_save_json_pretty_safe(job.data, job.filePath.c_str(), "tmp", "bak");
+
+		if (!success) {
+			blog(LOG_ERROR, "Could not save scene data to %s", job.filePath.c_str());
+		}
+
+		if (job.callback) {
+			job.callback(success);
+		}
+
+		job.data = nullptr;
+
+		lock.lock();
+		writing_ = false;
+
+		if (jobs_.empty()) {
+			jobsFinished_.notify_all();
+		}
+	}
+}
+} // namespace OBS
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <obs.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace OBS {
+
+/* Writes scene collection snapshots on a worker thread.
+ *
+ * Only the newest snapshot queued for a file is kept, so a burst of saves
+ * while a write is in progress results in a single additional write. Files
+ * are written with obs_data_save_json_pretty_safe, keeping the tmp/bak
+ * scheme used for synchronous saves. Snapshots must not share any data that
+ * is still modified elsewhere (see obs_save_source_snapshot). */
+class SceneCollectionWriter {
+public:
+	using WriteCallback = std::function<void(bool success)>;
+
+private:
+	struct WriteJob {
+		std::string filePath;
+		OBSData data;
+		WriteCallback callback;
+	};
+
+	std::thread thread_;
+	std::mutex mutex_;
+	std::condition_variable jobAvailable_;
+	std::condition_variable jobsFinished_;
+	std::deque<WriteJob> jobs_;
+	bool writing_ = false;
+	bool stopping_ = false;
+
+	void run();
+
+public:
+	SceneCollectionWriter() = default;
+	~SceneCollectionWriter();
+
+	SceneCollectionWriter(const SceneCollectionWriter &) = delete;
+	SceneCollectionWriter &operator=(const SceneCollectionWriter &) = delete;
+
+	/* Callback is invoked on the worker thread after the write finished. */
+	void queue(const std::string &filePath, obs_data_t *data, WriteCallback callback = nullptr);
+	void flush();
+};
+} // namespace OBS
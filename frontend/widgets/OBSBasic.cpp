@@ -825,6 +825,7 @@ bool OBSBasic::InitBasicConfigDefaults()
 
 	config_set_default_string(activeConfiguration, "Output", "BindIP", "default");
 	config_set_default_string(activeConfiguration, "Output", "IPFamily", "IPv4+IPv6");
+	config_set_default_string(activeConfiguration, "Output", "DynamicBitrateAlgorithm", "threshold");
 	config_set_default_bool(activeConfiguration, "Output", "NewSocketLoopEnable", false);
 	config_set_default_bool(activeConfiguration, "Output", "LowLatencyEnable", false);
 
@@ -863,8 +864,10 @@ bool OBSBasic::InitBasicConfigDefaults()
 	config_set_default_string(activeConfiguration, "Video", "ColorRange", "Partial");
 	config_set_default_uint(activeConfiguration, "Video", "SdrWhiteLevel", 300);
 	config_set_default_uint(activeConfiguration, "Video", "HdrNominalPeakLevel", 1000);
+	config_set_default_uint(activeConfiguration, "Video", "ReadbackDepth", 2);
 
 	config_set_default_string(activeConfiguration, "Audio", "MonitoringDeviceId", "default");
+	config_set_default_uint(activeConfiguration, "Audio", "MonitoringLatency", 40);
 	config_set_default_string(activeConfiguration, "Audio", "MonitoringDeviceName",
 				  Str("Basic.Settings.Advanced.Audio.MonitoringDevice"
 				      ".Default"));
@@ -1021,6 +1024,10 @@ void OBSBasic::OBSInit()
 		const char *device_name = config_get_string(activeConfiguration, "Audio", "MonitoringDeviceName");
 		const char *device_id = config_get_string(activeConfiguration, "Audio", "MonitoringDeviceId");
 
+		bool mixer = config_get_bool(activeConfiguration, "Audio", "MonitoringMixer");
+		uint32_t latency = (uint32_t)config_get_uint(activeConfiguration, "Audio", "MonitoringLatency");
+
+		obs_set_audio_monitoring_mixer(mixer, latency);
 		obs_set_audio_monitoring_device(device_name, device_id);
 
 		blog(LOG_INFO, "Audio monitoring device:\n\tname: %s\n\tid: %s", device_name, device_id);
@@ -1625,6 +1632,8 @@ int OBSBasic::ResetVideo()
 		config_set_uint(activeConfiguration, "Video", "OutputCY", ovi.base_height);
 	}
 
+	obs_set_video_readback_depth((uint32_t)config_get_uint(activeConfiguration, "Video", "ReadbackDepth"));
+
 	ret = AttemptToResetVideo(&ovi);
 	if (ret == OBS_VIDEO_CURRENTLY_ACTIVE) {
 		blog(LOG_WARNING, "Tried to reset when already active");
@@ -1699,6 +1708,8 @@ bool OBSBasic::ResetAudio()
 		ai.fixed_buffering = true;
 	}
 
+	ai.adaptive_buffering = config_get_bool(App()->GetUserConfig(), "Audio", "AdaptiveAudioBuffering");
+
 	return obs_reset_audio2(&ai);
 }
 
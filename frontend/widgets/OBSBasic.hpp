@@ -26,6 +26,8 @@
 #include <utility/BasicOutputHandler.hpp>
 #include <utility/OBSCanvas.hpp>
 #include <utility/PreviewProgramSizeObserver.hpp>
+#include <utility/SceneCollectionIndex.hpp>
+#include <utility/SceneCollectionWriter.hpp>
 #include <utility/VCamConfig.hpp>
 #include <utility/platform.hpp>
 #include <utility/undo_stack.hpp>
@@ -1079,6 +1081,9 @@ private:
 	QPointer<OBSMissingFiles> missDialog;
 
 	OBSSceneCollectionCache collections;
+	OBS::SceneCollectionIndex collectionIndex;
+	bool collectionIndexLoaded = false;
+	OBS::SceneCollectionWriter collectionWriter;
 
 	void DisableRelativeCoordinates(bool disable);
 	void CreateDefaultScene(bool firstStart);
@@ -94,6 +94,7 @@ OBSBasicStats::OBSBasicStats(QWidget *parent, bool closable)
 	renderTime = new QLabel(this);
 	skippedFrames = new QLabel(this);
 	missedFrames = new QLabel(this);
+	canvasRenders = new QLabel(this);
 
 	str = MakeMissedFramesText(999999, 999999, 99.99);
 	textWidth = missedFrames->fontMetrics().boundingRect(str).width();
@@ -105,6 +106,7 @@ OBSBasicStats::OBSBasicStats(QWidget *parent, bool closable)
 	newStat("AverageTimeToRender", renderTime, 2);
 	newStat("MissedFrames", missedFrames, 2);
 	newStat("SkippedFrames", skippedFrames, 2);
+	newStat("SkippedCanvasRenders", canvasRenders, 2);
 
 	/* --------------------------------------------- */
 	QPushButton *closeButton = nullptr;
@@ -256,6 +258,9 @@ static uint32_t first_encoded = 0xFFFFFFFF;
 static uint32_t first_skipped = 0xFFFFFFFF;
 static uint32_t first_rendered = 0xFFFFFFFF;
 static uint32_t first_lagged = 0xFFFFFFFF;
+static uint32_t first_canvas_rendered = 0xFFFFFFFF;
+static uint32_t first_canvas_skipped = 0xFFFFFFFF;
+static uint64_t first_canvas_saved_ns = UINT64_MAX;
 
 void OBSBasicStats::InitializeValues()
 {
@@ -264,6 +269,9 @@ void OBSBasicStats::InitializeValues()
 	first_skipped = video_output_get_skipped_frames(video);
 	first_rendered = obs_get_total_frames();
 	first_lagged = obs_get_lagged_frames();
+	first_canvas_rendered = obs_get_canvas_frames_rendered();
+	first_canvas_skipped = obs_get_canvas_frames_skipped();
+	first_canvas_saved_ns = obs_get_canvas_render_time_saved_ns();
 }
 
 void OBSBasicStats::Update()
@@ -415,6 +423,33 @@ void OBSBasicStats::Update()
 		setClasses(missedFrames, "");
 	}
 
+	/* ------------------ */
+
+	uint32_t canvas_rendered = obs_get_canvas_frames_rendered();
+	uint32_t canvas_skipped = obs_get_canvas_frames_skipped();
+	uint64_t canvas_saved_ns = obs_get_canvas_render_time_saved_ns();
+
+	if (canvas_rendered < first_canvas_rendered || canvas_skipped < first_canvas_skipped ||
+	    canvas_saved_ns < first_canvas_saved_ns) {
+		first_canvas_rendered = canvas_rendered;
+		first_canvas_skipped = canvas_skipped;
+		first_canvas_saved_ns = canvas_saved_ns;
+	}
+	canvas_rendered -= first_canvas_rendered;
+	canvas_skipped -= first_canvas_skipped;
+	canvas_saved_ns -= first_canvas_saved_ns;
+
+	uint32_t canvas_total = canvas_rendered + canvas_skipped;
+	num = canvas_total ? (long double)canvas_skipped / (long double)canvas_total : 0.0l;
+	num *= 100.0l;
+
+	/* average graphics thread time saved per main frame */
+	double saved_ms = total_rendered ? (double)canvas_saved_ns / (double)total_rendered / 1000000.0 : 0.0;
+
+	str = QTStr("Basic.Stats.SkippedCanvasRenders.Text")
+		      .arg(MakeMissedFramesText(canvas_skipped, canvas_total, num), QString::number(saved_ms, 'f', 2));
+	canvasRenders->setText(str);
+
 	/* ------------------------------------------- */
 	/* recording/streaming stats                   */
 
@@ -479,6 +514,9 @@ void OBSBasicStats::Reset()
 	first_skipped = 0xFFFFFFFF;
 	first_rendered = 0xFFFFFFFF;
 	first_lagged = 0xFFFFFFFF;
+	first_canvas_rendered = 0xFFFFFFFF;
+	first_canvas_skipped = 0xFFFFFFFF;
+	first_canvas_saved_ns = UINT64_MAX;
 
 	OBSOutputAutoRelease strOutput = obs_frontend_get_streaming_output();
 	OBSOutputAutoRelease recOutput = obs_frontend_get_recording_output();
@@ -753,6 +753,10 @@ void OBSBasic::ResetProfileData()
 		const char *device_name = config_get_string(activeConfiguration, "Audio", "MonitoringDeviceName");
 		const char *device_id = config_get_string(activeConfiguration, "Audio", "MonitoringDeviceId");
 
+		bool mixer = config_get_bool(activeConfiguration, "Audio", "MonitoringMixer");
+		uint32_t latency = (uint32_t)config_get_uint(activeConfiguration, "Audio", "MonitoringLatency");
+
+		obs_set_audio_monitoring_mixer(mixer, latency);
 		obs_set_audio_monitoring_device(device_name, device_id);
 
 		blog(LOG_INFO, "Audio monitoring device:\n\tname: %s\n\tid: %s", device_name, device_id);
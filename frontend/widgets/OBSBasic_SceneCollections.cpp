@@ -28,6 +28,7 @@
 
 #include <filesystem>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 extern bool safe_mode;
@@ -43,6 +44,7 @@ using SceneCollection = OBS::SceneCollection;
 // MARK: Constant Expressions
 
 static constexpr std::string_view SceneCollectionPath = "/obs-studio/basic/scenes/";
+static constexpr std::string_view SceneCollectionIndexPath = "/obs-studio/basic/scene_collection_index.json";
 
 namespace DataKeys {
 static constexpr std::string_view AbsoluteCoordinates = "AbsoluteCoordinates";
@@ -427,6 +429,8 @@ void OBSBasic::RefreshSceneCollections(bool refreshCache)
 
 void OBSBasic::RefreshSceneCollectionCache()
 {
+	ProfileScope("OBSBasic::RefreshSceneCollectionCache");
+
 	OBSSceneCollectionCache foundCollections{};
 
 	const std::filesystem::path collectionsPath =
@@ -437,6 +441,16 @@ void OBSBasic::RefreshSceneCollectionCache()
 		return;
 	}
 
+	const std::filesystem::path indexPath =
+		App()->userScenesLocation / std::filesystem::u8path(SceneCollectionIndexPath.substr(1));
+
+	if (!collectionIndexLoaded) {
+		collectionIndex.load(indexPath);
+		collectionIndexLoaded = true;
+	}
+
+	std::unordered_set<std::string> seenFiles{};
+
 	for (const auto &entry : std::filesystem::directory_iterator(collectionsPath)) {
 		if (entry.is_directory()) {
 			continue;
@@ -446,19 +460,21 @@ void OBSBasic::RefreshSceneCollectionCache()
 			continue;
 		}
 
-		OBSDataAutoRelease collectionData =
-			obs_data_create_from_json_file_safe(entry.path().u8string().c_str(), "bak");
+		const OBS::SceneCollectionIndexEntry &indexEntry = collectionIndex.getEntry(entry.path());
+		seenFiles.insert(entry.path().u8string());
 
-		std::string candidateName;
-		std::string collectionName = obs_data_get_string(collectionData, "name");
+		auto [collection, didInsert] =
+			foundCollections.try_emplace(indexEntry.name, indexEntry.name, entry.path());
 
-		if (collectionName.empty()) {
-			candidateName = entry.path().stem().u8string();
-		} else {
-			candidateName = std::move(collectionName);
+		if (didInsert && indexEntry.coordinateMode == SceneCoordinateMode::Relative) {
+			collection->second.setMigrationResolution(indexEntry.migrationResolution);
 		}
+	}
 
-		foundCollections.try_emplace(candidateName, candidateName, entry.path());
+	collectionIndex.prune(seenFiles);
+
+	if (collectionIndex.isDirty() && !collectionIndex.save(indexPath)) {
+		blog(LOG_WARNING, "Failed to save scene collection index to %s", indexPath.u8string().c_str());
 	}
 
 	collections.swap(foundCollections);
@@ -818,7 +834,7 @@ void OBSBasic::Save(SceneCollection &collection)
 	auto SaveAudioDevice = [&](const std::string_view &key, int channel) {
 		if (OBSSourceAutoRelease source = obs_get_output_source(channel)) {
 			audioSources.emplace_back(source.Get());
-			OBSDataAutoRelease data = obs_save_source(source);
+			OBSDataAutoRelease data = obs_save_source_snapshot(source);
 			obs_data_set_obj(saveData, key.data(), data);
 		}
 	};
@@ -842,7 +858,7 @@ void OBSBasic::Save(SceneCollection &collection)
 	};
 	using FilterAudioSources_t = decltype(FilterAudioSources);
 
-	OBSDataArrayAutoRelease sourcesArray = obs_save_sources_filtered(
+	OBSDataArrayAutoRelease sourcesArray = obs_save_sources_filtered_snapshot(
 		[](void *data, obs_source_t *source) {
 			auto &func = *static_cast<FilterAudioSources_t *>(data);
 			return func(source);
@@ -858,7 +874,7 @@ void OBSBasic::Save(SceneCollection &collection)
 
 	auto exportSceneItemsCallback = [](void *param, obs_source_t *source) -> bool {
 		auto sourcesArrays = static_cast<sourcesAndGroups_t *>(param);
-		OBSDataAutoRelease source_data = obs_save_source(source);
+		OBSDataAutoRelease source_data = obs_save_source_snapshot(source);
 
 		if (obs_source_is_scene(source)) {
 			obs_data_array_push_back(sourcesArrays->first, source_data);
@@ -950,7 +966,10 @@ void OBSBasic::Save(SceneCollection &collection)
 		}
 
 		api->on_save(collectionModuleData);
-		obs_data_set_obj(saveData, "modules", collectionModuleData);
+
+		OBSDataAutoRelease moduleData = obs_data_create();
+		obs_data_apply(moduleData, collectionModuleData);
+		obs_data_set_obj(saveData, "modules", moduleData);
 	}
 
 	// Relative coordinates metadata
@@ -981,12 +1000,17 @@ void OBSBasic::Save(SceneCollection &collection)
 	int sceneCollectionVersion = collection.getVersion();
 	obs_data_set_int(saveData, "version", sceneCollectionVersion);
 
-	const std::string collectionFileName = collection.getFilePathString();
-	bool success = obs_data_save_json_pretty_safe(saveData, collectionFileName.c_str(), "tmp", "bak");
+	// The snapshot shares no data with live sources, so serializing and writing it can happen off the UI thread.
+	auto onWritten = [this, collection](bool success) {
+		if (!success) {
+			return;
+		}
 
-	if (!success) {
-		blog(LOG_ERROR, "Could not save scene data to %s", collectionFileName.c_str());
-	}
+		QMetaObject::invokeMethod(
+			this, [this, collection]() { collectionIndex.record(collection); }, Qt::QueuedConnection);
+	};
+
+	collectionWriter.queue(collection.getFilePathString(), saveData, onWritten);
 }
 
 void OBSBasic::DeferSaveBegin()
@@ -1521,12 +1545,12 @@ retryScene:
 
 void OBSBasic::SaveProjectNow()
 {
-	if (disableSaving) {
-		return;
+	if (!disableSaving) {
+		projectChanged = true;
+		SaveProjectDeferred();
 	}
 
-	projectChanged = true;
-	SaveProjectDeferred();
+	collectionWriter.flush();
 }
 
 void OBSBasic::SaveProject()
@@ -1429,7 +1429,9 @@ obs_data_array_t *OBSBasic::SaveTransitions()
 		}
 
 		OBSDataAutoRelease sourceData = obs_data_create();
-		OBSDataAutoRelease settings = obs_source_get_settings(transition.Get());
+		OBSDataAutoRelease liveSettings = obs_source_get_settings(transition.Get());
+		OBSDataAutoRelease settings = obs_data_create();
+		obs_data_apply(settings, liveSettings);
 
 		obs_data_set_string(sourceData, "name", obs_source_get_name(transition.Get()));
 		obs_data_set_string(sourceData, "id", obs_obj_get_id(transition.Get()));
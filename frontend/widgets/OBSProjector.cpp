@@ -332,7 +332,10 @@ void OBSProjector::UpdateMultiview()
 
 	transitionOnDoubleClick = config_get_bool(App()->GetUserConfig(), "BasicWindow", "TransitionOnDoubleClick");
 
-	multiview->Update(multiviewLayout, drawLabel, drawSafeArea);
+	uint32_t thumbnailFPS =
+		(uint32_t)config_get_uint(App()->GetUserConfig(), "BasicWindow", "MultiviewThumbnailFPS");
+
+	multiview->Update(multiviewLayout, drawLabel, drawSafeArea, thumbnailFPS);
 }
 
 void OBSProjector::UpdateProjectorTitle(QString name)
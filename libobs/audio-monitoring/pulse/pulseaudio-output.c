@@ -23,6 +23,12 @@ struct audio_monitor {
 
 	bool ignore;
 	pthread_mutex_t playback_mutex;
+
+	/* with the shared mixer there is no stream, the source's audio is
+	 * queued here as is, guarded by the mixer's inputs_mutex */
+	struct monitor_mixer *mixer;
+	struct deque mix_data[MAX_AUDIO_CHANNELS];
+	bool mix_playing;
 };
 
 static enum speaker_layout pulseaudio_channels_to_obs_speakers(uint_fast32_t channels)
@@ -178,6 +184,474 @@ void process_volume(const struct audio_monitor *monitor, float vol, uint8_t *con
 	}
 }
 
+static void pulseaudio_server_info(pa_context *c, const pa_server_info *i, void *userdata)
+{
+	UNUSED_PARAMETER(c);
+	UNUSED_PARAMETER(userdata);
+
+	blog(LOG_INFO, "Server name: '%s %s'", i->server_name, i->server_version);
+
+	pulseaudio_signal(0);
+}
+
+static void pulseaudio_sink_info(pa_context *c, const pa_sink_info *i, int eol, void *userdata)
+{
+	UNUSED_PARAMETER(c);
+	pa_sample_spec *spec = userdata;
+	// An error occurred
+	if (eol < 0) {
+		spec->format = PA_SAMPLE_INVALID;
+		goto skip;
+	}
+	// Terminating call for multi instance callbacks
+	if (eol > 0)
+		goto skip;
+
+	blog(LOG_INFO, "Audio format: %s, %" PRIu32 " Hz, %" PRIu8 " channels",
+	     pa_sample_format_to_string(i->sample_spec.format), i->sample_spec.rate, i->sample_spec.channels);
+
+	pa_sample_format_t format = i->sample_spec.format;
+	if (pulseaudio_to_obs_audio_format(format) == AUDIO_FORMAT_UNKNOWN) {
+		format = PA_SAMPLE_FLOAT32LE;
+
+		blog(LOG_INFO,
+		     "Sample format %s not supported by OBS,"
+		     "using %s instead for recording",
+		     pa_sample_format_to_string(i->sample_spec.format), pa_sample_format_to_string(format));
+	}
+
+	uint8_t channels = i->sample_spec.channels;
+	if (pulseaudio_channels_to_obs_speakers(channels) == SPEAKERS_UNKNOWN) {
+		channels = 2;
+
+		blog(LOG_INFO,
+		     "%c channels not supported by OBS,"
+		     "using %c instead for recording",
+		     i->sample_spec.channels, channels);
+	}
+
+	spec->format = format;
+	spec->rate = i->sample_spec.rate;
+	spec->channels = channels;
+skip:
+	pulseaudio_signal(0);
+}
+
+static bool get_sink_spec(const char *device, pa_sample_spec *spec)
+{
+	if (pulseaudio_get_server_info(pulseaudio_server_info, NULL) < 0) {
+		blog(LOG_ERROR, "Unable to get server info !");
+		return false;
+	}
+
+	if (pulseaudio_get_sink_info(pulseaudio_sink_info, device, spec) < 0) {
+		blog(LOG_ERROR, "Unable to get sink info !");
+		return false;
+	}
+	if (spec->format == PA_SAMPLE_INVALID) {
+		blog(LOG_ERROR, "An error occurred while getting the source info!");
+		return false;
+	}
+
+	if (!pa_sample_spec_valid(spec)) {
+		blog(LOG_ERROR, "Sample spec is not valid");
+		return false;
+	}
+
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* shared monitoring mixer
+ *
+ * Instead of a stream and a resampler per monitored source, monitors queue
+ * their source's audio as is, and one thread per device mixes all of it,
+ * converts it once and writes it to a single stream.
+ *
+ * The thread runs on the system clock like the rest of OBS while the device
+ * plays on its own, so the two drift apart.  The resampler is nudged to hold
+ * the stream latency at the target instead of letting it build up. */
+
+#define MIXER_PERIOD_MS 10
+#define MIXER_PREFILL_PERIODS 2
+#define MAX_MIXER_LATENCY_MS 500
+
+struct monitor_mixer {
+	long refs;
+	char *device;
+	uint32_t latency_ms;
+
+	pa_stream *stream;
+	pa_sample_spec spec;
+	size_t bytes_per_frame;
+	audio_resampler_t *resampler;
+
+	size_t channels;
+	uint32_t period_frames;
+	uint32_t prefill_frames;
+	size_t max_queued_bytes;
+	float *mix[MAX_AUDIO_CHANNELS];
+	float *scratch;
+
+	pthread_mutex_t inputs_mutex;
+	DARRAY(struct audio_monitor *) inputs;
+
+	uint64_t target_usec;
+	int64_t avg_error_usec;
+	volatile bool underflow;
+
+	pthread_t thread;
+	os_event_t *stop_event;
+	bool thread_active;
+};
+
+static pthread_mutex_t mixers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct monitor_mixer *) mixers;
+
+static void monitor_mixer_push(struct monitor_mixer *mm, struct audio_monitor *monitor,
+			       const struct audio_data *audio_data)
+{
+	size_t bytes = audio_data->frames * sizeof(float);
+
+	pthread_mutex_lock(&mm->inputs_mutex);
+
+	for (size_t ch = 0; ch < mm->channels; ch++) {
+		struct deque *queue = &monitor->mix_data[ch];
+		deque_push_back(queue, audio_data->data[ch], bytes);
+
+		/* a source running ahead of the device would otherwise add
+		 * latency for good */
+		if (queue->size > mm->max_queued_bytes)
+			deque_pop_front(queue, NULL, queue->size - mm->max_queued_bytes);
+	}
+
+	pthread_mutex_unlock(&mm->inputs_mutex);
+}
+
+static void monitor_mixer_add_input(struct monitor_mixer *mm, struct audio_monitor *monitor)
+{
+	pthread_mutex_lock(&mm->inputs_mutex);
+	da_push_back(mm->inputs, &monitor);
+	pthread_mutex_unlock(&mm->inputs_mutex);
+}
+
+static void monitor_mixer_remove_input(struct monitor_mixer *mm, struct audio_monitor *monitor)
+{
+	pthread_mutex_lock(&mm->inputs_mutex);
+	da_erase_item(mm->inputs, &monitor);
+	pthread_mutex_unlock(&mm->inputs_mutex);
+}
+
+static void monitor_mixer_mix(struct monitor_mixer *mm)
+{
+	for (size_t ch = 0; ch < mm->channels; ch++)
+		memset(mm->mix[ch], 0, mm->period_frames * sizeof(float));
+
+	pthread_mutex_lock(&mm->inputs_mutex);
+
+	for (size_t i = 0; i < mm->inputs.num; i++) {
+		struct audio_monitor *monitor = mm->inputs.array[i];
+		float vol = monitor->source->user_volume;
+		size_t frames = monitor->mix_data[0].size / sizeof(float);
+
+		/* an input only joins the mix once a little is queued, so that
+		 * normal jitter in its delivery does not cut it up.  one that
+		 * runs dry plays out what is left and then queues up again. */
+		if (!monitor->mix_playing) {
+			if (frames < mm->prefill_frames)
+				continue;
+			monitor->mix_playing = true;
+		}
+
+		if (frames < mm->period_frames)
+			monitor->mix_playing = false;
+		else
+			frames = mm->period_frames;
+
+		for (size_t ch = 0; ch < mm->channels; ch++) {
+			float *mix = mm->mix[ch];
+
+			deque_pop_front(&monitor->mix_data[ch], mm->scratch, frames * sizeof(float));
+			for (size_t j = 0; j < frames; j++)
+				mix[j] += mm->scratch[j] * vol;
+		}
+	}
+
+	pthread_mutex_unlock(&mm->inputs_mutex);
+}
+
+static void monitor_mixer_underflow(pa_stream *p, void *userdata)
+{
+	UNUSED_PARAMETER(p);
+
+	struct monitor_mixer *mm = userdata;
+	os_atomic_set_bool(&mm->underflow, true);
+}
+
+/* start playing once the target latency is buffered, and have the server
+ * keep no more than that */
+static pa_buffer_attr monitor_mixer_buffer_attr(struct monitor_mixer *mm)
+{
+	uint32_t target_bytes = (uint32_t)pa_usec_to_bytes(mm->target_usec, &mm->spec);
+	pa_buffer_attr attr = {
+		.maxlength = (uint32_t)-1,
+		.tlength = target_bytes,
+		.prebuf = target_bytes,
+		.minreq = (uint32_t)-1,
+		.fragsize = (uint32_t)-1,
+	};
+
+	return attr;
+}
+
+static void monitor_mixer_compensate(struct monitor_mixer *mm)
+{
+	pa_usec_t latency;
+	int negative = 0;
+	int ret = -1;
+	bool raised = false;
+
+	/* the device cannot keep up with this little latency, back off */
+	if (os_atomic_exchange_bool(&mm->underflow, false) && mm->target_usec < MAX_MIXER_LATENCY_MS * 1000) {
+		mm->target_usec += MIXER_PERIOD_MS * 1000;
+		raised = true;
+		blog(LOG_WARNING, "Monitoring underflowed in '%s', raising latency to %d ms", mm->device,
+		     (int)(mm->target_usec / 1000));
+	}
+
+	pulseaudio_lock();
+	if (pa_stream_get_state(mm->stream) == PA_STREAM_READY) {
+		/* the server only buffers as much as it was asked for, so it
+		 * has to be told about the new target as well */
+		if (raised) {
+			pa_buffer_attr attr = monitor_mixer_buffer_attr(mm);
+			pa_operation *op = pa_stream_set_buffer_attr(mm->stream, &attr, NULL, NULL);
+			if (op)
+				pa_operation_unref(op);
+		}
+
+		ret = pa_stream_get_latency(mm->stream, &latency, &negative);
+	}
+	pulseaudio_unlock();
+
+	if (ret < 0 || negative)
+		return;
+
+	/* the estimate jitters a lot from one period to the next */
+	int64_t error = (int64_t)latency - (int64_t)mm->target_usec;
+	mm->avg_error_usec += (error - mm->avg_error_usec) / 8;
+
+	/* correct the error over about two seconds, by at most 0.5% */
+	int distance = (int)(mm->spec.rate * MIXER_PERIOD_MS / 1000);
+	int max_delta = distance / 200;
+	int64_t delta = -mm->avg_error_usec * (int64_t)mm->spec.rate / 1000000 * MIXER_PERIOD_MS / 2000;
+
+	if (delta > max_delta)
+		delta = max_delta;
+	else if (delta < -max_delta)
+		delta = -max_delta;
+
+	audio_resampler_set_compensation(mm->resampler, (int)delta, distance);
+}
+
+static void monitor_mixer_write(struct monitor_mixer *mm)
+{
+	const uint8_t *input[MAX_AV_PLANES] = {0};
+	uint8_t *output[MAX_AV_PLANES];
+	uint32_t frames;
+	uint64_t ts_offset;
+
+	for (size_t ch = 0; ch < mm->channels; ch++)
+		input[ch] = (const uint8_t *)mm->mix[ch];
+
+	if (!audio_resampler_resample(mm->resampler, output, &frames, &ts_offset, input, mm->period_frames))
+		return;
+
+	pulseaudio_lock();
+	if (frames && pa_stream_get_state(mm->stream) == PA_STREAM_READY)
+		pa_stream_write(mm->stream, output[0], frames * mm->bytes_per_frame, NULL, 0LL, PA_SEEK_RELATIVE);
+	pulseaudio_unlock();
+}
+
+static void *monitor_mixer_thread(void *param)
+{
+	struct monitor_mixer *mm = param;
+	const uint64_t period_ns = MIXER_PERIOD_MS * 1000000ULL;
+	uint64_t next = os_gettime_ns();
+
+	/* runs at normal priority, as it shares inputs_mutex with the audio
+	 * thread, and the inputs and the stream are buffered for jitter */
+	os_set_thread_name("pulse-am: monitoring mixer");
+
+	while (os_event_try(mm->stop_event) == EAGAIN) {
+		next += period_ns;
+
+		/* after a stall, start over rather than trying to catch up */
+		if (!os_sleepto_ns(next) && os_gettime_ns() - next > period_ns * 4)
+			next = os_gettime_ns();
+
+		monitor_mixer_mix(mm);
+		monitor_mixer_compensate(mm);
+		monitor_mixer_write(mm);
+	}
+
+	return NULL;
+}
+
+static void monitor_mixer_destroy(struct monitor_mixer *mm)
+{
+	if (mm->thread_active) {
+		os_event_signal(mm->stop_event);
+		pthread_join(mm->thread, NULL);
+	}
+
+	if (mm->stream) {
+		pulseaudio_set_underflow_callback(mm->stream, NULL, NULL);
+
+		pulseaudio_lock();
+		pa_stream_disconnect(mm->stream);
+		pa_stream_unref(mm->stream);
+		pulseaudio_unlock();
+
+		blog(LOG_INFO, "Stopped the monitoring mixer in '%s'", mm->device);
+	}
+
+	for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++)
+		bfree(mm->mix[ch]);
+	bfree(mm->scratch);
+
+	audio_resampler_destroy(mm->resampler);
+	os_event_destroy(mm->stop_event);
+	da_free(mm->inputs);
+	pthread_mutex_destroy(&mm->inputs_mutex);
+	bfree(mm->device);
+	bfree(mm);
+}
+
+static struct monitor_mixer *monitor_mixer_create(const char *device, uint32_t latency_ms)
+{
+	const struct audio_output_info *info = audio_output_get_info(obs->audio.audio);
+	struct monitor_mixer *mm = bzalloc(sizeof(*mm));
+
+	mm->refs = 1;
+	mm->device = bstrdup(device);
+	mm->latency_ms = latency_ms;
+	mm->target_usec = latency_ms * 1000ULL;
+	pthread_mutex_init_value(&mm->inputs_mutex);
+
+	if (pthread_mutex_init(&mm->inputs_mutex, NULL) != 0)
+		goto fail;
+	if (os_event_init(&mm->stop_event, OS_EVENT_TYPE_MANUAL) != 0)
+		goto fail;
+	if (!get_sink_spec(device, &mm->spec))
+		goto fail;
+
+	struct resample_info from = {.samples_per_sec = info->samples_per_sec,
+				     .speakers = info->speakers,
+				     .format = AUDIO_FORMAT_FLOAT_PLANAR};
+	struct resample_info to = {.samples_per_sec = mm->spec.rate,
+				   .speakers = pulseaudio_channels_to_obs_speakers(mm->spec.channels),
+				   .format = pulseaudio_to_obs_audio_format(mm->spec.format)};
+
+	mm->resampler = audio_resampler_create(&to, &from);
+	if (!mm->resampler) {
+		blog(LOG_WARNING, "%s: %s", __FUNCTION__, "Failed to create resampler");
+		goto fail;
+	}
+
+	mm->channels = get_audio_channels(info->speakers);
+	mm->bytes_per_frame = pa_frame_size(&mm->spec);
+	mm->period_frames = info->samples_per_sec * MIXER_PERIOD_MS / 1000;
+	mm->prefill_frames = mm->period_frames * MIXER_PREFILL_PERIODS;
+	mm->max_queued_bytes = (size_t)info->samples_per_sec * latency_ms / 1000 * sizeof(float);
+	if (mm->max_queued_bytes < (mm->prefill_frames + mm->period_frames) * sizeof(float))
+		mm->max_queued_bytes = (mm->prefill_frames + mm->period_frames) * sizeof(float);
+
+	for (size_t ch = 0; ch < mm->channels; ch++)
+		mm->mix[ch] = bzalloc(mm->period_frames * sizeof(float));
+	mm->scratch = bzalloc(mm->period_frames * sizeof(float));
+
+	pa_channel_map channel_map = pulseaudio_channel_map(to.speakers);
+
+	mm->stream = pulseaudio_stream_new("OBS Monitoring", &mm->spec, &channel_map);
+	if (!mm->stream) {
+		blog(LOG_ERROR, "Unable to create stream");
+		goto fail;
+	}
+
+	pa_buffer_attr attr = monitor_mixer_buffer_attr(mm);
+
+	pa_stream_flags_t flags = PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE |
+				  PA_STREAM_ADJUST_LATENCY;
+
+	pulseaudio_set_underflow_callback(mm->stream, monitor_mixer_underflow, mm);
+
+	if (pulseaudio_connect_playback(mm->stream, device, &attr, flags) < 0) {
+		blog(LOG_ERROR, "Unable to connect to stream");
+		goto fail;
+	}
+
+	if (pthread_create(&mm->thread, NULL, monitor_mixer_thread, mm) != 0) {
+		blog(LOG_ERROR, "Unable to create the monitoring mixer thread");
+		goto fail;
+	}
+	mm->thread_active = true;
+
+	blog(LOG_INFO, "Started the monitoring mixer in '%s' with %" PRIu32 " ms of latency", device, latency_ms);
+	return mm;
+
+fail:
+	monitor_mixer_destroy(mm);
+	return NULL;
+}
+
+/* one mixer per device, shared by every monitor playing to it */
+static struct monitor_mixer *monitor_mixer_acquire(const char *device, uint32_t latency_ms)
+{
+	struct monitor_mixer *mm = NULL;
+
+	pthread_mutex_lock(&mixers_mutex);
+
+	for (size_t i = 0; i < mixers.num; i++) {
+		struct monitor_mixer *cur = mixers.array[i];
+		if (strcmp(cur->device, device) == 0 && cur->latency_ms == latency_ms) {
+			mm = cur;
+			mm->refs++;
+			break;
+		}
+	}
+
+	if (!mm) {
+		mm = monitor_mixer_create(device, latency_ms);
+		if (mm)
+			da_push_back(mixers, &mm);
+	}
+
+	pthread_mutex_unlock(&mixers_mutex);
+	return mm;
+}
+
+static void monitor_mixer_release(struct monitor_mixer *mm)
+{
+	bool destroy;
+
+	pthread_mutex_lock(&mixers_mutex);
+
+	destroy = --mm->refs == 0;
+	if (destroy) {
+		da_erase_item(mixers, &mm);
+		if (!mixers.num)
+			da_free(mixers);
+	}
+
+	pthread_mutex_unlock(&mixers_mutex);
+
+	if (destroy)
+		monitor_mixer_destroy(mm);
+}
+
+/* ------------------------------------------------------------------------- */
+
 static void do_stream_write(void *param)
 {
 	PULSE_DATA(param);
@@ -240,6 +714,12 @@ static void on_audio_playback(void *param, obs_source_t *source, const struct au
 	uint64_t ts_offset;
 	bool success;
 
+	if (monitor->mixer) {
+		if (os_atomic_load_long(&source->activate_refs) != 0)
+			monitor_mixer_push(monitor->mixer, monitor, audio_data);
+		return;
+	}
+
 	if (pthread_mutex_trylock(&monitor->playback_mutex) != 0)
 		return;
 
@@ -267,59 +747,6 @@ unlock:
 	do_stream_write(param);
 }
 
-static void pulseaudio_server_info(pa_context *c, const pa_server_info *i, void *userdata)
-{
-	UNUSED_PARAMETER(c);
-	UNUSED_PARAMETER(userdata);
-
-	blog(LOG_INFO, "Server name: '%s %s'", i->server_name, i->server_version);
-
-	pulseaudio_signal(0);
-}
-
-static void pulseaudio_sink_info(pa_context *c, const pa_sink_info *i, int eol, void *userdata)
-{
-	UNUSED_PARAMETER(c);
-	PULSE_DATA(userdata);
-	// An error occurred
-	if (eol < 0) {
-		data->format = PA_SAMPLE_INVALID;
-		goto skip;
-	}
-	// Terminating call for multi instance callbacks
-	if (eol > 0)
-		goto skip;
-
-	blog(LOG_INFO, "Audio format: %s, %" PRIu32 " Hz, %" PRIu8 " channels",
-	     pa_sample_format_to_string(i->sample_spec.format), i->sample_spec.rate, i->sample_spec.channels);
-
-	pa_sample_format_t format = i->sample_spec.format;
-	if (pulseaudio_to_obs_audio_format(format) == AUDIO_FORMAT_UNKNOWN) {
-		format = PA_SAMPLE_FLOAT32LE;
-
-		blog(LOG_INFO,
-		     "Sample format %s not supported by OBS,"
-		     "using %s instead for recording",
-		     pa_sample_format_to_string(i->sample_spec.format), pa_sample_format_to_string(format));
-	}
-
-	uint8_t channels = i->sample_spec.channels;
-	if (pulseaudio_channels_to_obs_speakers(channels) == SPEAKERS_UNKNOWN) {
-		channels = 2;
-
-		blog(LOG_INFO,
-		     "%c channels not supported by OBS,"
-		     "using %c instead for recording",
-		     i->sample_spec.channels, channels);
-	}
-
-	data->format = format;
-	data->samples_per_sec = i->sample_spec.rate;
-	data->channels = channels;
-skip:
-	pulseaudio_signal(0);
-}
-
 static void pulseaudio_stop_playback(struct audio_monitor *monitor)
 {
 	if (monitor->stream) {
@@ -379,29 +806,22 @@ static bool audio_monitor_init(struct audio_monitor *monitor, obs_source_t *sour
 	if (!monitor->device)
 		return false;
 
-	if (pulseaudio_get_server_info(pulseaudio_server_info, (void *)monitor) < 0) {
-		blog(LOG_ERROR, "Unable to get server info !");
-		return false;
-	}
+	if (obs->audio.monitoring_mixer) {
+		monitor->mixer = monitor_mixer_acquire(monitor->device, obs->audio.monitoring_latency_ms);
+		if (!monitor->mixer)
+			return false;
 
-	if (pulseaudio_get_sink_info(pulseaudio_sink_info, monitor->device, (void *)monitor) < 0) {
-		blog(LOG_ERROR, "Unable to get sink info !");
-		return false;
-	}
-	if (monitor->format == PA_SAMPLE_INVALID) {
-		blog(LOG_ERROR, "An error occurred while getting the source info!");
-		return false;
+		blog(LOG_INFO, "Started Monitoring in '%s' through the mixer", monitor->device);
+		return true;
 	}
 
-	pa_sample_spec spec;
-	spec.format = monitor->format;
-	spec.rate = (uint32_t)monitor->samples_per_sec;
-	spec.channels = monitor->channels;
-
-	if (!pa_sample_spec_valid(&spec)) {
-		blog(LOG_ERROR, "Sample spec is not valid");
+	pa_sample_spec spec = {0};
+	if (!get_sink_spec(monitor->device, &spec))
 		return false;
-	}
+
+	monitor->format = spec.format;
+	monitor->samples_per_sec = spec.rate;
+	monitor->channels = spec.channels;
 
 	const struct audio_output_info *info = audio_output_get_info(obs->audio.audio);
 
@@ -453,6 +873,9 @@ static void audio_monitor_init_final(struct audio_monitor *monitor)
 	if (monitor->ignore)
 		return;
 
+	if (monitor->mixer)
+		monitor_mixer_add_input(monitor->mixer, monitor);
+
 	obs_source_add_audio_capture_callback(monitor->source, on_audio_playback, monitor);
 }
 
@@ -464,6 +887,14 @@ static inline void audio_monitor_free(struct audio_monitor *monitor)
 	if (monitor->source)
 		obs_source_remove_audio_capture_callback(monitor->source, on_audio_playback, monitor);
 
+	if (monitor->mixer) {
+		monitor_mixer_remove_input(monitor->mixer, monitor);
+		monitor_mixer_release(monitor->mixer);
+		monitor->mixer = NULL;
+	}
+	for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++)
+		deque_free(&monitor->mix_data[ch]);
+
 	audio_resampler_destroy(monitor->resampler);
 	deque_free(&monitor->new_data);
 
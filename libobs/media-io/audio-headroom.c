@@ -0,0 +1,74 @@
+#include "audio-headroom.h"
+#include "audio-io.h"
+#include "../util/base.h"
+
+#define HEADROOM_WINDOW_SEC 5
+#define SPARE_HEADROOM_TICKS 1
+
+static inline int64_t tick_duration_ns(size_t sample_rate)
+{
+	return (int64_t)audio_frames_to_ns(sample_rate, AUDIO_OUTPUT_FRAMES);
+}
+
+void audio_headroom_reset(struct audio_headroom *hr)
+{
+	hr->min_headroom_ns = INT64_MAX;
+	hr->window_ticks = 0;
+	hr->drain_ticks = 0;
+	hr->drain_wait_ticks = 0;
+}
+
+void audio_headroom_add_source(struct audio_headroom *hr, size_t sample_rate, uint64_t data_ts, size_t frames,
+			       uint64_t end_ts)
+{
+	int64_t headroom = 0;
+
+	/* a starving or late source has no lead, which holds the buffering
+	 * rather than draining what it is about to need again */
+	if (frames && data_ts < end_ts)
+		headroom = (int64_t)(data_ts + audio_frames_to_ns(sample_rate, frames)) - (int64_t)end_ts;
+
+	if (headroom < hr->min_headroom_ns)
+		hr->min_headroom_ns = headroom;
+}
+
+bool audio_headroom_tick(struct audio_headroom *hr, size_t sample_rate, int buffering_ticks)
+{
+	const uint32_t ticks_per_sec = (uint32_t)(sample_rate / AUDIO_OUTPUT_FRAMES);
+
+	if (hr->drain_wait_ticks)
+		hr->drain_wait_ticks--;
+
+	if (++hr->window_ticks >= ticks_per_sec * HEADROOM_WINDOW_SEC) {
+		if (hr->min_headroom_ns != INT64_MAX) {
+			int64_t excess = hr->min_headroom_ns / tick_duration_ns(sample_rate) - SPARE_HEADROOM_TICKS;
+			if (excess > buffering_ticks)
+				excess = buffering_ticks;
+
+			hr->drain_ticks = excess > 0 ? (int)excess : 0;
+			if (hr->drain_ticks) {
+				blog(LOG_INFO, "draining %d milliseconds of audio buffering",
+				     (int)(hr->drain_ticks * AUDIO_OUTPUT_FRAMES * 1000 / sample_rate));
+			}
+		}
+
+		hr->min_headroom_ns = INT64_MAX;
+		hr->window_ticks = 0;
+	}
+
+	/* one tick a second, so a source that is late again does not get
+	 * caught out by a sudden drop */
+	if (!hr->drain_ticks || hr->drain_wait_ticks)
+		return false;
+
+	hr->drain_ticks--;
+	hr->drain_wait_ticks = ticks_per_sec;
+	return true;
+}
+
+void audio_headroom_drained(struct audio_headroom *hr, size_t sample_rate)
+{
+	/* every source just lost a tick of lead */
+	if (hr->min_headroom_ns != INT64_MAX)
+		hr->min_headroom_ns -= tick_duration_ns(sample_rate);
+}
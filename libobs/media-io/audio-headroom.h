@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../util/c99defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Controller for adaptive audio buffering.
+ *
+ * Tracks the smallest lead the data of any source has over the block being
+ * rendered, over windows of a few seconds.  When even the smallest lead in a
+ * window exceeds a tick plus a spare one, the excess is drained again one
+ * tick at a time.  A source that is active but has no data for the block, or
+ * whose data only starts after it, has no lead at all, so the buffering it
+ * needs is held.
+ */
+
+struct audio_headroom {
+	int64_t min_headroom_ns;
+	uint32_t window_ticks;
+	int drain_ticks;
+	uint32_t drain_wait_ticks;
+};
+
+/* starts a new measurement window and cancels pending drains, e.g. when
+ * buffering was just added */
+void audio_headroom_reset(struct audio_headroom *hr);
+
+/* data_ts is the timestamp of the first buffered frame of a source, end_ts
+ * the end of the block being rendered */
+void audio_headroom_add_source(struct audio_headroom *hr, size_t sample_rate, uint64_t data_ts, size_t frames,
+			       uint64_t end_ts);
+
+/* called once per rendered block, returns true if a tick of buffering should
+ * be drained now */
+bool audio_headroom_tick(struct audio_headroom *hr, size_t sample_rate, int buffering_ticks);
+
+/* called once a tick of buffering was drained */
+void audio_headroom_drained(struct audio_headroom *hr, size_t sample_rate);
+
+#ifdef __cplusplus
+}
+#endif
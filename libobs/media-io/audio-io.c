@@ -77,6 +77,9 @@ struct audio_output {
 	void *input_param;
 	pthread_mutex_t input_mutex;
 	struct audio_mix mixes[MAX_AUDIO_MIXES];
+
+	/* only touched by the audio thread */
+	uint32_t extra_blocks;
 };
 
 /* ------------------------------------------------------------------------- */
@@ -231,6 +234,13 @@ static void *audio_thread(void *param)
 		input_and_output(audio, audio_time, prev_time);
 		prev_time = audio_time;
 
+		/* an empty time range tells the input callback to render the
+		 * next block it has buffered rather than a new one */
+		while (audio->extra_blocks) {
+			audio->extra_blocks--;
+			input_and_output(audio, audio_time, audio_time);
+		}
+
 		profile_end(audio_thread_name);
 
 		profile_reenable_thread();
@@ -419,6 +429,12 @@ const struct audio_output_info *audio_output_get_info(const audio_t *audio)
 	return audio ? &audio->info : NULL;
 }
 
+void audio_output_request_extra_block(audio_t *audio)
+{
+	if (audio)
+		audio->extra_blocks++;
+}
+
 bool audio_output_active(const audio_t *audio)
 {
 	if (!audio)
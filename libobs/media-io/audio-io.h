@@ -217,6 +217,12 @@ EXPORT void audio_output_disconnect(audio_t *video, size_t mix_idx, audio_output
 
 EXPORT bool audio_output_active(const audio_t *audio);
 
+/* Only valid from within the input callback.  Once the current block has been
+ * output, the input callback is called again right away with start_ts equal
+ * to end_ts, and should output the next block it has buffered.  Lets a client
+ * that buffers ahead of real time drain that buffering without a gap. */
+EXPORT void audio_output_request_extra_block(audio_t *audio);
+
 EXPORT size_t audio_output_get_block_size(const audio_t *audio);
 EXPORT size_t audio_output_get_planes(const audio_t *audio);
 EXPORT size_t audio_output_get_channels(const audio_t *audio);
@@ -39,6 +39,11 @@ EXPORT void audio_resampler_destroy(audio_resampler_t *resampler);
 EXPORT bool audio_resampler_resample(audio_resampler_t *resampler, uint8_t *output[], uint32_t *out_frames,
 				     uint64_t *ts_offset, const uint8_t *const input[], uint32_t in_frames);
 
+/* Stretches (sample_delta > 0) or squeezes (sample_delta < 0) the next
+ * distance output frames by sample_delta frames, to follow a clock that
+ * drifts against the input.  Replaces any compensation still pending. */
+EXPORT bool audio_resampler_set_compensation(audio_resampler_t *resampler, int sample_delta, int distance);
+
 #ifdef __cplusplus
 }
 #endif
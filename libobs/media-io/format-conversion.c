@@ -18,6 +18,23 @@
 #include "format-conversion.h"
 
 #include "../util/sse-intrin.h"
+#include "../util/threading.h"
+
+#include <string.h>
+
+/* FORMAT_CONVERSION_SSE2_ONLY is set by the tests to run the SSE2 kernels on
+ * CPUs that have AVX2 */
+#if ((defined(_M_X64) && !defined(_M_ARM64EC)) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)) && \
+	!defined(FORMAT_CONVERSION_SSE2_ONLY)
+#define HAVE_AVX2_KERNELS
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_FUNC
+#else
+#define AVX2_FUNC __attribute__((target("avx2")))
+#endif
+#endif
 
 /* ...surprisingly, if I don't use a macro to force inlining, it causes the
  * CPU usage to boost by a tremendous amount in debug builds. */
@@ -77,8 +94,8 @@ static FORCE_INLINE uint32_t min_uint32(uint32_t a, uint32_t b)
 	return a < b ? a : b;
 }
 
-void compress_uyvx_to_i420(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
-			   uint8_t *output[], const uint32_t out_linesize[])
+static void compress_uyvx_to_i420_sse2(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
+				    uint8_t *output[], const uint32_t out_linesize[])
 {
 	uint8_t *lum_plane = output[0];
 	uint8_t *u_plane = output[1];
@@ -109,8 +126,8 @@ void compress_uyvx_to_i420(const uint8_t *input, uint32_t in_linesize, uint32_t
 	}
 }
 
-void compress_uyvx_to_nv12(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
-			   uint8_t *output[], const uint32_t out_linesize[])
+static void compress_uyvx_to_nv12_sse2(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
+				    uint8_t *output[], const uint32_t out_linesize[])
 {
 	uint8_t *lum_plane = output[0];
 	uint8_t *chroma_plane = output[1];
@@ -140,8 +157,8 @@ void compress_uyvx_to_nv12(const uint8_t *input, uint32_t in_linesize, uint32_t
 	}
 }
 
-void convert_uyvx_to_i444(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
-			  uint8_t *output[], const uint32_t out_linesize[])
+static void convert_uyvx_to_i444_sse2(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
+				     uint8_t *output[], const uint32_t out_linesize[])
 {
 	uint8_t *lum_plane = output[0];
 	uint8_t *u_plane = output[1];
@@ -173,6 +190,290 @@ void convert_uyvx_to_i444(const uint8_t *input, uint32_t in_linesize, uint32_t s
 	}
 }
 
+#ifdef HAVE_AVX2_KERNELS
+
+/* The AVX2 kernels handle 8 pixels of two lines per iteration.  Byte shuffles
+ * only work within 128-bit lanes, so each line is gathered into the low dwords
+ * of both lanes and a cross-lane permute puts the halves back in order. */
+
+#define gather_shuf(ofs) \
+	_mm256_setr_epi8(ofs, ofs + 4, ofs + 8, ofs + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, ofs, \
+			 ofs + 4, ofs + 8, ofs + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)
+#define gather_shuf_hi(ofs) \
+	_mm256_setr_epi8(-1, -1, -1, -1, ofs, ofs + 4, ofs + 8, ofs + 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, \
+			 -1, -1, ofs, ofs + 4, ofs + 8, ofs + 12, -1, -1, -1, -1, -1, -1, -1, -1)
+
+#define pack_lines_avx2(plane, pos0, pos1, line1, line2, shuf1, shuf2, perm)                                     \
+	do {                                                                                                     \
+		__m256i packed = _mm256_or_si256(_mm256_shuffle_epi8(line1, shuf1),                              \
+						 _mm256_shuffle_epi8(line2, shuf2));                             \
+		__m128i vals = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(packed, perm));                \
+                                                                                                                 \
+		_mm_storel_epi64((__m128i *)(plane + pos0), vals);                                               \
+		_mm_storel_epi64((__m128i *)(plane + pos1), _mm_srli_si128(vals, 8));                            \
+	} while (false)
+
+/* leaves the 2x2 averages of U and V in the low bytes of the 16-bit words of
+ * dwords 0 and 2 of each lane */
+#define average_ch_avx2(avg_val, line1, line2, uv_mask)                                                         \
+	do {                                                                                                     \
+		__m256i add_val = _mm256_add_epi16(_mm256_and_si256(line1, uv_mask), _mm256_and_si256(line2, uv_mask)); \
+		add_val = _mm256_add_epi16(add_val, _mm256_shuffle_epi32(add_val, _MM_SHUFFLE(2, 3, 0, 1)));     \
+		avg_val = _mm256_srli_epi16(add_val, 2);                                                          \
+	} while (false)
+
+AVX2_FUNC static void compress_uyvx_to_i420_avx2(const uint8_t *input, uint32_t in_linesize, uint32_t start_y,
+						 uint32_t end_y, uint8_t *output[], const uint32_t out_linesize[])
+{
+	uint8_t *lum_plane = output[0];
+	uint8_t *u_plane = output[1];
+	uint8_t *v_plane = output[2];
+	uint32_t width = min_uint32(in_linesize, out_linesize[0]);
+	uint32_t width_avx2 = width & ~7;
+	uint32_t y;
+
+	const __m256i lum_shuf1 = gather_shuf(1);
+	const __m256i lum_shuf2 = gather_shuf_hi(1);
+	const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	const __m256i ch_shuf = _mm256_setr_epi8(0, 8, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 8, 2,
+						 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i planar_shuf = _mm_setr_epi8(0, 1, 4, 5, 2, 3, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m256i uv_mask_avx2 = _mm256_set1_epi16(0x00FF);
+
+	__m128i lum_mask = _mm_set1_epi32(0x0000FF00);
+	__m128i uv_mask = _mm_set1_epi16(0x00FF);
+
+	for (y = start_y; y < end_y; y += 2) {
+		uint32_t y_pos = y * in_linesize;
+		uint32_t chroma_y_pos = (y >> 1) * out_linesize[1];
+		uint32_t lum_y_pos = y * out_linesize[0];
+		uint32_t x;
+
+		for (x = 0; x < width_avx2; x += 8) {
+			const uint8_t *img = input + y_pos + x * 4;
+			uint32_t lum_pos0 = lum_y_pos + x;
+			uint32_t lum_pos1 = lum_pos0 + out_linesize[0];
+			uint32_t chroma_pos = chroma_y_pos + (x >> 1);
+			__m256i avg_val;
+
+			__m256i line1 = _mm256_loadu_si256((const __m256i *)img);
+			__m256i line2 = _mm256_loadu_si256((const __m256i *)(img + in_linesize));
+
+			pack_lines_avx2(lum_plane, lum_pos0, lum_pos1, line1, line2, lum_shuf1, lum_shuf2, perm);
+
+			average_ch_avx2(avg_val, line1, line2, uv_mask_avx2);
+			avg_val = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(avg_val, ch_shuf), perm);
+
+			__m128i uv_vals = _mm_shuffle_epi8(_mm256_castsi256_si128(avg_val), planar_shuf);
+			uint32_t u_vals = (uint32_t)_mm_cvtsi128_si32(uv_vals);
+			uint32_t v_vals = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(uv_vals, 4));
+
+			/* chroma lines are only 2 byte aligned */
+			memcpy(u_plane + chroma_pos, &u_vals, sizeof(u_vals));
+			memcpy(v_plane + chroma_pos, &v_vals, sizeof(v_vals));
+		}
+
+		for (; x < width; x += 4) {
+			const uint8_t *img = input + y_pos + x * 4;
+			uint32_t lum_pos0 = lum_y_pos + x;
+			uint32_t lum_pos1 = lum_pos0 + out_linesize[0];
+
+			__m128i line1 = _mm_load_si128((const __m128i *)img);
+			__m128i line2 = _mm_load_si128((const __m128i *)(img + in_linesize));
+
+			pack_shift(lum_plane, lum_pos0, lum_pos1, line1, line2, lum_mask, 1);
+			pack_ch_2plane(u_plane, v_plane, chroma_y_pos + (x >> 1), line1, line2, uv_mask);
+		}
+	}
+}
+
+AVX2_FUNC static void compress_uyvx_to_nv12_avx2(const uint8_t *input, uint32_t in_linesize, uint32_t start_y,
+						 uint32_t end_y, uint8_t *output[], const uint32_t out_linesize[])
+{
+	uint8_t *lum_plane = output[0];
+	uint8_t *chroma_plane = output[1];
+	uint32_t width = min_uint32(in_linesize, out_linesize[0]);
+	uint32_t width_avx2 = width & ~7;
+	uint32_t y;
+
+	const __m256i lum_shuf1 = gather_shuf(1);
+	const __m256i lum_shuf2 = gather_shuf_hi(1);
+	const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	const __m256i ch_shuf = _mm256_setr_epi8(0, 2, 8, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 2, 8,
+						 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m256i uv_mask_avx2 = _mm256_set1_epi16(0x00FF);
+
+	__m128i lum_mask = _mm_set1_epi32(0x0000FF00);
+	__m128i uv_mask = _mm_set1_epi16(0x00FF);
+
+	for (y = start_y; y < end_y; y += 2) {
+		uint32_t y_pos = y * in_linesize;
+		uint32_t chroma_y_pos = (y >> 1) * out_linesize[1];
+		uint32_t lum_y_pos = y * out_linesize[0];
+		uint32_t x;
+
+		for (x = 0; x < width_avx2; x += 8) {
+			const uint8_t *img = input + y_pos + x * 4;
+			uint32_t lum_pos0 = lum_y_pos + x;
+			uint32_t lum_pos1 = lum_pos0 + out_linesize[0];
+			__m256i avg_val;
+
+			__m256i line1 = _mm256_loadu_si256((const __m256i *)img);
+			__m256i line2 = _mm256_loadu_si256((const __m256i *)(img + in_linesize));
+
+			pack_lines_avx2(lum_plane, lum_pos0, lum_pos1, line1, line2, lum_shuf1, lum_shuf2, perm);
+
+			average_ch_avx2(avg_val, line1, line2, uv_mask_avx2);
+			avg_val = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(avg_val, ch_shuf), perm);
+			_mm_storel_epi64((__m128i *)(chroma_plane + chroma_y_pos + x), _mm256_castsi256_si128(avg_val));
+		}
+
+		for (; x < width; x += 4) {
+			const uint8_t *img = input + y_pos + x * 4;
+			uint32_t lum_pos0 = lum_y_pos + x;
+			uint32_t lum_pos1 = lum_pos0 + out_linesize[0];
+
+			__m128i line1 = _mm_load_si128((const __m128i *)img);
+			__m128i line2 = _mm_load_si128((const __m128i *)(img + in_linesize));
+
+			pack_shift(lum_plane, lum_pos0, lum_pos1, line1, line2, lum_mask, 1);
+			pack_ch_1plane(chroma_plane, chroma_y_pos + x, line1, line2, uv_mask);
+		}
+	}
+}
+
+AVX2_FUNC static void convert_uyvx_to_i444_avx2(const uint8_t *input, uint32_t in_linesize, uint32_t start_y,
+						uint32_t end_y, uint8_t *output[], const uint32_t out_linesize[])
+{
+	uint8_t *lum_plane = output[0];
+	uint8_t *u_plane = output[1];
+	uint8_t *v_plane = output[2];
+	uint32_t width = min_uint32(in_linesize, out_linesize[0]);
+	uint32_t width_avx2 = width & ~7;
+	uint32_t y;
+
+	const __m256i lum_shuf1 = gather_shuf(1);
+	const __m256i lum_shuf2 = gather_shuf_hi(1);
+	const __m256i u_shuf1 = gather_shuf(0);
+	const __m256i u_shuf2 = gather_shuf_hi(0);
+	const __m256i v_shuf1 = gather_shuf(2);
+	const __m256i v_shuf2 = gather_shuf_hi(2);
+	const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+	__m128i lum_mask = _mm_set1_epi32(0x0000FF00);
+	__m128i u_mask = _mm_set1_epi32(0x000000FF);
+	__m128i v_mask = _mm_set1_epi32(0x00FF0000);
+
+	for (y = start_y; y < end_y; y += 2) {
+		uint32_t y_pos = y * in_linesize;
+		uint32_t lum_y_pos = y * out_linesize[0];
+		uint32_t x;
+
+		for (x = 0; x < width_avx2; x += 8) {
+			const uint8_t *img = input + y_pos + x * 4;
+			uint32_t lum_pos0 = lum_y_pos + x;
+			uint32_t lum_pos1 = lum_pos0 + out_linesize[0];
+
+			__m256i line1 = _mm256_loadu_si256((const __m256i *)img);
+			__m256i line2 = _mm256_loadu_si256((const __m256i *)(img + in_linesize));
+
+			pack_lines_avx2(lum_plane, lum_pos0, lum_pos1, line1, line2, lum_shuf1, lum_shuf2, perm);
+			pack_lines_avx2(u_plane, lum_pos0, lum_pos1, line1, line2, u_shuf1, u_shuf2, perm);
+			pack_lines_avx2(v_plane, lum_pos0, lum_pos1, line1, line2, v_shuf1, v_shuf2, perm);
+		}
+
+		for (; x < width; x += 4) {
+			const uint8_t *img = input + y_pos + x * 4;
+			uint32_t lum_pos0 = lum_y_pos + x;
+			uint32_t lum_pos1 = lum_pos0 + out_linesize[0];
+
+			__m128i line1 = _mm_load_si128((const __m128i *)img);
+			__m128i line2 = _mm_load_si128((const __m128i *)(img + in_linesize));
+
+			pack_shift(lum_plane, lum_pos0, lum_pos1, line1, line2, lum_mask, 1);
+			pack_val(u_plane, lum_pos0, lum_pos1, line1, line2, u_mask);
+			pack_shift(v_plane, lum_pos0, lum_pos1, line1, line2, v_mask, 2);
+		}
+	}
+}
+
+static bool cpu_has_avx2(void)
+{
+#ifdef _MSC_VER
+	int info[4];
+
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	/* AVX and OSXSAVE, then check that the OS saves the YMM registers */
+	__cpuid(info, 1);
+	if ((info[2] & 0x18000000) != 0x18000000)
+		return false;
+	if ((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & 0x20) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static inline bool use_avx2(void)
+{
+	static volatile long avx2 = -1;
+	long val = os_atomic_load_long(&avx2);
+
+	if (val == -1) {
+		val = cpu_has_avx2() ? 1 : 0;
+		os_atomic_set_long(&avx2, val);
+	}
+
+	return val == 1;
+}
+
+#else
+
+static inline bool use_avx2(void)
+{
+	return false;
+}
+
+#define compress_uyvx_to_i420_avx2 compress_uyvx_to_i420_sse2
+#define compress_uyvx_to_nv12_avx2 compress_uyvx_to_nv12_sse2
+#define convert_uyvx_to_i444_avx2 convert_uyvx_to_i444_sse2
+
+#endif
+
+void compress_uyvx_to_i420(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
+			   uint8_t *output[], const uint32_t out_linesize[])
+{
+	if (use_avx2())
+		compress_uyvx_to_i420_avx2(input, in_linesize, start_y, end_y, output, out_linesize);
+	else
+		compress_uyvx_to_i420_sse2(input, in_linesize, start_y, end_y, output, out_linesize);
+}
+
+void compress_uyvx_to_nv12(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
+			   uint8_t *output[], const uint32_t out_linesize[])
+{
+	if (use_avx2())
+		compress_uyvx_to_nv12_avx2(input, in_linesize, start_y, end_y, output, out_linesize);
+	else
+		compress_uyvx_to_nv12_sse2(input, in_linesize, start_y, end_y, output, out_linesize);
+}
+
+void convert_uyvx_to_i444(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
+			  uint8_t *output[], const uint32_t out_linesize[])
+{
+	if (use_avx2())
+		convert_uyvx_to_i444_avx2(input, in_linesize, start_y, end_y, output, out_linesize);
+	else
+		convert_uyvx_to_i444_sse2(input, in_linesize, start_y, end_y, output, out_linesize);
+}
+
 void decompress_420(const uint8_t *const input[], const uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
 		    uint8_t *output, uint32_t out_linesize)
 {
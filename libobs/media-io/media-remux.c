@@ -19,16 +19,51 @@
 
 #include "../util/base.h"
 #include "../util/bmem.h"
+#include "../util/deque.h"
+#include "../util/dstr.h"
 #include "../util/platform.h"
+#include "../util/threading.h"
 
 #include <libavformat/avformat.h>
 #include <libavcodec/version.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
+/* Recordings are read and written in large blocks rather than FFmpeg's
+ * default 32 KiB, and the input is read ahead on its own thread, so the
+ * disks stay busy while packets are being muxed. */
+#define AVIO_READ_BUFFER_SIZE (1024 * 1024)
+#define AVIO_WRITE_BUFFER_SIZE (4 * 1024 * 1024)
+#define READ_CHUNK_SIZE (4 * 1024 * 1024)
+#define READ_AHEAD_SIZE (32 * 1024 * 1024)
+
+struct remux_reader {
+	FILE *file;
+	int64_t size;
+
+	pthread_t thread;
+	bool thread_valid;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+
+	struct deque data;
+	int64_t pos; /* file position of the first byte of data */
+	uint64_t seek_id;
+	bool eof;
+	bool error;
+	bool stop;
+};
+
 struct media_remux_job {
 	int64_t in_size;
 	AVFormatContext *ifmt_ctx, *ofmt_ctx;
+	uint32_t flags;
+
+	struct remux_reader reader;
+	AVIOContext *in_pb;
+
+	FILE *out_file;
+	AVIOContext *out_pb;
 };
 
 static inline void init_size(media_remux_job_t job, const char *in_filename)
@@ -43,8 +78,229 @@ static inline void init_size(media_remux_job_t job, const char *in_filename)
 	job->in_size = st.st_size;
 }
 
+/* ------------------------------------------------------------------------- */
+/* read-ahead input                                                          */
+
+static void *reader_thread(void *opaque)
+{
+	struct remux_reader *reader = opaque;
+	uint8_t *chunk = bmalloc(READ_CHUNK_SIZE);
+	int64_t file_pos = 0;
+
+	os_set_thread_name("media_remux: reader");
+
+	pthread_mutex_lock(&reader->mutex);
+
+	for (;;) {
+		while (!reader->stop && (reader->eof || reader->data.size >= READ_AHEAD_SIZE))
+			pthread_cond_wait(&reader->cond, &reader->mutex);
+		if (reader->stop)
+			break;
+
+		int64_t pos = reader->pos + (int64_t)reader->data.size;
+		uint64_t seek_id = reader->seek_id;
+		pthread_mutex_unlock(&reader->mutex);
+
+		size_t size = 0;
+		bool error = false;
+
+		if (pos == file_pos || os_fseeki64(reader->file, pos, SEEK_SET) == 0) {
+			size = fread(chunk, 1, READ_CHUNK_SIZE, reader->file);
+			error = ferror(reader->file) != 0;
+			file_pos = pos + (int64_t)size;
+		} else {
+			error = true;
+		}
+
+		pthread_mutex_lock(&reader->mutex);
+
+		/* the data is stale if the demuxer seeked in the meantime */
+		if (seek_id == reader->seek_id) {
+			deque_push_back(&reader->data, chunk, size);
+			reader->eof = size < READ_CHUNK_SIZE;
+			reader->error = error;
+		} else {
+			file_pos = -1;
+		}
+
+		pthread_cond_broadcast(&reader->cond);
+	}
+
+	pthread_mutex_unlock(&reader->mutex);
+	bfree(chunk);
+	return NULL;
+}
+
+static int reader_read(void *opaque, uint8_t *buf, int buf_size)
+{
+	struct remux_reader *reader = opaque;
+	size_t size;
+
+	pthread_mutex_lock(&reader->mutex);
+
+	while (!reader->data.size && !reader->eof)
+		pthread_cond_wait(&reader->cond, &reader->mutex);
+
+	size = reader->data.size < (size_t)buf_size ? reader->data.size : (size_t)buf_size;
+	deque_pop_front(&reader->data, buf, size);
+	reader->pos += (int64_t)size;
+
+	pthread_cond_broadcast(&reader->cond);
+	bool error = reader->error;
+	pthread_mutex_unlock(&reader->mutex);
+
+	if (!size)
+		return error ? AVERROR(EIO) : AVERROR_EOF;
+	return (int)size;
+}
+
+static int64_t reader_seek(void *opaque, int64_t offset, int whence)
+{
+	struct remux_reader *reader = opaque;
+	int64_t target;
+
+	if (whence & AVSEEK_SIZE)
+		return reader->size;
+
+	pthread_mutex_lock(&reader->mutex);
+
+	switch (whence & ~AVSEEK_FORCE) {
+	case SEEK_SET:
+		target = offset;
+		break;
+	case SEEK_CUR:
+		target = reader->pos + offset;
+		break;
+	case SEEK_END:
+		target = reader->size + offset;
+		break;
+	default:
+		pthread_mutex_unlock(&reader->mutex);
+		return AVERROR(EINVAL);
+	}
+
+	if (target < 0) {
+		pthread_mutex_unlock(&reader->mutex);
+		return AVERROR(EINVAL);
+	}
+
+	/* short skips forward are served from what was already read */
+	if (target >= reader->pos && target <= reader->pos + (int64_t)reader->data.size) {
+		deque_pop_front(&reader->data, NULL, (size_t)(target - reader->pos));
+	} else {
+		deque_pop_front(&reader->data, NULL, reader->data.size);
+		reader->seek_id++;
+		reader->eof = false;
+		reader->error = false;
+	}
+
+	reader->pos = target;
+	pthread_cond_broadcast(&reader->cond);
+	pthread_mutex_unlock(&reader->mutex);
+	return target;
+}
+
+static bool reader_init(struct remux_reader *reader, const char *filename, int64_t size)
+{
+	reader->file = os_fopen(filename, "rb");
+	if (!reader->file)
+		return false;
+
+	reader->size = size;
+
+	if (pthread_mutex_init(&reader->mutex, NULL) != 0)
+		goto fail_mutex;
+	if (pthread_cond_init(&reader->cond, NULL) != 0)
+		goto fail_cond;
+	if (pthread_create(&reader->thread, NULL, reader_thread, reader) != 0)
+		goto fail_thread;
+
+	reader->thread_valid = true;
+	return true;
+
+fail_thread:
+	pthread_cond_destroy(&reader->cond);
+fail_cond:
+	pthread_mutex_destroy(&reader->mutex);
+fail_mutex:
+	fclose(reader->file);
+	reader->file = NULL;
+	return false;
+}
+
+static void reader_free(struct remux_reader *reader)
+{
+	if (!reader->thread_valid)
+		return;
+
+	pthread_mutex_lock(&reader->mutex);
+	reader->stop = true;
+	pthread_cond_broadcast(&reader->cond);
+	pthread_mutex_unlock(&reader->mutex);
+
+	pthread_join(reader->thread, NULL);
+	pthread_cond_destroy(&reader->cond);
+	pthread_mutex_destroy(&reader->mutex);
+	deque_free(&reader->data);
+	fclose(reader->file);
+
+	reader->thread_valid = false;
+	reader->file = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/* buffered output                                                           */
+
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+static int writer_write(void *opaque, const uint8_t *buf, int buf_size)
+#else
+static int writer_write(void *opaque, uint8_t *buf, int buf_size)
+#endif
+{
+	media_remux_job_t job = opaque;
+
+	if (fwrite(buf, 1, (size_t)buf_size, job->out_file) != (size_t)buf_size)
+		return AVERROR(EIO);
+	return buf_size;
+}
+
+static int64_t writer_seek(void *opaque, int64_t offset, int whence)
+{
+	media_remux_job_t job = opaque;
+
+	if (whence & AVSEEK_SIZE) {
+		int64_t pos = os_ftelli64(job->out_file);
+		if (os_fseeki64(job->out_file, 0, SEEK_END) != 0)
+			return AVERROR(EIO);
+
+		int64_t size = os_ftelli64(job->out_file);
+		os_fseeki64(job->out_file, pos, SEEK_SET);
+		return size;
+	}
+
+	if (os_fseeki64(job->out_file, offset, whence & ~AVSEEK_FORCE) != 0)
+		return AVERROR(EIO);
+	return os_ftelli64(job->out_file);
+}
+
+/* ------------------------------------------------------------------------- */
+
 static inline bool init_input(media_remux_job_t job, const char *in_filename)
 {
+	/* playlists open their segments through FFmpeg's own I/O */
+	const char *ext = os_get_path_extension(in_filename);
+	bool read_ahead = !ext || astrcmpi(ext, ".m3u8") != 0;
+
+	if (read_ahead && reader_init(&job->reader, in_filename, job->in_size)) {
+		uint8_t *buffer = av_malloc(AVIO_READ_BUFFER_SIZE);
+
+		job->in_pb = avio_alloc_context(buffer, AVIO_READ_BUFFER_SIZE, 0, &job->reader, reader_read, NULL,
+						reader_seek);
+		job->ifmt_ctx = avformat_alloc_context();
+		job->ifmt_ctx->pb = job->in_pb;
+		job->ifmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+	}
+
 	int ret = avformat_open_input(&job->ifmt_ctx, in_filename, NULL, NULL);
 	if (ret < 0) {
 		blog(LOG_ERROR, "media_remux: Could not open input file '%s'", in_filename);
@@ -120,20 +376,36 @@ static inline bool init_output(media_remux_job_t job, const char *out_filename)
 #endif
 
 	if (!(job->ofmt_ctx->oformat->flags & AVFMT_NOFILE)) {
-		ret = avio_open(&job->ofmt_ctx->pb, out_filename, AVIO_FLAG_WRITE);
-		if (ret < 0) {
+		/* unbuffered, as the avio buffer is large already and fast
+		 * start reads the file back through a separate handle */
+		job->out_file = os_fopen(out_filename, "wb");
+		if (!job->out_file) {
 			blog(LOG_ERROR,
 			     "media_remux: Failed to open output"
 			     " file '%s'",
 			     out_filename);
 			return false;
 		}
+		setvbuf(job->out_file, NULL, _IONBF, 0);
+
+		uint8_t *buffer = av_malloc(AVIO_WRITE_BUFFER_SIZE);
+
+		job->out_pb = avio_alloc_context(buffer, AVIO_WRITE_BUFFER_SIZE, 1, job, NULL, writer_write,
+						 writer_seek);
+		job->ofmt_ctx->pb = job->out_pb;
+		job->ofmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
 	}
 
 	return true;
 }
 
 bool media_remux_job_create(media_remux_job_t *job, const char *in_filename, const char *out_filename)
+{
+	return media_remux_job_create2(job, in_filename, out_filename, 0);
+}
+
+bool media_remux_job_create2(media_remux_job_t *job, const char *in_filename, const char *out_filename,
+			     uint32_t flags)
 {
 	if (!job)
 		return false;
@@ -149,6 +421,7 @@ bool media_remux_job_create(media_remux_job_t *job, const char *in_filename, con
 	if (!*job)
 		return false;
 
+	(*job)->flags = flags;
 	init_size(*job, in_filename);
 
 	if (!init_input(*job, in_filename))
@@ -174,9 +447,33 @@ static inline void process_packet(AVPacket *pkt, AVStream *in_stream, AVStream *
 	pkt->pos = -1;
 }
 
-static inline int process_packets(media_remux_job_t job, media_remux_progress_callback callback, void *data)
+static inline uint64_t bytes_processed(media_remux_job_t job, const AVPacket *pkt)
+{
+	if (job->in_pb)
+		return (uint64_t)avio_tell(job->in_pb);
+	return pkt->pos > 0 ? (uint64_t)pkt->pos : 0;
+}
+
+static inline bool report_progress(media_remux_job_t job, media_remux_progress2_callback callback, void *data,
+				   uint64_t start_ts, uint64_t processed)
+{
+	struct media_remux_progress progress = {0};
+	uint64_t elapsed = os_gettime_ns() - start_ts;
+
+	progress.bytes_total = (uint64_t)job->in_size;
+	progress.bytes_processed = processed;
+	if (job->in_size > 0)
+		progress.percent = (float)((double)processed / (double)job->in_size * 100.0);
+	if (elapsed > 0)
+		progress.bytes_per_sec = (uint64_t)((double)processed * 1000000000.0 / (double)elapsed);
+
+	return callback(data, &progress);
+}
+
+static inline int process_packets(media_remux_job_t job, media_remux_progress2_callback callback, void *data)
 {
 	AVPacket pkt;
+	uint64_t start_ts = os_gettime_ns();
 
 	int ret, throttle = 0;
 	for (;;) {
@@ -191,9 +488,10 @@ static inline int process_packets(media_remux_job_t job, media_remux_progress_ca
 		}
 
 		if (callback != NULL && throttle++ > 10) {
-			float progress = pkt.pos / (float)job->in_size * 100.f;
-			if (!callback(data, progress))
+			if (!report_progress(job, callback, data, start_ts, bytes_processed(job, &pkt))) {
+				av_packet_unref(&pkt);
 				break;
+			}
 			throttle = 0;
 		}
 
@@ -218,22 +516,51 @@ static inline int process_packets(media_remux_job_t job, media_remux_progress_ca
 	return ret;
 }
 
+struct progress_wrapper {
+	media_remux_progress_callback *callback;
+	void *data;
+};
+
+static bool wrap_progress(void *data, const struct media_remux_progress *progress)
+{
+	struct progress_wrapper *wrapper = data;
+	return wrapper->callback(wrapper->data, progress->percent);
+}
+
 bool media_remux_job_process(media_remux_job_t job, media_remux_progress_callback callback, void *data)
+{
+	struct progress_wrapper wrapper = {callback, data};
+	return media_remux_job_process2(job, callback ? wrap_progress : NULL, &wrapper);
+}
+
+static inline bool is_mov_format(const AVOutputFormat *format)
+{
+	return strcmp(format->name, "mp4") == 0 || strcmp(format->name, "mov") == 0;
+}
+
+bool media_remux_job_process2(media_remux_job_t job, media_remux_progress2_callback callback, void *data)
 {
 	int ret;
 	bool success = false;
+	AVDictionary *opts = NULL;
 
 	if (!job)
 		return success;
 
-	ret = avformat_write_header(job->ofmt_ctx, NULL);
+	/* the moov atom is moved to the front when the trailer is written */
+	if ((job->flags & MEDIA_REMUX_FAST_START) != 0 && is_mov_format(job->ofmt_ctx->oformat))
+		av_dict_set(&opts, "movflags", "+faststart", 0);
+
+	ret = avformat_write_header(job->ofmt_ctx, &opts);
+	av_dict_free(&opts);
 	if (ret < 0) {
 		blog(LOG_ERROR, "media_remux: Error opening output file: %s", av_err2str(ret));
 		return success;
 	}
 
+	struct media_remux_progress progress = {.bytes_total = (uint64_t)job->in_size};
 	if (callback != NULL)
-		callback(data, 0.f);
+		callback(data, &progress);
 
 	ret = process_packets(job, callback, data);
 	success = ret >= 0 || ret == AVERROR_EOF;
@@ -244,8 +571,18 @@ bool media_remux_job_process(media_remux_job_t job, media_remux_progress_callbac
 		success = false;
 	}
 
+	if (job->out_pb) {
+		avio_flush(job->out_pb);
+		if (job->out_pb->error < 0) {
+			blog(LOG_ERROR, "media_remux: Error writing output file: %s", av_err2str(job->out_pb->error));
+			success = false;
+		}
+	}
+
+	progress.percent = 100.f;
+	progress.bytes_processed = progress.bytes_total;
 	if (callback != NULL)
-		callback(data, 100.f);
+		callback(data, &progress);
 
 	return success;
 }
@@ -256,11 +593,19 @@ void media_remux_job_destroy(media_remux_job_t job)
 		return;
 
 	avformat_close_input(&job->ifmt_ctx);
-
-	if (job->ofmt_ctx && !(job->ofmt_ctx->oformat->flags & AVFMT_NOFILE))
-		avio_close(job->ofmt_ctx->pb);
+	if (job->in_pb) {
+		av_freep(&job->in_pb->buffer);
+		avio_context_free(&job->in_pb);
+	}
+	reader_free(&job->reader);
 
 	avformat_free_context(job->ofmt_ctx);
+	if (job->out_pb) {
+		av_freep(&job->out_pb->buffer);
+		avio_context_free(&job->out_pb);
+	}
+	if (job->out_file)
+		fclose(job->out_file);
 
 	bfree(job);
 }
@@ -24,12 +24,30 @@ typedef struct media_remux_job *media_remux_job_t;
 
 typedef bool(media_remux_progress_callback)(void *data, float percent);
 
+/* Writes MP4/MOV output with the index at the start of the file, so it can
+ * be played before it is fully downloaded.  Ignored for other formats. */
+#define MEDIA_REMUX_FAST_START (1 << 0)
+
+struct media_remux_progress {
+	float percent;
+	uint64_t bytes_processed;
+	uint64_t bytes_total;
+	uint64_t bytes_per_sec;
+};
+
+typedef bool(media_remux_progress2_callback)(void *data, const struct media_remux_progress *progress);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Jobs share no state, so several can be processed at once on different
+ * threads. */
 EXPORT bool media_remux_job_create(media_remux_job_t *job, const char *in_filename, const char *out_filename);
+EXPORT bool media_remux_job_create2(media_remux_job_t *job, const char *in_filename, const char *out_filename,
+				    uint32_t flags);
 EXPORT bool media_remux_job_process(media_remux_job_t job, media_remux_progress_callback callback, void *data);
+EXPORT bool media_remux_job_process2(media_remux_job_t job, media_remux_progress2_callback callback, void *data);
 EXPORT void media_remux_job_destroy(media_remux_job_t job);
 
 #ifdef __cplusplus
@@ -0,0 +1,154 @@
+#include "video-slice-pool.h"
+#include "../util/base.h"
+#include "../util/bmem.h"
+#include "../util/platform.h"
+#include "../util/threading.h"
+
+#define MAX_SLICE_THREADS 8
+#define AUTO_SLICE_THREADS 4
+
+/* slices per thread, so a thread that gets descheduled holds up less work */
+#define SLICES_PER_THREAD 2
+
+struct video_slice_pool {
+	pthread_t workers[MAX_SLICE_THREADS - 1];
+	uint32_t num_workers;
+
+	pthread_mutex_t run_mutex;
+	os_sem_t *start_sem;
+	os_sem_t *done_sem;
+	volatile bool stop;
+
+	video_slice_func_t func;
+	void *param;
+	uint32_t height;
+	uint32_t slice_height;
+	long num_slices;
+	volatile long next_slice;
+};
+
+static void run_slices(struct video_slice_pool *pool)
+{
+	long slice;
+
+	while ((slice = os_atomic_inc_long(&pool->next_slice) - 1) < pool->num_slices) {
+		uint32_t start_y = (uint32_t)slice * pool->slice_height;
+		uint32_t end_y = start_y + pool->slice_height;
+
+		if (end_y > pool->height)
+			end_y = pool->height;
+
+		pool->func(pool->param, start_y, end_y);
+	}
+}
+
+static void *slice_thread(void *data)
+{
+	struct video_slice_pool *pool = data;
+
+	os_set_thread_name("video-slice");
+
+	while (os_sem_wait(pool->start_sem) == 0) {
+		if (os_atomic_load_bool(&pool->stop))
+			break;
+
+		run_slices(pool);
+		os_sem_post(pool->done_sem);
+	}
+
+	return NULL;
+}
+
+video_slice_pool_t *video_slice_pool_create(uint32_t threads)
+{
+	struct video_slice_pool *pool = bzalloc(sizeof(struct video_slice_pool));
+
+	if (pthread_mutex_init(&pool->run_mutex, NULL) != 0) {
+		bfree(pool);
+		return NULL;
+	}
+
+	if (!threads) {
+		threads = (uint32_t)os_get_logical_cores() / 2;
+		if (threads > AUTO_SLICE_THREADS)
+			threads = AUTO_SLICE_THREADS;
+	}
+	if (threads > MAX_SLICE_THREADS)
+		threads = MAX_SLICE_THREADS;
+	if (threads < 2)
+		return pool;
+
+	if (os_sem_init(&pool->start_sem, 0) != 0 || os_sem_init(&pool->done_sem, 0) != 0)
+		goto fail;
+
+	for (uint32_t i = 0; i < threads - 1; i++) {
+		if (pthread_create(&pool->workers[i], NULL, slice_thread, pool) != 0)
+			goto fail;
+		pool->num_workers++;
+	}
+
+	return pool;
+
+fail:
+	blog(LOG_WARNING, "video_slice_pool_create: failed to start %u threads", threads);
+	video_slice_pool_destroy(pool);
+	return NULL;
+}
+
+void video_slice_pool_destroy(video_slice_pool_t *pool)
+{
+	if (!pool)
+		return;
+
+	os_atomic_set_bool(&pool->stop, true);
+	for (uint32_t i = 0; i < pool->num_workers; i++)
+		os_sem_post(pool->start_sem);
+	for (uint32_t i = 0; i < pool->num_workers; i++)
+		pthread_join(pool->workers[i], NULL);
+
+	pthread_mutex_destroy(&pool->run_mutex);
+	os_sem_destroy(pool->start_sem);
+	os_sem_destroy(pool->done_sem);
+	bfree(pool);
+}
+
+uint32_t video_slice_pool_threads(const video_slice_pool_t *pool)
+{
+	return pool ? pool->num_workers + 1 : 1;
+}
+
+void video_slice_pool_run(video_slice_pool_t *pool, video_slice_func_t func, void *param, uint32_t height,
+			  uint32_t row_align)
+{
+	uint32_t threads = video_slice_pool_threads(pool);
+	uint32_t slice_height;
+
+	if (!row_align)
+		row_align = 1;
+
+	slice_height = (height + threads * SLICES_PER_THREAD - 1) / (threads * SLICES_PER_THREAD);
+	slice_height = (slice_height + row_align - 1) / row_align * row_align;
+
+	/* another thread has the workers, don't wait for them */
+	if (threads == 1 || slice_height >= height || pthread_mutex_trylock(&pool->run_mutex) != 0) {
+		func(param, 0, height);
+		return;
+	}
+
+	pool->func = func;
+	pool->param = param;
+	pool->height = height;
+	pool->slice_height = slice_height;
+	pool->num_slices = (long)((height + slice_height - 1) / slice_height);
+	os_atomic_set_long(&pool->next_slice, 0);
+
+	for (uint32_t i = 0; i < pool->num_workers; i++)
+		os_sem_post(pool->start_sem);
+
+	run_slices(pool);
+
+	for (uint32_t i = 0; i < pool->num_workers; i++)
+		os_sem_wait(pool->done_sem);
+
+	pthread_mutex_unlock(&pool->run_mutex);
+}
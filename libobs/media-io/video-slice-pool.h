@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../util/c99defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Splits the rows of a frame across a pool of worker threads.  The thread
+ * calling video_slice_pool_run works on slices itself, so a pool with a single
+ * thread (or no pool at all) just calls the function for the whole frame.
+ */
+
+struct video_slice_pool;
+typedef struct video_slice_pool video_slice_pool_t;
+
+typedef void (*video_slice_func_t)(void *param, uint32_t start_y, uint32_t end_y);
+
+/* threads includes the calling thread; 0 picks a count suited to memory
+ * bound work like format conversion */
+EXPORT video_slice_pool_t *video_slice_pool_create(uint32_t threads);
+EXPORT void video_slice_pool_destroy(video_slice_pool_t *pool);
+
+EXPORT uint32_t video_slice_pool_threads(const video_slice_pool_t *pool);
+
+/* Calls func over disjoint row ranges covering 0..height, each starting on a
+ * multiple of row_align, and returns when all of them are done.  If another
+ * thread is already running the pool, func is called once for the whole frame
+ * on the calling thread instead. */
+EXPORT void video_slice_pool_run(video_slice_pool_t *pool, video_slice_func_t func, void *param, uint32_t height,
+				 uint32_t row_align);
+
+#ifdef __cplusplus
+}
+#endif
@@ -317,6 +317,22 @@ static inline bool audio_buffering_maxed(struct obs_core_audio *audio)
 	return audio->total_buffering_ticks == audio->max_buffering_ticks;
 }
 
+static void record_buffering_change(struct obs_core_audio *audio, size_t total_ms)
+{
+	struct obs_audio_buffering_change change = {
+		.timestamp = os_gettime_ns(),
+		.buffering_ms = (uint32_t)total_ms,
+	};
+
+	pthread_mutex_lock(&audio->buffering_mutex);
+	audio->buffering_ms = change.buffering_ms;
+	audio->buffering_history[audio->buffering_history_pos] = change;
+	audio->buffering_history_pos = (audio->buffering_history_pos + 1) % AUDIO_BUFFERING_HISTORY;
+	if (audio->buffering_history_count < AUDIO_BUFFERING_HISTORY)
+		audio->buffering_history_count++;
+	pthread_mutex_unlock(&audio->buffering_mutex);
+}
+
 static void set_fixed_audio_buffering(struct obs_core_audio *audio, size_t sample_rate, struct ts_info *ts)
 {
 	struct ts_info new_ts;
@@ -338,6 +354,7 @@ static void set_fixed_audio_buffering(struct obs_core_audio *audio, size_t sampl
 	     "Enabling fixed audio buffering, total "
 	     "audio buffering is now %d milliseconds",
 	     (int)total_ms);
+	record_buffering_change(audio, total_ms);
 
 	new_ts.start =
 		audio->buffered_ts - audio_frames_to_ns(sample_rate, audio->buffering_wait_ticks * AUDIO_OUTPUT_FRAMES);
@@ -394,6 +411,10 @@ static void add_audio_buffering(struct obs_core_audio *audio, size_t sample_rate
 	     "audio buffering is now %d milliseconds"
 	     " (source: %s)\n",
 	     (int)ms, (int)total_ms, buffering_name);
+	record_buffering_change(audio, total_ms);
+
+	/* whatever was measured so far no longer holds */
+	audio_headroom_reset(&audio->headroom);
 #if DEBUG_AUDIO == 1
 	blog(LOG_DEBUG,
 	     "min_ts (%" PRIu64 ") < start timestamp "
@@ -421,6 +442,48 @@ static void add_audio_buffering(struct obs_core_audio *audio, size_t sample_rate
 	*ts = new_ts;
 }
 
+/* ------------------------------------------------------------------------- */
+/* adaptive buffering
+ *
+ * Buffering is added as soon as any source is late, but sources often only
+ * need it for a moment: a USB hiccup, a Bluetooth device reconnecting.  With
+ * adaptive buffering, excess buffering is drained again one tick at a time,
+ * by asking audio-io to render the next buffered block right away.  Output
+ * stays continuous, so no samples are dropped and A/V sync is unaffected. */
+
+static inline void update_source_headroom(struct obs_core_audio *audio, obs_source_t *source, size_t sample_rate,
+					  const struct ts_info *ts)
+{
+	size_t frames = source->audio_input_buf[0].size / sizeof(float);
+
+	/* sources without audio timing do not provide audio right now */
+	if (source->info.audio_render || !source->audio_ts)
+		return;
+
+	audio_headroom_add_source(&audio->headroom, sample_rate, source->audio_ts, frames, ts->end);
+}
+
+static void update_adaptive_buffering(struct obs_core_audio *audio, size_t sample_rate)
+{
+	if (audio_headroom_tick(&audio->headroom, sample_rate, audio->total_buffering_ticks))
+		audio_output_request_extra_block(audio->audio);
+}
+
+static void drain_audio_buffering(struct obs_core_audio *audio, size_t sample_rate)
+{
+	size_t total_ms;
+
+	audio->total_buffering_ticks--;
+	audio_headroom_drained(&audio->headroom, sample_rate);
+
+	total_ms = audio->total_buffering_ticks * AUDIO_OUTPUT_FRAMES * 1000 / sample_rate;
+	record_buffering_change(audio, total_ms);
+
+#if DEBUG_AUDIO == 1
+	blog(LOG_DEBUG, "drained a tick of audio buffering, total is now %d milliseconds", (int)total_ms);
+#endif
+}
+
 static bool audio_buffer_insufficient(struct obs_source *source, size_t sample_rate, uint64_t min_ts)
 {
 	size_t total_floats = AUDIO_OUTPUT_FRAMES;
@@ -564,10 +627,19 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 	size_t audio_size;
 	uint64_t min_ts;
 
+	/* audio-io passes an empty range when adaptive buffering asked it for
+	 * an extra block: output the next buffered block, no new one */
+	bool drain = start_ts_in == end_ts_in;
+	if (drain && (!audio->total_buffering_ticks || audio->buffering_wait_ticks))
+		return false;
+
 	da_resize(audio->render_order, 0);
 	da_resize(audio->root_nodes, 0);
 
-	deque_push_back(&audio->buffered_timestamps, &ts, sizeof(ts));
+	if (drain)
+		drain_audio_buffering(audio, sample_rate);
+	else
+		deque_push_back(&audio->buffered_timestamps, &ts, sizeof(ts));
 	deque_peek_front(&audio->buffered_timestamps, &ts, sizeof(ts));
 	min_ts = ts.start;
 
@@ -697,9 +769,13 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 	/* discard audio */
 	pthread_mutex_lock(&data->audio_sources_mutex);
 
+	bool measure_headroom = audio->adaptive_buffer && !audio->buffering_wait_ticks;
+
 	source = data->first_audio_source;
 	while (source) {
 		pthread_mutex_lock(&source->audio_buf_mutex);
+		if (measure_headroom)
+			update_source_headroom(audio, source, sample_rate, &ts);
 		discard_audio(audio, source, channels, sample_rate, &ts);
 		pthread_mutex_unlock(&source->audio_buf_mutex);
 
@@ -721,6 +797,9 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 		return false;
 	}
 
+	if (audio->adaptive_buffer && !drain)
+		update_adaptive_buffering(audio, sample_rate);
+
 	execute_audio_tasks();
 
 	UNUSED_PARAMETER(param);
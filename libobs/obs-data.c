@@ -27,12 +27,19 @@
 #include "graphics/quat.h"
 #include "obs-data.h"
 
-#include <jansson.h>
+#include <errno.h>
+#include <locale.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+struct obs_data_arena_block;
 
 struct obs_data_item {
 	volatile long ref;
 	const char *name;
 	struct obs_data *parent;
+	struct obs_data_arena_block *block;
 	UT_hash_handle hh;
 	enum obs_data_type type;
 	size_t name_len;
@@ -48,11 +55,13 @@ struct obs_data {
 	volatile long ref;
 	char *json;
 	struct obs_data_item *items;
+	struct obs_data_arena_block *block;
 };
 
 struct obs_data_array {
 	volatile long ref;
 	DARRAY(obs_data_t *) objects;
+	struct obs_data_arena_block *block;
 };
 
 struct obs_data_number {
@@ -64,7 +73,26 @@ struct obs_data_number {
 };
 
 /* ------------------------------------------------------------------------- */
-/* Item structure, designed to be one allocation only */
+/* Arena for trees bulk-loaded from JSON
+ *
+ * Objects, arrays and items of a parsed tree are carved out of large blocks
+ * instead of being allocated one by one.  Everything allocated from a block
+ * holds a reference to it, so a block is freed as soon as the last object
+ * inside of it is destroyed, even if other parts of the tree (e.g. source
+ * settings) are kept around for longer.  Items that need to grow after
+ * loading are moved to the heap. */
+
+#define OBS_DATA_ARENA_BLOCK_SIZE (64 * 1024)
+
+struct obs_data_arena_block {
+	volatile long ref;
+	size_t size;
+	size_t used;
+};
+
+struct obs_data_arena {
+	struct obs_data_arena_block *block;
+};
 
 static inline size_t get_align_size(size_t size)
 {
@@ -72,6 +100,77 @@ static inline size_t get_align_size(size_t size)
 	return (size + alignment - 1) & ~(alignment - 1);
 }
 
+static inline void obs_data_arena_block_release(struct obs_data_arena_block *block)
+{
+	if (os_atomic_dec_long(&block->ref) == 0)
+		bfree(block);
+}
+
+static void *obs_data_arena_alloc(struct obs_data_arena *arena, size_t size, struct obs_data_arena_block **p_block)
+{
+	const size_t header_size = get_align_size(sizeof(struct obs_data_arena_block));
+	struct obs_data_arena_block *block = arena->block;
+	void *ptr;
+
+	size = get_align_size(size);
+
+	/* oversized allocations go to the heap */
+	if (size > OBS_DATA_ARENA_BLOCK_SIZE - header_size)
+		return NULL;
+
+	if (!block || block->used + size > block->size) {
+		if (block)
+			obs_data_arena_block_release(block);
+
+		/* the arena itself holds a reference to its current block */
+		block = bmalloc(OBS_DATA_ARENA_BLOCK_SIZE);
+		block->ref = 1;
+		block->size = OBS_DATA_ARENA_BLOCK_SIZE;
+		block->used = header_size;
+		arena->block = block;
+	}
+
+	ptr = (uint8_t *)block + block->used;
+	block->used += size;
+
+	/* the tree is not visible to other threads until loading has
+	 * finished, so no atomic is needed here */
+	block->ref++;
+
+	memset(ptr, 0, size);
+	*p_block = block;
+	return ptr;
+}
+
+static inline void obs_data_arena_free(struct obs_data_arena *arena)
+{
+	if (arena->block) {
+		obs_data_arena_block_release(arena->block);
+		arena->block = NULL;
+	}
+}
+
+static inline void *obs_data_zalloc(struct obs_data_arena *arena, size_t size, struct obs_data_arena_block **p_block)
+{
+	void *ptr = arena ? obs_data_arena_alloc(arena, size, p_block) : NULL;
+	if (!ptr) {
+		ptr = bzalloc(size);
+		*p_block = NULL;
+	}
+	return ptr;
+}
+
+static inline void obs_data_free_mem(void *ptr, struct obs_data_arena_block *block)
+{
+	if (block)
+		obs_data_arena_block_release(block);
+	else
+		bfree(ptr);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Item structure, designed to be one allocation only */
+
 /* ensures data after the name has alignment (in case of SSE) */
 static inline size_t get_name_align_size(const char *name)
 {
@@ -261,9 +360,11 @@ static inline void item_autoselect_data_addref(struct obs_data_item *item)
 	}
 }
 
-static struct obs_data_item *obs_data_item_create(const char *name, const void *data, size_t size,
-						  enum obs_data_type type, bool default_data, bool autoselect_data)
+static struct obs_data_item *obs_data_item_create(struct obs_data_arena *arena, const char *name, const void *data,
+						  size_t size, enum obs_data_type type, bool default_data,
+						  bool autoselect_data)
 {
+	struct obs_data_arena_block *block;
 	struct obs_data_item *item;
 	size_t name_size, total_size;
 
@@ -273,8 +374,9 @@ static struct obs_data_item *obs_data_item_create(const char *name, const void *
 	name_size = get_name_align_size(name);
 	total_size = name_size + sizeof(struct obs_data_item) + size;
 
-	item = bzalloc(total_size);
+	item = obs_data_zalloc(arena, total_size, &block);
 
+	item->block = block;
 	item->capacity = total_size;
 	item->type = type;
 	item->name_len = name_size;
@@ -329,7 +431,17 @@ static struct obs_data_item *obs_data_item_ensure_capacity(struct obs_data_item
 	struct obs_data *parent = item->parent;
 	obs_data_item_detach(item);
 
-	new_item = brealloc(item, new_size);
+	if (item->block) {
+		struct obs_data_arena_block *block = item->block;
+
+		new_item = bmalloc(new_size);
+		memcpy(new_item, item, item->capacity);
+		new_item->block = NULL;
+		obs_data_arena_block_release(block);
+	} else {
+		new_item = brealloc(item, new_size);
+	}
+
 	new_item->capacity = new_size;
 	new_item->name = get_item_name(new_item);
 
@@ -347,7 +459,7 @@ static inline void obs_data_item_destroy(struct obs_data_item *item)
 	item_default_data_release(item);
 	item_autoselect_data_release(item);
 	obs_data_item_detach(item);
-	bfree(item);
+	obs_data_free_mem(item, item->block);
 }
 
 static inline void move_data(obs_data_item_t *old_item, void *old_data, obs_data_item_t *item, void *data, size_t len)
@@ -439,185 +551,642 @@ static inline void obs_data_item_set_autoselect_data(struct obs_data_item **p_it
 }
 
 /* ------------------------------------------------------------------------- */
+/* JSON reader, parses directly into (arena allocated) obs_data trees
+ *
+ * Mirrors what jansson accepted with JSON_REJECT_DUPLICATES: the root must
+ * be an object or an array, duplicate keys and invalid UTF-8 are rejected,
+ * and arrays only keep their object elements. */
+
+#define JSON_MAX_DEPTH 2048
+
+static obs_data_t *obs_data_create_internal(struct obs_data_arena *arena);
+static obs_data_array_t *obs_data_array_create_internal(struct obs_data_arena *arena);
+
+struct json_reader {
+	const char *start;
+	const char *pos;
+	size_t depth;
 
-static void obs_data_add_json_item(obs_data_t *data, const char *key, json_t *json);
+	struct obs_data_arena arena;
+	DARRAY(char) key;
+	DARRAY(char) str;
 
-static inline void obs_data_add_json_object_data(obs_data_t *data, json_t *jobj)
+	const char *error_pos;
+	char error[96];
+};
+
+static void json_reader_error(struct json_reader *reader, const char *format, ...)
 {
-	const char *item_key;
-	json_t *jitem;
+	va_list args;
 
-	json_object_foreach (jobj, item_key, jitem) {
-		obs_data_add_json_item(data, item_key, jitem);
-	}
+	if (reader->error_pos)
+		return;
+
+	va_start(args, format);
+	vsnprintf(reader->error, sizeof(reader->error), format, args);
+	va_end(args);
+
+	reader->error_pos = reader->pos;
 }
 
-static inline void obs_data_add_json_object(obs_data_t *data, const char *key, json_t *jobj)
+static inline void json_skip_whitespace(struct json_reader *reader)
 {
-	obs_data_t *sub_obj = obs_data_create();
+	const char *pos = reader->pos;
 
-	obs_data_add_json_object_data(sub_obj, jobj);
-	obs_data_set_obj(data, key, sub_obj);
-	obs_data_release(sub_obj);
+	while (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r')
+		pos++;
+
+	reader->pos = pos;
 }
 
-static void obs_data_add_json_array(obs_data_t *data, const char *key, json_t *jarray)
+/* returns the length of a valid UTF-8 sequence, or 0 if it is invalid */
+static size_t utf8_sequence_length(const uint8_t *str)
 {
-	obs_data_array_t *array = obs_data_array_create();
-	size_t idx;
-	json_t *jitem;
+	uint32_t code_point;
+	size_t length;
 
-	json_array_foreach (jarray, idx, jitem) {
-		obs_data_t *item;
+	if (str[0] < 0x80)
+		return 1;
+	else if (str[0] < 0xC2)
+		return 0;
+	else if (str[0] < 0xE0)
+		length = 2;
+	else if (str[0] < 0xF0)
+		length = 3;
+	else if (str[0] < 0xF5)
+		length = 4;
+	else
+		return 0;
 
-		if (!json_is_object(jitem))
-			continue;
+	code_point = str[0] & (0x3F >> (length - 1));
 
-		item = obs_data_create();
-		obs_data_add_json_object_data(item, jitem);
-		obs_data_array_push_back(array, item);
-		obs_data_release(item);
+	for (size_t i = 1; i < length; i++) {
+		if ((str[i] & 0xC0) != 0x80)
+			return 0;
+		code_point = (code_point << 6) | (str[i] & 0x3F);
 	}
 
-	obs_data_set_array(data, key, array);
-	obs_data_array_release(array);
+	if ((length == 3 && code_point < 0x800) || (length == 4 && code_point < 0x10000))
+		return 0;
+	if ((code_point >= 0xD800 && code_point <= 0xDFFF) || code_point > 0x10FFFF)
+		return 0;
+
+	return length;
 }
 
-static inline void obs_data_add_json_null(obs_data_t *data, const char *key)
+static bool utf8_is_valid(const char *str)
 {
-	obs_data_set_obj(data, key, NULL);
+	const uint8_t *pos = (const uint8_t *)str;
+
+	while (*pos) {
+		size_t length = utf8_sequence_length(pos);
+		if (!length)
+			return false;
+		pos += length;
+	}
+
+	return true;
 }
 
-static void obs_data_add_json_item(obs_data_t *data, const char *key, json_t *json)
+static void utf8_encode(struct darray *dst, uint32_t code_point)
 {
-	if (json_is_object(json))
-		obs_data_add_json_object(data, key, json);
-	else if (json_is_array(json))
-		obs_data_add_json_array(data, key, json);
-	else if (json_is_string(json))
-		obs_data_set_string(data, key, json_string_value(json));
-	else if (json_is_integer(json))
-		obs_data_set_int(data, key, json_integer_value(json));
-	else if (json_is_real(json))
-		obs_data_set_double(data, key, json_real_value(json));
-	else if (json_is_true(json))
-		obs_data_set_bool(data, key, true);
-	else if (json_is_false(json))
-		obs_data_set_bool(data, key, false);
-	else if (json_is_null(json))
-		obs_data_add_json_null(data, key);
+	uint8_t bytes[4];
+	size_t length;
+
+	if (code_point < 0x80) {
+		bytes[0] = (uint8_t)code_point;
+		length = 1;
+	} else if (code_point < 0x800) {
+		bytes[0] = (uint8_t)(0xC0 | (code_point >> 6));
+		bytes[1] = (uint8_t)(0x80 | (code_point & 0x3F));
+		length = 2;
+	} else if (code_point < 0x10000) {
+		bytes[0] = (uint8_t)(0xE0 | (code_point >> 12));
+		bytes[1] = (uint8_t)(0x80 | ((code_point >> 6) & 0x3F));
+		bytes[2] = (uint8_t)(0x80 | (code_point & 0x3F));
+		length = 3;
+	} else {
+		bytes[0] = (uint8_t)(0xF0 | (code_point >> 18));
+		bytes[1] = (uint8_t)(0x80 | ((code_point >> 12) & 0x3F));
+		bytes[2] = (uint8_t)(0x80 | ((code_point >> 6) & 0x3F));
+		bytes[3] = (uint8_t)(0x80 | (code_point & 0x3F));
+		length = 4;
+	}
+
+	darray_push_back_array(1, dst, bytes, length);
 }
 
-/* ------------------------------------------------------------------------- */
+static bool json_read_hex4(struct json_reader *reader, uint32_t *value)
+{
+	uint32_t result = 0;
+
+	for (size_t i = 0; i < 4; i++) {
+		char ch = reader->pos[i];
+		result <<= 4;
+
+		if (ch >= '0' && ch <= '9')
+			result |= (uint32_t)(ch - '0');
+		else if (ch >= 'a' && ch <= 'f')
+			result |= (uint32_t)(ch - 'a' + 10);
+		else if (ch >= 'A' && ch <= 'F')
+			result |= (uint32_t)(ch - 'A' + 10);
+		else {
+			json_reader_error(reader, "invalid escape");
+			return false;
+		}
+	}
 
-static inline void set_json_string(json_t *json, const char *name, obs_data_item_t *item)
+	reader->pos += 4;
+	*value = result;
+	return true;
+}
+
+static bool json_read_escape(struct json_reader *reader, struct darray *dst)
 {
-	const char *val = obs_data_item_get_string(item);
-	json_object_set_new(json, name, json_string(val));
+	uint32_t code_point;
+	char ch = *reader->pos++;
+
+	switch (ch) {
+	case '"':
+	case '\\':
+	case '/':
+		darray_push_back(1, dst, &ch);
+		return true;
+	case 'b':
+		ch = '\b';
+		break;
+	case 'f':
+		ch = '\f';
+		break;
+	case 'n':
+		ch = '\n';
+		break;
+	case 'r':
+		ch = '\r';
+		break;
+	case 't':
+		ch = '\t';
+		break;
+	case 'u':
+		if (!json_read_hex4(reader, &code_point))
+			return false;
+
+		if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+			uint32_t low_surrogate;
+
+			if (reader->pos[0] != '\\' || reader->pos[1] != 'u') {
+				json_reader_error(reader, "invalid Unicode '\\u%04X'", code_point);
+				return false;
+			}
+
+			reader->pos += 2;
+			if (!json_read_hex4(reader, &low_surrogate))
+				return false;
+
+			if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF) {
+				json_reader_error(reader, "invalid Unicode '\\u%04X\\u%04X'", code_point,
+						  low_surrogate);
+				return false;
+			}
+
+			code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+
+		} else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+			json_reader_error(reader, "invalid Unicode '\\u%04X'", code_point);
+			return false;
+
+		} else if (code_point == 0) {
+			json_reader_error(reader, "\\u0000 is not allowed");
+			return false;
+		}
+
+		utf8_encode(dst, code_point);
+		return true;
+	default:
+		reader->pos--;
+		json_reader_error(reader, "invalid escape");
+		return false;
+	}
+
+	darray_push_back(1, dst, &ch);
+	return true;
+}
+
+/* reads a string into dst, which is null terminated on success */
+static bool json_read_string(struct json_reader *reader, struct darray *dst)
+{
+	const char *pos = ++reader->pos;
+
+	dst->num = 0;
+
+	for (;;) {
+		const char *run = pos;
+		const uint8_t *upos;
+		size_t length;
+
+		while (*pos != '"' && *pos != '\\' && (uint8_t)*pos >= 0x20 && (uint8_t)*pos < 0x80)
+			pos++;
+
+		if (pos != run)
+			darray_push_back_array(1, dst, run, pos - run);
+
+		reader->pos = pos;
+		upos = (const uint8_t *)pos;
+
+		if (*pos == '"') {
+			char terminator = 0;
+			darray_push_back(1, dst, &terminator);
+			reader->pos++;
+			return true;
+
+		} else if (*pos == '\\') {
+			reader->pos++;
+			if (!json_read_escape(reader, dst))
+				return false;
+			pos = reader->pos;
+
+		} else if (!*pos) {
+			json_reader_error(reader, "premature end of input");
+			return false;
+
+		} else if (*upos < 0x20) {
+			json_reader_error(reader, "control character 0x%x", *upos);
+			return false;
+
+		} else {
+			length = utf8_sequence_length(upos);
+			if (!length) {
+				json_reader_error(reader, "unable to decode byte 0x%x", *upos);
+				return false;
+			}
+
+			darray_push_back_array(1, dst, pos, length);
+			pos += length;
+		}
+	}
+}
+
+static inline bool is_digit(char ch)
+{
+	return ch >= '0' && ch <= '9';
 }
 
-static inline void set_json_number(json_t *json, const char *name, obs_data_item_t *item)
+static bool json_read_number(struct json_reader *reader, struct obs_data_number *num)
 {
-	enum obs_data_number_type type = obs_data_item_numtype(item);
+	const char *start = reader->pos;
+	const char *pos = start;
+	bool is_real = false;
+	bool success = true;
+	char buffer[64];
+	char *number;
+	size_t length;
 
-	if (type == OBS_DATA_NUM_INT) {
-		long long val = obs_data_item_get_int(item);
-		json_object_set_new(json, name, json_integer(val));
+	if (*pos == '-')
+		pos++;
+
+	if (*pos == '0') {
+		pos++;
+		if (is_digit(*pos)) {
+			json_reader_error(reader, "invalid token");
+			return false;
+		}
+	} else if (is_digit(*pos)) {
+		while (is_digit(*pos))
+			pos++;
 	} else {
-		double val = obs_data_item_get_double(item);
-		json_object_set_new(json, name, json_real(val));
+		json_reader_error(reader, "invalid token");
+		return false;
+	}
+
+	if (*pos == '.') {
+		pos++;
+		if (!is_digit(*pos)) {
+			reader->pos = pos;
+			json_reader_error(reader, "invalid token");
+			return false;
+		}
+		while (is_digit(*pos))
+			pos++;
+		is_real = true;
 	}
+
+	if (*pos == 'e' || *pos == 'E') {
+		pos++;
+		if (*pos == '+' || *pos == '-')
+			pos++;
+		if (!is_digit(*pos)) {
+			reader->pos = pos;
+			json_reader_error(reader, "invalid token");
+			return false;
+		}
+		while (is_digit(*pos))
+			pos++;
+		is_real = true;
+	}
+
+	length = pos - start;
+	number = length < sizeof(buffer) ? buffer : bmalloc(length + 1);
+	memcpy(number, start, length);
+	number[length] = 0;
+
+	errno = 0;
+
+	if (!is_real) {
+		num->type = OBS_DATA_NUM_INT;
+		num->int_val = strtoll(number, NULL, 10);
+
+		if (errno == ERANGE) {
+			json_reader_error(reader, num->int_val < 0 ? "too big negative integer" : "too big integer");
+			success = false;
+		}
+	} else {
+		const char *decimal_point = localeconv()->decimal_point;
+		char *dot = strchr(number, '.');
+
+		/* strtod is locale dependent */
+		if (dot && decimal_point && *decimal_point)
+			*dot = *decimal_point;
+
+		num->type = OBS_DATA_NUM_DOUBLE;
+		num->double_val = strtod(number, NULL);
+
+		if (errno == ERANGE && num->double_val != 0.0) {
+			json_reader_error(reader, "real number overflow");
+			success = false;
+		}
+	}
+
+	if (number != buffer)
+		bfree(number);
+
+	reader->pos = pos;
+	return success;
 }
 
-static inline void set_json_bool(json_t *json, const char *name, obs_data_item_t *item)
+static inline bool json_read_literal(struct json_reader *reader, const char *literal, size_t length)
 {
-	bool val = obs_data_item_get_bool(item);
-	json_object_set_new(json, name, val ? json_true() : json_false());
+	if (strncmp(reader->pos, literal, length) != 0) {
+		json_reader_error(reader, "invalid token");
+		return false;
+	}
+
+	reader->pos += length;
+	return true;
 }
 
-static json_t *obs_data_to_json(obs_data_t *data, bool with_defaults);
+static bool json_read_value(struct json_reader *reader, obs_data_t *parent);
 
-static inline void set_json_obj(json_t *json, const char *name, obs_data_item_t *item, bool with_defaults)
+static bool json_add_item(struct json_reader *reader, obs_data_t *data, const void *ptr, size_t size,
+			  enum obs_data_type type)
 {
-	obs_data_t *obj = obs_data_item_get_obj(item);
-	json_object_set_new(json, name, obs_data_to_json(obj, with_defaults));
-	obs_data_release(obj);
+	const char *name = reader->key.array;
+	size_t name_len = reader->key.num - 1;
+	struct obs_data_item *item;
+
+	HASH_FIND(hh, data->items, name, name_len, item);
+	if (item) {
+		json_reader_error(reader, "duplicate object key");
+		return false;
+	}
+
+	item = obs_data_item_create(&reader->arena, name, ptr, size, type, false, false);
+	item->parent = data;
+	HASH_ADD_KEYPTR(hh, data->items, item->name, name_len, item);
+	return true;
 }
 
-static inline void set_json_array(json_t *json, const char *name, obs_data_item_t *item, bool with_defaults)
+static bool json_read_object(struct json_reader *reader, obs_data_t *data)
 {
-	json_t *jarray = json_array();
-	obs_data_array_t *array = obs_data_item_get_array(item);
-	size_t count = obs_data_array_count(array);
+	bool success = false;
 
-	for (size_t idx = 0; idx < count; idx++) {
-		obs_data_t *sub_item = obs_data_array_item(array, idx);
-		json_t *jitem = obs_data_to_json(sub_item, with_defaults);
-		json_array_append_new(jarray, jitem);
-		obs_data_release(sub_item);
+	if (++reader->depth > JSON_MAX_DEPTH) {
+		json_reader_error(reader, "maximum parsing depth reached");
+		return false;
 	}
 
-	json_object_set_new(json, name, jarray);
-	obs_data_array_release(array);
+	reader->pos++;
+	json_skip_whitespace(reader);
+
+	if (*reader->pos == '}') {
+		reader->pos++;
+		reader->depth--;
+		return true;
+	}
+
+	for (;;) {
+		if (*reader->pos != '"') {
+			json_reader_error(reader, "string or '}' expected");
+			goto fail;
+		}
+
+		if (!json_read_string(reader, &reader->key.da))
+			goto fail;
+		if (reader->key.num - 1 != strlen(reader->key.array)) {
+			json_reader_error(reader, "NUL byte in object key not supported");
+			goto fail;
+		}
+
+		json_skip_whitespace(reader);
+		if (*reader->pos != ':') {
+			json_reader_error(reader, "':' expected");
+			goto fail;
+		}
+
+		reader->pos++;
+		json_skip_whitespace(reader);
+
+		if (!json_read_value(reader, data))
+			goto fail;
+
+		json_skip_whitespace(reader);
+
+		if (*reader->pos == '}') {
+			reader->pos++;
+			break;
+		} else if (*reader->pos != ',') {
+			json_reader_error(reader, "'}' expected");
+			goto fail;
+		}
+
+		reader->pos++;
+		json_skip_whitespace(reader);
+	}
+
+	success = true;
+
+fail:
+	reader->depth--;
+	return success;
 }
 
-static json_t *obs_data_to_json(obs_data_t *data, bool with_defaults)
+static bool json_read_array(struct json_reader *reader, obs_data_array_t *array)
 {
-	if (!data)
-		return json_null();
+	bool success = false;
 
-	json_t *json = json_object();
+	if (++reader->depth > JSON_MAX_DEPTH) {
+		json_reader_error(reader, "maximum parsing depth reached");
+		return false;
+	}
 
-	obs_data_item_t *item = NULL;
-	obs_data_item_t *temp = NULL;
+	reader->pos++;
+	json_skip_whitespace(reader);
 
-	HASH_ITER (hh, data->items, item, temp) {
-		enum obs_data_type type = obs_data_item_gettype(item);
-		const char *name = get_item_name(item);
+	if (*reader->pos == ']') {
+		reader->pos++;
+		reader->depth--;
+		return true;
+	}
 
-		if (!with_defaults && !obs_data_item_has_user_value(item))
-			continue;
+	for (;;) {
+		if (*reader->pos == '{') {
+			obs_data_t *obj = obs_data_create_internal(&reader->arena);
+			bool read = json_read_object(reader, obj);
+
+			if (read && array)
+				obs_data_array_push_back(array, obj);
+			obs_data_release(obj);
+
+			if (!read)
+				goto fail;
+
+		} else if (!json_read_value(reader, NULL)) {
+			/* only objects are kept in arrays */
+			goto fail;
+		}
 
-		if (type == OBS_DATA_STRING)
-			set_json_string(json, name, item);
-		else if (type == OBS_DATA_NUMBER)
-			set_json_number(json, name, item);
-		else if (type == OBS_DATA_BOOLEAN)
-			set_json_bool(json, name, item);
-		else if (type == OBS_DATA_OBJECT)
-			set_json_obj(json, name, item, with_defaults);
-		else if (type == OBS_DATA_ARRAY)
-			set_json_array(json, name, item, with_defaults);
+		json_skip_whitespace(reader);
+
+		if (*reader->pos == ']') {
+			reader->pos++;
+			break;
+		} else if (*reader->pos != ',') {
+			json_reader_error(reader, "']' expected");
+			goto fail;
+		}
+
+		reader->pos++;
+		json_skip_whitespace(reader);
 	}
 
-	return json;
+	success = true;
+
+fail:
+	reader->depth--;
+	return success;
 }
 
-/* ------------------------------------------------------------------------- */
+/* reads a value, and adds it to parent (if any) under the current key */
+static bool json_read_value(struct json_reader *reader, obs_data_t *parent)
+{
+	struct obs_data_number num;
+	obs_data_t *null_obj = NULL;
+	bool boolean;
+	bool success;
 
-obs_data_t *obs_data_create()
+	switch (*reader->pos) {
+	case '{': {
+		obs_data_t *obj = obs_data_create_internal(parent ? &reader->arena : NULL);
+
+		success = (!parent || json_add_item(reader, parent, &obj, sizeof(obj), OBS_DATA_OBJECT)) &&
+			  json_read_object(reader, obj);
+
+		obs_data_release(obj);
+		return success;
+	}
+	case '[': {
+		obs_data_array_t *array = obs_data_array_create_internal(parent ? &reader->arena : NULL);
+
+		success = (!parent || json_add_item(reader, parent, &array, sizeof(array), OBS_DATA_ARRAY)) &&
+			  json_read_array(reader, parent ? array : NULL);
+
+		obs_data_array_release(array);
+		return success;
+	}
+	case '"':
+		if (!json_read_string(reader, &reader->str.da))
+			return false;
+		if (reader->str.num - 1 != strlen(reader->str.array)) {
+			json_reader_error(reader, "NUL byte in string not supported");
+			return false;
+		}
+		return !parent || json_add_item(reader, parent, reader->str.array, reader->str.num, OBS_DATA_STRING);
+	case 't':
+	case 'f':
+		boolean = *reader->pos == 't';
+		if (!json_read_literal(reader, boolean ? "true" : "false", boolean ? 4 : 5))
+			return false;
+		return !parent || json_add_item(reader, parent, &boolean, sizeof(bool), OBS_DATA_BOOLEAN);
+	case 'n':
+		if (!json_read_literal(reader, "null", 4))
+			return false;
+		return !parent || json_add_item(reader, parent, &null_obj, sizeof(obs_data_t *), OBS_DATA_OBJECT);
+	default:
+		if (!json_read_number(reader, &num))
+			return false;
+		return !parent || json_add_item(reader, parent, &num, sizeof(num), OBS_DATA_NUMBER);
+	}
+}
+
+static int json_reader_error_line(struct json_reader *reader)
 {
-	struct obs_data *data = bzalloc(sizeof(struct obs_data));
-	data->ref = 1;
+	int line = 1;
 
-	return data;
+	for (const char *pos = reader->start; pos < reader->error_pos; pos++) {
+		if (*pos == '\n')
+			line++;
+	}
+
+	return line;
 }
 
-obs_data_t *obs_data_create_from_json(const char *json_string)
+static obs_data_t *obs_data_create_from_json_internal(const char *json_string)
 {
-	obs_data_t *data = obs_data_create();
+	struct json_reader reader = {0};
+	obs_data_t *data = NULL;
+	bool success = false;
 
-	json_error_t error;
-	json_t *root = json_loads(json_string, JSON_REJECT_DUPLICATES, &error);
+	if (!json_string) {
+		blog(LOG_ERROR, "obs-data.c: [obs_data_create_from_json] "
+				"Failed reading json string: no string provided");
+		return NULL;
+	}
+
+	reader.start = json_string;
+	reader.pos = json_string;
+
+	data = obs_data_create_internal(&reader.arena);
+
+	json_skip_whitespace(&reader);
+
+	if (*reader.pos == '{') {
+		success = json_read_object(&reader, data);
+
+	} else if (*reader.pos == '[') {
+		/* arrays are valid roots, but have no keys to add to the object */
+		success = json_read_array(&reader, NULL);
 
-	if (root) {
-		obs_data_add_json_object_data(data, root);
-		json_decref(root);
 	} else {
+		json_reader_error(&reader, "'[' or '{' expected");
+	}
+
+	if (success) {
+		json_skip_whitespace(&reader);
+
+		if (*reader.pos) {
+			json_reader_error(&reader, "end of file expected");
+			success = false;
+		}
+	}
+
+	obs_data_arena_free(&reader.arena);
+	da_free(reader.key);
+	da_free(reader.str);
+
+	if (!success) {
 		blog(LOG_ERROR,
 		     "obs-data.c: [obs_data_create_from_json] "
 		     "Failed reading json string (%d): %s",
-		     error.line, error.text);
+		     json_reader_error_line(&reader), reader.error);
 		obs_data_release(data);
 		data = NULL;
 	}
@@ -625,6 +1194,278 @@ obs_data_t *obs_data_create_from_json(const char *json_string)
 	return data;
 }
 
+/* ------------------------------------------------------------------------- */
+/* JSON writer, output matches what jansson produced for JSON_PRESERVE_ORDER
+ * with either JSON_COMPACT or JSON_INDENT(4) */
+
+#define JSON_INDENT_SPACES 4
+
+struct json_writer {
+	struct dstr out;
+	bool pretty;
+	bool with_defaults;
+};
+
+static inline void json_write_indent(struct json_writer *writer, size_t depth)
+{
+	if (!writer->pretty)
+		return;
+
+	dstr_cat_ch(&writer->out, '\n');
+	for (size_t i = 0; i < depth * JSON_INDENT_SPACES; i++)
+		dstr_cat_ch(&writer->out, ' ');
+}
+
+static void json_write_string(struct json_writer *writer, const char *str)
+{
+	const char *run = str;
+	const char *pos = str;
+
+	dstr_cat_ch(&writer->out, '"');
+
+	for (; *pos; pos++) {
+		uint8_t ch = (uint8_t)*pos;
+		char escape[8];
+
+		if (ch >= 0x20 && ch != '"' && ch != '\\')
+			continue;
+
+		if (pos != run)
+			dstr_ncat(&writer->out, run, pos - run);
+
+		switch (ch) {
+		case '"':
+			dstr_ncat(&writer->out, "\\\"", 2);
+			break;
+		case '\\':
+			dstr_ncat(&writer->out, "\\\\", 2);
+			break;
+		case '\b':
+			dstr_ncat(&writer->out, "\\b", 2);
+			break;
+		case '\f':
+			dstr_ncat(&writer->out, "\\f", 2);
+			break;
+		case '\n':
+			dstr_ncat(&writer->out, "\\n", 2);
+			break;
+		case '\r':
+			dstr_ncat(&writer->out, "\\r", 2);
+			break;
+		case '\t':
+			dstr_ncat(&writer->out, "\\t", 2);
+			break;
+		default:
+			snprintf(escape, sizeof(escape), "\\u%04X", ch);
+			dstr_cat(&writer->out, escape);
+			break;
+		}
+
+		run = pos + 1;
+	}
+
+	if (pos != run)
+		dstr_ncat(&writer->out, run, pos - run);
+
+	dstr_cat_ch(&writer->out, '"');
+}
+
+static void json_write_real(struct json_writer *writer, double val)
+{
+	char buffer[64];
+	char *exponent;
+	int length = snprintf(buffer, sizeof(buffer), "%.17g", val);
+
+	if (length < 0 || (size_t)length >= sizeof(buffer) - 3)
+		return;
+
+	/* snprintf is locale dependent */
+	for (char *pos = buffer; *pos; pos++) {
+		if (!is_digit(*pos) && *pos != '-' && *pos != '+' && *pos != 'e')
+			*pos = '.';
+	}
+
+	/* make sure the value is read back as a real */
+	if (!strchr(buffer, '.') && !strchr(buffer, 'e')) {
+		buffer[length++] = '.';
+		buffer[length++] = '0';
+		buffer[length] = 0;
+	}
+
+	/* remove '+' and leading zeros from the exponent */
+	exponent = strchr(buffer, 'e');
+	if (exponent) {
+		char *start = exponent + 1;
+		char *end = start + 1;
+
+		if (*start == '-')
+			start++;
+		while (*end == '0')
+			end++;
+
+		if (end != start) {
+			memmove(start, end, length - (end - buffer) + 1);
+			length -= (int)(end - start);
+		}
+	}
+
+	dstr_ncat(&writer->out, buffer, length);
+}
+
+static bool json_item_is_writable(obs_data_item_t *item)
+{
+	if (!utf8_is_valid(get_item_name(item)))
+		return false;
+
+	switch (obs_data_item_gettype(item)) {
+	case OBS_DATA_STRING:
+		return utf8_is_valid(obs_data_item_get_string(item));
+	case OBS_DATA_NUMBER:
+		if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT)
+			return true;
+		return isfinite(obs_data_item_get_double(item));
+	case OBS_DATA_BOOLEAN:
+	case OBS_DATA_OBJECT:
+	case OBS_DATA_ARRAY:
+		return true;
+	case OBS_DATA_NULL:
+		break;
+	}
+
+	return false;
+}
+
+static void json_write_object(struct json_writer *writer, obs_data_t *data, size_t depth);
+
+static void json_write_array(struct json_writer *writer, obs_data_array_t *array, size_t depth)
+{
+	size_t count = obs_data_array_count(array);
+
+	if (!count) {
+		dstr_ncat(&writer->out, "[]", 2);
+		return;
+	}
+
+	dstr_cat_ch(&writer->out, '[');
+	json_write_indent(writer, depth + 1);
+
+	for (size_t idx = 0; idx < count; idx++) {
+		if (idx) {
+			dstr_cat_ch(&writer->out, ',');
+			json_write_indent(writer, depth + 1);
+		}
+
+		json_write_object(writer, array->objects.array[idx], depth + 1);
+	}
+
+	json_write_indent(writer, depth);
+	dstr_cat_ch(&writer->out, ']');
+}
+
+static void json_write_item_value(struct json_writer *writer, obs_data_item_t *item, size_t depth)
+{
+	char buffer[32];
+
+	switch (obs_data_item_gettype(item)) {
+	case OBS_DATA_STRING:
+		json_write_string(writer, obs_data_item_get_string(item));
+		break;
+	case OBS_DATA_NUMBER:
+		if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT) {
+			snprintf(buffer, sizeof(buffer), "%lld", obs_data_item_get_int(item));
+			dstr_cat(&writer->out, buffer);
+		} else {
+			json_write_real(writer, obs_data_item_get_double(item));
+		}
+		break;
+	case OBS_DATA_BOOLEAN:
+		if (obs_data_item_get_bool(item))
+			dstr_ncat(&writer->out, "true", 4);
+		else
+			dstr_ncat(&writer->out, "false", 5);
+		break;
+	case OBS_DATA_OBJECT: {
+		obs_data_t *obj = obs_data_item_get_obj(item);
+		json_write_object(writer, obj, depth);
+		obs_data_release(obj);
+		break;
+	}
+	case OBS_DATA_ARRAY: {
+		obs_data_array_t *array = obs_data_item_get_array(item);
+		json_write_array(writer, array, depth);
+		obs_data_array_release(array);
+		break;
+	}
+	case OBS_DATA_NULL:
+		break;
+	}
+}
+
+static void json_write_object(struct json_writer *writer, obs_data_t *data, size_t depth)
+{
+	obs_data_item_t *item = NULL;
+	obs_data_item_t *temp = NULL;
+	bool empty = true;
+
+	if (!data) {
+		dstr_ncat(&writer->out, "null", 4);
+		return;
+	}
+
+	HASH_ITER (hh, data->items, item, temp) {
+		if (!writer->with_defaults && !obs_data_item_has_user_value(item))
+			continue;
+		if (!json_item_is_writable(item))
+			continue;
+
+		if (empty) {
+			dstr_cat_ch(&writer->out, '{');
+			empty = false;
+		} else {
+			dstr_cat_ch(&writer->out, ',');
+		}
+
+		json_write_indent(writer, depth + 1);
+		json_write_string(writer, get_item_name(item));
+
+		if (writer->pretty)
+			dstr_ncat(&writer->out, ": ", 2);
+		else
+			dstr_cat_ch(&writer->out, ':');
+
+		json_write_item_value(writer, item, depth + 1);
+	}
+
+	if (empty) {
+		dstr_ncat(&writer->out, "{}", 2);
+	} else {
+		json_write_indent(writer, depth);
+		dstr_cat_ch(&writer->out, '}');
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+static obs_data_t *obs_data_create_internal(struct obs_data_arena *arena)
+{
+	struct obs_data_arena_block *block;
+	struct obs_data *data = obs_data_zalloc(arena, sizeof(struct obs_data), &block);
+	data->block = block;
+	data->ref = 1;
+
+	return data;
+}
+
+obs_data_t *obs_data_create()
+{
+	return obs_data_create_internal(NULL);
+}
+
+obs_data_t *obs_data_create_from_json(const char *json_string)
+{
+	return obs_data_create_from_json_internal(json_string);
+}
+
 obs_data_t *obs_data_create_from_json_file(const char *json_file)
 {
 	char *file_data = os_quick_read_utf8_file(json_file);
@@ -682,9 +1523,8 @@ static inline void obs_data_destroy(struct obs_data *data)
 		obs_data_item_release(&item);
 	}
 
-	/* NOTE: don't use bfree for json text, allocated by json */
-	free(data->json);
-	bfree(data);
+	bfree(data->json);
+	obs_data_free_mem(data, data->block);
 }
 
 void obs_data_release(obs_data_t *data)
@@ -701,20 +1541,14 @@ static const char *obs_data_get_json_internal(obs_data_t *data, bool pretty, boo
 	if (!data)
 		return NULL;
 
-	size_t flags = JSON_PRESERVE_ORDER;
-
-	if (pretty)
-		flags |= JSON_INDENT(4);
-	else
-		flags |= JSON_COMPACT;
+	struct json_writer writer = {0};
+	writer.pretty = pretty;
+	writer.with_defaults = with_defaults;
 
-	/* NOTE: don't use libobs bfree for json text */
-	free(data->json);
-	data->json = NULL;
+	json_write_object(&writer, data, 0);
 
-	json_t *root = obs_data_to_json(data, with_defaults);
-	data->json = json_dumps(root, flags);
-	json_decref(root);
+	bfree(data->json);
+	data->json = writer.out.array;
 
 	return data->json;
 }
@@ -878,7 +1712,7 @@ static void set_item_data(struct obs_data *data, struct obs_data_item **item, co
 	obs_data_item_t *new_item = NULL;
 
 	if ((!item || !*item) && data) {
-		new_item = obs_data_item_create(name, ptr, size, type, default_data, autoselect_data);
+		new_item = obs_data_item_create(NULL, name, ptr, size, type, default_data, autoselect_data);
 		new_item->parent = data;
 		HASH_ADD_STR(data->items, name, new_item);
 
@@ -1292,14 +2126,21 @@ obs_data_array_t *obs_data_get_autoselect_array(obs_data_t *data, const char *na
 	return obs_data_item_get_autoselect_array(get_item(data, name));
 }
 
-obs_data_array_t *obs_data_array_create()
+static obs_data_array_t *obs_data_array_create_internal(struct obs_data_arena *arena)
 {
-	struct obs_data_array *array = bzalloc(sizeof(struct obs_data_array));
+	struct obs_data_arena_block *block;
+	struct obs_data_array *array = obs_data_zalloc(arena, sizeof(struct obs_data_array), &block);
+	array->block = block;
 	array->ref = 1;
 
 	return array;
 }
 
+obs_data_array_t *obs_data_array_create()
+{
+	return obs_data_array_create_internal(NULL);
+}
+
 void obs_data_array_addref(obs_data_array_t *array)
 {
 	if (array)
@@ -1312,7 +2153,7 @@ static inline void obs_data_array_destroy(obs_data_array_t *array)
 		for (size_t i = 0; i < array->objects.num; i++)
 			obs_data_release(array->objects.array[i]);
 		da_free(array->objects);
-		bfree(array);
+		obs_data_free_mem(array, array->block);
 	}
 }
 
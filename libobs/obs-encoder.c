@@ -26,7 +26,7 @@
 
 static void encoder_set_video(obs_encoder_t *encoder, video_t *video);
 
-struct obs_encoder_info *find_encoder(const char *id)
+static struct obs_encoder_info *find_encoder_type(const char *id)
 {
 	for (size_t i = 0; i < obs->encoder_types.num; i++) {
 		struct obs_encoder_info *info = obs->encoder_types.array + i;
@@ -38,6 +38,23 @@ struct obs_encoder_info *find_encoder(const char *id)
 	return NULL;
 }
 
+struct obs_encoder_info *find_encoder(const char *id)
+{
+	struct obs_encoder_info *info;
+
+	obs_lock_module_types();
+	info = find_encoder_type(id);
+	obs_unlock_module_types();
+
+	if (!info && obs_load_deferred_module(OBS_MODULE_TYPE_ENCODER, id)) {
+		obs_lock_module_types();
+		info = find_encoder_type(id);
+		obs_unlock_module_types();
+	}
+
+	return info;
+}
+
 const char *obs_encoder_get_display_name(const char *id)
 {
 	struct obs_encoder_info *ei = find_encoder(id);
@@ -36,6 +36,8 @@
 #include "media-io/audio-resampler.h"
 #include "media-io/video-io.h"
 #include "media-io/audio-io.h"
+#include "media-io/video-slice-pool.h"
+#include "media-io/audio-headroom.h"
 
 #include "obs.h"
 
@@ -46,7 +48,9 @@
 #define HASH_FIND_UUID(head, uuid, out) HASH_FIND(hh_uuid, head, uuid, UUID_STR_LENGTH, out)
 #define HASH_ADD_UUID(head, uuid_field, add) HASH_ADD(hh_uuid, head, uuid_field[0], UUID_STR_LENGTH, add)
 
-#define NUM_TEXTURES 2
+/* raw video readback ring: NUM_TEXTURES is the deepest it can be configured */
+#define NUM_TEXTURES 4
+#define DEFAULT_READBACK_DEPTH 2
 #define NUM_CHANNELS 3
 #define MICROSECOND_DEN 1000000
 #define NUM_ENCODE_TEXTURES 10
@@ -126,6 +130,7 @@ struct obs_module {
 	const char *(*name)(void);
 	const char *(*description)(void);
 	const char *(*author)(void);
+	bool (*thread_safe_load)(void);
 
 	struct obs_module_metadata *metadata;
 
@@ -151,7 +156,17 @@ struct obs_disabled_module {
 	DARRAY(char *) services;
 };
 
+enum obs_module_type {
+	OBS_MODULE_TYPE_SOURCE,
+	OBS_MODULE_TYPE_OUTPUT,
+	OBS_MODULE_TYPE_ENCODER,
+	OBS_MODULE_TYPE_SERVICE,
+};
+
 extern void free_module(struct obs_module *mod);
+/* returns true if the type should be looked up again */
+extern bool obs_load_deferred_module(enum obs_module_type type, const char *id);
+extern void obs_free_deferred_modules(void);
 
 struct obs_module_path {
 	char *bin;
@@ -351,6 +366,24 @@ struct obs_core_video_mix {
 	struct deque vframe_info_buffer_gpu;
 	gs_stagesurf_t *mapped_surfaces[NUM_CHANNELS];
 	int cur_texture;
+	int readback_depth;
+	uint64_t staged_ts[NUM_TEXTURES];
+
+	/* copies mapped frames into the video output while the graphics
+	 * thread moves on to the next frame */
+	pthread_t readback_thread;
+	bool readback_thread_initialized;
+	os_sem_t *readback_sem;
+	os_event_t *readback_idle;
+	volatile bool readback_stop;
+	struct video_data readback_frame;
+	int readback_count;
+	uint64_t readback_staged_ts;
+
+	/* time from staging a frame to it reaching the video output */
+	uint64_t readback_latency_total;
+	uint64_t readback_latency_max;
+	uint32_t readback_frames;
 	volatile long raw_active;
 	volatile long gpu_encoder_active;
 	bool gpu_was_active;
@@ -380,12 +413,29 @@ struct obs_core_video_mix {
 	bool encoder_only_mix;
 	long encoder_refs;
 
+	/* secondary canvases render every frame_divisor-th tick of the main
+	 * canvas, and not at all while no output or display uses them */
+	uint32_t frame_divisor;
+	uint32_t divisor_ticks;
+	bool frame_due;
+	bool texture_fresh;
+	volatile bool texture_used;
+	uint64_t avg_render_ns;
+
 	bool mix_audio;
 };
 
 extern struct obs_core_video_mix *obs_create_video_mix(struct obs_video_info *ovi);
 extern void obs_free_video_mix(struct obs_core_video_mix *video);
 
+extern void output_video_data(struct obs_core_video_mix *video, const struct video_data *input_frame, int count);
+
+extern bool init_video_readback(struct obs_core_video_mix *video);
+extern void stop_video_readback(struct obs_core_video_mix *video);
+extern void wait_video_readback(struct obs_core_video_mix *video);
+extern void queue_video_readback(struct obs_core_video_mix *video, const struct video_data *frame, int count,
+				 uint64_t staged_ts);
+
 struct obs_core_video {
 	graphics_t *graphics;
 	gs_effect_t *default_effect;
@@ -409,8 +459,17 @@ struct obs_core_video {
 	pthread_t video_thread;
 	uint32_t total_frames;
 	uint32_t lagged_frames;
+	uint32_t canvas_frames_rendered;
+	uint32_t canvas_frames_skipped;
+	uint64_t canvas_render_ns_saved;
 	bool thread_initialized;
 
+	/* splits CPU copies of large output frames across threads */
+	video_slice_pool_t *slice_pool;
+
+	/* applied to mixes when they are (re)created, 0 for the default */
+	uint32_t readback_depth;
+
 	gs_texture_t *transparent_texture;
 
 	gs_effect_t *deinterlace_discard_effect;
@@ -439,6 +498,10 @@ extern void add_ready_encoder_group(obs_encoder_t *encoder);
 
 struct audio_monitor;
 
+#define AUDIO_BUFFERING_HISTORY 64
+#define DEFAULT_MONITORING_LATENCY_MS 40
+#define MIN_MONITORING_LATENCY_MS 20
+
 struct obs_core_audio {
 	audio_t *audio;
 
@@ -452,10 +515,21 @@ struct obs_core_audio {
 	int max_buffering_ticks;
 	bool fixed_buffer;
 
+	bool adaptive_buffer;
+	struct audio_headroom headroom;
+
+	pthread_mutex_t buffering_mutex;
+	uint32_t buffering_ms;
+	struct obs_audio_buffering_change buffering_history[AUDIO_BUFFERING_HISTORY];
+	size_t buffering_history_pos;
+	size_t buffering_history_count;
+
 	pthread_mutex_t monitoring_mutex;
 	DARRAY(struct audio_monitor *) monitors;
 	char *monitoring_device_name;
 	char *monitoring_device_id;
+	bool monitoring_mixer;
+	uint32_t monitoring_latency_ms;
 
 	pthread_mutex_t task_mutex;
 	struct deque tasks;
@@ -545,6 +619,14 @@ struct obs_core {
 	struct obs_module *first_module;
 	struct obs_module *first_disabled_module;
 
+	/* modules found in the module cache that are only loaded once one of
+	 * their types is first used, see obs_set_lazy_module_loading */
+	struct obs_module *first_deferred_module;
+	pthread_mutex_t deferred_load_mutex;
+	pthread_mutex_t module_mutex;
+	bool lazy_module_loading;
+	bool modules_post_loaded;
+
 	DARRAY(struct obs_module_path) module_paths;
 	DARRAY(char *) safe_modules;
 	DARRAY(char *) disabled_modules;
@@ -580,6 +662,20 @@ struct obs_core {
 
 extern struct obs_core *obs;
 
+/* registered types can only change after startup if modules are loaded
+ * lazily, in which case lookups need to be serialized with the loading */
+static inline void obs_lock_module_types(void)
+{
+	if (obs->lazy_module_loading)
+		pthread_mutex_lock(&obs->module_mutex);
+}
+
+static inline void obs_unlock_module_types(void)
+{
+	if (obs->lazy_module_loading)
+		pthread_mutex_unlock(&obs->module_mutex);
+}
+
 struct obs_graphics_context {
 	uint64_t last_time;
 	uint64_t interval;
@@ -999,6 +1095,13 @@ struct obs_source {
 	/* private data */
 	obs_data_t *private_settings;
 
+	/* immutable copy of the settings used by obs_save_source_snapshot,
+	 * reused for as long as settings_generation does not change */
+	pthread_mutex_t settings_snapshot_mutex;
+	obs_data_t *settings_snapshot;
+	long settings_snapshot_generation;
+	volatile long settings_generation;
+
 	/* canvas this source belongs to (only used for scenes) */
 	obs_weak_canvas_t *canvas;
 };
@@ -1007,6 +1110,8 @@ extern struct obs_source_info *get_source_info(const char *id);
 extern struct obs_source_info *get_source_info2(const char *unversioned_id, uint32_t ver);
 extern bool obs_source_init_context(struct obs_source *source, obs_data_t *settings, const char *name, const char *uuid,
 				    obs_data_t *hotkey_data, bool private);
+extern void obs_source_settings_changed(obs_source_t *source);
+extern obs_data_t *obs_source_get_settings_snapshot(obs_source_t *source);
 
 extern bool obs_transition_init(obs_source_t *transition);
 extern void obs_transition_free(obs_source_t *transition);
@@ -1021,9 +1126,9 @@ extern void audio_monitor_destroy(struct audio_monitor *monitor);
 
 extern obs_source_t *obs_source_create_canvas(obs_canvas_t *canvas, const char *id, const char *name,
 					      obs_data_t *settings, obs_data_t *hotkey_data);
-extern obs_source_t *obs_source_create_set_last_ver(obs_canvas_t *canvas, const char *id, const char *name,
-						    const char *uuid, obs_data_t *settings, obs_data_t *hotkey_data,
-						    uint32_t last_obs_ver, bool is_private);
+extern obs_source_t *obs_source_construct(const char *id, const char *name, const char *uuid, obs_data_t *settings,
+					  obs_data_t *hotkey_data, bool private, uint32_t last_obs_ver);
+extern void obs_source_publish(obs_source_t *source, obs_canvas_t *canvas);
 
 extern void obs_source_destroy(struct obs_source *source);
 extern void obs_source_addref(obs_source_t *source);
@@ -17,6 +17,9 @@
 
 #include "util/platform.h"
 #include "util/dstr.h"
+#include "util/threading.h"
+
+#include <sys/stat.h>
 
 #include "obs-defs.h"
 #include "obs-internal.h"
@@ -24,7 +27,10 @@
 
 extern const char *get_module_extension(void);
 
-obs_module_t *loadingModule = NULL;
+/* thread local, as modules that declare a thread-safe load are loaded in
+ * parallel */
+static THREAD_LOCAL obs_module_t *loadingModule = NULL;
+static THREAD_LOCAL bool registeringType = false;
 
 static inline int req_func_not_found(const char *name, const char *path)
 {
@@ -58,6 +64,7 @@ static int load_module_exports(struct obs_module *mod, const char *path)
 	mod->description = os_dlsym(mod->module, "obs_module_description");
 	mod->author = os_dlsym(mod->module, "obs_module_author");
 	mod->get_string = os_dlsym(mod->module, "obs_module_get_string");
+	mod->thread_safe_load = os_dlsym(mod->module, "obs_module_thread_safe_load");
 	return MODULE_SUCCESS;
 }
 
@@ -157,7 +164,13 @@ int obs_open_module(obs_module_t **module, const char *path, const char *data_pa
 
 	blog(LOG_DEBUG, "---------------------------------");
 
+	const char *file = strrchr(path, '/');
+	const char *profile_name =
+		profile_store_name(obs_get_profiler_name_store(), "obs_open_module(%s)", file ? file + 1 : path);
+	profile_start(profile_name);
 	mod.module = os_dlopen(path);
+	profile_end(profile_name);
+
 	if (!mod.module) {
 		blog(LOG_WARNING, "Module '%s' not loaded", path);
 		return MODULE_FAILED_TO_OPEN;
@@ -490,38 +503,453 @@ bool obs_get_module_allow_disable(const char *name)
 	return !is_core_module(name);
 }
 
+/* ------------------------------------------------------------------------- */
+/* Module cache
+ *
+ * Remembers which types each module registered the last time it was loaded,
+ * keyed by the path of the module binary and validated against its
+ * modification time and size.  Known modules skip the plugin check, and with
+ * lazy module loading enabled they are not loaded until one of their types is
+ * actually used. */
+
+#define MODULE_CACHE_FILE "obs-module-cache.json"
+#define MODULE_CACHE_VERSION 1
+
+struct module_load_context {
+	struct fail_info *fail_info;
+	obs_data_t *cache;
+	obs_data_array_t *cache_modules;
+	obs_data_array_t *deferred_entries;
+	DARRAY(obs_module_t *) parallel_modules;
+};
+
+static char *get_module_cache_path(void)
+{
+	struct dstr path = {0};
+
+	if (!obs->module_config_path)
+		return NULL;
+
+	dstr_copy(&path, obs->module_config_path);
+	if (!dstr_is_empty(&path) && dstr_end(&path) != '/')
+		dstr_cat_ch(&path, '/');
+	dstr_cat(&path, MODULE_CACHE_FILE);
+	return path.array;
+}
+
+static bool get_module_file_info(const char *path, long long *mtime, long long *size)
+{
+	struct stat st;
+
+	if (os_stat(path, &st) != 0)
+		return false;
+
+	*mtime = (long long)st.st_mtime;
+	*size = (long long)st.st_size;
+	return true;
+}
+
+static void load_module_cache(struct module_load_context *ctx)
+{
+	char *path = get_module_cache_path();
+
+	if (path && os_file_exists(path)) {
+		ctx->cache = obs_data_create_from_json_file_safe(path, "bak");
+
+		if (obs_data_get_int(ctx->cache, "version") == MODULE_CACHE_VERSION) {
+			ctx->cache_modules = obs_data_get_array(ctx->cache, "modules");
+		} else {
+			obs_data_release(ctx->cache);
+			ctx->cache = NULL;
+		}
+	}
+
+	ctx->deferred_entries = obs_data_array_create();
+	bfree(path);
+}
+
+static obs_data_t *find_module_cache_entry(struct module_load_context *ctx, const char *bin_path)
+{
+	long long mtime, size;
+	size_t count = obs_data_array_count(ctx->cache_modules);
+
+	if (!count || !get_module_file_info(bin_path, &mtime, &size))
+		return NULL;
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *entry = obs_data_array_item(ctx->cache_modules, i);
+
+		if (strcmp(obs_data_get_string(entry, "bin_path"), bin_path) == 0 &&
+		    obs_data_get_int(entry, "mtime") == mtime && obs_data_get_int(entry, "size") == size)
+			return entry;
+
+		obs_data_release(entry);
+	}
+
+	return NULL;
+}
+
+static void join_type_ids(struct dstr *str, const char **ids, size_t num)
+{
+	dstr_free(str);
+
+	for (size_t i = 0; i < num; i++) {
+		if (i)
+			dstr_cat_ch(str, ';');
+		dstr_cat(str, ids[i]);
+	}
+}
+
+static void add_module_cache_entry(obs_data_array_t *modules, struct obs_module *mod)
+{
+	struct dstr ids = {0};
+	long long mtime, size;
+
+	if (!mod->bin_path || !get_module_file_info(mod->bin_path, &mtime, &size))
+		return;
+
+	obs_data_t *entry = obs_data_create();
+	obs_data_set_string(entry, "bin_path", mod->bin_path);
+	obs_data_set_int(entry, "mtime", mtime);
+	obs_data_set_int(entry, "size", size);
+
+	join_type_ids(&ids, (const char **)mod->sources.array, mod->sources.num);
+	obs_data_set_string(entry, "sources", ids.array ? ids.array : "");
+	join_type_ids(&ids, (const char **)mod->outputs.array, mod->outputs.num);
+	obs_data_set_string(entry, "outputs", ids.array ? ids.array : "");
+	join_type_ids(&ids, (const char **)mod->encoders.array, mod->encoders.num);
+	obs_data_set_string(entry, "encoders", ids.array ? ids.array : "");
+	join_type_ids(&ids, (const char **)mod->services.array, mod->services.num);
+	obs_data_set_string(entry, "services", ids.array ? ids.array : "");
+
+	obs_data_array_push_back(modules, entry);
+	obs_data_release(entry);
+	dstr_free(&ids);
+}
+
+static void save_module_cache(struct module_load_context *ctx)
+{
+	char *path = get_module_cache_path();
+	if (!path)
+		return;
+
+	obs_data_t *cache = obs_data_create();
+	obs_data_array_t *modules = obs_data_array_create();
+
+	for (struct obs_module *mod = obs->first_module; !!mod; mod = mod->next)
+		add_module_cache_entry(modules, mod);
+	obs_data_array_push_back_array(modules, ctx->deferred_entries);
+
+	obs_data_set_int(cache, "version", MODULE_CACHE_VERSION);
+	obs_data_set_array(cache, "modules", modules);
+
+	if (!obs_data_save_json_safe(cache, path, "tmp", "bak"))
+		blog(LOG_WARNING, "Failed to save module cache to '%s'", path);
+
+	obs_data_array_release(modules);
+	obs_data_release(cache);
+	bfree(path);
+}
+
+static void free_module_load_context(struct module_load_context *ctx)
+{
+	obs_data_array_release(ctx->deferred_entries);
+	obs_data_array_release(ctx->cache_modules);
+	obs_data_release(ctx->cache);
+	da_free(ctx->parallel_modules);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Deferred modules */
+
+static void add_cached_type_ids(obs_data_t *entry, const char *name, struct darray *ids)
+{
+	char **list = strlist_split(obs_data_get_string(entry, name), ';', false);
+
+	for (char **id = list; *id; id++) {
+		char *id_copy = bstrdup(*id);
+		darray_push_back(sizeof(char *), ids, &id_copy);
+	}
+
+	strlist_free(list);
+}
+
+static bool defer_module(const struct obs_module_info2 *info, obs_data_t *entry)
+{
+	struct obs_module *mod = bzalloc(sizeof(struct obs_module));
+
+	add_cached_type_ids(entry, "sources", &mod->sources.da);
+	add_cached_type_ids(entry, "outputs", &mod->outputs.da);
+	add_cached_type_ids(entry, "encoders", &mod->encoders.da);
+	add_cached_type_ids(entry, "services", &mod->services.da);
+
+	/* modules that did not register any types do something else in their
+	 * load function, so they always have to be loaded */
+	if (!mod->sources.num && !mod->outputs.num && !mod->encoders.num && !mod->services.num) {
+		bfree(mod);
+		return false;
+	}
+
+	mod->bin_path = bstrdup(info->bin_path);
+	mod->file = strrchr(mod->bin_path, '/');
+	mod->file = (!mod->file) ? mod->bin_path : (mod->file + 1);
+	mod->mod_name = get_module_name(mod->file);
+	mod->data_path = bstrdup(info->data_path);
+	mod->load_state = OBS_MODULE_ENABLED;
+	mod->next = obs->first_deferred_module;
+	obs->first_deferred_module = mod;
+
+	blog(LOG_DEBUG, "Deferring load of module '%s'", mod->file);
+	return true;
+}
+
+static bool module_has_type(struct obs_module *mod, enum obs_module_type type, const char *id)
+{
+	char **ids = NULL;
+	size_t num = 0;
+
+	switch (type) {
+	case OBS_MODULE_TYPE_SOURCE:
+		ids = mod->sources.array;
+		num = mod->sources.num;
+		break;
+	case OBS_MODULE_TYPE_OUTPUT:
+		ids = mod->outputs.array;
+		num = mod->outputs.num;
+		break;
+	case OBS_MODULE_TYPE_ENCODER:
+		ids = mod->encoders.array;
+		num = mod->encoders.num;
+		break;
+	case OBS_MODULE_TYPE_SERVICE:
+		ids = mod->services.array;
+		num = mod->services.num;
+		break;
+	}
+
+	for (size_t i = 0; i < num; i++) {
+		if (strcmp(ids[i], id) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/* registering types of a deferred module must never move the existing type
+ * arrays, as lookups hand out pointers into them */
+static void reserve_deferred_types(void)
+{
+	size_t sources = 0, outputs = 0, encoders = 0, services = 0;
+
+	for (struct obs_module *mod = obs->first_deferred_module; !!mod; mod = mod->next) {
+		sources += mod->sources.num;
+		outputs += mod->outputs.num;
+		encoders += mod->encoders.num;
+		services += mod->services.num;
+	}
+
+	da_reserve(obs->source_types, obs->source_types.num + sources);
+	da_reserve(obs->input_types, obs->input_types.num + sources);
+	da_reserve(obs->filter_types, obs->filter_types.num + sources);
+	da_reserve(obs->transition_types, obs->transition_types.num + sources);
+	da_reserve(obs->output_types, obs->output_types.num + outputs);
+	da_reserve(obs->encoder_types, obs->encoder_types.num + encoders);
+	da_reserve(obs->service_types, obs->service_types.num + services);
+}
+
+static void disable_failed_module(obs_module_t *module)
+{
+	obs_module_t *disabled_module;
+	char *bin_path = bstrdup(module->bin_path);
+	char *data_path = bstrdup(module->data_path);
+
+	free_module(module);
+	obs_create_disabled_module(&disabled_module, bin_path, data_path, OBS_MODULE_FAILED_TO_INITIALIZE);
+
+	bfree(bin_path);
+	bfree(data_path);
+}
+
+static bool load_deferred_module(struct obs_module *deferred)
+{
+	obs_module_t *module;
+	bool success = false;
+
+	const char *profile_name =
+		profile_store_name(obs_get_profiler_name_store(), "obs_load_deferred_module(%s)", deferred->file);
+	profile_start(profile_name);
+
+	blog(LOG_INFO, "Loading deferred module '%s'", deferred->file);
+
+	if (obs_open_module(&module, deferred->bin_path, deferred->data_path) != MODULE_SUCCESS) {
+		blog(LOG_WARNING, "Failed to open deferred module '%s'", deferred->bin_path);
+	} else if (!obs_init_module(module)) {
+		disable_failed_module(module);
+	} else {
+		if (obs->modules_post_loaded && module->post_load)
+			module->post_load();
+		success = true;
+	}
+
+	profile_end(profile_name);
+	return success;
+}
+
+bool obs_load_deferred_module(enum obs_module_type type, const char *id)
+{
+	struct obs_module **prev;
+	struct obs_module *mod;
+	bool success = true;
+
+	/* never load other modules from within a module's load function or
+	 * while registering a type, the registration functions also look up
+	 * their type ids with the module mutex held */
+	if (!obs || !obs->lazy_module_loading || loadingModule || registeringType || !id)
+		return false;
+
+	/* deferred loads are serialized with each other, but the module is
+	 * loaded without holding the module mutex, so its load function is
+	 * free to take other locks while other threads look up types.  if the
+	 * entry is already gone, another thread loaded it while we waited. */
+	pthread_mutex_lock(&obs->deferred_load_mutex);
+
+	pthread_mutex_lock(&obs->module_mutex);
+	for (prev = &obs->first_deferred_module; (mod = *prev) != NULL; prev = &mod->next) {
+		if (module_has_type(mod, type, id)) {
+			*prev = mod->next;
+			mod->next = NULL;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&obs->module_mutex);
+
+	if (mod) {
+		success = load_deferred_module(mod);
+		free_module(mod);
+	}
+
+	pthread_mutex_unlock(&obs->deferred_load_mutex);
+	return success;
+}
+
+void obs_free_deferred_modules(void)
+{
+	struct obs_module *mod = obs->first_deferred_module;
+
+	while (mod) {
+		struct obs_module *next = mod->next;
+		mod->next = NULL;
+		free_module(mod);
+		mod = next;
+	}
+
+	obs->first_deferred_module = NULL;
+}
+
+/* with lazy module loading, types are registered in whatever order their
+ * modules happen to be loaded in, so the type arrays are kept sorted by id to
+ * keep their enumeration order stable.  all type info structures start with
+ * the id. */
+static int cmp_type_id(const void *a, const void *b)
+{
+	return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static size_t type_insert_idx(const void *array, size_t size, size_t num, const char *id)
+{
+	const uint8_t *types = array;
+	size_t lo = 0;
+	size_t hi = num;
+
+	if (!obs->lazy_module_loading)
+		return num;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (cmp_type_id(types + mid * size, &id) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+#define sort_types(types) qsort((types).array, (types).num, sizeof(*(types).array), cmp_type_id)
+#define push_type(types, data) \
+	da_insert(types, type_insert_idx((types).array, sizeof(*(types).array), (types).num, (data)->id), data)
+
+void obs_set_lazy_module_loading(bool enable)
+{
+	if (!obs)
+		return;
+
+	if (obs->first_module) {
+		blog(LOG_WARNING, "obs_set_lazy_module_loading: Modules have already been loaded");
+		return;
+	}
+
+	obs->lazy_module_loading = enable;
+
+	/* types registered by libobs itself */
+	if (enable) {
+		obs_lock_module_types();
+		sort_types(obs->source_types);
+		sort_types(obs->input_types);
+		sort_types(obs->filter_types);
+		sort_types(obs->transition_types);
+		sort_types(obs->output_types);
+		sort_types(obs->encoder_types);
+		sort_types(obs->service_types);
+		obs_unlock_module_types();
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/* Loading all modules */
+
 static void load_all_callback(void *param, const struct obs_module_info2 *info)
 {
-	struct fail_info *fail_info = param;
+	struct module_load_context *ctx = param;
+	struct fail_info *fail_info = ctx->fail_info;
+	obs_data_t *cache_entry = find_module_cache_entry(ctx, info->bin_path);
 	obs_module_t *module;
 	obs_module_t *disabled_module;
 
-	bool is_obs_plugin;
+	/* modules from the cache are already known to be plugins */
+	if (!cache_entry) {
+		bool is_obs_plugin;
 
-	get_plugin_info(info->bin_path, &is_obs_plugin);
+		get_plugin_info(info->bin_path, &is_obs_plugin);
 
-	if (!is_obs_plugin) {
-		blog(LOG_WARNING, "Skipping module '%s', not an OBS plugin", info->bin_path);
-		return;
+		if (!is_obs_plugin) {
+			blog(LOG_WARNING, "Skipping module '%s', not an OBS plugin", info->bin_path);
+			return;
+		}
 	}
 
 	if (!is_safe_module(info->name)) {
 		obs_create_disabled_module(&disabled_module, info->bin_path, info->data_path, OBS_MODULE_DISABLED_SAFE);
 		blog(LOG_WARNING, "Skipping module '%s', not on safe list", info->name);
-		return;
+		goto cleanup;
 	}
 
 	if (is_disabled_module(info->name)) {
 		obs_create_disabled_module(&disabled_module, info->bin_path, info->data_path, OBS_MODULE_DISABLED);
 		blog(LOG_WARNING, "Skipping module '%s', is disabled", info->name);
-		return;
+		goto cleanup;
+	}
+
+	if (cache_entry && obs->lazy_module_loading && defer_module(info, cache_entry)) {
+		obs_data_array_push_back(ctx->deferred_entries, cache_entry);
+		goto cleanup;
 	}
 
 	int code = obs_open_module(&module, info->bin_path, info->data_path);
 	switch (code) {
 	case MODULE_MISSING_EXPORTS:
 		blog(LOG_DEBUG, "Failed to load module file '%s', not an OBS plugin", info->bin_path);
-		return;
+		goto cleanup;
 	case MODULE_FAILED_TO_OPEN:
 		blog(LOG_DEBUG, "Failed to load module file '%s', module failed to open", info->bin_path);
 		obs_create_disabled_module(&disabled_module, info->bin_path, info->data_path,
@@ -536,17 +964,19 @@ static void load_all_callback(void *param, const struct obs_module_info2 *info)
 					   OBS_MODULE_FAILED_TO_OPEN);
 		goto load_failure;
 	case MODULE_HARDCODED_SKIP:
-		return;
+		goto cleanup;
 	}
 
-	if (!obs_init_module(module)) {
-		free_module(module);
-		obs_create_disabled_module(&disabled_module, info->bin_path, info->data_path,
-					   OBS_MODULE_FAILED_TO_INITIALIZE);
+	/* initialized later on the module init threads */
+	if (module->thread_safe_load && module->thread_safe_load()) {
+		da_push_back(ctx->parallel_modules, &module);
+		goto cleanup;
 	}
 
-	UNUSED_PARAMETER(param);
-	return;
+	if (!obs_init_module(module))
+		disable_failed_module(module);
+
+	goto cleanup;
 
 load_failure:
 	if (fail_info) {
@@ -554,6 +984,90 @@ load_failure:
 		dstr_cat(&fail_info->fail_modules, ";");
 		fail_info->fail_count++;
 	}
+
+cleanup:
+	obs_data_release(cache_entry);
+}
+
+#define MAX_MODULE_INIT_THREADS 8
+
+struct module_init_queue {
+	obs_module_t **modules;
+	bool *results;
+	size_t num;
+	volatile long next;
+};
+
+static void *module_init_thread(void *param)
+{
+	struct module_init_queue *queue = param;
+
+	os_set_thread_name("libobs: module init thread");
+
+	for (;;) {
+		long idx = os_atomic_inc_long(&queue->next) - 1;
+		if ((size_t)idx >= queue->num)
+			break;
+
+		queue->results[idx] = obs_init_module(queue->modules[idx]);
+	}
+
+	return NULL;
+}
+
+static void init_parallel_modules(struct module_load_context *ctx)
+{
+	struct module_init_queue queue = {0};
+	pthread_t threads[MAX_MODULE_INIT_THREADS];
+	size_t num_threads = (size_t)os_get_logical_cores();
+	size_t started = 0;
+
+	if (!ctx->parallel_modules.num)
+		return;
+
+	queue.modules = ctx->parallel_modules.array;
+	queue.num = ctx->parallel_modules.num;
+	queue.results = bzalloc(sizeof(bool) * queue.num);
+
+	if (num_threads > MAX_MODULE_INIT_THREADS)
+		num_threads = MAX_MODULE_INIT_THREADS;
+	if (num_threads > queue.num)
+		num_threads = queue.num;
+
+	for (; started < num_threads; started++) {
+		if (pthread_create(&threads[started], NULL, module_init_thread, &queue) != 0)
+			break;
+	}
+
+	/* also does all of the work if no thread could be created */
+	module_init_thread(&queue);
+
+	for (size_t i = 0; i < started; i++)
+		pthread_join(threads[i], NULL);
+
+	for (size_t i = 0; i < queue.num; i++) {
+		if (!queue.results[i])
+			disable_failed_module(queue.modules[i]);
+	}
+
+	bfree(queue.results);
+}
+
+static void load_all_modules(struct fail_info *fail_info)
+{
+	struct module_load_context ctx = {0};
+
+	ctx.fail_info = fail_info;
+	load_module_cache(&ctx);
+
+	obs_find_modules2(load_all_callback, &ctx);
+	init_parallel_modules(&ctx);
+
+	if (obs->first_deferred_module)
+		reserve_deferred_types();
+
+	save_module_cache(&ctx);
+	free_module_load_context(&ctx);
 }
 
 static const char *obs_load_all_modules_name = "obs_load_all_modules";
@@ -564,7 +1078,7 @@ static const char *reset_win32_symbol_paths_name = "reset_win32_symbol_paths";
 void obs_load_all_modules(void)
 {
 	profile_start(obs_load_all_modules_name);
-	obs_find_modules2(load_all_callback, NULL);
+	load_all_modules(NULL);
 #ifdef _WIN32
 	profile_start(reset_win32_symbol_paths_name);
 	reset_win32_symbol_paths();
@@ -581,7 +1095,7 @@ void obs_load_all_modules2(struct obs_module_failure_info *mfi)
 	memset(mfi, 0, sizeof(*mfi));
 
 	profile_start(obs_load_all_modules2_name);
-	obs_find_modules2(load_all_callback, &fail_info);
+	load_all_modules(&fail_info);
 #ifdef _WIN32
 	profile_start(reset_win32_symbol_paths_name);
 	reset_win32_symbol_paths();
@@ -604,6 +1118,8 @@ void obs_module_failure_info_free(struct obs_module_failure_info *mfi)
 
 void obs_post_load_modules(void)
 {
+	obs->modules_post_loaded = true;
+
 	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next)
 		if (mod->post_load)
 			mod->post_load();
@@ -909,7 +1425,7 @@ cleanup:
 		}                                                                                       \
                                                                                                         \
 		memcpy(&data, info, size_var);                                                          \
-		da_push_back(dest, &data);                                                              \
+		push_type(dest, &data);                                                                 \
 	} while (false)
 
 #define HAS_VAL(type, info, val) ((offsetof(type, val) + sizeof(info->val) <= size) && info->val)
@@ -953,7 +1469,7 @@ cleanup:
 #define encoder_warn(format, ...) blog(LOG_WARNING, "obs_register_encoder: " format, ##__VA_ARGS__)
 #define service_warn(format, ...) blog(LOG_WARNING, "obs_register_service: " format, ##__VA_ARGS__)
 
-void obs_register_source_s(const struct obs_source_info *info, size_t size)
+static void register_source(const struct obs_source_info *info, size_t size)
 {
 	struct obs_source_info data = {0};
 	obs_source_info_array_t *array = NULL;
@@ -1050,15 +1566,15 @@ void obs_register_source_s(const struct obs_source_info *info, size_t size)
 	}
 
 	if (array)
-		da_push_back(*array, &data);
-	da_push_back(obs->source_types, &data);
+		push_type(*array, &data);
+	push_type(obs->source_types, &data);
 	return;
 
 error:
 	HANDLE_ERROR(size, obs_source_info, info);
 }
 
-void obs_register_output_s(const struct obs_output_info *info, size_t size)
+static void register_output(const struct obs_output_info *info, size_t size)
 {
 	if (find_output(info->id)) {
 		output_warn("Output id '%s' already exists!  "
@@ -1123,7 +1639,7 @@ error:
 	HANDLE_ERROR(size, obs_output_info, info);
 }
 
-void obs_register_encoder_s(const struct obs_encoder_info *info, size_t size)
+static void register_encoder(const struct obs_encoder_info *info, size_t size)
 {
 	if (find_encoder(info->id)) {
 		encoder_warn("Encoder id '%s' already exists!  "
@@ -1165,7 +1681,7 @@ error:
 	HANDLE_ERROR(size, obs_encoder_info, info);
 }
 
-void obs_register_service_s(const struct obs_service_info *info, size_t size)
+static void register_service(const struct obs_service_info *info, size_t size)
 {
 	if (find_service(info->id)) {
 		service_warn("Service id '%s' already exists!  "
@@ -1193,3 +1709,40 @@ void obs_register_service_s(const struct obs_service_info *info, size_t size)
 error:
 	HANDLE_ERROR(size, obs_service_info, info);
 }
+
+/* modules that declare a thread-safe load register their types in parallel */
+void obs_register_source_s(const struct obs_source_info *info, size_t size)
+{
+	pthread_mutex_lock(&obs->module_mutex);
+	registeringType = true;
+	register_source(info, size);
+	registeringType = false;
+	pthread_mutex_unlock(&obs->module_mutex);
+}
+
+void obs_register_output_s(const struct obs_output_info *info, size_t size)
+{
+	pthread_mutex_lock(&obs->module_mutex);
+	registeringType = true;
+	register_output(info, size);
+	registeringType = false;
+	pthread_mutex_unlock(&obs->module_mutex);
+}
+
+void obs_register_encoder_s(const struct obs_encoder_info *info, size_t size)
+{
+	pthread_mutex_lock(&obs->module_mutex);
+	registeringType = true;
+	register_encoder(info, size);
+	registeringType = false;
+	pthread_mutex_unlock(&obs->module_mutex);
+}
+
+void obs_register_service_s(const struct obs_service_info *info, size_t size)
+{
+	pthread_mutex_lock(&obs->module_mutex);
+	registeringType = true;
+	register_service(info, size);
+	registeringType = false;
+	pthread_mutex_unlock(&obs->module_mutex);
+}
@@ -106,6 +106,18 @@ MODULE_EXPORT void obs_module_unload(void);
 /** Optional: Called when all modules have finished loading */
 MODULE_EXPORT void obs_module_post_load(void);
 
+/**
+ * Optional: Declares that obs_module_load does not depend on other modules
+ * and only uses thread-safe functions, so it can be called in parallel with
+ * the obs_module_load of other modules.
+ */
+#define OBS_MODULE_THREAD_SAFE_LOAD()                         \
+	MODULE_EXPORT bool obs_module_thread_safe_load(void); \
+	bool obs_module_thread_safe_load(void)                \
+	{                                                     \
+		return true;                                  \
+	}
+
 /** Called to set the current locale data for the module.  */
 MODULE_EXPORT void obs_module_set_locale(const char *locale);
 
@@ -119,7 +119,7 @@ static inline bool log_flag_service(const struct obs_output *output, const char
 	return ret;
 }
 
-const struct obs_output_info *find_output(const char *id)
+static const struct obs_output_info *find_output_type(const char *id)
 {
 	size_t i;
 	for (i = 0; i < obs->output_types.num; i++)
@@ -129,6 +129,23 @@ const struct obs_output_info *find_output(const char *id)
 	return NULL;
 }
 
+const struct obs_output_info *find_output(const char *id)
+{
+	const struct obs_output_info *info;
+
+	obs_lock_module_types();
+	info = find_output_type(id);
+	obs_unlock_module_types();
+
+	if (!info && obs_load_deferred_module(OBS_MODULE_TYPE_OUTPUT, id)) {
+		obs_lock_module_types();
+		info = find_output_type(id);
+		obs_unlock_module_types();
+	}
+
+	return info;
+}
+
 const char *obs_output_get_display_name(const char *id)
 {
 	const struct obs_output_info *info = find_output(id);
@@ -19,7 +19,7 @@
 
 #define get_weak(service) ((obs_weak_service_t *)service->context.control)
 
-const struct obs_service_info *find_service(const char *id)
+static const struct obs_service_info *find_service_type(const char *id)
 {
 	size_t i;
 	for (i = 0; i < obs->service_types.num; i++)
@@ -29,6 +29,23 @@ const struct obs_service_info *find_service(const char *id)
 	return NULL;
 }
 
+const struct obs_service_info *find_service(const char *id)
+{
+	const struct obs_service_info *info;
+
+	obs_lock_module_types();
+	info = find_service_type(id);
+	obs_unlock_module_types();
+
+	if (!info && obs_load_deferred_module(OBS_MODULE_TYPE_SERVICE, id)) {
+		obs_lock_module_types();
+		info = find_service_type(id);
+		obs_unlock_module_types();
+	}
+
+	return info;
+}
+
 const char *obs_service_get_display_name(const char *id)
 {
 	const struct obs_service_info *info = find_service(id);
@@ -50,7 +50,7 @@ static inline bool destroying(const struct obs_source *source)
 	return os_atomic_load_long(&source->destroying);
 }
 
-struct obs_source_info *get_source_info(const char *id)
+static struct obs_source_info *find_source_type(const char *id)
 {
 	for (size_t i = 0; i < obs->source_types.num; i++) {
 		struct obs_source_info *info = &obs->source_types.array[i];
@@ -61,7 +61,24 @@ struct obs_source_info *get_source_info(const char *id)
 	return NULL;
 }
 
-struct obs_source_info *get_source_info2(const char *unversioned_id, uint32_t ver)
+struct obs_source_info *get_source_info(const char *id)
+{
+	struct obs_source_info *info;
+
+	obs_lock_module_types();
+	info = find_source_type(id);
+	obs_unlock_module_types();
+
+	if (!info && obs_load_deferred_module(OBS_MODULE_TYPE_SOURCE, id)) {
+		obs_lock_module_types();
+		info = find_source_type(id);
+		obs_unlock_module_types();
+	}
+
+	return info;
+}
+
+static struct obs_source_info *find_source_type2(const char *unversioned_id, uint32_t ver)
 {
 	for (size_t i = 0; i < obs->source_types.num; i++) {
 		struct obs_source_info *info = &obs->source_types.array[i];
@@ -72,6 +89,34 @@ struct obs_source_info *get_source_info2(const char *unversioned_id, uint32_t ve
 	return NULL;
 }
 
+struct obs_source_info *get_source_info2(const char *unversioned_id, uint32_t ver)
+{
+	struct obs_source_info *info;
+	struct dstr id = {0};
+
+	obs_lock_module_types();
+	info = find_source_type2(unversioned_id, ver);
+	obs_unlock_module_types();
+
+	if (info || !obs->lazy_module_loading)
+		return info;
+
+	/* the module cache stores the versioned ids */
+	if (ver)
+		dstr_printf(&id, "%s_v%d", unversioned_id, (int)ver);
+	else
+		dstr_copy(&id, unversioned_id);
+
+	if (obs_load_deferred_module(OBS_MODULE_TYPE_SOURCE, id.array)) {
+		obs_lock_module_types();
+		info = find_source_type2(unversioned_id, ver);
+		obs_unlock_module_types();
+	}
+
+	dstr_free(&id);
+	return info;
+}
+
 static const char *source_signals[] = {
 	"void destroy(ptr source)",
 	"void remove(ptr source)",
@@ -226,6 +271,7 @@ static bool obs_source_init(struct obs_source *source)
 	pthread_mutex_init_value(&source->audio_cb_mutex);
 	pthread_mutex_init_value(&source->caption_cb_mutex);
 	pthread_mutex_init_value(&source->media_actions_mutex);
+	pthread_mutex_init_value(&source->settings_snapshot_mutex);
 
 	if (pthread_mutex_init_recursive(&source->filter_mutex) != 0)
 		return false;
@@ -243,6 +289,8 @@ static bool obs_source_init(struct obs_source *source)
 		return false;
 	if (pthread_mutex_init(&source->media_actions_mutex, NULL) != 0)
 		return false;
+	if (pthread_mutex_init(&source->settings_snapshot_mutex, NULL) != 0)
+		return false;
 
 	if (is_audio_source(source) || is_composite_source(source))
 		allocate_audio_output_buffer(source);
@@ -433,9 +481,12 @@ void obs_source_audio_output_capture_device_changed(obs_source_t *src, const cha
 	}
 }
 
-static obs_source_t *obs_source_create_internal(const char *id, const char *name, const char *uuid,
-						obs_data_t *settings, obs_data_t *hotkey_data, bool private,
-						uint32_t last_obs_ver, obs_canvas_t *canvas)
+/* Creates the source and calls the create callback of its type, but does not
+ * make it visible through any of the global source lists yet.  This is what
+ * allows sources to be constructed on other threads while a scene collection
+ * is loaded, see obs_source_publish. */
+obs_source_t *obs_source_construct(const char *id, const char *name, const char *uuid, obs_data_t *settings,
+				   obs_data_t *hotkey_data, bool private, uint32_t last_obs_ver)
 {
 	struct obs_source *source = bzalloc(sizeof(struct obs_source));
 
@@ -477,12 +528,6 @@ static obs_source_t *obs_source_create_internal(const char *id, const char *name
 	if (!obs_source_init(source))
 		goto fail;
 
-	/* Scenes need canvases, fall back to using default canvas if none provided here. */
-	if (requires_canvas(source) && !canvas) {
-		blog(LOG_WARNING, "Attempted to add Scene without specifying a canvas! Using default canvas instead.");
-		canvas = obs->data.main_canvas;
-	}
-
 	if (!private)
 		obs_source_init_audio_hotkeys(source);
 
@@ -501,20 +546,41 @@ static obs_source_t *obs_source_create_internal(const char *id, const char *name
 	/* audio deduplication initialization */
 	source->audio_is_duplicated = false;
 
+	return source;
+
+fail:
+	blog(LOG_ERROR, "obs_source_create failed");
+	obs_source_destroy(source);
+	return NULL;
+}
+
+void obs_source_publish(obs_source_t *source, obs_canvas_t *canvas)
+{
+	/* Scenes need canvases, fall back to using default canvas if none provided here. */
+	if (requires_canvas(source) && !canvas) {
+		blog(LOG_WARNING, "Attempted to add Scene without specifying a canvas! Using default canvas instead.");
+		canvas = obs->data.main_canvas;
+	}
+
 	obs_source_init_finalize(source, canvas);
-	if (!private) {
+	if (!source->context.private) {
 		if (canvas)
 			obs_source_dosignal_canvas(source, canvas, "source_create_canvas", NULL);
 		if (!canvas || canvas == obs->data.main_canvas)
 			obs_source_dosignal(source, "source_create", NULL);
 	}
+}
 
-	return source;
+static obs_source_t *obs_source_create_internal(const char *id, const char *name, const char *uuid,
+						obs_data_t *settings, obs_data_t *hotkey_data, bool private,
+						uint32_t last_obs_ver, obs_canvas_t *canvas)
+{
+	obs_source_t *source = obs_source_construct(id, name, uuid, settings, hotkey_data, private, last_obs_ver);
 
-fail:
-	blog(LOG_ERROR, "obs_source_create failed");
-	obs_source_destroy(source);
-	return NULL;
+	if (source)
+		obs_source_publish(source, canvas);
+
+	return source;
 }
 
 obs_source_t *obs_source_create(const char *id, const char *name, obs_data_t *settings, obs_data_t *hotkey_data)
@@ -533,13 +599,6 @@ obs_source_t *obs_source_create_canvas(obs_canvas_t *canvas, const char *id, con
 	return obs_source_create_internal(id, name, NULL, settings, hotkey_data, false, LIBOBS_API_VER, canvas);
 }
 
-obs_source_t *obs_source_create_set_last_ver(obs_canvas_t *canvas, const char *id, const char *name, const char *uuid,
-					     obs_data_t *settings, obs_data_t *hotkey_data, uint32_t last_obs_ver,
-					     bool is_private)
-{
-	return obs_source_create_internal(id, name, uuid, settings, hotkey_data, is_private, last_obs_ver, canvas);
-}
-
 static char *get_new_filter_name(obs_source_t *dst, const char *name)
 {
 	struct dstr new_name = {0};
@@ -831,7 +890,9 @@ static void obs_source_destroy_defer(struct obs_source *source)
 	pthread_mutex_destroy(&source->caption_cb_mutex);
 	pthread_mutex_destroy(&source->async_mutex);
 	pthread_mutex_destroy(&source->media_actions_mutex);
+	pthread_mutex_destroy(&source->settings_snapshot_mutex);
 	obs_data_release(source->private_settings);
+	obs_data_release(source->settings_snapshot);
 	obs_context_data_free(&source->context);
 
 	if (source->owns_info_id) {
@@ -1059,6 +1120,7 @@ static void obs_source_deferred_update(obs_source_t *source)
 		long count = os_atomic_load_long(&source->defer_update_count);
 		source->info.update(source->context.data, source->context.settings);
 		os_atomic_compare_swap_long(&source->defer_update_count, count, 0);
+		obs_source_settings_changed(source);
 		obs_source_dosignal(source, "source_update", "update");
 	}
 }
@@ -1072,10 +1134,13 @@ void obs_source_update(obs_source_t *source, obs_data_t *settings)
 		obs_data_apply(source->context.settings, settings);
 	}
 
+	obs_source_settings_changed(source);
+
 	if (source->info.output_flags & OBS_SOURCE_VIDEO) {
 		os_atomic_inc_long(&source->defer_update_count);
 	} else if (source->context.data && source->info.update) {
 		source->info.update(source->context.data, source->context.settings);
+		obs_source_settings_changed(source);
 		obs_source_dosignal(source, "source_update", "update");
 	}
 }
@@ -4740,8 +4805,38 @@ void obs_source_save(obs_source_t *source)
 
 	obs_source_dosignal(source, "source_save", "save");
 
-	if (source->info.save)
+	if (source->info.save) {
 		source->info.save(source->context.data, source->context.settings);
+		obs_source_settings_changed(source);
+	}
+}
+
+void obs_source_settings_changed(obs_source_t *source)
+{
+	os_atomic_inc_long(&source->settings_generation);
+}
+
+obs_data_t *obs_source_get_settings_snapshot(obs_source_t *source)
+{
+	obs_data_t *snapshot;
+
+	pthread_mutex_lock(&source->settings_snapshot_mutex);
+
+	long generation = os_atomic_load_long(&source->settings_generation);
+
+	if (!source->settings_snapshot || source->settings_snapshot_generation != generation) {
+		obs_data_release(source->settings_snapshot);
+
+		source->settings_snapshot = obs_data_create();
+		source->settings_snapshot_generation = generation;
+		obs_data_apply(source->settings_snapshot, source->context.settings);
+	}
+
+	snapshot = source->settings_snapshot;
+	obs_data_addref(snapshot);
+
+	pthread_mutex_unlock(&source->settings_snapshot_mutex);
+	return snapshot;
 }
 
 void obs_source_load(obs_source_t *source)
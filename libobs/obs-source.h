@@ -208,6 +208,13 @@ enum obs_media_state {
  */
 #define OBS_SOURCE_REQUIRES_CANVAS (1 << 17)
 
+/**
+ * Source type's create callback can be called from any thread and does not
+ * look up other sources, so the source can be constructed in parallel with
+ * other sources when loading a scene collection.
+ */
+#define OBS_SOURCE_THREAD_SAFE_CREATE (1 << 18)
+
 /** @} */
 
 typedef void (*obs_source_enum_proc_t)(obs_source_t *parent, obs_source_t *child, void *param);
@@ -0,0 +1,130 @@
+#include "obs-internal.h"
+
+#define NBSP "\xC2\xA0"
+static const char *readback_output_video_data_name = "output_video_data";
+static const char *wait_video_readback_name = "wait_video_readback";
+
+static inline void record_readback_latency(struct obs_core_video_mix *video, uint64_t staged_ts)
+{
+	uint64_t latency = os_gettime_ns() - staged_ts;
+
+	video->readback_latency_total += latency;
+	if (latency > video->readback_latency_max)
+		video->readback_latency_max = latency;
+	video->readback_frames++;
+}
+
+static void *readback_thread(void *data)
+{
+	struct obs_core_video_mix *video = data;
+	uint64_t interval = video_output_get_frame_time(video->video);
+
+	os_set_thread_name("obs video readback thread");
+	const char *readback_thread_name = profile_store_name(
+		obs_get_profiler_name_store(), "obs_video_readback_thread(%g" NBSP "ms)", interval / 1000000.);
+	profile_register_root(readback_thread_name, interval);
+
+	while (os_sem_wait(video->readback_sem) == 0) {
+		if (os_atomic_load_bool(&video->readback_stop))
+			break;
+
+		profile_start(readback_thread_name);
+
+		profile_start(readback_output_video_data_name);
+		output_video_data(video, &video->readback_frame, video->readback_count);
+		profile_end(readback_output_video_data_name);
+
+		record_readback_latency(video, video->readback_staged_ts);
+		os_event_signal(video->readback_idle);
+
+		profile_end(readback_thread_name);
+		profile_reenable_thread();
+	}
+
+	return NULL;
+}
+
+bool init_video_readback(struct obs_core_video_mix *video)
+{
+	video->readback_stop = false;
+
+	if (os_sem_init(&video->readback_sem, 0) != 0)
+		goto fail;
+	if (os_event_init(&video->readback_idle, OS_EVENT_TYPE_MANUAL) != 0)
+		goto fail;
+
+	os_event_signal(video->readback_idle);
+
+	if (pthread_create(&video->readback_thread, NULL, readback_thread, video) != 0)
+		goto fail;
+
+	video->readback_thread_initialized = true;
+	return true;
+
+fail:
+	os_sem_destroy(video->readback_sem);
+	os_event_destroy(video->readback_idle);
+	video->readback_sem = NULL;
+	video->readback_idle = NULL;
+	return false;
+}
+
+/* must not race with queue_video_readback, so only call it from the graphics
+ * thread or once the graphics thread has stopped */
+void stop_video_readback(struct obs_core_video_mix *video)
+{
+	if (video->readback_thread_initialized) {
+		os_event_wait(video->readback_idle);
+
+		os_atomic_set_bool(&video->readback_stop, true);
+		os_sem_post(video->readback_sem);
+		pthread_join(video->readback_thread, NULL);
+		video->readback_thread_initialized = false;
+	}
+
+	os_sem_destroy(video->readback_sem);
+	os_event_destroy(video->readback_idle);
+	video->readback_sem = NULL;
+	video->readback_idle = NULL;
+
+	if (video->readback_frames) {
+		blog(LOG_INFO, "Video readback (depth %d): %u frames, staging to output avg %.2f ms, max %.2f ms",
+		     video->readback_depth, video->readback_frames,
+		     (double)video->readback_latency_total / (double)video->readback_frames / 1000000.0,
+		     (double)video->readback_latency_max / 1000000.0);
+
+		video->readback_latency_total = 0;
+		video->readback_latency_max = 0;
+		video->readback_frames = 0;
+	}
+}
+
+/* waits until the readback thread is done with the mapped surfaces */
+void wait_video_readback(struct obs_core_video_mix *video)
+{
+	if (!video->readback_thread_initialized)
+		return;
+
+	profile_start(wait_video_readback_name);
+	os_event_wait(video->readback_idle);
+	profile_end(wait_video_readback_name);
+}
+
+void queue_video_readback(struct obs_core_video_mix *video, const struct video_data *frame, int count,
+			  uint64_t staged_ts)
+{
+	if (!video->readback_thread_initialized) {
+		output_video_data(video, frame, count);
+		record_readback_latency(video, staged_ts);
+		return;
+	}
+
+	wait_video_readback(video);
+	os_event_reset(video->readback_idle);
+
+	video->readback_frame = *frame;
+	video->readback_count = count;
+	video->readback_staged_ts = staged_ts;
+
+	os_sem_post(video->readback_sem);
+}
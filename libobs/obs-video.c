@@ -125,6 +125,8 @@ static inline void set_render_size(uint32_t width, uint32_t height)
 
 static inline void unmap_last_surface(struct obs_core_video_mix *video)
 {
+	wait_video_readback(video);
+
 	for (int c = 0; c < NUM_CHANNELS; ++c) {
 		if (video->mapped_surfaces[c]) {
 			gs_stagesurface_unmap(video->mapped_surfaces[c]);
@@ -145,7 +147,7 @@ static inline bool can_reuse_mix_texture(const struct obs_core_video_mix *mix, s
 			continue;
 		if (other->ovi.base_width != mix->ovi.base_width || other->ovi.base_height != mix->ovi.base_height)
 			continue;
-		if (!other->texture_rendered)
+		if (!other->texture_fresh)
 			continue;
 
 		*idx = i;
@@ -422,6 +424,7 @@ static inline void stage_output_texture(struct obs_core_video_mix *video, int cu
 			video->active_copy_surfaces[cur_texture][i] = NULL;
 
 		video->textures_copied[cur_texture] = true;
+		video->staged_ts[cur_texture] = os_gettime_ns();
 	} else if (video->texture_converted) {
 		for (size_t i = 0; i < channel_count; i++) {
 			gs_stagesurf_t *copy = copy_surfaces[i];
@@ -434,6 +437,7 @@ static inline void stage_output_texture(struct obs_core_video_mix *video, int cu
 			video->active_copy_surfaces[cur_texture][i] = NULL;
 
 		video->textures_copied[cur_texture] = true;
+		video->staged_ts[cur_texture] = os_gettime_ns();
 	}
 
 	profile_end(stage_output_texture_name);
@@ -580,13 +584,13 @@ static inline void render_video(struct obs_core_video_mix *video, bool raw_activ
 	gs_end_scene();
 }
 
-static inline bool download_frame(struct obs_core_video_mix *video, int prev_texture, struct video_data *frame)
+static inline bool download_frame(struct obs_core_video_mix *video, int read_texture, struct video_data *frame)
 {
-	if (!video->textures_copied[prev_texture])
+	if (!video->textures_copied[read_texture])
 		return false;
 
 	for (int channel = 0; channel < NUM_CHANNELS; ++channel) {
-		gs_stagesurf_t *surface = video->active_copy_surfaces[prev_texture][channel];
+		gs_stagesurf_t *surface = video->active_copy_surfaces[read_texture][channel];
 		if (surface) {
 			if (!gs_stagesurface_map(surface, &frame->data[channel], &frame->linesize[channel]))
 				return false;
@@ -597,22 +601,45 @@ static inline bool download_frame(struct obs_core_video_mix *video, int prev_tex
 	return true;
 }
 
-static const uint8_t *set_gpu_converted_plane(uint32_t width, uint32_t height, uint32_t linesize_input,
-					      uint32_t linesize_output, const uint8_t *in, uint8_t *out)
+struct plane_copy {
+	const uint8_t *in;
+	uint8_t *out;
+	uint32_t width;
+	uint32_t linesize_input;
+	uint32_t linesize_output;
+};
+
+static void copy_plane_rows(void *param, uint32_t start_y, uint32_t end_y)
 {
-	if ((width == linesize_input) && (width == linesize_output)) {
-		size_t total = (size_t)width * (size_t)height;
-		memcpy(out, in, total);
-		in += total;
+	const struct plane_copy *copy = param;
+	const uint8_t *in = copy->in + (size_t)start_y * copy->linesize_input;
+	uint8_t *out = copy->out + (size_t)start_y * copy->linesize_output;
+
+	if ((copy->width == copy->linesize_input) && (copy->width == copy->linesize_output)) {
+		memcpy(out, in, (size_t)copy->width * (size_t)(end_y - start_y));
 	} else {
-		for (size_t y = 0; y < height; y++) {
-			memcpy(out, in, width);
-			out += linesize_output;
-			in += linesize_input;
+		for (uint32_t y = start_y; y < end_y; y++) {
+			memcpy(out, in, copy->width);
+			out += copy->linesize_output;
+			in += copy->linesize_input;
 		}
 	}
+}
+
+/* below this, waking the slice threads costs more than they save */
+#define MIN_SLICED_PLANE_SIZE (1024 * 1024)
 
-	return in;
+static const uint8_t *set_gpu_converted_plane(uint32_t width, uint32_t height, uint32_t linesize_input,
+					      uint32_t linesize_output, const uint8_t *in, uint8_t *out)
+{
+	struct plane_copy copy = {in, out, width, linesize_input, linesize_output};
+
+	if ((size_t)width * (size_t)height >= MIN_SLICED_PLANE_SIZE)
+		video_slice_pool_run(obs->video.slice_pool, copy_plane_rows, &copy, height, 1);
+	else
+		copy_plane_rows(&copy, 0, height);
+
+	return in + (size_t)linesize_input * (size_t)height;
 }
 
 static void set_gpu_converted_data(struct video_frame *output, const struct video_data *input,
@@ -774,7 +801,7 @@ static inline void copy_rgbx_frame(struct video_frame *output, const struct vide
 	}
 }
 
-static inline void output_video_data(struct obs_core_video_mix *video, struct video_data *input_frame, int count)
+void output_video_data(struct obs_core_video_mix *video, const struct video_data *input_frame, int count)
 {
 	const struct video_output_info *info;
 	struct video_frame output_frame;
@@ -852,6 +879,15 @@ static inline void video_sleep(struct obs_core_video *video, uint64_t *p_time, u
 		bool raw_active = video->raw_was_active;
 		bool gpu_active = video->gpu_was_active;
 
+		/* a frame of a divided mix covers frame_divisor ticks */
+		video->divisor_ticks += (uint32_t)count;
+		video->frame_due = video->divisor_ticks >= video->frame_divisor;
+		if (!video->frame_due)
+			continue;
+
+		vframe_info.count = (int)(video->divisor_ticks / video->frame_divisor);
+		video->divisor_ticks %= video->frame_divisor;
+
 		if (raw_active)
 			deque_push_back(&video->vframe_info_buffer, &vframe_info, sizeof(vframe_info));
 		if (gpu_active)
@@ -864,14 +900,41 @@ static const char *output_frame_gs_context_name = "gs_context(video->graphics)";
 static const char *output_frame_render_video_name = "render_video";
 static const char *output_frame_download_frame_name = "download_frame";
 static const char *output_frame_gs_flush_name = "gs_flush";
-static const char *output_frame_output_video_data_name = "output_video_data";
+static const char *output_frame_queue_video_readback_name = "queue_video_readback";
+static inline bool is_main_mix(const struct obs_core_video_mix *video)
+{
+	return video == obs->data.main_canvas->mix;
+}
+
+static inline bool should_render_mix(struct obs_core_video_mix *video)
+{
+	/* reset every tick so displays re-request the texture */
+	const bool used = os_atomic_exchange_bool(&video->texture_used, false);
+
+	if (!video->frame_due)
+		return false;
+
+	return is_main_mix(video) || video->was_active || used;
+}
+
 static inline void output_frame(struct obs_core_video_mix *video)
 {
 	const bool raw_active = video->raw_was_active;
 	const bool gpu_active = video->gpu_was_active;
+	const bool is_canvas = !is_main_mix(video);
+
+	video->texture_fresh = false;
+
+	if (!should_render_mix(video)) {
+		obs->video.canvas_frames_skipped++;
+		obs->video.canvas_render_ns_saved += video->avg_render_ns;
+		return;
+	}
 
+	/* the oldest frame in the ring is read back, giving the GPU
+	 * readback_depth - 1 frames to finish copying it */
 	int cur_texture = video->cur_texture;
-	int prev_texture = cur_texture == 0 ? NUM_TEXTURES - 1 : cur_texture - 1;
+	int read_texture = cur_texture + 1 == video->readback_depth ? 0 : cur_texture + 1;
 	struct video_data frame;
 	bool frame_ready = 0;
 
@@ -882,13 +945,21 @@ static inline void output_frame(struct obs_core_video_mix *video)
 
 	profile_start(output_frame_render_video_name);
 	GS_DEBUG_MARKER_BEGIN(GS_DEBUG_COLOR_RENDER_VIDEO, output_frame_render_video_name);
+	uint64_t render_start = os_gettime_ns();
 	render_video(video, raw_active, gpu_active, cur_texture);
+	uint64_t render_ns = os_gettime_ns() - render_start;
 	GS_DEBUG_MARKER_END();
 	profile_end(output_frame_render_video_name);
 
+	video->texture_fresh = true;
+	if (is_canvas) {
+		video->avg_render_ns = video->avg_render_ns ? (video->avg_render_ns * 7 + render_ns) / 8 : render_ns;
+		obs->video.canvas_frames_rendered++;
+	}
+
 	if (raw_active) {
 		profile_start(output_frame_download_frame_name);
-		frame_ready = download_frame(video, prev_texture, &frame);
+		frame_ready = download_frame(video, read_texture, &frame);
 		profile_end(output_frame_download_frame_name);
 	}
 
@@ -904,12 +975,12 @@ static inline void output_frame(struct obs_core_video_mix *video)
 		deque_pop_front(&video->vframe_info_buffer, &vframe_info, sizeof(vframe_info));
 
 		frame.timestamp = vframe_info.timestamp;
-		profile_start(output_frame_output_video_data_name);
-		output_video_data(video, &frame, vframe_info.count);
-		profile_end(output_frame_output_video_data_name);
+		profile_start(output_frame_queue_video_readback_name);
+		queue_video_readback(video, &frame, vframe_info.count, video->staged_ts[read_texture]);
+		profile_end(output_frame_queue_video_readback_name);
 	}
 
-	if (++video->cur_texture == NUM_TEXTURES)
+	if (++video->cur_texture == video->readback_depth)
 		video->cur_texture = 0;
 }
 
@@ -370,7 +370,7 @@ static bool obs_init_textures(struct obs_core_video_mix *video)
 		break;
 	}
 
-	for (size_t i = 0; i < NUM_TEXTURES; i++) {
+	for (int i = 0; i < video->readback_depth; i++) {
 #ifdef _WIN32
 		if (video->using_nv12_tex) {
 			video->copy_surfaces_encode[i] = gs_stagesurface_create_nv12(info->width, info->height);
@@ -602,27 +602,57 @@ static inline void set_video_matrix(struct obs_core_video_mix *video, struct vid
 	memcpy(video->color_matrix, &mat, sizeof(float) * 16);
 }
 
+/* returns n if main runs at exactly n times the FPS of ovi, 0 otherwise */
+static uint32_t get_frame_divisor(const struct obs_video_info *main_ovi, const struct obs_video_info *ovi)
+{
+	if (!ovi->fps_num || !ovi->fps_den)
+		return 0;
+
+	uint64_t num = (uint64_t)main_ovi->fps_num * ovi->fps_den;
+	uint64_t den = (uint64_t)main_ovi->fps_den * ovi->fps_num;
+
+	if (num < den || num % den != 0)
+		return 0;
+
+	return (uint32_t)(num / den);
+}
+
 static int obs_init_video_mix(struct obs_video_info *ovi, struct obs_core_video_mix *video)
 {
 	struct video_output_info vi;
 
 	pthread_mutex_init_value(&video->gpu_encoder_mutex);
 
-	make_video_info(&vi, ovi);
 	video->ovi = *ovi;
 
-	/* main view graphics thread drives all frame output,
-	 * so share FPS settings for aux views */
+	/* main view graphics thread drives all frame output, so aux views
+	 * either run at an integer fraction of its FPS or share it */
+	video->frame_divisor = 1;
+	video->frame_due = true;
+
 	pthread_mutex_lock(&obs->video.mixes_mutex);
 	size_t num = obs->video.mixes.num;
 	if (num && obs->data.main_canvas->mix) {
 		struct obs_video_info main_ovi = obs->data.main_canvas->mix->ovi;
-		video->ovi.fps_num = main_ovi.fps_num;
-		video->ovi.fps_den = main_ovi.fps_den;
+		uint32_t divisor = get_frame_divisor(&main_ovi, ovi);
+
+		if (divisor) {
+			video->frame_divisor = divisor;
+		} else {
+			if (ovi->fps_num != main_ovi.fps_num || ovi->fps_den != main_ovi.fps_den)
+				blog(LOG_INFO, "Canvas FPS %u/%u is not a fraction of %u/%u, using the main FPS",
+				     ovi->fps_num, ovi->fps_den, main_ovi.fps_num, main_ovi.fps_den);
+
+			video->ovi.fps_num = main_ovi.fps_num;
+			video->ovi.fps_den = main_ovi.fps_den;
+		}
 	}
 	pthread_mutex_unlock(&obs->video.mixes_mutex);
 
+	make_video_info(&vi, &video->ovi);
+
 	video->gpu_conversion = ovi->gpu_conversion;
+	video->readback_depth = obs->video.readback_depth ? (int)obs->video.readback_depth : DEFAULT_READBACK_DEPTH;
 	video->gpu_was_active = false;
 	video->raw_was_active = false;
 	video->was_active = false;
@@ -652,6 +682,9 @@ static int obs_init_video_mix(struct obs_video_info *ovi, struct obs_core_video_
 
 	gs_leave_context();
 
+	if (!init_video_readback(video))
+		blog(LOG_WARNING, "Failed to start the video readback thread, reading back on the graphics thread");
+
 	return OBS_VIDEO_SUCCESS;
 }
 
@@ -708,6 +741,8 @@ static int obs_init_video(struct obs_video_info *ovi)
 	if (!restore_canvases())
 		return OBS_VIDEO_FAIL;
 
+	video->slice_pool = video_slice_pool_create(0);
+
 	int errorcode;
 #ifdef __APPLE__
 	pthread_attr_t attr;
@@ -798,6 +833,8 @@ static void obs_free_render_textures(struct obs_core_video_mix *video)
 void obs_free_video_mix(struct obs_core_video_mix *video)
 {
 	if (video->video) {
+		stop_video_readback(video);
+
 		video_output_close(video->video);
 		video->video = NULL;
 
@@ -850,6 +887,9 @@ static void obs_free_video(void)
 	pthread_mutex_destroy(&obs->video.task_mutex);
 	pthread_mutex_init_value(&obs->video.task_mutex);
 	deque_free(&obs->video.tasks);
+
+	video_slice_pool_destroy(obs->video.slice_pool);
+	obs->video.slice_pool = NULL;
 }
 
 static void obs_free_graphics(void)
@@ -906,17 +946,23 @@ static bool obs_init_audio(struct audio_output_info *ai)
 	int errorcode;
 
 	pthread_mutex_init_value(&audio->monitoring_mutex);
+	pthread_mutex_init_value(&audio->buffering_mutex);
 
 	if (pthread_mutex_init_recursive(&audio->monitoring_mutex) != 0)
 		return false;
 	if (pthread_mutex_init(&audio->task_mutex, NULL) != 0)
 		return false;
+	if (pthread_mutex_init(&audio->buffering_mutex, NULL) != 0)
+		return false;
+
+	audio_headroom_reset(&audio->headroom);
 
 	struct obs_task_info audio_init = {.task = set_audio_thread};
 	deque_push_back(&audio->tasks, &audio_init, sizeof(audio_init));
 
 	audio->monitoring_device_name = bstrdup("Default");
 	audio->monitoring_device_id = bstrdup("default");
+	audio->monitoring_latency_ms = DEFAULT_MONITORING_LATENCY_MS;
 	audio->monitoring_duplicating_source = NULL;
 
 	signal_handler_add(obs->signals, "void deduplication_changed(ptr source)");
@@ -959,6 +1005,7 @@ static void obs_free_audio(void)
 	deque_free(&audio->tasks);
 	pthread_mutex_destroy(&audio->task_mutex);
 	pthread_mutex_destroy(&audio->monitoring_mutex);
+	pthread_mutex_destroy(&audio->buffering_mutex);
 
 	memset(audio, 0, sizeof(struct obs_core_audio));
 }
@@ -1224,12 +1271,19 @@ static bool obs_init(const char *locale, const char *module_config_path, profile
 {
 	obs = bzalloc(sizeof(struct obs_core));
 
+	pthread_mutex_init_value(&obs->deferred_load_mutex);
+	pthread_mutex_init_value(&obs->module_mutex);
 	pthread_mutex_init_value(&obs->audio.monitoring_mutex);
 	pthread_mutex_init_value(&obs->audio.task_mutex);
 	pthread_mutex_init_value(&obs->video.task_mutex);
 	pthread_mutex_init_value(&obs->video.encoder_group_mutex);
 	pthread_mutex_init_value(&obs->video.mixes_mutex);
 
+	if (pthread_mutex_init_recursive(&obs->deferred_load_mutex) != 0)
+		return false;
+	if (pthread_mutex_init_recursive(&obs->module_mutex) != 0)
+		return false;
+
 	obs->name_store_owned = !store;
 	obs->name_store = store ? store : profiler_name_store_create();
 	if (!obs->name_store) {
@@ -1431,6 +1485,8 @@ void obs_shutdown(void)
 	}
 	obs->first_disabled_module = NULL;
 
+	obs_free_deferred_modules();
+
 	obs_free_data();
 	obs_free_audio();
 	obs_free_video();
@@ -1465,6 +1521,8 @@ void obs_shutdown(void)
 	if (obs->name_store_owned)
 		profiler_name_store_free(obs->name_store);
 
+	pthread_mutex_destroy(&obs->deferred_load_mutex);
+	pthread_mutex_destroy(&obs->module_mutex);
 	bfree(obs->module_config_path);
 	bfree(obs->locale);
 	bfree(obs);
@@ -1619,10 +1677,17 @@ bool obs_reset_audio2(const struct obs_audio_info2 *oai)
 		audio->max_buffering_ticks = 45;
 	}
 	audio->fixed_buffer = oai->fixed_buffering;
+	audio->adaptive_buffer = oai->adaptive_buffering && !oai->fixed_buffering;
 
 	int max_buffering_ms =
 		audio->max_buffering_ticks * AUDIO_OUTPUT_FRAMES * SEC_TO_MSEC / (int)oai->samples_per_sec;
 
+	const char *buffering_type = "dynamically increasing";
+	if (audio->fixed_buffer)
+		buffering_type = "fixed";
+	else if (audio->adaptive_buffer)
+		buffering_type = "adaptive";
+
 	ai.name = "Audio";
 	ai.samples_per_sec = oai->samples_per_sec;
 	ai.format = AUDIO_FORMAT_FLOAT_PLANAR;
@@ -1637,7 +1702,7 @@ bool obs_reset_audio2(const struct obs_audio_info2 *oai)
 	     "\tmax buffering:   %d milliseconds\n"
 	     "\tbuffering type:  %s",
 	     (int)ai.samples_per_sec, (int)ai.speakers, max_buffering_ms,
-	     oai->fixed_buffering ? "fixed" : "dynamically increasing");
+	     buffering_type);
 
 	return obs_init_audio(&ai);
 }
@@ -1673,6 +1738,21 @@ float obs_get_video_hdr_nominal_peak_level(void)
 	return video->graphics ? video->hdr_nominal_peak_level : 1000.f;
 }
 
+void obs_set_video_readback_depth(uint32_t depth)
+{
+	if (depth && depth < DEFAULT_READBACK_DEPTH)
+		depth = DEFAULT_READBACK_DEPTH;
+	else if (depth > NUM_TEXTURES)
+		depth = NUM_TEXTURES;
+
+	obs->video.readback_depth = depth;
+}
+
+uint32_t obs_get_video_readback_depth(void)
+{
+	return obs->video.readback_depth ? obs->video.readback_depth : DEFAULT_READBACK_DEPTH;
+}
+
 void obs_set_video_levels(float sdr_white_level, float hdr_nominal_peak_level)
 {
 	struct obs_core_video *video = &obs->video;
@@ -1708,37 +1788,91 @@ bool obs_get_audio_info2(struct obs_audio_info2 *oai2)
 		oai2->samples_per_sec = oai.samples_per_sec;
 		oai2->speakers = oai.speakers;
 		oai2->fixed_buffering = audio->fixed_buffer;
+		oai2->adaptive_buffering = audio->adaptive_buffer;
 		oai2->max_buffering_ms =
 			audio->max_buffering_ticks * AUDIO_OUTPUT_FRAMES * SEC_TO_MSEC / (int)oai2->samples_per_sec;
 		return true;
 	}
 }
 
+uint32_t obs_get_audio_buffering_ms(void)
+{
+	struct obs_core_audio *audio = &obs->audio;
+	uint32_t ms;
+
+	if (!audio->audio)
+		return 0;
+
+	pthread_mutex_lock(&audio->buffering_mutex);
+	ms = audio->buffering_ms;
+	pthread_mutex_unlock(&audio->buffering_mutex);
+	return ms;
+}
+
+size_t obs_get_audio_buffering_history(struct obs_audio_buffering_change *changes, size_t max)
+{
+	struct obs_core_audio *audio = &obs->audio;
+	size_t count;
+
+	if (!audio->audio || !changes)
+		return 0;
+
+	pthread_mutex_lock(&audio->buffering_mutex);
+
+	count = audio->buffering_history_count;
+	if (count > max)
+		count = max;
+
+	/* the most recent changes, oldest first */
+	size_t idx = audio->buffering_history_pos + AUDIO_BUFFERING_HISTORY - count;
+	for (size_t i = 0; i < count; i++)
+		changes[i] = audio->buffering_history[(idx + i) % AUDIO_BUFFERING_HISTORY];
+
+	pthread_mutex_unlock(&audio->buffering_mutex);
+	return count;
+}
+
+
 bool obs_enum_source_types(size_t idx, const char **id)
 {
-	if (idx >= obs->source_types.num)
-		return false;
-	*id = obs->source_types.array[idx].id;
-	return true;
+	bool found = false;
+
+	obs_lock_module_types();
+	if (idx < obs->source_types.num) {
+		*id = obs->source_types.array[idx].id;
+		found = true;
+	}
+	obs_unlock_module_types();
+	return found;
 }
 
 bool obs_enum_input_types(size_t idx, const char **id)
 {
-	if (idx >= obs->input_types.num)
-		return false;
-	*id = obs->input_types.array[idx].id;
-	return true;
+	bool found = false;
+
+	obs_lock_module_types();
+	if (idx < obs->input_types.num) {
+		*id = obs->input_types.array[idx].id;
+		found = true;
+	}
+	obs_unlock_module_types();
+	return found;
 }
 
 bool obs_enum_input_types2(size_t idx, const char **id, const char **unversioned_id)
 {
-	if (idx >= obs->input_types.num)
-		return false;
-	if (id)
-		*id = obs->input_types.array[idx].id;
-	if (unversioned_id)
-		*unversioned_id = obs->input_types.array[idx].unversioned_id;
-	return true;
+	bool found = false;
+
+	obs_lock_module_types();
+	if (idx < obs->input_types.num) {
+		if (id)
+			*id = obs->input_types.array[idx].id;
+		if (unversioned_id)
+			*unversioned_id = obs->input_types.array[idx].unversioned_id;
+		found = true;
+	}
+	obs_unlock_module_types();
+	return found;
 }
 
 const char *obs_get_latest_input_type_id(const char *unversioned_id)
@@ -1766,42 +1900,67 @@ const char *obs_get_latest_input_type_id(const char *unversioned_id)
 
 bool obs_enum_filter_types(size_t idx, const char **id)
 {
-	if (idx >= obs->filter_types.num)
-		return false;
-	*id = obs->filter_types.array[idx].id;
-	return true;
+	bool found = false;
+
+	obs_lock_module_types();
+	if (idx < obs->filter_types.num) {
+		*id = obs->filter_types.array[idx].id;
+		found = true;
+	}
+	obs_unlock_module_types();
+	return found;
 }
 
 bool obs_enum_transition_types(size_t idx, const char **id)
 {
-	if (idx >= obs->transition_types.num)
-		return false;
-	*id = obs->transition_types.array[idx].id;
-	return true;
+	bool found = false;
+
+	obs_lock_module_types();
+	if (idx < obs->transition_types.num) {
+		*id = obs->transition_types.array[idx].id;
+		found = true;
+	}
+	obs_unlock_module_types();
+	return found;
 }
 
 bool obs_enum_output_types(size_t idx, const char **id)
 {
-	if (idx >= obs->output_types.num)
-		return false;
-	*id = obs->output_types.array[idx].id;
-	return true;
+	bool found = false;
+
+	obs_lock_module_types();
+	if (idx < obs->output_types.num) {
+		*id = obs->output_types.array[idx].id;
+		found = true;
+	}
+	obs_unlock_module_types();
+	return found;
 }
 
 bool obs_enum_encoder_types(size_t idx, const char **id)
 {
-	if (idx >= obs->encoder_types.num)
-		return false;
-	*id = obs->encoder_types.array[idx].id;
-	return true;
+	bool found = false;
+
+	obs_lock_module_types();
+	if (idx < obs->encoder_types.num) {
+		*id = obs->encoder_types.array[idx].id;
+		found = true;
+	}
+	obs_unlock_module_types();
+	return found;
 }
 
 bool obs_enum_service_types(size_t idx, const char **id)
 {
-	if (idx >= obs->service_types.num)
-		return false;
-	*id = obs->service_types.array[idx].id;
-	return true;
+	bool found = false;
+
+	obs_lock_module_types();
+	if (idx < obs->service_types.num) {
+		*id = obs->service_types.array[idx].id;
+		found = true;
+	}
+	obs_unlock_module_types();
+	return found;
 }
 
 void obs_enter_graphics(void)
@@ -2177,7 +2336,12 @@ static void obs_render_canvas_texture_internal(obs_canvas_t *canvas, enum gs_ble
 	gs_eparam_t *param;
 
 	video = canvas->mix;
-	if (!video || !video->texture_rendered)
+	if (!video)
+		return;
+
+	os_atomic_set_bool(&video->texture_used, true);
+
+	if (!video->texture_rendered)
 		return;
 
 	const enum gs_color_space source_space = video->render_space;
@@ -2253,32 +2417,42 @@ gs_texture_t *obs_get_main_texture(void)
 	return video->render_texture;
 }
 
-static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_private)
+static inline const char *get_saved_source_id(obs_data_t *source_data)
+{
+	const char *v_id = obs_data_get_string(source_data, "versioned_id");
+	return *v_id ? v_id : obs_data_get_string(source_data, "id");
+}
+
+/* constructs the source without publishing it, safe to call from any thread
+ * for source types with OBS_SOURCE_THREAD_SAFE_CREATE */
+static obs_source_t *obs_load_source_construct(obs_data_t *source_data, bool is_private)
 {
-	obs_data_array_t *filters = obs_data_get_array(source_data, "filters");
 	obs_source_t *source;
 	const char *name = obs_data_get_string(source_data, "name");
 	const char *uuid = obs_data_get_string(source_data, "uuid");
 	const char *id = obs_data_get_string(source_data, "id");
-	const char *v_id = obs_data_get_string(source_data, "versioned_id");
+	const char *v_id = get_saved_source_id(source_data);
 	obs_data_t *settings = obs_data_get_obj(source_data, "settings");
 	obs_data_t *hotkeys = obs_data_get_obj(source_data, "hotkeys");
-	obs_canvas_t *canvas = NULL;
-	double volume;
-	double balance;
-	int64_t sync;
-	uint32_t prev_ver;
-	uint32_t caps;
-	uint32_t flags;
-	uint32_t mixers;
-	int di_order;
-	int di_mode;
-	int monitoring_type;
+	uint32_t prev_ver = (uint32_t)obs_data_get_int(source_data, "prev_ver");
 
-	prev_ver = (uint32_t)obs_data_get_int(source_data, "prev_ver");
+	source = obs_source_construct(v_id, name, uuid, settings, hotkeys, is_private, prev_ver);
 
-	if (!*v_id)
-		v_id = id;
+	if (source && source->owns_info_id) {
+		bfree((void *)source->info.unversioned_id);
+		source->info.unversioned_id = bstrdup(id);
+	}
+
+	obs_data_release(hotkeys);
+	obs_data_release(settings);
+
+	return source;
+}
+
+static obs_canvas_t *obs_load_source_canvas(obs_data_t *source_data)
+{
+	const char *id = obs_data_get_string(source_data, "id");
+	obs_canvas_t *canvas = NULL;
 
 	if (obs_source_type_is_scene(id) || obs_source_type_is_group(id)) {
 		const char *canvas_uuid = obs_data_get_string(source_data, "canvas_uuid");
@@ -2289,16 +2463,26 @@ static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_priva
 		}
 	}
 
-	source = obs_source_create_set_last_ver(canvas, v_id, name, uuid, settings, hotkeys, prev_ver, is_private);
+	return canvas;
+}
 
-	if (source->owns_info_id) {
-		bfree((void *)source->info.unversioned_id);
-		source->info.unversioned_id = bstrdup(id);
-	}
+static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_private);
 
-	obs_canvas_release(canvas);
-	obs_data_release(hotkeys);
+static void obs_load_source_finish(obs_source_t *source, obs_data_t *source_data)
+{
+	obs_data_array_t *filters = obs_data_get_array(source_data, "filters");
+	double volume;
+	double balance;
+	int64_t sync;
+	uint32_t prev_ver;
+	uint32_t caps;
+	uint32_t flags;
+	uint32_t mixers;
+	int di_order;
+	int di_mode;
+	int monitoring_type;
 
+	prev_ver = (uint32_t)obs_data_get_int(source_data, "prev_ver");
 	caps = obs_source_get_output_flags(source);
 
 	obs_data_set_default_double(source_data, "volume", 1.0);
@@ -2378,9 +2562,19 @@ static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_priva
 
 		obs_data_array_release(filters);
 	}
+}
 
-	obs_data_release(settings);
+static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_private)
+{
+	obs_source_t *source = obs_load_source_construct(source_data, is_private);
+	if (!source)
+		return NULL;
+
+	obs_canvas_t *canvas = obs_load_source_canvas(source_data);
+	obs_source_publish(source, canvas);
+	obs_canvas_release(canvas);
 
+	obs_load_source_finish(source, source_data);
 	return source;
 }
 
@@ -2394,10 +2588,99 @@ obs_source_t *obs_load_private_source(obs_data_t *source_data)
 	return obs_load_source_type(source_data, true);
 }
 
+/* ------------------------------------------------------------------------- */
+/* Parallel source construction
+ *
+ * Sources whose type sets OBS_SOURCE_THREAD_SAFE_CREATE are constructed on
+ * worker threads ahead of time.  Publishing them (adding them to the source
+ * lists and sending "source_create"), applying the saved audio/flag state and
+ * loading their filters still happens on the loading thread in the original
+ * order, so the sources and signals seen by the frontend do not change.
+ * Anything that depends on other sources (scene items, sidechains) is only
+ * resolved afterwards by obs_source_load2. */
+
+#define MAX_SOURCE_LOAD_THREADS 8
+
+struct source_load_job {
+	obs_data_t *source_data;
+	obs_source_t *source;
+	os_event_t *constructed;
+};
+
+struct source_load_queue {
+	struct source_load_job *jobs;
+	size_t num;
+	volatile long next;
+};
+
+static void *source_load_thread(void *param)
+{
+	struct source_load_queue *queue = param;
+
+	os_set_thread_name("libobs: source load thread");
+
+	for (;;) {
+		long idx = os_atomic_inc_long(&queue->next) - 1;
+		if ((size_t)idx >= queue->num)
+			break;
+
+		struct source_load_job *job = &queue->jobs[idx];
+		if (!job->constructed)
+			continue;
+
+		job->source = obs_load_source_construct(job->source_data, false);
+		os_event_signal(job->constructed);
+	}
+
+	return NULL;
+}
+
+static inline bool source_create_is_thread_safe(obs_data_t *source_data)
+{
+	return (obs_get_source_output_flags(get_saved_source_id(source_data)) & OBS_SOURCE_THREAD_SAFE_CREATE) != 0;
+}
+
+static size_t prepare_source_load_jobs(struct source_load_job *jobs, obs_data_array_t *array, size_t count)
+{
+	size_t parallel = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		jobs[i].source_data = obs_data_array_item(array, i);
+
+		if (source_create_is_thread_safe(jobs[i].source_data) &&
+		    os_event_init(&jobs[i].constructed, OS_EVENT_TYPE_MANUAL) == 0)
+			parallel++;
+	}
+
+	return parallel;
+}
+
+static obs_source_t *finish_source_load_job(struct source_load_job *job)
+{
+	obs_source_t *source;
+
+	if (!job->constructed)
+		return obs_load_source(job->source_data);
+
+	os_event_wait(job->constructed);
+
+	source = job->source;
+	if (source) {
+		obs_source_publish(source, NULL);
+		obs_load_source_finish(source, job->source_data);
+	}
+
+	return source;
+}
+
 void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb, void *private_data)
 {
+	struct source_load_queue queue = {0};
+	pthread_t threads[MAX_SOURCE_LOAD_THREADS];
+	size_t num_threads = 0;
 	DARRAY(obs_source_t *) sources;
 	size_t count;
+	size_t parallel;
 	size_t i;
 
 	da_init(sources);
@@ -2405,15 +2688,46 @@ void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb, void *priv
 	count = obs_data_array_count(array);
 	da_reserve(sources, count);
 
+	queue.jobs = bzalloc(sizeof(struct source_load_job) * (count ? count : 1));
+	queue.num = count;
+	parallel = prepare_source_load_jobs(queue.jobs, array, count);
+
+	if (parallel > 1) {
+		size_t max_threads = (size_t)os_get_logical_cores();
+		if (max_threads > MAX_SOURCE_LOAD_THREADS)
+			max_threads = MAX_SOURCE_LOAD_THREADS;
+		if (max_threads > parallel)
+			max_threads = parallel;
+
+		for (; num_threads < max_threads; num_threads++) {
+			if (pthread_create(&threads[num_threads], NULL, source_load_thread, &queue) != 0)
+				break;
+		}
+	}
+
+	/* without any worker threads, everything is constructed in order */
+	if (!num_threads) {
+		for (i = 0; i < count; i++) {
+			os_event_destroy(queue.jobs[i].constructed);
+			queue.jobs[i].constructed = NULL;
+		}
+	}
+
 	for (i = 0; i < count; i++) {
-		obs_data_t *source_data = obs_data_array_item(array, i);
-		obs_source_t *source = obs_load_source(source_data);
+		obs_source_t *source = finish_source_load_job(&queue.jobs[i]);
 
 		da_push_back(sources, &source);
 
-		obs_data_release(source_data);
+		obs_data_release(queue.jobs[i].source_data);
 	}
 
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+	for (i = 0; i < count; i++)
+		os_event_destroy(queue.jobs[i].constructed);
+
+	bfree(queue.jobs);
+
 	/* tell sources that we want to load */
 	for (i = 0; i < sources.num; i++) {
 		obs_source_t *source = sources.array[i];
@@ -2434,11 +2748,24 @@ void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb, void *priv
 	da_free(sources);
 }
 
-obs_data_t *obs_save_source(obs_source_t *source)
+static obs_data_t *copy_data(obs_data_t *data)
+{
+	obs_data_t *copy;
+
+	if (!data)
+		return NULL;
+
+	copy = obs_data_create();
+	obs_data_apply(copy, data);
+	return copy;
+}
+
+static obs_data_t *save_source(obs_source_t *source, bool snapshot)
 {
 	obs_data_array_t *filters = obs_data_array_create();
 	obs_data_t *source_data = obs_data_create();
-	obs_data_t *settings = obs_source_get_settings(source);
+	obs_data_t *settings;
+	obs_data_t *private_settings;
 	obs_data_t *hotkey_data = source->context.hotkey_data;
 	obs_data_t *hotkeys;
 	float volume = obs_source_get_volume(source);
@@ -2471,6 +2798,18 @@ obs_data_t *obs_save_source(obs_source_t *source)
 		hotkey_data = hotkeys;
 	}
 
+	/* snapshots must not share any data that can still be modified after
+	 * this call, as they are allowed to be serialized on another thread */
+	if (snapshot) {
+		settings = obs_source_get_settings_snapshot(source);
+		private_settings = copy_data(source->private_settings);
+		hotkey_data = copy_data(hotkey_data);
+	} else {
+		settings = obs_source_get_settings(source);
+		private_settings = obs_data_newref(source->private_settings);
+		hotkey_data = obs_data_newref(hotkey_data);
+	}
+
 	obs_data_set_int(source_data, "prev_ver", LIBOBS_API_VER);
 
 	obs_data_set_string(source_data, "name", name);
@@ -2499,7 +2838,7 @@ obs_data_t *obs_save_source(obs_source_t *source)
 		obs_canvas_release(canvas);
 	}
 
-	obs_data_set_obj(source_data, "private_settings", source->private_settings);
+	obs_data_set_obj(source_data, "private_settings", private_settings);
 
 	if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
 		obs_transition_save(source, source_data);
@@ -2519,7 +2858,7 @@ obs_data_t *obs_save_source(obs_source_t *source)
 	if (filters_copy.num) {
 		for (size_t i = filters_copy.num; i > 0; i--) {
 			obs_source_t *filter = filters_copy.array[i - 1];
-			obs_data_t *filter_data = obs_save_source(filter);
+			obs_data_t *filter_data = save_source(filter, snapshot);
 			obs_data_array_push_back(filters, filter_data);
 			obs_data_release(filter_data);
 			obs_source_release(filter);
@@ -2531,12 +2870,24 @@ obs_data_t *obs_save_source(obs_source_t *source)
 	da_free(filters_copy);
 
 	obs_data_release(settings);
+	obs_data_release(private_settings);
+	obs_data_release(hotkey_data);
 	obs_data_array_release(filters);
 
 	return source_data;
 }
 
-obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb, void *data_)
+obs_data_t *obs_save_source(obs_source_t *source)
+{
+	return save_source(source, false);
+}
+
+obs_data_t *obs_save_source_snapshot(obs_source_t *source)
+{
+	return save_source(source, true);
+}
+
+static obs_data_array_t *save_sources_filtered(obs_save_source_filter_cb cb, void *data_, bool snapshot)
 {
 	struct obs_core_data *data = &obs->data;
 	obs_data_array_t *array;
@@ -2551,7 +2902,7 @@ obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb, void *
 	while (source) {
 		if ((source->info.type != OBS_SOURCE_TYPE_FILTER) != 0 && !source->removed && !source->temp_removed &&
 		    !source->context.private && cb(data_, source)) {
-			obs_data_t *source_data = obs_save_source(source);
+			obs_data_t *source_data = save_source(source, snapshot);
 
 			obs_data_array_push_back(array, source_data);
 			obs_data_release(source_data);
@@ -2565,6 +2916,16 @@ obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb, void *
 	return array;
 }
 
+obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb, void *data)
+{
+	return save_sources_filtered(cb, data, false);
+}
+
+obs_data_array_t *obs_save_sources_filtered_snapshot(obs_save_source_filter_cb cb, void *data)
+{
+	return save_sources_filtered(cb, data, true);
+}
+
 static bool save_source_filter(void *data, obs_source_t *source)
 {
 	UNUSED_PARAMETER(data);
@@ -3018,6 +3379,37 @@ void obs_get_audio_monitoring_device(const char **name, const char **id)
 		*id = obs->audio.monitoring_device_id;
 }
 
+void obs_set_audio_monitoring_mixer(bool enable, uint32_t latency_ms)
+{
+	if (!obs_audio_monitoring_available())
+		return;
+
+	if (!latency_ms)
+		latency_ms = DEFAULT_MONITORING_LATENCY_MS;
+	else if (latency_ms < MIN_MONITORING_LATENCY_MS)
+		latency_ms = MIN_MONITORING_LATENCY_MS;
+
+	pthread_mutex_lock(&obs->audio.monitoring_mutex);
+
+	if (obs->audio.monitoring_mixer == enable && obs->audio.monitoring_latency_ms == latency_ms) {
+		pthread_mutex_unlock(&obs->audio.monitoring_mutex);
+		return;
+	}
+
+	obs->audio.monitoring_mixer = enable;
+	obs->audio.monitoring_latency_ms = latency_ms;
+	pthread_mutex_unlock(&obs->audio.monitoring_mutex);
+
+	obs_reset_audio_monitoring();
+}
+
+bool obs_get_audio_monitoring_mixer(uint32_t *latency_ms)
+{
+	if (latency_ms)
+		*latency_ms = obs->audio.monitoring_latency_ms;
+	return obs->audio.monitoring_mixer;
+}
+
 void obs_add_tick_callback(void (*tick)(void *param, float seconds), void *param)
 {
 	struct tick_callback data = {tick, param};
@@ -3082,6 +3474,21 @@ uint32_t obs_get_lagged_frames(void)
 	return obs->video.lagged_frames;
 }
 
+uint32_t obs_get_canvas_frames_rendered(void)
+{
+	return obs->video.canvas_frames_rendered;
+}
+
+uint32_t obs_get_canvas_frames_skipped(void)
+{
+	return obs->video.canvas_frames_skipped;
+}
+
+uint64_t obs_get_canvas_render_time_saved_ns(void)
+{
+	return obs->video.canvas_render_ns_saved;
+}
+
 struct obs_core_video_mix *get_mix_for_video(video_t *v)
 {
 	struct obs_core_video_mix *result = NULL;
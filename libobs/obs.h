@@ -232,6 +232,15 @@ struct obs_audio_info2 {
 
 	uint32_t max_buffering_ms;
 	bool fixed_buffering;
+
+	/** Drain buffering again once sources have stopped needing it.
+	 * Ignored with fixed buffering. */
+	bool adaptive_buffering;
+};
+
+struct obs_audio_buffering_change {
+	uint64_t timestamp; /**< os_gettime_ns() of the change */
+	uint32_t buffering_ms;
 };
 
 /**
@@ -454,6 +463,15 @@ EXPORT float obs_get_video_sdr_white_level(void);
 /** Gets the HDR nominal peak level, returns 1000.f if no video */
 EXPORT float obs_get_video_hdr_nominal_peak_level(void);
 
+/**
+ * Sets how many frames deep the raw video readback ring is, from 2 to 4.
+ * A deeper ring gives slow drivers more time to finish copying a frame before
+ * it is mapped, at the cost of one frame of output latency per step.  Takes
+ * effect on the next video reset, 0 restores the default.
+ */
+EXPORT void obs_set_video_readback_depth(uint32_t depth);
+EXPORT uint32_t obs_get_video_readback_depth(void);
+
 /** Sets the video levels */
 EXPORT void obs_set_video_levels(float sdr_white_level, float hdr_nominal_peak_level);
 
@@ -466,6 +484,16 @@ EXPORT bool obs_get_audio_info(struct obs_audio_info *oai);
  */
 EXPORT bool obs_get_audio_info2(struct obs_audio_info2 *oai2);
 
+/** Gets how much audio buffering currently delays every output */
+EXPORT uint32_t obs_get_audio_buffering_ms(void);
+
+/**
+ * Copies up to max of the most recent changes to audio buffering into
+ * changes, oldest first, and returns how many were copied.  Only the last
+ * 64 changes are kept.
+ */
+EXPORT size_t obs_get_audio_buffering_history(struct obs_audio_buffering_change *changes, size_t max);
+
 /**
  * Opens a plugin module directly from a specific path.
  *
@@ -574,6 +602,19 @@ EXPORT void obs_add_safe_module(const char *name);
  */
 EXPORT void obs_add_core_module(const char *name);
 
+/**
+ * Enables lazy module loading.  Modules listed in the module cache (stored in
+ * the module config path) are then only loaded once one of the source,
+ * output, encoder or service types they registered is first looked up, e.g.
+ * by obs_source_create.  Types of modules that have not been loaded yet are
+ * not enumerated, so this is meant for applications that do not present the
+ * available types to the user, such as headless renderers.  Types that are
+ * enumerated are sorted by id.
+ *
+ * Must be called before any modules are loaded.
+ */
+EXPORT void obs_set_lazy_module_loading(bool enable);
+
 /** Automatically loads all modules from module paths (convenience function) */
 EXPORT void obs_load_all_modules(void);
 
@@ -829,6 +870,13 @@ EXPORT gs_texture_t *obs_get_main_texture(void);
 /** Saves a source to settings data */
 EXPORT obs_data_t *obs_save_source(obs_source_t *source);
 
+/**
+ * Saves a source to settings data that shares no modifiable data with the
+ * source, so it can safely be serialized on another thread.  The settings of
+ * the source are copied only when they changed since the last snapshot.
+ */
+EXPORT obs_data_t *obs_save_source_snapshot(obs_source_t *source);
+
 /** Loads a source from settings data */
 EXPORT obs_source_t *obs_load_source(obs_data_t *data);
 
@@ -854,6 +902,7 @@ EXPORT obs_data_array_t *obs_save_sources(void);
 
 typedef bool (*obs_save_source_filter_cb)(void *data, obs_source_t *source);
 EXPORT obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb, void *data);
+EXPORT obs_data_array_t *obs_save_sources_filtered_snapshot(obs_save_source_filter_cb cb, void *data);
 
 /** Reset source UUIDs. NOTE: this function is only to be used by the UI and
  *  will be removed in a future version! */
@@ -885,6 +934,16 @@ EXPORT void obs_enum_audio_monitoring_devices(obs_enum_audio_device_cb cb, void
 EXPORT bool obs_set_audio_monitoring_device(const char *name, const char *id);
 EXPORT void obs_get_audio_monitoring_device(const char **name, const char **id);
 
+/**
+ * Mixes every monitored source into a single stream to the monitoring device,
+ * fed from a dedicated thread that holds the device buffer at latency_ms,
+ * instead of opening one stream per source.  0 uses the default latency.
+ * Only supported with PulseAudio, other backends ignore it.  Resets audio
+ * monitoring when changed.
+ */
+EXPORT void obs_set_audio_monitoring_mixer(bool enable, uint32_t latency_ms);
+EXPORT bool obs_get_audio_monitoring_mixer(uint32_t *latency_ms);
+
 EXPORT void obs_add_tick_callback(void (*tick)(void *param, float seconds), void *param);
 EXPORT void obs_remove_tick_callback(void (*tick)(void *param, float seconds), void *param);
 
@@ -913,6 +972,14 @@ EXPORT uint64_t obs_get_frame_interval_ns(void);
 EXPORT uint32_t obs_get_total_frames(void);
 EXPORT uint32_t obs_get_lagged_frames(void);
 
+/** Renders of secondary canvases, and renders skipped because a canvas runs
+ * at a fraction of the main FPS or nothing was using it */
+EXPORT uint32_t obs_get_canvas_frames_rendered(void);
+EXPORT uint32_t obs_get_canvas_frames_skipped(void);
+
+/** Estimated graphics thread time saved by skipped canvas renders */
+EXPORT uint64_t obs_get_canvas_render_time_saved_ns(void);
+
 OBS_DEPRECATED EXPORT bool obs_nv12_tex_active(void);
 OBS_DEPRECATED EXPORT bool obs_p010_tex_active(void);
 
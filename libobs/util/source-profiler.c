@@ -69,6 +69,9 @@ struct profiler_entry {
 	struct ucirclebuf async_frame_ts;
 	/* Timestamps of last N async frames rendered */
 	struct ucirclebuf async_rendered_ts;
+	/* Lateness and queue depth of last N async frames, if reported */
+	struct ucirclebuf async_late;
+	struct ucirclebuf async_queued;
 
 	UT_hash_handle hh;
 };
@@ -174,6 +177,8 @@ static struct profiler_entry *entry_create(const uintptr_t key)
 	ucirclebuf_init(&ent->render_gpu_sum, profiler_samples);
 	ucirclebuf_init(&ent->async_frame_ts, profiler_samples);
 	ucirclebuf_init(&ent->async_rendered_ts, profiler_samples);
+	ucirclebuf_init(&ent->async_late, profiler_samples);
+	ucirclebuf_init(&ent->async_queued, profiler_samples);
 	return ent;
 }
 
@@ -186,6 +191,8 @@ static void entry_destroy(struct profiler_entry *entry)
 	ucirclebuf_free(&entry->render_gpu_sum);
 	ucirclebuf_free(&entry->async_frame_ts);
 	ucirclebuf_free(&entry->async_rendered_ts);
+	ucirclebuf_free(&entry->async_late);
+	ucirclebuf_free(&entry->async_queued);
 	bfree(entry);
 }
 
@@ -412,6 +419,23 @@ void source_profiler_async_frame_received(obs_source_t *source)
 	pthread_rwlock_unlock(&hm_rwlock);
 }
 
+void source_profiler_async_frame_stats(obs_source_t *source, uint64_t late_ns, uint32_t queued)
+{
+	if (!enabled)
+		return;
+
+	pthread_rwlock_wrlock(&hm_rwlock);
+
+	struct profiler_entry *ent;
+	HASH_FIND_PTR(hm_entries, &source, ent);
+	if (ent) {
+		ucirclebuf_push(&ent->async_late, late_ns);
+		ucirclebuf_push(&ent->async_queued, queued);
+	}
+
+	pthread_rwlock_unlock(&hm_rwlock);
+}
+
 uint64_t source_profiler_source_tick_start(void)
 {
 	if (!enabled)
@@ -619,6 +643,51 @@ bool source_profiler_fill_result(obs_source_t *source, struct profiler_result *r
 	return !!ent;
 }
 
+static inline void calculate_queue(struct profiler_entry *ent, struct profiler_async_result *result)
+{
+	uint64_t sum = 0;
+
+	for (size_t idx = 0; idx < ent->async_late.num; idx++) {
+		const uint64_t late = ent->async_late.array[idx];
+		if (!late)
+			continue;
+
+		if (late > result->late_worst)
+			result->late_worst = late;
+		result->late++;
+	}
+
+	for (size_t idx = 0; idx < ent->async_queued.num; idx++) {
+		const uint64_t queued = ent->async_queued.array[idx];
+		if (!idx || queued < result->queue_min)
+			result->queue_min = queued;
+
+		sum += queued;
+	}
+
+	if (ent->async_queued.num)
+		result->queue_avg = (double)sum / (double)ent->async_queued.num;
+}
+
+bool source_profiler_fill_async_result(obs_source_t *source, struct profiler_async_result *result)
+{
+	if (!enabled || !result)
+		return false;
+
+	memset(result, 0, sizeof(struct profiler_async_result));
+
+	pthread_rwlock_rdlock(&hm_rwlock);
+
+	struct profiler_entry *ent = NULL;
+	HASH_FIND_PTR(hm_entries, &source, ent);
+	if (ent)
+		calculate_queue(ent, result);
+
+	pthread_rwlock_unlock(&hm_rwlock);
+
+	return !!ent;
+}
+
 profiler_result_t *source_profiler_get_result(obs_source_t *source)
 {
 	profiler_result_t *ret = bmalloc(sizeof(profiler_result_t));
@@ -51,6 +51,15 @@ typedef struct profiler_result {
 	uint64_t async_rendered_worst;
 } profiler_result_t;
 
+typedef struct profiler_async_result {
+	/* Frames the source reported as late, and how late the worst was in ns */
+	uint64_t late;
+	uint64_t late_worst;
+	/* Average and lowest number of frames the source had queued */
+	double queue_avg;
+	uint64_t queue_min;
+} profiler_async_result_t;
+
 /* Enable/disable profiler (applied on next frame) */
 EXPORT void source_profiler_enable(bool enable);
 /* Enable/disable GPU profiling (applied on next frame) */
@@ -60,6 +69,12 @@ EXPORT void source_profiler_gpu_enable(bool enable);
 EXPORT profiler_result_t *source_profiler_get_result(obs_source_t *source);
 /* Update existing profiler results object for source */
 EXPORT bool source_profiler_fill_result(obs_source_t *source, profiler_result_t *result);
+/* Update existing async frame statistics object for source */
+EXPORT bool source_profiler_fill_async_result(obs_source_t *source, profiler_async_result_t *result);
+
+/* Report how late an async frame was output (0 if on time) and how many
+ * frames the source had ready behind it, from any thread */
+EXPORT void source_profiler_async_frame_stats(obs_source_t *source, uint64_t late_ns, uint32_t queued);
 
 #ifdef __cplusplus
 }
@@ -205,6 +205,9 @@ ScriptsTool::ScriptsTool() : QDialog(nullptr), ui(new Ui_ScriptsTool)
 	config_t *user_config = obs_frontend_get_user_config();
 	int row = config_get_int(user_config, "scripts-tool", "prevScriptRow");
 	ui->scripts->setCurrentRow(row);
+
+	connect(&timingTimer, &QTimer::timeout, this, &ScriptsTool::UpdateTiming);
+	timingTimer.start(1000);
 }
 
 ScriptsTool::~ScriptsTool()
@@ -486,6 +489,7 @@ void ScriptsTool::on_scripts_currentRowChanged(int row)
 		propertiesView->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 		ui->propertiesLayout->addWidget(propertiesView);
 		ui->description->setText(QString());
+		ui->timing->setText(QString());
 		return;
 	}
 
@@ -509,6 +513,8 @@ void ScriptsTool::on_scripts_currentRowChanged(int row)
 
 	ui->propertiesLayout->addWidget(propertiesView);
 	ui->description->setText(obs_script_get_description(script));
+
+	UpdateTiming();
 }
 
 void ScriptsTool::on_defaults_clicked()
@@ -550,6 +556,77 @@ void ScriptsTool::on_description_linkActivated(const QString &link)
 	}
 }
 
+static inline double ns_to_ms(uint64_t ns)
+{
+	return (double)ns / 1000000.0;
+}
+
+void ScriptsTool::UpdateTiming()
+{
+	if (!isVisible()) {
+		return;
+	}
+
+	for (int i = 0; i < ui->scripts->count(); i++) {
+		QListWidgetItem *item = ui->scripts->item(i);
+		QByteArray array = item->data(Qt::UserRole).toString().toUtf8();
+
+		obs_script_t *script = scriptData->FindScript(array.constData());
+		if (!script) {
+			continue;
+		}
+
+		QString text = QT_UTF8(obs_script_get_file(script));
+		if (obs_script_over_budget(script)) {
+			text = QString(obs_module_text("ScriptTiming.Slow")).arg(text);
+		}
+		if (item->text() != text) {
+			item->setText(text);
+		}
+	}
+
+	QListWidgetItem *item = ui->scripts->currentItem();
+	if (!item) {
+		ui->timing->setText(QString());
+		return;
+	}
+
+	QByteArray array = item->data(Qt::UserRole).toString().toUtf8();
+	obs_script_t *script = scriptData->FindScript(array.constData());
+	if (!script) {
+		ui->timing->setText(QString());
+		return;
+	}
+
+	QStringList lines;
+
+	if (obs_script_over_budget(script)) {
+		lines << obs_module_text("ScriptTiming.OverBudget");
+	}
+
+	for (int i = 0; i < OBS_SCRIPT_CALLBACK_COUNT; i++) {
+		enum obs_script_callback_type type = (enum obs_script_callback_type)i;
+		struct obs_script_callback_stats stats;
+
+		if (!obs_script_get_callback_stats(script, type, &stats) || !stats.calls) {
+			continue;
+		}
+
+		lines << QString(obs_module_text("ScriptTiming.Stats"))
+				 .arg(obs_script_callback_type_name(type))
+				 .arg(stats.calls)
+				 .arg(ns_to_ms(stats.total_ns / stats.calls), 0, 'f', 2)
+				 .arg(ns_to_ms(stats.p99_ns), 0, 'f', 2)
+				 .arg(ns_to_ms(stats.max_ns), 0, 'f', 2);
+	}
+
+	if (lines.isEmpty()) {
+		lines << obs_module_text("ScriptTiming.None");
+	}
+
+	ui->timing->setText(lines.join(QStringLiteral("\n")));
+}
+
 /* ----------------------------------------------------------------- */
 
 extern "C" void FreeScripts()
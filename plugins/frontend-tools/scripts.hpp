@@ -2,6 +2,7 @@
 
 #include <QDialog>
 #include <QString>
+#include <QTimer>
 #include <memory>
 
 class Ui_ScriptsTool;
@@ -30,6 +31,7 @@ class ScriptsTool : public QDialog {
 
 	std::unique_ptr<Ui_ScriptsTool> ui;
 	QWidget *propertiesView = nullptr;
+	QTimer timingTimer;
 
 	void updatePythonVersionLabel();
 
@@ -61,4 +63,6 @@ public slots:
 private slots:
 	void on_description_linkActivated(const QString &link);
 	void on_scripts_customContextMenuRequested(const QPoint &pos);
+
+	void UpdateTiming();
 };
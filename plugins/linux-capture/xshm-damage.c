@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/xcb.h>
+
+#include <util/bmem.h>
+
+#include "xshm-damage.h"
+
+bool xshm_damage_init(struct xshm_damage *damage, xcb_connection_t *xcb, xcb_window_t root, int_fast32_t x_org,
+		      int_fast32_t y_org, int_fast32_t width, int_fast32_t height)
+{
+	const xcb_query_extension_reply_t *ext = xcb_get_extension_data(xcb, &xcb_damage_id);
+
+	memset(damage, 0, sizeof(*damage));
+
+	if (!ext || !ext->present)
+		return false;
+
+	xcb_damage_query_version_cookie_t ver_c =
+		xcb_damage_query_version_unchecked(xcb, XCB_DAMAGE_MAJOR_VERSION, XCB_DAMAGE_MINOR_VERSION);
+	xcb_damage_query_version_reply_t *ver_r = xcb_damage_query_version_reply(xcb, ver_c, NULL);
+	if (!ver_r)
+		return false;
+	free(ver_r);
+
+	damage->xcb = xcb;
+	damage->root = root;
+	damage->x_org = x_org;
+	damage->y_org = y_org;
+	damage->width = width;
+	damage->height = height;
+
+	damage->event_base = ext->first_event;
+	damage->damage = xcb_generate_id(xcb);
+	xcb_damage_create(xcb, damage->damage, root, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+
+	damage->region = xcb_generate_id(xcb);
+	xcb_xfixes_create_region(xcb, damage->region, 0, NULL);
+	xcb_flush(xcb);
+	return true;
+}
+
+void xshm_damage_free(struct xshm_damage *damage)
+{
+	if (damage->damage)
+		xcb_damage_destroy(damage->xcb, damage->damage);
+	if (damage->region)
+		xcb_xfixes_destroy_region(damage->xcb, damage->region);
+
+	memset(damage, 0, sizeof(*damage));
+}
+
+bool xshm_damage_add_region(const struct xshm_damage *damage, struct xshm_frame *frame, struct xshm_region region)
+{
+	const size_t capacity = (size_t)damage->width * damage->height * 4;
+
+	region.offset = frame->used;
+	frame->used += (size_t)region.width * region.height * 4;
+	if (frame->used > capacity)
+		return false;
+
+	da_push_back(frame->regions, &region);
+	return true;
+}
+
+bool xshm_damage_fetch(struct xshm_damage *damage, struct xshm_frame *frame)
+{
+	bool damaged = false;
+	xcb_generic_event_t *event;
+
+	while ((event = xcb_poll_for_event(damage->xcb))) {
+		if ((event->response_type & ~0x80) == damage->event_base + XCB_DAMAGE_NOTIFY)
+			damaged = true;
+		free(event);
+	}
+
+	if (!damaged)
+		return true;
+
+	xcb_damage_subtract(damage->xcb, damage->damage, XCB_NONE, damage->region);
+
+	xcb_xfixes_fetch_region_cookie_t region_c = xcb_xfixes_fetch_region_unchecked(damage->xcb, damage->region);
+	xcb_xfixes_fetch_region_reply_t *region_r = xcb_xfixes_fetch_region_reply(damage->xcb, region_c, NULL);
+	if (!region_r)
+		return false;
+
+	xcb_rectangle_t *rects = xcb_xfixes_fetch_region_rectangles(region_r);
+	int count = xcb_xfixes_fetch_region_rectangles_length(region_r);
+	bool ok = true;
+
+	for (int i = 0; i < count; i++) {
+		int_fast32_t x1 = rects[i].x > damage->x_org ? rects[i].x : damage->x_org;
+		int_fast32_t y1 = rects[i].y > damage->y_org ? rects[i].y : damage->y_org;
+		int_fast32_t x2 = rects[i].x + rects[i].width;
+		int_fast32_t y2 = rects[i].y + rects[i].height;
+
+		if (x2 > damage->x_org + damage->width)
+			x2 = damage->x_org + damage->width;
+		if (y2 > damage->y_org + damage->height)
+			y2 = damage->y_org + damage->height;
+		if (x2 <= x1 || y2 <= y1)
+			continue;
+
+		struct xshm_region region = {
+			.x = (int16_t)(x1 - damage->x_org),
+			.y = (int16_t)(y1 - damage->y_org),
+			.width = (uint16_t)(x2 - x1),
+			.height = (uint16_t)(y2 - y1),
+		};
+
+		/* regions carried over from a frame that was never uploaded
+		 * can overlap the new ones and outgrow the segment */
+		if (!xshm_damage_add_region(damage, frame, region)) {
+			ok = false;
+			break;
+		}
+	}
+
+	free(region_r);
+	return ok;
+}
+
+bool xshm_damage_fetch_regions(struct xshm_damage *damage, struct xshm_frame *frame)
+{
+	size_t count = frame->regions.num;
+	xcb_shm_get_image_cookie_t *cookies = bmalloc(count * sizeof(*cookies));
+	bool ok = true;
+
+	/* issue all requests before waiting for the first reply */
+	for (size_t i = 0; i < count; i++) {
+		struct xshm_region *region = frame->regions.array + i;
+		cookies[i] = xcb_shm_get_image_unchecked(damage->xcb, damage->root, damage->x_org + region->x,
+							 damage->y_org + region->y, region->width, region->height, ~0,
+							 XCB_IMAGE_FORMAT_Z_PIXMAP, frame->shm->seg,
+							 (uint32_t)region->offset);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		xcb_shm_get_image_reply_t *img_r = xcb_shm_get_image_reply(damage->xcb, cookies[i], NULL);
+		if (!img_r)
+			ok = false;
+		free(img_r);
+	}
+
+	bfree(cookies);
+	return ok;
+}
+
+bool xshm_damage_fetch_full(struct xshm_damage *damage, struct xshm_frame *frame)
+{
+	xcb_shm_get_image_cookie_t img_c;
+	xcb_shm_get_image_reply_t *img_r;
+
+	da_resize(frame->regions, 0);
+	frame->full = true;
+	frame->used = 0;
+
+	/* anything damaged so far is part of this capture */
+	xcb_damage_subtract(damage->xcb, damage->damage, XCB_NONE, XCB_NONE);
+
+	img_c = xcb_shm_get_image_unchecked(damage->xcb, damage->root, damage->x_org, damage->y_org, damage->width,
+					    damage->height, ~0, XCB_IMAGE_FORMAT_Z_PIXMAP, frame->shm->seg, 0);
+	img_r = xcb_shm_get_image_reply(damage->xcb, img_c, NULL);
+
+	free(img_r);
+	return img_r != NULL;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xcb/damage.h>
+#include <xcb/xfixes.h>
+#include <xcb/xproto.h>
+#include <util/darray.h>
+
+#include "xhelpers.h"
+
+struct xshm_region {
+	int16_t x;
+	int16_t y;
+	uint16_t width;
+	uint16_t height;
+	size_t offset; /* position of the packed pixels in the segment */
+};
+
+/**
+ * Pixels fetched from the X server, waiting to be uploaded
+ *
+ * Either the whole capture area, or only the damaged regions packed one after
+ * another in the shm segment.
+ */
+struct xshm_frame {
+	xcb_shm_t *shm;
+	bool full;
+	size_t used;
+	DARRAY(struct xshm_region) regions;
+};
+
+/**
+ * Damage tracking of an area of the root window
+ */
+struct xshm_damage {
+	xcb_connection_t *xcb;
+	xcb_window_t root;
+
+	int_fast32_t x_org;
+	int_fast32_t y_org;
+	int_fast32_t width;
+	int_fast32_t height;
+
+	uint8_t event_base;
+	xcb_damage_damage_t damage;
+	xcb_xfixes_region_t region;
+};
+
+/**
+ * Start tracking damage to an area of the root window
+ *
+ * The XFixes version has to be negotiated on the connection beforehand.
+ *
+ * @return false if the server does not support the Damage extension
+ */
+bool xshm_damage_init(struct xshm_damage *damage, xcb_connection_t *xcb, xcb_window_t root, int_fast32_t x_org,
+		      int_fast32_t y_org, int_fast32_t width, int_fast32_t height);
+
+/**
+ * Stop tracking damage
+ */
+void xshm_damage_free(struct xshm_damage *damage);
+
+/**
+ * Append a region to a frame, packing its pixels after the previous ones
+ *
+ * @return false if the pixels do not fit into a segment of the capture area
+ */
+bool xshm_damage_add_region(const struct xshm_damage *damage, struct xshm_frame *frame, struct xshm_region region);
+
+/**
+ * Append the parts of the capture area damaged since the last call to a frame
+ *
+ * Regions are relative to the capture area.
+ *
+ * @return false if the frame should be captured in full instead
+ */
+bool xshm_damage_fetch(struct xshm_damage *damage, struct xshm_frame *frame);
+
+/**
+ * Copy the regions of a frame from the X server into its shm segment
+ */
+bool xshm_damage_fetch_regions(struct xshm_damage *damage, struct xshm_frame *frame);
+
+/**
+ * Capture the whole capture area into a frame
+ */
+bool xshm_damage_fetch_full(struct xshm_damage *damage, struct xshm_frame *frame);
+
+#ifdef __cplusplus
+}
+#endif
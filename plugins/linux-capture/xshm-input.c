@@ -18,15 +18,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <xcb/damage.h>
 #include <xcb/randr.h>
 #include <xcb/shm.h>
 #include <xcb/xfixes.h>
 #include <xcb/xinerama.h>
 
+#include <glad/glad.h>
 #include <obs-module.h>
+#include <util/darray.h>
 #include <util/dstr.h>
+#include <util/threading.h>
 #include "xcursor-xcb.h"
 #include "xhelpers.h"
+#include "xshm-damage.h"
 
 #define XSHM_DATA(voidptr) struct xshm_data *data = voidptr;
 
@@ -34,6 +39,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define INVALID_DISPLAY (-1)
 
+#define XSHM_FRAMES 3
+
 struct xshm_data {
 	obs_source_t *source;
 
@@ -65,6 +72,20 @@ struct xshm_data {
 	bool use_xinerama;
 	bool use_randr;
 	bool advanced;
+
+	/* damage tracking, only used when the server supports it */
+	bool use_damage;
+	struct xshm_damage damage;
+
+	pthread_t capture_thread;
+	bool capture_thread_active;
+	volatile bool capture_stop;
+	os_event_t *capture_event;
+
+	pthread_mutex_t frame_mutex;
+	struct xshm_frame frames[XSHM_FRAMES];
+	int pending_frame;
+	int uploading_frame;
 };
 
 /**
@@ -99,9 +120,202 @@ static bool xshm_check_extensions(xcb_connection_t *xcb)
 	if (!xcb_get_extension_data(xcb, &xcb_randr_id)->present)
 		blog(LOG_INFO, "Missing Randr extension !");
 
+	if (!xcb_get_extension_data(xcb, &xcb_damage_id)->present)
+		blog(LOG_INFO, "Missing Damage extension, capturing full frames !");
+
 	return ok;
 }
 
+/**
+ * Pick the frame the capture thread fetches into
+ *
+ * Neither the published frame nor the one being uploaded are ever touched, so
+ * with three frames there is always one left.
+ */
+static int xshm_free_frame(struct xshm_data *data, int pending)
+{
+	for (int i = 0; i < XSHM_FRAMES; i++) {
+		if (i != pending && i != data->uploading_frame)
+			return i;
+	}
+
+	return -1;
+}
+
+/**
+ * Capture thread
+ *
+ * Woken up once per video tick, fetches whatever was damaged since the last
+ * wake up into a free frame and publishes it to the graphics thread.  A
+ * published frame is never taken back.  If it was not uploaded in time, its
+ * regions are fetched again into the new frame, which then replaces it.
+ */
+static void *xshm_capture_thread(void *vptr)
+{
+	XSHM_DATA(vptr);
+	bool first = true;
+
+	os_set_thread_name("xshm-input: capture");
+
+	while (os_event_wait(data->capture_event) == 0) {
+		if (os_atomic_load_bool(&data->capture_stop))
+			break;
+
+		pthread_mutex_lock(&data->frame_mutex);
+		int pending = data->pending_frame;
+		int idx = xshm_free_frame(data, pending);
+		pthread_mutex_unlock(&data->frame_mutex);
+
+		struct xshm_frame *frame = &data->frames[idx];
+		bool full = first;
+		bool ok;
+
+		da_resize(frame->regions, 0);
+		frame->full = false;
+		frame->used = 0;
+
+		/* the graphics thread only reads the published frame, so its
+		 * regions can be read here even if it is being uploaded */
+		if (!full && pending != -1) {
+			const struct xshm_frame *prev = &data->frames[pending];
+
+			full = prev->full;
+			for (size_t i = 0; !full && i < prev->regions.num; i++)
+				full = !xshm_damage_add_region(&data->damage, frame, prev->regions.array[i]);
+		}
+
+		if (!full)
+			full = !xshm_damage_fetch(&data->damage, frame);
+
+		if (full) {
+			ok = xshm_damage_fetch_full(&data->damage, frame);
+		} else if (frame->regions.num) {
+			ok = xshm_damage_fetch_regions(&data->damage, frame);
+		} else {
+			continue;
+		}
+
+		if (!ok) {
+			/* retry everything on the next tick */
+			first = true;
+			continue;
+		}
+
+		first = false;
+
+		pthread_mutex_lock(&data->frame_mutex);
+		data->pending_frame = idx;
+		pthread_mutex_unlock(&data->frame_mutex);
+	}
+
+	return NULL;
+}
+
+/**
+ * Upload the latest frame published by the capture thread, if any
+ *
+ * Damaged regions are written into the texture with glTexSubImage2D, so only
+ * their pixels are transferred.  Linux only has the OpenGL renderer.
+ *
+ * @note requires to be called within the obs graphics context
+ */
+static void xshm_upload_frame(struct xshm_data *data)
+{
+	pthread_mutex_lock(&data->frame_mutex);
+	int idx = data->pending_frame;
+	data->pending_frame = -1;
+	data->uploading_frame = idx;
+	pthread_mutex_unlock(&data->frame_mutex);
+
+	if (idx == -1)
+		return;
+
+	const struct xshm_frame *frame = &data->frames[idx];
+
+	if (frame->full) {
+		gs_texture_set_image(data->texture, frame->shm->data, data->adj_width * 4, false);
+	} else {
+		const GLuint gltex = *(GLuint *)gs_texture_get_obj(data->texture);
+
+		glBindTexture(GL_TEXTURE_2D, gltex);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		for (size_t i = 0; i < frame->regions.num; i++) {
+			const struct xshm_region *region = frame->regions.array + i;
+
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, region->width);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, region->x, region->y, region->width, region->height, GL_BGRA,
+					GL_UNSIGNED_BYTE, frame->shm->data + region->offset);
+		}
+
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	pthread_mutex_lock(&data->frame_mutex);
+	data->uploading_frame = -1;
+	pthread_mutex_unlock(&data->frame_mutex);
+}
+
+/**
+ * Set up damage tracking and start the capture thread
+ *
+ * @return false if the synchronous capture has to be used instead
+ */
+static bool xshm_damage_start(struct xshm_data *data)
+{
+	/* the xfixes version was negotiated by the cursor */
+	if (!xshm_damage_init(&data->damage, data->xcb, data->xcb_screen->root, data->adj_x_org, data->adj_y_org,
+			      data->adj_width, data->adj_height))
+		return false;
+
+	for (size_t i = 0; i < XSHM_FRAMES; i++) {
+		data->frames[i].shm = xshm_xcb_attach(data->xcb, data->adj_width, data->adj_height);
+		if (!data->frames[i].shm)
+			return false;
+	}
+
+	data->pending_frame = -1;
+	data->uploading_frame = -1;
+	data->capture_stop = false;
+
+	if (os_event_init(&data->capture_event, OS_EVENT_TYPE_AUTO) != 0)
+		return false;
+	if (pthread_create(&data->capture_thread, NULL, xshm_capture_thread, data) != 0)
+		return false;
+
+	data->capture_thread_active = true;
+	return true;
+}
+
+/**
+ * Stop the capture thread and release the damage resources
+ */
+static void xshm_damage_stop(struct xshm_data *data)
+{
+	if (data->capture_thread_active) {
+		os_atomic_set_bool(&data->capture_stop, true);
+		os_event_signal(data->capture_event);
+		pthread_join(data->capture_thread, NULL);
+		data->capture_thread_active = false;
+	}
+
+	os_event_destroy(data->capture_event);
+	data->capture_event = NULL;
+
+	xshm_damage_free(&data->damage);
+
+	for (size_t i = 0; i < XSHM_FRAMES; i++) {
+		xshm_xcb_detach(data->frames[i].shm);
+		data->frames[i].shm = NULL;
+		da_free(data->frames[i].regions);
+		data->frames[i].full = false;
+		data->frames[i].used = 0;
+	}
+
+	data->use_damage = false;
+}
+
 /**
  * Update the capture
  *
@@ -197,6 +411,9 @@ static void xshm_capture_stop(struct xshm_data *data)
 
 	obs_leave_graphics();
 
+	if (data->xcb)
+		xshm_damage_stop(data);
+
 	if (data->xshm) {
 		xshm_xcb_detach(data->xshm);
 		data->xshm = NULL;
@@ -247,12 +464,6 @@ static void xshm_capture_start(struct xshm_data *data)
 		goto fail;
 	}
 
-	data->xshm = xshm_xcb_attach(data->xcb, data->adj_width, data->adj_height);
-	if (!data->xshm) {
-		blog(LOG_ERROR, "failed to attach shm !");
-		goto fail;
-	}
-
 	data->cursor = xcb_xcursor_init(data->xcb);
 	xcb_xcursor_offset(data->cursor, data->adj_x_org, data->adj_y_org);
 
@@ -262,6 +473,20 @@ static void xshm_capture_start(struct xshm_data *data)
 
 	obs_leave_graphics();
 
+	data->use_damage = xshm_damage_start(data);
+	if (data->use_damage) {
+		blog(LOG_INFO, "Capturing damaged regions only");
+		return;
+	}
+
+	xshm_damage_stop(data);
+
+	data->xshm = xshm_xcb_attach(data->xcb, data->adj_width, data->adj_height);
+	if (!data->xshm) {
+		blog(LOG_ERROR, "failed to attach shm !");
+		goto fail;
+	}
+
 	return;
 fail:
 	xshm_capture_stop(data);
@@ -465,6 +690,7 @@ static void xshm_destroy(void *vptr)
 
 	xshm_capture_stop(data);
 
+	pthread_mutex_destroy(&data->frame_mutex);
 	bfree(data);
 }
 
@@ -475,6 +701,14 @@ static void *xshm_create(obs_data_t *settings, obs_source_t *source)
 {
 	struct xshm_data *data = bzalloc(sizeof(struct xshm_data));
 	data->source = source;
+	data->pending_frame = -1;
+	data->uploading_frame = -1;
+
+	pthread_mutex_init_value(&data->frame_mutex);
+	if (pthread_mutex_init(&data->frame_mutex, NULL) != 0) {
+		bfree(data);
+		return NULL;
+	}
 
 	xshm_update(data, settings);
 
@@ -494,6 +728,15 @@ static void xshm_video_tick(void *vptr, float seconds)
 	if (!obs_source_showing(data->source))
 		return;
 
+	if (data->use_damage) {
+		os_event_signal(data->capture_event);
+
+		obs_enter_graphics();
+		xcb_xcursor_update(data->xcb, data->cursor);
+		obs_leave_graphics();
+		return;
+	}
+
 	xcb_shm_get_image_cookie_t img_c;
 	xcb_shm_get_image_reply_t *img_r;
 
@@ -529,6 +772,9 @@ static void xshm_video_render(void *vptr, gs_effect_t *effect)
 	if (!data->texture)
 		return;
 
+	if (data->use_damage)
+		xshm_upload_frame(data);
+
 	const bool linear_srgb = gs_get_linear_srgb();
 
 	const bool previous = gs_framebuffer_srgb_enabled();
@@ -15,7 +15,10 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <inttypes.h>
 #include <obs-module.h>
+#include <obs-avc.h>
+#include <util/platform.h>
 #include <linux/videodev2.h>
 #include <libavutil/error.h>
 
@@ -23,7 +26,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define blog(level, msg, ...) blog(level, "v4l2-input: decoder: " msg, ##__VA_ARGS__)
 
-int v4l2_init_decoder(struct v4l2_decoder *decoder, int pixfmt)
+/* frames waiting for a worker, per worker.  h264 frames cannot be dropped on
+ * their own, so its single worker gets more room to ride out a slow frame. */
+#define JOBS_PER_WORKER 2
+#define INTER_CODED_JOBS 8
+#define MAX_AUTO_WORKERS 4
+
+struct v4l2_decode_worker {
+	struct v4l2_decode_pool *pool;
+	struct v4l2_decoder decoder;
+	pthread_t thread;
+	bool thread_active;
+};
+
+int v4l2_init_decoder(struct v4l2_decoder *decoder, int pixfmt, int threads)
 {
 	if (pixfmt == V4L2_PIX_FMT_MJPEG) {
 		decoder->codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
@@ -56,6 +72,14 @@ int v4l2_init_decoder(struct v4l2_decoder *decoder, int pixfmt)
 
 	decoder->context->flags2 |= AV_CODEC_FLAG2_FAST;
 
+	/* frame threading would delay the output by one frame per thread */
+	if (threads > 1) {
+		decoder->context->thread_count = threads;
+		decoder->context->thread_type = FF_THREAD_SLICE;
+	} else {
+		decoder->context->thread_count = 1;
+	}
+
 	if (avcodec_open2(decoder->context, decoder->codec, NULL) < 0) {
 		blog(LOG_ERROR, "failed to open codec");
 		return -1;
@@ -97,7 +121,7 @@ int v4l2_decode_frame(struct obs_source_frame *out, uint8_t *data, size_t length
 	r = avcodec_receive_frame(decoder->context, decoder->frame);
 	if (r == AVERROR(EAGAIN)) {
 		blog(LOG_DEBUG, "failed to receive frame in this state, try to send new frame to codec");
-		return 0;
+		return 1;
 	} else if (r < 0) {
 		blog(LOG_ERROR, "failed to receive frame from codec");
 		return -1;
@@ -130,3 +154,215 @@ int v4l2_decode_frame(struct obs_source_frame *out, uint8_t *data, size_t length
 
 	return 0;
 }
+
+/* the packet keeps its buffer so the next frame of similar size reuses it */
+static inline void release_job(struct v4l2_decode_pool *pool, struct v4l2_decode_job *job)
+{
+	da_push_back(pool->free_packets, &job->packet);
+}
+
+static bool fill_packet(AVPacket *packet, const uint8_t *data, size_t length)
+{
+	if (!packet->buf || !av_buffer_is_writable(packet->buf) ||
+	    (size_t)packet->buf->size < length + AV_INPUT_BUFFER_PADDING_SIZE) {
+		av_packet_unref(packet);
+		if (av_new_packet(packet, (int)length) < 0)
+			return false;
+	} else {
+		packet->data = packet->buf->data;
+		packet->size = (int)length;
+		memset(packet->data + length, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+	}
+
+	memcpy(packet->data, data, length);
+	return true;
+}
+
+static void *decode_thread(void *vptr)
+{
+	struct v4l2_decode_worker *worker = vptr;
+	struct v4l2_decode_pool *pool = worker->pool;
+	struct obs_source_frame out = pool->frame;
+
+	os_set_thread_name("v4l2: decode");
+
+	pthread_mutex_lock(&pool->mutex);
+
+	for (;;) {
+		struct v4l2_decode_job job;
+
+		while (!pool->stop && !pool->jobs.size)
+			pthread_cond_wait(&pool->job_cond, &pool->mutex);
+		if (pool->stop)
+			break;
+
+		deque_pop_front(&pool->jobs, &job, sizeof(job));
+		pthread_mutex_unlock(&pool->mutex);
+
+		int r = v4l2_decode_frame(&out, job.packet->data, job.packet->size, &worker->decoder);
+		if (r < 0)
+			blog(LOG_WARNING, "failed to unpack jpeg or h264, dropping frame");
+		out.timestamp = job.timestamp;
+
+		/* output in capture order, only the worker holding the next
+		 * frame gets past this point */
+		pthread_mutex_lock(&pool->mutex);
+		while (!pool->stop && pool->next_output != job.seq)
+			pthread_cond_wait(&pool->output_cond, &pool->mutex);
+		if (pool->stop) {
+			release_job(pool, &job);
+			break;
+		}
+		pthread_mutex_unlock(&pool->mutex);
+
+		if (r == 0)
+			obs_source_output_video(pool->source, &out);
+
+		pthread_mutex_lock(&pool->mutex);
+		release_job(pool, &job);
+		pool->next_output++;
+		pthread_cond_broadcast(&pool->output_cond);
+	}
+
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+int v4l2_init_decode_pool(struct v4l2_decode_pool *pool, obs_source_t *source, const struct obs_source_frame *frame,
+			  int pixfmt, int threads)
+{
+	pool->source = source;
+	pool->frame = *frame;
+	pool->pixfmt = pixfmt;
+	pool->intra_only = pixfmt == V4L2_PIX_FMT_MJPEG;
+
+	if (threads <= 0) {
+		threads = os_get_logical_cores() / 2;
+		if (threads > MAX_AUTO_WORKERS)
+			threads = MAX_AUTO_WORKERS;
+		if (threads < 1)
+			threads = 1;
+	}
+
+	pthread_mutex_init_value(&pool->mutex);
+	if (pthread_mutex_init(&pool->mutex, NULL) != 0)
+		return -1;
+	if (pthread_cond_init(&pool->job_cond, NULL) != 0)
+		return -1;
+	if (pthread_cond_init(&pool->output_cond, NULL) != 0)
+		return -1;
+
+	/* jpeg frames are independent and can be decoded by separate decoders,
+	 * h264 needs a single decoder that may use slice threads */
+	size_t workers = pixfmt == V4L2_PIX_FMT_MJPEG ? (size_t)threads : 1;
+	int slice_threads = pixfmt == V4L2_PIX_FMT_MJPEG ? 1 : threads;
+
+	pool->max_jobs = pool->intra_only ? workers * JOBS_PER_WORKER : INTER_CODED_JOBS;
+
+	for (size_t i = 0; i < workers; i++) {
+		struct v4l2_decode_worker *worker = bzalloc(sizeof(*worker));
+		worker->pool = pool;
+		da_push_back(pool->workers, &worker);
+
+		if (v4l2_init_decoder(&worker->decoder, pixfmt, slice_threads) < 0)
+			return -1;
+		if (pthread_create(&worker->thread, NULL, decode_thread, worker) != 0)
+			return -1;
+		worker->thread_active = true;
+	}
+
+	blog(LOG_INFO, "decoding with %zu worker(s), %d thread(s) each", workers, slice_threads);
+	return 0;
+}
+
+void v4l2_destroy_decode_pool(struct v4l2_decode_pool *pool)
+{
+	if (!pool->source)
+		return;
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->stop = true;
+	pthread_cond_broadcast(&pool->job_cond);
+	pthread_cond_broadcast(&pool->output_cond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (size_t i = 0; i < pool->workers.num; i++) {
+		struct v4l2_decode_worker *worker = pool->workers.array[i];
+		if (worker->thread_active)
+			pthread_join(worker->thread, NULL);
+		v4l2_destroy_decoder(&worker->decoder);
+		bfree(worker);
+	}
+
+	while (pool->jobs.size) {
+		struct v4l2_decode_job job;
+		deque_pop_front(&pool->jobs, &job, sizeof(job));
+		av_packet_free(&job.packet);
+	}
+	for (size_t i = 0; i < pool->free_packets.num; i++)
+		av_packet_free(&pool->free_packets.array[i]);
+
+	if (pool->dropped)
+		blog(LOG_INFO, "dropped %" PRIu64 " frames while all decode workers were busy", pool->dropped);
+
+	deque_free(&pool->jobs);
+	da_free(pool->free_packets);
+	da_free(pool->workers);
+	pthread_cond_destroy(&pool->output_cond);
+	pthread_cond_destroy(&pool->job_cond);
+	pthread_mutex_destroy(&pool->mutex);
+
+	memset(pool, 0, sizeof(*pool));
+}
+
+bool v4l2_decode_pool_push(struct v4l2_decode_pool *pool, const uint8_t *data, size_t length, uint64_t timestamp)
+{
+	struct v4l2_decode_job job = {.timestamp = timestamp};
+	bool keyframe = !pool->intra_only && obs_avc_keyframe(data, length);
+
+	pthread_mutex_lock(&pool->mutex);
+
+	/* after dropping an h264 frame, the frames referencing it up to the
+	 * next keyframe would only decode into garbage */
+	if (pool->wait_keyframe && !keyframe) {
+		pool->dropped++;
+		pthread_mutex_unlock(&pool->mutex);
+		return false;
+	}
+
+	if (pool->jobs.size / sizeof(job) >= pool->max_jobs) {
+		pool->wait_keyframe = !pool->intra_only;
+		pool->dropped++;
+		pthread_mutex_unlock(&pool->mutex);
+		return false;
+	}
+
+	pool->wait_keyframe = false;
+
+	if (pool->free_packets.num) {
+		job.packet = pool->free_packets.array[pool->free_packets.num - 1];
+		da_pop_back(pool->free_packets);
+	}
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (!job.packet)
+		job.packet = av_packet_alloc();
+	if (!job.packet || !fill_packet(job.packet, data, length)) {
+		av_packet_free(&job.packet);
+
+		pthread_mutex_lock(&pool->mutex);
+		pool->wait_keyframe = !pool->intra_only;
+		pool->dropped++;
+		pthread_mutex_unlock(&pool->mutex);
+		return false;
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	job.seq = pool->next_seq++;
+	deque_push_back(&pool->jobs, &job, sizeof(job));
+	pthread_cond_signal(&pool->job_cond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	return true;
+}
@@ -24,6 +24,10 @@ extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
 #include <libavutil/pixfmt.h>
+#include <obs.h>
+#include <util/deque.h>
+#include <util/darray.h>
+#include <util/threading.h>
 
 /**
  * Data structure for decoder
@@ -41,9 +45,10 @@ struct v4l2_decoder {
  *
  * @param decoder the decoder structure
  * @param pixfmt which codec is used
+ * @param threads number of slice threads libavcodec may use
  * @return non-zero on failure
  */
-int v4l2_init_decoder(struct v4l2_decoder *decoder, int pixfmt);
+int v4l2_init_decoder(struct v4l2_decoder *decoder, int pixfmt, int threads);
 
 /**
  * Free any data associated with the decoder.
@@ -59,10 +64,85 @@ void v4l2_destroy_decoder(struct v4l2_decoder *decoder);
  * @param data the codec data
  * @param length length of the data
  * @param decoder the decoder as initialized by v4l2_init_decoder
- * @return non-zero on failure
+ * @return negative on failure, positive if the decoder did not output a frame
  */
 int v4l2_decode_frame(struct obs_source_frame *out, uint8_t *data, size_t length, struct v4l2_decoder *decoder);
 
+/**
+ * Data structure for a compressed frame waiting to be decoded
+ */
+struct v4l2_decode_job {
+	AVPacket *packet;
+	uint64_t timestamp;
+	uint64_t seq;
+};
+
+/**
+ * Data structure for the decode stage
+ *
+ * Compressed frames are copied out of the v4l2 buffers so these can be
+ * queued back to the driver right away. The workers decode in parallel, each
+ * with its own decoder, and output the frames in capture order.
+ */
+struct v4l2_decode_pool {
+	obs_source_t *source;
+	struct obs_source_frame frame;
+	int pixfmt;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t job_cond;
+	pthread_cond_t output_cond;
+	bool stop;
+
+	struct deque jobs;
+	size_t max_jobs;
+	bool intra_only;
+	bool wait_keyframe;
+	uint64_t next_seq;
+	uint64_t next_output;
+	uint64_t dropped;
+
+	DARRAY(struct v4l2_decode_worker *) workers;
+	DARRAY(AVPacket *) free_packets;
+};
+
+/**
+ * Start the decode workers.
+ * The pool must be destroyed on failure.
+ *
+ * @param pool the pool structure, zero initialized
+ * @param source the source the decoded frames are output to
+ * @param frame prepared obs frame, the planes are filled in by the decoder
+ * @param pixfmt which codec is used
+ * @param threads number of decode threads, 0 to pick automatically
+ * @return non-zero on failure
+ */
+int v4l2_init_decode_pool(struct v4l2_decode_pool *pool, obs_source_t *source, const struct obs_source_frame *frame,
+			  int pixfmt, int threads);
+
+/**
+ * Stop the workers and free any data associated with the pool.
+ *
+ * @param pool the pool structure
+ */
+void v4l2_destroy_decode_pool(struct v4l2_decode_pool *pool);
+
+/**
+ * Queue a compressed frame for decoding
+ *
+ * The data is copied, so the v4l2 buffer can be queued again as soon as
+ * this returns. If all workers are busy and the queue is full the frame is
+ * dropped. For h264, frames depend on the previous ones, so everything up to
+ * the next keyframe is dropped along with it.
+ *
+ * @param pool the pool structure
+ * @param data the codec data
+ * @param length length of the data
+ * @param timestamp timestamp of the frame
+ * @return false if the frame was dropped
+ */
+bool v4l2_decode_pool_push(struct v4l2_decode_pool *pool, const uint8_t *data, size_t length, uint64_t timestamp);
+
 #ifdef __cplusplus
 }
 #endif
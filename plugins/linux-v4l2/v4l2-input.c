@@ -76,12 +76,13 @@ struct v4l2_data {
 	int64_t resolution;
 	int64_t framerate;
 	int color_range;
+	int decode_threads;
 
 	/* internal data */
 	obs_source_t *source;
 	pthread_t thread;
 	os_event_t *event;
-	struct v4l2_decoder decoder;
+	struct v4l2_decode_pool decode_pool;
 
 	bool framerate_unchanged;
 	bool resolution_unchanged;
@@ -259,15 +260,14 @@ static void *v4l2_thread(void *vptr)
 		start = (uint8_t *)data->buffers.info[buf.index].start;
 
 		if (data->pixfmt == V4L2_PIX_FMT_MJPEG || data->pixfmt == V4L2_PIX_FMT_H264) {
-			if (v4l2_decode_frame(&out, start, buf.bytesused, &data->decoder) < 0) {
-				blog(LOG_ERROR, "failed to unpack jpeg or h264");
-				break;
-			}
+			/* decoded and output by the decode workers */
+			if (!v4l2_decode_pool_push(&data->decode_pool, start, buf.bytesused, out.timestamp))
+				blog(LOG_DEBUG, "%s: decoder busy, dropping frame", data->device_id);
 		} else {
 			for (uint_fast32_t i = 0; i < MAX_AV_PLANES; ++i)
 				out.data[i] = start + plane_offsets[i];
+			obs_source_output_video(data->source, &out);
 		}
-		obs_source_output_video(data->source, &out);
 
 	continue_queue_buffer:
 		if (v4l2_ioctl(data->dev, VIDIOC_QBUF, &buf) < 0) {
@@ -303,6 +303,7 @@ static void v4l2_defaults(obs_data_t *settings)
 	obs_data_set_default_bool(settings, "buffering", true);
 	obs_data_set_default_bool(settings, "auto_reset", false);
 	obs_data_set_default_int(settings, "timeout_frames", 5);
+	obs_data_set_default_int(settings, "decode_threads", 0);
 }
 
 /**
@@ -813,6 +814,10 @@ static obs_properties_t *v4l2_properties(void *vptr)
 
 	obs_properties_add_int(props, "timeout_frames", obs_module_text("FramesUntilTimeout"), 2, 120, 1);
 
+	obs_property_t *decode_threads =
+		obs_properties_add_int(props, "decode_threads", obs_module_text("DecodeThreads"), 0, 16, 1);
+	obs_property_set_long_description(decode_threads, obs_module_text("DecodeThreads.ToolTip"));
+
 	// a group to contain the camera control
 	obs_properties_t *ctrl_props = obs_properties_create();
 	obs_properties_add_group(props, "controls", obs_module_text("CameraCtrls"), OBS_GROUP_NORMAL, ctrl_props);
@@ -838,9 +843,7 @@ static void v4l2_terminate(struct v4l2_data *data)
 		data->thread = 0;
 	}
 
-	if (data->pixfmt == V4L2_PIX_FMT_MJPEG || data->pixfmt == V4L2_PIX_FMT_H264) {
-		v4l2_destroy_decoder(&data->decoder);
-	}
+	v4l2_destroy_decode_pool(&data->decode_pool);
 	v4l2_destroy_mmap(&data->buffers);
 
 	if (data->dev != -1) {
@@ -959,7 +962,12 @@ static void v4l2_init(struct v4l2_data *data)
 	}
 
 	if (data->pixfmt == V4L2_PIX_FMT_MJPEG || data->pixfmt == V4L2_PIX_FMT_H264) {
-		if (v4l2_init_decoder(&data->decoder, data->pixfmt) < 0) {
+		struct obs_source_frame frame;
+		size_t plane_offsets[MAX_AV_PLANES];
+
+		v4l2_prep_obs_frame(data, &frame, plane_offsets);
+		if (v4l2_init_decode_pool(&data->decode_pool, data->source, &frame, data->pixfmt,
+					  data->decode_threads) < 0) {
 			blog(LOG_ERROR, "Failed to initialize decoder");
 			goto fail;
 		}
@@ -1020,6 +1028,7 @@ static bool v4l2_settings_changed(struct v4l2_data *data, obs_data_t *settings)
 		}
 
 		res |= data->color_range != obs_data_get_int(settings, "color_range");
+		res |= data->decode_threads != obs_data_get_int(settings, "decode_threads");
 	} else {
 		res = true;
 	}
@@ -1055,6 +1064,7 @@ static void v4l2_update(void *vptr, obs_data_t *settings)
 	data->resolution = obs_data_get_int(settings, "resolution");
 	data->framerate = obs_data_get_int(settings, "framerate");
 	data->color_range = obs_data_get_int(settings, "color_range");
+	data->decode_threads = obs_data_get_int(settings, "decode_threads");
 	data->auto_reset = obs_data_get_bool(settings, "auto_reset");
 	data->timeout_frames = obs_data_get_int(settings, "timeout_frames");
 
@@ -42,6 +42,7 @@ struct ffmpeg_source {
 	char *ffmpeg_options;
 	int buffering_mb;
 	int speed_percent;
+	int decode_ahead;
 	bool is_looping;
 	bool is_local_file;
 	bool is_hw_decoding;
@@ -54,6 +55,15 @@ struct ffmpeg_source {
 	bool is_track_matte;
 	bool log_changes;
 
+	/* playlist of local files, the next one is opened while the current
+	 * one plays.  Guarded by playlist_mutex once media is playing, as the
+	 * media thread moves through it. */
+	pthread_mutex_t playlist_mutex;
+	DARRAY(char *) playlist;
+	size_t playlist_idx;
+	size_t playlist_next;
+	size_t playlist_failures;
+
 	pthread_t reconnect_thread;
 	pthread_mutex_t reconnect_mutex;
 	bool reconnect_thread_valid;
@@ -98,16 +108,20 @@ static bool is_local_file_modified(obs_properties_t *props, obs_property_t *prop
 	obs_property_t *input_format = obs_properties_get(props, "input_format");
 	obs_property_t *local_file = obs_properties_get(props, "local_file");
 	obs_property_t *looping = obs_properties_get(props, "looping");
+	obs_property_t *playlist = obs_properties_get(props, "playlist");
 	obs_property_t *buffering = obs_properties_get(props, "buffering_mb");
 	obs_property_t *seekable = obs_properties_get(props, "seekable");
 	obs_property_t *speed = obs_properties_get(props, "speed_percent");
+	obs_property_t *decode_ahead = obs_properties_get(props, "decode_ahead_frames");
 	obs_property_t *reconnect_delay_sec = obs_properties_get(props, "reconnect_delay_sec");
 	obs_property_set_visible(input, !enabled);
 	obs_property_set_visible(input_format, !enabled);
 	obs_property_set_visible(buffering, !enabled);
 	obs_property_set_visible(local_file, enabled);
 	obs_property_set_visible(looping, enabled);
+	obs_property_set_visible(playlist, enabled);
 	obs_property_set_visible(speed, enabled);
+	obs_property_set_visible(decode_ahead, enabled);
 	obs_property_set_visible(seekable, !enabled);
 	obs_property_set_visible(reconnect_delay_sec, !enabled);
 
@@ -124,6 +138,7 @@ static void ffmpeg_source_defaults(obs_data_t *settings)
 	obs_data_set_default_int(settings, "reconnect_delay_sec", 10);
 	obs_data_set_default_int(settings, "buffering_mb", 2);
 	obs_data_set_default_int(settings, "speed_percent", 100);
+	obs_data_set_default_int(settings, "decode_ahead_frames", 8);
 	obs_data_set_default_bool(settings, "log_changes", true);
 }
 
@@ -169,6 +184,10 @@ static obs_properties_t *ffmpeg_source_getproperties(void *data)
 
 	obs_properties_add_path(props, "local_file", obs_module_text("LocalFile"), OBS_PATH_FILE, filter.array,
 				path.array);
+
+	prop = obs_properties_add_editable_list(props, "playlist", obs_module_text("Playlist"),
+						OBS_EDITABLE_LIST_TYPE_FILES, filter.array, path.array);
+	obs_property_set_long_description(prop, obs_module_text("Playlist.ToolTip"));
 	dstr_free(&filter);
 	dstr_free(&path);
 
@@ -198,6 +217,10 @@ static obs_properties_t *ffmpeg_source_getproperties(void *data)
 	prop = obs_properties_add_int_slider(props, "speed_percent", obs_module_text("SpeedPercentage"), 1, 200, 1);
 	obs_property_int_set_suffix(prop, "%");
 
+	prop = obs_properties_add_int_slider(props, "decode_ahead_frames", obs_module_text("DecodeAheadFrames"), 0, 60,
+					     1);
+	obs_property_set_long_description(prop, obs_module_text("DecodeAheadFrames.ToolTip"));
+
 	prop = obs_properties_add_list(props, "color_range", obs_module_text("ColorRange"), OBS_COMBO_TYPE_LIST,
 				       OBS_COMBO_FORMAT_INT);
 	obs_property_list_add_int(prop, obs_module_text("ColorRange.Auto"), VIDEO_RANGE_DEFAULT);
@@ -287,20 +310,85 @@ static void media_stopped(void *opaque)
 	}
 }
 
+static inline bool has_playlist(const struct ffmpeg_source *s)
+{
+	return s->is_local_file && s->playlist.num > 0;
+}
+
+/* with several items, looping wraps the playlist around instead */
+static inline bool media_is_looping(const struct ffmpeg_source *s)
+{
+	return s->is_looping && s->playlist.num <= 1;
+}
+
+static void queue_next_item(struct ffmpeg_source *s, size_t after)
+{
+	size_t idx = after + 1;
+
+	if (idx == s->playlist.num) {
+		if (!s->is_looping || s->playlist.num == 1) {
+			media_playback_set_next(s->media, NULL);
+			return;
+		}
+		idx = 0;
+	}
+
+	s->playlist_next = idx;
+	media_playback_set_next(s->media, s->playlist.array[idx]);
+}
+
+/* called from the media thread once it moved on to the queued item */
+static void next_item(void *opaque, bool success)
+{
+	struct ffmpeg_source *s = opaque;
+
+	pthread_mutex_lock(&s->playlist_mutex);
+
+	if (success) {
+		s->playlist_idx = s->playlist_next;
+		s->playlist_failures = 0;
+	} else if (++s->playlist_failures >= s->playlist.num) {
+		FF_BLOG(LOG_WARNING, "None of the playlist items could be opened");
+		pthread_mutex_unlock(&s->playlist_mutex);
+		return;
+	}
+
+	queue_next_item(s, s->playlist_next);
+	pthread_mutex_unlock(&s->playlist_mutex);
+}
+
+static void free_playlist(struct ffmpeg_source *s)
+{
+	for (size_t i = 0; i < s->playlist.num; i++)
+		bfree(s->playlist.array[i]);
+	da_free(s->playlist);
+}
+
 static void ffmpeg_source_open(struct ffmpeg_source *s)
 {
-	if (s->input && *s->input) {
+	const char *input = s->input;
+
+	if (has_playlist(s)) {
+		s->playlist_idx = 0;
+		s->playlist_failures = 0;
+		input = s->playlist.array[0];
+	}
+
+	if (input && *input) {
 		struct mp_media_info info = {
 			.opaque = s,
+			.source = s->source,
 			.v_cb = get_frame,
 			.v_preload_cb = preload_frame,
 			.v_seek_cb = seek_frame,
 			.a_cb = get_audio,
 			.stop_cb = media_stopped,
-			.path = s->input,
+			.next_cb = has_playlist(s) ? next_item : NULL,
+			.path = input,
 			.format = s->input_format,
 			.buffering = s->buffering_mb * 1024 * 1024,
 			.speed = s->speed_percent,
+			.decode_ahead = s->decode_ahead,
 			.force_range = s->range,
 			.is_linear_alpha = s->is_linear_alpha,
 			.hardware_decoding = s->is_hw_decoding,
@@ -308,22 +396,38 @@ static void ffmpeg_source_open(struct ffmpeg_source *s)
 			.is_local_file = s->is_local_file || s->seekable,
 			.reconnecting = s->reconnecting,
 			.request_preload = s->is_stinger,
-			.full_decode = s->full_decode,
+			.full_decode = s->full_decode && !has_playlist(s),
 		};
 
 		s->media = media_playback_create(&info);
+
+		if (s->media && has_playlist(s)) {
+			pthread_mutex_lock(&s->playlist_mutex);
+			queue_next_item(s, 0);
+			pthread_mutex_unlock(&s->playlist_mutex);
+		}
 	}
 }
 
 static void ffmpeg_source_start(struct ffmpeg_source *s)
 {
+	/* restarting a playlist starts it from the first item */
+	pthread_mutex_lock(&s->playlist_mutex);
+	bool rewind = s->media && has_playlist(s) && s->playlist_idx != 0;
+	pthread_mutex_unlock(&s->playlist_mutex);
+
+	if (rewind) {
+		media_playback_destroy(s->media);
+		s->media = NULL;
+	}
+
 	if (!s->media)
 		ffmpeg_source_open(s);
 
 	if (!s->media)
 		return;
 
-	media_playback_play(s->media, s->is_looping, s->reconnecting);
+	media_playback_play(s->media, media_is_looping(s), s->reconnecting);
 	if (s->is_local_file && media_playback_has_video(s->media) && (s->is_clear_on_media_end || s->is_looping))
 		obs_source_show_preloaded_video(s->source);
 	else
@@ -406,8 +510,11 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 	enum video_range_type range;
 	bool is_linear_alpha;
 	int speed_percent;
+	int decode_ahead;
 	bool is_looping;
+	DARRAY(char *) playlist;
 
+	da_init(playlist);
 	bfree(s->input_format);
 
 	if (is_local_file) {
@@ -415,8 +522,28 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 		input_format = NULL;
 		is_looping = obs_data_get_bool(settings, "looping");
 
+		obs_data_array_t *array = obs_data_get_array(settings, "playlist");
+		size_t count = obs_data_array_count(array);
+
+		for (size_t i = 0; i < count; i++) {
+			obs_data_t *item = obs_data_array_item(array, i);
+			const char *path = obs_data_get_string(item, "value");
+			if (path && *path) {
+				char *copy = bstrdup(path);
+				da_push_back(playlist, &copy);
+			}
+			obs_data_release(item);
+		}
+
+		obs_data_array_release(array);
+
 		if (s->input && !should_restart_media)
 			should_restart_media |= strcmp(s->input, input) != 0;
+
+		if (!should_restart_media && playlist.num != s->playlist.num)
+			should_restart_media = true;
+		for (size_t i = 0; i < playlist.num && !should_restart_media; i++)
+			should_restart_media |= strcmp(playlist.array[i], s->playlist.array[i]) != 0;
 	} else {
 		should_restart_media = true;
 		input = obs_data_get_string(settings, "input");
@@ -433,10 +560,12 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 	speed_percent = (int)obs_data_get_int(settings, "speed_percent");
 	if (speed_percent < 1 || speed_percent > 200)
 		speed_percent = 100;
+	decode_ahead = (int)obs_data_get_int(settings, "decode_ahead_frames");
 	ffmpeg_options = obs_data_get_string(settings, "ffmpeg_options");
 
 	/* Restart media source if these properties are changed */
 	if (s->is_hw_decoding != is_hw_decoding || s->range != range || s->speed_percent != speed_percent ||
+	    s->decode_ahead != decode_ahead ||
 	    (s->ffmpeg_options && strcmp(s->ffmpeg_options, ffmpeg_options) != 0))
 		should_restart_media = true;
 
@@ -465,6 +594,7 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 	s->is_linear_alpha = is_linear_alpha;
 	s->buffering_mb = (int)obs_data_get_int(settings, "buffering_mb");
 	s->speed_percent = speed_percent;
+	s->decode_ahead = decode_ahead;
 	s->is_local_file = is_local_file;
 	s->seekable = obs_data_get_bool(settings, "seekable");
 	s->ffmpeg_options = ffmpeg_options ? bstrdup(ffmpeg_options) : NULL;
@@ -480,10 +610,30 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 		s->media = NULL;
 	}
 
+	/* the media thread only reads the playlist while media is open */
+	pthread_mutex_lock(&s->playlist_mutex);
+	if (should_restart_media || !s->media) {
+		free_playlist(s);
+		memcpy(&s->playlist, &playlist, sizeof(playlist));
+	} else {
+		for (size_t i = 0; i < playlist.num; i++)
+			bfree(playlist.array[i]);
+		da_free(playlist);
+	}
+	pthread_mutex_unlock(&s->playlist_mutex);
+
 	/* directly set options if media is playing */
 	if (s->media) {
-		media_playback_set_looping(s->media, is_looping);
+		media_playback_set_looping(s->media, media_is_looping(s));
 		media_playback_set_is_linear_alpha(s->media, is_linear_alpha);
+
+		/* looping decides whether the last item is followed by the
+		 * first one */
+		if (has_playlist(s)) {
+			pthread_mutex_lock(&s->playlist_mutex);
+			queue_next_item(s, s->playlist_idx);
+			pthread_mutex_unlock(&s->playlist_mutex);
+		}
 	}
 	if ((!s->close_when_inactive || active) && should_restart_media)
 		ffmpeg_source_open(s);
@@ -611,6 +761,14 @@ static void *ffmpeg_source_create(obs_data_t *settings, obs_source_t *source)
 		return NULL;
 	}
 
+	if (pthread_mutex_init(&s->playlist_mutex, NULL)) {
+		FF_BLOG(LOG_ERROR, "Failed to initialize playlist mutex");
+		pthread_mutex_destroy(&s->reconnect_mutex);
+		os_event_destroy(s->reconnect_stop_event);
+		bfree(s);
+		return NULL;
+	}
+
 	s->hotkey = obs_hotkey_register_source(source, "MediaSource.Restart", obs_module_text("RestartMedia"),
 					       restart_hotkey, s);
 
@@ -644,7 +802,9 @@ static void ffmpeg_source_destroy(void *data)
 		media_playback_destroy(s->media);
 
 	pthread_mutex_destroy(&s->reconnect_mutex);
+	pthread_mutex_destroy(&s->playlist_mutex);
 	os_event_destroy(s->reconnect_stop_event);
+	free_playlist(s);
 	bfree(s->input);
 	bfree(s->input_format);
 	bfree(s->ffmpeg_options);
@@ -764,6 +924,39 @@ static void missing_file_callback(void *src, const char *new_path, void *data)
 	UNUSED_PARAMETER(data);
 }
 
+static void missing_playlist_item_callback(void *src, const char *new_path, void *data)
+{
+	struct ffmpeg_source *s = src;
+	const char *orig_path = data;
+
+	obs_source_t *source = s->source;
+	obs_data_t *settings = obs_source_get_settings(source);
+	obs_data_array_t *array = obs_data_get_array(settings, "playlist");
+
+	size_t count = obs_data_array_count(array);
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+		const char *path = obs_data_get_string(item, "value");
+
+		if (strcmp(path, orig_path) == 0) {
+			if (new_path && *new_path)
+				obs_data_set_string(item, "value", new_path);
+			else
+				obs_data_array_erase(array, i);
+
+			obs_data_release(item);
+			break;
+		}
+
+		obs_data_release(item);
+	}
+
+	obs_source_update(source, settings);
+
+	obs_data_array_release(array);
+	obs_data_release(settings);
+}
+
 static obs_missing_files_t *ffmpeg_source_missingfiles(void *data)
 {
 	struct ffmpeg_source *s = data;
@@ -778,6 +971,30 @@ static obs_missing_files_t *ffmpeg_source_missingfiles(void *data)
 		}
 	}
 
+	if (s->is_local_file) {
+		obs_data_t *settings = obs_source_get_settings(s->source);
+		obs_data_array_t *array = obs_data_get_array(settings, "playlist");
+
+		size_t count = obs_data_array_count(array);
+		for (size_t i = 0; i < count; i++) {
+			obs_data_t *item = obs_data_array_item(array, i);
+			const char *path = obs_data_get_string(item, "value");
+
+			if (*path && !os_file_exists(path)) {
+				obs_missing_file_t *file =
+					obs_missing_file_create(path, missing_playlist_item_callback,
+								OBS_MISSING_FILE_SOURCE, s->source, (void *)path);
+
+				obs_missing_files_add_file(files, file);
+			}
+
+			obs_data_release(item);
+		}
+
+		obs_data_array_release(array);
+		obs_data_release(settings);
+	}
+
 	return files;
 }
 
@@ -305,123 +305,151 @@ void flv_meta_data(obs_output_t *context, uint8_t **output, size_t *size, bool w
 static int32_t last_time = 0;
 #endif
 
-static void flv_video(struct serializer *s, int32_t dts_offset, struct encoder_packet *packet, bool is_header)
+static size_t tag_prefix_write(void *param, const void *data, size_t size)
 {
-	int32_t ct_offset_ms = get_ms_time(packet, packet->pts) - get_ms_time(packet, packet->dts);
-	int32_t time_ms = get_ms_time(packet, packet->dts) - dts_offset;
+	struct flv_tag *tag = param;
 
-	if (!packet->data || !packet->size)
-		return;
+	if (tag->prefix_size + size > sizeof(tag->prefix))
+		return 0;
 
-	s_w8(s, RTMP_PACKET_TYPE_VIDEO);
+	memcpy(tag->prefix + tag->prefix_size, data, size);
+	tag->prefix_size += size;
+	return size;
+}
 
-#ifdef DEBUG_TIMESTAMPS
-	blog(LOG_DEBUG, "Video: %lu", time_ms);
+static int64_t tag_prefix_get_pos(void *param)
+{
+	struct flv_tag *tag = param;
+	return (int64_t)tag->prefix_size;
+}
 
-	if (last_time > time_ms)
-		blog(LOG_DEBUG, "Non-monotonic");
+static void tag_prefix_serializer_init(struct serializer *s, struct flv_tag *tag)
+{
+	memset(s, 0, sizeof(*s));
+	s->data = tag;
+	s->write = tag_prefix_write;
+	s->get_pos = tag_prefix_get_pos;
 
-	last_time = time_ms;
-#endif
+	tag->prefix_size = 0;
+}
 
-	s_wb24(s, (uint32_t)packet->size + 5);
-	s_wb24(s, (uint32_t)time_ms);
-	s_w8(s, (time_ms >> 24) & 0x7F);
+static void write_flv_tag(struct serializer *s, const struct flv_tag *tag, struct encoder_packet *packet)
+{
+	s_w8(s, tag->type);
+	s_wb24(s, (uint32_t)(tag->prefix_size + packet->size));
+	s_wtimestamp(s, tag->time_ms);
 	s_wb24(s, 0);
 
-	/* these are the 5 extra bytes mentioned above */
-	s_w8(s, packet->keyframe ? 0x17 : 0x27);
-	s_w8(s, is_header ? 0 : 1);
-	s_wb24(s, ct_offset_ms);
+	s_write(s, tag->prefix, tag->prefix_size);
 	s_write(s, packet->data, packet->size);
 
 	write_previous_tag_size(s);
 }
 
-static void flv_audio(struct serializer *s, int32_t dts_offset, struct encoder_packet *packet, bool is_header)
+static void flv_packet_serialize(const struct flv_tag *tag, struct encoder_packet *packet, uint8_t **output,
+				 size_t *size)
 {
-	int32_t time_ms = get_ms_time(packet, packet->dts) - dts_offset;
+	struct array_output_data data;
+	struct serializer s;
 
-	if (!packet->data || !packet->size)
-		return;
+	array_output_serializer_init(&s, &data);
+	write_flv_tag(&s, tag, packet);
 
-	s_w8(s, RTMP_PACKET_TYPE_AUDIO);
+	*output = data.bytes.array;
+	*size = data.bytes.num;
+}
 
 #ifdef DEBUG_TIMESTAMPS
-	blog(LOG_DEBUG, "Audio: %lu", time_ms);
+static void debug_timestamp(const char *type, int32_t time_ms)
+{
+	blog(LOG_DEBUG, "%s: %lu", type, time_ms);
 
 	if (last_time > time_ms)
 		blog(LOG_DEBUG, "Non-monotonic");
 
 	last_time = time_ms;
+}
 #endif
 
-	s_wb24(s, (uint32_t)packet->size + 2);
-	s_wb24(s, (uint32_t)time_ms);
-	s_w8(s, (time_ms >> 24) & 0x7F);
-	s_wb24(s, 0);
+static void flv_video(struct flv_tag *tag, int32_t dts_offset, struct encoder_packet *packet, bool is_header)
+{
+	int32_t ct_offset_ms = get_ms_time(packet, packet->pts) - get_ms_time(packet, packet->dts);
+	struct serializer s;
 
-	/* these are the two extra bytes mentioned above */
-	s_w8(s, 0xaf);
-	s_w8(s, is_header ? 0 : 1);
-	s_write(s, packet->data, packet->size);
+	tag->type = RTMP_PACKET_TYPE_VIDEO;
+	tag->time_ms = get_ms_time(packet, packet->dts) - dts_offset;
 
-	write_previous_tag_size(s);
+#ifdef DEBUG_TIMESTAMPS
+	debug_timestamp("Video", tag->time_ms);
+#endif
+
+	tag_prefix_serializer_init(&s, tag);
+	s_w8(&s, packet->keyframe ? 0x17 : 0x27);
+	s_w8(&s, is_header ? 0 : 1);
+	s_wb24(&s, ct_offset_ms);
 }
 
-void flv_packet_mux(struct encoder_packet *packet, int32_t dts_offset, uint8_t **output, size_t *size, bool is_header)
+static void flv_audio(struct flv_tag *tag, int32_t dts_offset, struct encoder_packet *packet, bool is_header)
 {
-	struct array_output_data data;
 	struct serializer s;
 
-	array_output_serializer_init(&s, &data);
+	tag->type = RTMP_PACKET_TYPE_AUDIO;
+	tag->time_ms = get_ms_time(packet, packet->dts) - dts_offset;
+
+#ifdef DEBUG_TIMESTAMPS
+	debug_timestamp("Audio", tag->time_ms);
+#endif
+
+	tag_prefix_serializer_init(&s, tag);
+	s_w8(&s, 0xaf);
+	s_w8(&s, is_header ? 0 : 1);
+}
+
+bool flv_tag_mux(struct encoder_packet *packet, int32_t dts_offset, struct flv_tag *tag, bool is_header)
+{
+	if (!packet->data || !packet->size)
+		return false;
 
 	if (packet->type == OBS_ENCODER_VIDEO)
-		flv_video(&s, dts_offset, packet, is_header);
+		flv_video(tag, dts_offset, packet, is_header);
 	else
-		flv_audio(&s, dts_offset, packet, is_header);
+		flv_audio(tag, dts_offset, packet, is_header);
+	return true;
+}
 
-	*output = data.bytes.array;
-	*size = data.bytes.num;
+void flv_packet_mux(struct encoder_packet *packet, int32_t dts_offset, uint8_t **output, size_t *size, bool is_header)
+{
+	struct flv_tag tag;
+
+	if (!flv_tag_mux(packet, dts_offset, &tag, is_header)) {
+		*output = NULL;
+		*size = 0;
+		return;
+	}
+
+	flv_packet_serialize(&tag, packet, output, size);
 }
 
-void flv_packet_audio_ex(struct encoder_packet *packet, enum audio_id_t codec_id, int32_t dts_offset, uint8_t **output,
-			 size_t *size, int type, size_t idx)
+static bool flv_tag_audio_ex(struct encoder_packet *packet, enum audio_id_t codec_id, int32_t dts_offset,
+			     struct flv_tag *tag, int type, size_t idx)
 {
-	struct array_output_data data;
 	struct serializer s;
 
-	array_output_serializer_init(&s, &data);
-
 	assert(packet->type == OBS_ENCODER_AUDIO);
 
-	int32_t time_ms = get_ms_time(packet, packet->dts) - dts_offset;
-
 	bool is_multitrack = idx > 0;
 
 	if (!packet->data || !packet->size)
-		return;
+		return false;
 
-	int header_metadata_size = 5; // w8+wa4cc
-	if (is_multitrack)
-		header_metadata_size += 2; // w8 + w8
-
-	s_w8(&s, RTMP_PACKET_TYPE_AUDIO);
+	tag->type = RTMP_PACKET_TYPE_AUDIO;
+	tag->time_ms = get_ms_time(packet, packet->dts) - dts_offset;
 
 #ifdef DEBUG_TIMESTAMPS
-	blog(LOG_DEBUG, "Audio: %lu", time_ms);
-
-	if (last_time > time_ms)
-		blog(LOG_DEBUG, "Non-monotonic");
-
-	last_time = time_ms;
+	debug_timestamp("Audio", tag->time_ms);
 #endif
 
-	s_wb24(&s, (uint32_t)packet->size + header_metadata_size);
-	s_wb24(&s, (uint32_t)time_ms);
-	s_w8(&s, (time_ms >> 24) & 0x7F);
-	s_wb24(&s, 0);
-
+	tag_prefix_serializer_init(&s, tag);
 	s_w8(&s, AUDIO_HEADER_EX | (is_multitrack ? AUDIO_PACKETTYPE_MULTITRACK : type));
 	if (is_multitrack) {
 		s_w8(&s, MULTITRACKTYPE_ONE_TRACK | type);
@@ -431,41 +459,37 @@ void flv_packet_audio_ex(struct encoder_packet *packet, enum audio_id_t codec_id
 		s_wa4cc(&s, codec_id);
 	}
 
-	s_write(&s, packet->data, packet->size);
+	return true;
+}
 
-	write_previous_tag_size(&s);
+static void flv_packet_audio_ex(struct encoder_packet *packet, enum audio_id_t codec_id, int32_t dts_offset,
+				uint8_t **output, size_t *size, int type, size_t idx)
+{
+	struct flv_tag tag;
 
-	*output = data.bytes.array;
-	*size = data.bytes.num;
+	if (!flv_tag_audio_ex(packet, codec_id, dts_offset, &tag, type, idx)) {
+		*output = NULL;
+		*size = 0;
+		return;
+	}
+
+	flv_packet_serialize(&tag, packet, output, size);
 }
 
 // Y2023 spec
-void flv_packet_ex(struct encoder_packet *packet, enum video_id_t codec_id, int32_t dts_offset, uint8_t **output,
-		   size_t *size, int type, size_t idx)
+static void flv_tag_ex(struct encoder_packet *packet, enum video_id_t codec_id, int32_t dts_offset,
+		       struct flv_tag *tag, int type, size_t idx)
 {
-	struct array_output_data data;
 	struct serializer s;
-	array_output_serializer_init(&s, &data);
 
 	assert(packet->type == OBS_ENCODER_VIDEO);
 
-	int32_t time_ms = get_ms_time(packet, packet->dts) - dts_offset;
-
 	bool is_multitrack = idx > 0;
 
-	// packet head
-	int header_metadata_size = 5; // w8+w4cc
-	// 3 extra bytes for composition time offset
-	if ((codec_id == CODEC_H264 || codec_id == CODEC_HEVC) && type == PACKETTYPE_FRAMES) {
-		header_metadata_size += 3; // w24
-	}
-	if (is_multitrack)
-		header_metadata_size += 2; // w8+w8
+	tag->type = RTMP_PACKET_TYPE_VIDEO;
+	tag->time_ms = get_ms_time(packet, packet->dts) - dts_offset;
 
-	s_w8(&s, RTMP_PACKET_TYPE_VIDEO);
-	s_wb24(&s, (uint32_t)packet->size + header_metadata_size);
-	s_wtimestamp(&s, time_ms);
-	s_wb24(&s, 0); // always 0
+	tag_prefix_serializer_init(&s, tag);
 
 	uint8_t frame_type = packet->keyframe ? FT_KEY : FT_INTER;
 
@@ -489,15 +513,51 @@ void flv_packet_ex(struct encoder_packet *packet, enum video_id_t codec_id, int3
 		int32_t ct_offset_ms = get_ms_time(packet, packet->pts) - get_ms_time(packet, packet->dts);
 		s_wb24(&s, ct_offset_ms);
 	}
+}
 
-	// packet data
-	s_write(&s, packet->data, packet->size);
+static void flv_packet_ex(struct encoder_packet *packet, enum video_id_t codec_id, int32_t dts_offset,
+			  uint8_t **output, size_t *size, int type, size_t idx)
+{
+	struct flv_tag tag;
 
-	// packet tail
-	write_previous_tag_size(&s);
+	flv_tag_ex(packet, codec_id, dts_offset, &tag, type, idx);
+	flv_packet_serialize(&tag, packet, output, size);
+}
 
-	*output = data.bytes.array;
-	*size = data.bytes.num;
+static int flv_frames_type(struct encoder_packet *packet, enum video_id_t codec)
+{
+	// PACKETTYPE_FRAMESX is an optimization to avoid sending composition
+	// time offsets of 0. See Enhanced RTMP spec.
+	if ((codec == CODEC_H264 || codec == CODEC_HEVC) && packet->dts == packet->pts)
+		return PACKETTYPE_FRAMESX;
+	return PACKETTYPE_FRAMES;
+}
+
+void flv_tag_start(struct encoder_packet *packet, enum video_id_t codec, struct flv_tag *tag, size_t idx)
+{
+	flv_tag_ex(packet, codec, 0, tag, PACKETTYPE_SEQ_START, idx);
+}
+
+void flv_tag_frames(struct encoder_packet *packet, enum video_id_t codec, int32_t dts_offset, struct flv_tag *tag,
+		    size_t idx)
+{
+	flv_tag_ex(packet, codec, dts_offset, tag, flv_frames_type(packet, codec), idx);
+}
+
+void flv_tag_end(struct encoder_packet *packet, enum video_id_t codec, struct flv_tag *tag, size_t idx)
+{
+	flv_tag_ex(packet, codec, 0, tag, PACKETTYPE_SEQ_END, idx);
+}
+
+bool flv_tag_audio_start(struct encoder_packet *packet, enum audio_id_t codec, struct flv_tag *tag, size_t idx)
+{
+	return flv_tag_audio_ex(packet, codec, 0, tag, AUDIO_PACKETTYPE_SEQ_START, idx);
+}
+
+bool flv_tag_audio_frames(struct encoder_packet *packet, enum audio_id_t codec, int32_t dts_offset,
+			  struct flv_tag *tag, size_t idx)
+{
+	return flv_tag_audio_ex(packet, codec, dts_offset, tag, AUDIO_PACKETTYPE_FRAMES, idx);
 }
 
 void flv_packet_start(struct encoder_packet *packet, enum video_id_t codec, uint8_t **output, size_t *size, size_t idx)
@@ -508,12 +568,7 @@ void flv_packet_start(struct encoder_packet *packet, enum video_id_t codec, uint
 void flv_packet_frames(struct encoder_packet *packet, enum video_id_t codec, int32_t dts_offset, uint8_t **output,
 		       size_t *size, size_t idx)
 {
-	int packet_type = PACKETTYPE_FRAMES;
-	// PACKETTYPE_FRAMESX is an optimization to avoid sending composition
-	// time offsets of 0. See Enhanced RTMP spec.
-	if ((codec == CODEC_H264 || codec == CODEC_HEVC) && packet->dts == packet->pts)
-		packet_type = PACKETTYPE_FRAMESX;
-	flv_packet_ex(packet, codec, dts_offset, output, size, packet_type, idx);
+	flv_packet_ex(packet, codec, dts_offset, output, size, flv_frames_type(packet, codec), idx);
 }
 
 void flv_packet_end(struct encoder_packet *packet, enum video_id_t codec, uint8_t **output, size_t *size, size_t idx)
@@ -58,6 +58,16 @@ static int32_t get_ms_time(struct encoder_packet *packet, int64_t val)
 	return (int32_t)(val * MILLISECOND_DEN / packet->timebase_den);
 }
 
+/* FLV tag of an encoder packet without the packet data.  The tag body is the
+ * prefix followed by the packet data, which lets the packet be written
+ * without copying its data into the tag first. */
+struct flv_tag {
+	uint8_t type;
+	int32_t time_ms;
+	uint8_t prefix[16];
+	size_t prefix_size;
+};
+
 extern void write_file_info(FILE *file, int64_t duration_ms, int64_t size);
 
 extern void flv_meta_data(obs_output_t *context, uint8_t **output, size_t *size, bool write_header);
@@ -77,3 +87,14 @@ extern void flv_packet_audio_start(struct encoder_packet *packet, enum audio_id_
 				   size_t idx);
 extern void flv_packet_audio_frames(struct encoder_packet *packet, enum audio_id_t codec, int32_t dts_offset,
 				    uint8_t **output, size_t *size, size_t idx);
+
+extern bool flv_tag_mux(struct encoder_packet *packet, int32_t dts_offset, struct flv_tag *tag, bool is_header);
+// Y2023 spec
+extern void flv_tag_start(struct encoder_packet *packet, enum video_id_t codec, struct flv_tag *tag, size_t idx);
+extern void flv_tag_frames(struct encoder_packet *packet, enum video_id_t codec, int32_t dts_offset,
+			   struct flv_tag *tag, size_t idx);
+extern void flv_tag_end(struct encoder_packet *packet, enum video_id_t codec, struct flv_tag *tag, size_t idx);
+extern bool flv_tag_audio_start(struct encoder_packet *packet, enum audio_id_t codec, struct flv_tag *tag,
+				size_t idx);
+extern bool flv_tag_audio_frames(struct encoder_packet *packet, enum audio_id_t codec, int32_t dts_offset,
+				 struct flv_tag *tag, size_t idx);
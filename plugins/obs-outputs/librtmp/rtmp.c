@@ -173,6 +173,7 @@ static void HandleClientBW(RTMP *r, const RTMPPacket *packet);
 
 static int ReadN(RTMP *r, char *buffer, int n);
 static int WriteN(RTMP *r, const char *buffer, int n);
+static int WriteV(RTMP *r, RTMP_IOVEC *iov, int cnt);
 
 static void DecodeTEA(AVal *key, AVal *text);
 
@@ -1576,11 +1577,29 @@ ReadN(RTMP *r, char *buffer, int n)
     return nOriginalSize - n;
 }
 
+static void
+AbortSend(RTMP *r, int sockerr)
+{
+    struct linger l;
+
+    r->last_error_code = sockerr;
+
+    // Force-close the socket. Sometimes a send() error isn't fatal, so
+    // we could end up writing an unpublish message which some services
+    // treat as a clean shutdown. We need to disable lingering too so
+    // the remote side sees an abortive shutdown (RST).
+    l.l_onoff = 1;
+    l.l_linger = 0;
+    setsockopt(r->m_sb.sb_socket, SOL_SOCKET, SO_LINGER, (char *)&l, sizeof(l));
+    RTMPSockBuf_Close(&r->m_sb);
+
+    RTMP_Close(r);
+}
+
 static int
 WriteN(RTMP *r, const char *buffer, int n)
 {
     const char *ptr = buffer;
-    struct linger l;
 
     while (n > 0)
     {
@@ -1603,18 +1622,7 @@ WriteN(RTMP *r, const char *buffer, int n)
             if (sockerr == EINTR && !RTMP_ctrlC)
                 continue;
 
-            r->last_error_code = sockerr;
-
-            // Force-close the socket. Sometimes a send() error isn't fatal, so
-            // we could end up writing an unpublish message which some services
-            // treat as a clean shutdown. We need to disable lingering too so
-            // the remote side sees an abortive shutdown (RST).
-            l.l_onoff = 1;
-            l.l_linger = 0;
-            setsockopt(r->m_sb.sb_socket, SOL_SOCKET, SO_LINGER, (char *)&l, sizeof(l));
-            RTMPSockBuf_Close(&r->m_sb);
-
-            RTMP_Close(r);
+            AbortSend(r, sockerr);
             n = 1;
             break;
         }
@@ -1629,6 +1637,49 @@ WriteN(RTMP *r, const char *buffer, int n)
     return n == 0;
 }
 
+/* Writes a list of buffers to the socket with a single scatter-gather send
+ * where possible.  Only used for plain TCP connections, see
+ * RTMP_WriteMessage. */
+static int
+WriteV(RTMP *r, RTMP_IOVEC *iov, int cnt)
+{
+    while (cnt > 0)
+    {
+        int nBytes = RTMPSockBuf_SendV(&r->m_sb, iov, cnt);
+
+        if (nBytes < 0)
+        {
+            int sockerr = GetSockError();
+            RTMP_Log(RTMP_LOGERROR, "%s, RTMP send error %d (%d buffers)", __FUNCTION__,
+                     sockerr, cnt);
+
+            if (sockerr == EINTR && !RTMP_ctrlC)
+                continue;
+
+            AbortSend(r, sockerr);
+            return FALSE;
+        }
+
+        if (nBytes == 0)
+            return FALSE;
+
+        while (cnt > 0 && (size_t)nBytes >= (size_t)RTMP_IOVEC_LEN(iov))
+        {
+            nBytes -= (int)RTMP_IOVEC_LEN(iov);
+            iov++;
+            cnt--;
+        }
+
+        if (cnt > 0)
+        {
+            RTMP_IOVEC_BASE(iov) = (char *)RTMP_IOVEC_BASE(iov) + nBytes;
+            RTMP_IOVEC_LEN(iov) -= nBytes;
+        }
+    }
+
+    return TRUE;
+}
+
 #define SAVC(x)	static const AVal av_##x = AVC(#x)
 
 SAVC(app);
@@ -4085,18 +4136,19 @@ RTMP_SendChunk(RTMP *r, RTMPChunk *chunk)
     return wrote;
 }
 
-int
-RTMP_SendPacket(RTMP *r, RTMPPacket *packet, int queue)
+/* Encodes the header of the first chunk of packet so that it ends at hend,
+ * and updates the channel state used to compress headers.  Returns the
+ * header size, or 0 on failure. */
+static int
+EncodePacketHeader(RTMP *r, RTMPPacket *packet, char *hend, char **pheader,
+                   int *pcSize, uint32_t *pt, char *pc)
 {
     const RTMPPacket *prevPacket;
     uint32_t last = 0;
     int nSize;
     int hSize, cSize;
-    char *header, *hptr, *hend, hbuf[RTMP_MAX_HEADER_SIZE], c;
+    char *header, *hptr, c;
     uint32_t t;
-    char *buffer, *tbuf = NULL, *toff = NULL;
-    int nChunkSize;
-    int tlen;
 
     if (packet->m_nChannel >= r->m_channelsAllocatedOut)
     {
@@ -4107,7 +4159,7 @@ RTMP_SendPacket(RTMP *r, RTMPPacket *packet, int queue)
             free(r->m_vecChannelsOut);
             r->m_vecChannelsOut = NULL;
             r->m_channelsAllocatedOut = 0;
-            return FALSE;
+            return 0;
         }
         r->m_vecChannelsOut = packets;
         memset(r->m_vecChannelsOut + r->m_channelsAllocatedOut, 0, sizeof(RTMPPacket*) * (n - r->m_channelsAllocatedOut));
@@ -4128,8 +4180,8 @@ RTMP_SendPacket(RTMP *r, RTMPPacket *packet, int queue)
          * whatever was previously sent, rather than just looking at the previous packet's absolute timestamp.
          *
          * The type 3 chunks/RTMP_PACKET_SIZE_MINIMUM packets produced here specify the beginning of a new
-         * message as opposed to message continuation type 3 chunks that are handled in the loop further down
-         * in this function.
+         * message as opposed to message continuation type 3 chunks that are handled by the chunk loops in
+         * RTMP_SendPacket and RTMP_WriteMessage.
          */
         uint32_t delta = packet->m_nTimeStamp - prevPacket->m_nTimeStamp;
         if (delta == prevPacket->m_nLastWireTimeStamp
@@ -4142,7 +4194,7 @@ RTMP_SendPacket(RTMP *r, RTMPPacket *packet, int queue)
     {
         RTMP_Log(RTMP_LOGERROR, "sanity failed!! trying to send header of type: 0x%02x.",
                  (unsigned char)packet->m_headerType);
-        return FALSE;
+        return 0;
     }
 
     nSize = packetSize[packet->m_headerType];
@@ -4151,16 +4203,7 @@ RTMP_SendPacket(RTMP *r, RTMPPacket *packet, int queue)
     t = packet->m_nTimeStamp - last;
     packet->m_nLastWireTimeStamp = t;
 
-    if (packet->m_body)
-    {
-        header = packet->m_body - nSize;
-        hend = packet->m_body;
-    }
-    else
-    {
-        header = hbuf + 6;
-        hend = hbuf + sizeof(hbuf);
-    }
+    header = hend - nSize;
 
     if (packet->m_nChannel > 319)
         cSize = 2;
@@ -4217,6 +4260,34 @@ RTMP_SendPacket(RTMP *r, RTMPPacket *packet, int queue)
     if (nSize > 1 && t >= 0xffffff)
         hptr = AMF_EncodeInt32(hptr, hend, t);
 
+
+    *pheader = header;
+    *pcSize = cSize;
+    *pt = t;
+    *pc = c;
+    return hSize;
+}
+
+int
+RTMP_SendPacket(RTMP *r, RTMPPacket *packet, int queue)
+{
+    int nSize;
+    int hSize, cSize;
+    char *header, *hend, hbuf[RTMP_MAX_HEADER_SIZE], c;
+    uint32_t t;
+    char *buffer, *tbuf = NULL, *toff = NULL;
+    int nChunkSize;
+    int tlen;
+
+    if (packet->m_body)
+        hend = packet->m_body;
+    else
+        hend = hbuf + sizeof(hbuf);
+
+    hSize = EncodePacketHeader(r, packet, hend, &header, &cSize, &t, &c);
+    if (!hSize)
+        return FALSE;
+
     nSize = packet->m_nBodySize;
     buffer = packet->m_body;
     nChunkSize = r->m_outChunkSize;
@@ -4320,6 +4391,150 @@ RTMP_SendPacket(RTMP *r, RTMPPacket *packet, int queue)
     return TRUE;
 }
 
+#define RTMP_WRITEV_BATCH 64
+
+static int
+AddIOVec(RTMP *r, RTMP_IOVEC *iov, int *cnt, const char *buf, int len)
+{
+    if (!len)
+        return TRUE;
+
+    if (*cnt == RTMP_WRITEV_BATCH)
+    {
+        if (!WriteV(r, iov, *cnt))
+            return FALSE;
+        *cnt = 0;
+    }
+
+    RTMP_IOVEC_BASE(&iov[*cnt]) = (char *)buf;
+    RTMP_IOVEC_LEN(&iov[*cnt]) = len;
+    (*cnt)++;
+    return TRUE;
+}
+
+static int
+WriteMessageCopy(RTMP *r, RTMPPacket *packet, const RTMPBuf *body, int nBody)
+{
+    char *enc;
+    int ret;
+
+    if (!RTMPPacket_Alloc(packet, packet->m_nBodySize))
+    {
+        RTMP_Log(RTMP_LOGDEBUG, "%s, failed to allocate packet", __FUNCTION__);
+        return FALSE;
+    }
+
+    enc = packet->m_body;
+    for (int i = 0; i < nBody; i++)
+    {
+        memcpy(enc, body[i].buf, body[i].len);
+        enc += body[i].len;
+    }
+
+    ret = RTMP_SendPacket(r, packet, FALSE);
+    RTMPPacket_Free(packet);
+    return ret;
+}
+
+int
+RTMP_WriteMessage(RTMP *r, uint8_t packetType, uint32_t timestamp,
+                  const RTMPBuf *body, int nBody, int streamIdx)
+{
+    RTMPPacket packet = {0};
+    RTMP_IOVEC iov[RTMP_WRITEV_BATCH];
+    char hbuf[RTMP_MAX_HEADER_SIZE], cbuf[7];
+    char *header, c;
+    int hSize, cSize, clen, cnt = 0;
+    int nChunkSize = r->m_outChunkSize;
+    int chunkLeft, idx = 0, off = 0;
+    uint32_t nSize = 0, t;
+
+    for (int i = 0; i < nBody; i++)
+        nSize += body[i].len;
+
+    packet.m_nChannel = 0x04;	/* source channel */
+    packet.m_nInfoField2 = r->Link.streams[streamIdx].id;
+    packet.m_packetType = packetType;
+    packet.m_nTimeStamp = timestamp;
+    packet.m_nBodySize = nSize;
+
+    if (((packetType == RTMP_PACKET_TYPE_AUDIO
+            || packetType == RTMP_PACKET_TYPE_VIDEO) &&
+            !timestamp) || packetType == RTMP_PACKET_TYPE_INFO)
+        packet.m_headerType = RTMP_PACKET_SIZE_LARGE;
+    else
+        packet.m_headerType = RTMP_PACKET_SIZE_MEDIUM;
+
+    /* HTTP tunneling, TLS and custom send functions need the whole message
+     * in one contiguous buffer */
+    if ((r->Link.protocol & RTMP_FEATURE_HTTP) || r->m_sb.sb_ssl ||
+            (r->m_bCustomSend && r->m_customSendFunc))
+        return WriteMessageCopy(r, &packet, body, nBody);
+
+    hSize = EncodePacketHeader(r, &packet, hbuf + sizeof(hbuf), &header, &cSize, &t, &c);
+    if (!hSize)
+        return FALSE;
+
+    /* all continuation chunks share the same type 3 header */
+    clen = 0;
+    cbuf[clen++] = (0xc0 | c);
+    if (cSize)
+    {
+        int tmp = packet.m_nChannel - 64;
+        cbuf[clen++] = tmp & 0xff;
+        if (cSize == 2)
+            cbuf[clen++] = tmp >> 8;
+    }
+    if (t >= 0xffffff)
+    {
+        AMF_EncodeInt32(cbuf + clen, cbuf + sizeof(cbuf), t);
+        clen += 4;
+    }
+
+    RTMP_Log(RTMP_LOGDEBUG2, "%s: fd=%d, size=%u", __FUNCTION__, (int)r->m_sb.sb_socket,
+             nSize);
+
+    if (!AddIOVec(r, iov, &cnt, header, hSize))
+        return FALSE;
+
+    chunkLeft = nChunkSize;
+    while (nSize)
+    {
+        int len = body[idx].len - off;
+
+        if (!chunkLeft)
+        {
+            if (!AddIOVec(r, iov, &cnt, cbuf, clen))
+                return FALSE;
+            chunkLeft = nChunkSize;
+        }
+
+        if (len > chunkLeft)
+            len = chunkLeft;
+
+        if (!AddIOVec(r, iov, &cnt, body[idx].buf + off, len))
+            return FALSE;
+
+        off += len;
+        chunkLeft -= len;
+        nSize -= len;
+
+        if (off == body[idx].len)
+        {
+            idx++;
+            off = 0;
+        }
+    }
+
+    if (cnt && !WriteV(r, iov, cnt))
+        return FALSE;
+
+    if (!r->m_vecChannelsOut[packet.m_nChannel])
+        r->m_vecChannelsOut[packet.m_nChannel] = malloc(sizeof(RTMPPacket));
+    memcpy(r->m_vecChannelsOut[packet.m_nChannel], &packet, sizeof(RTMPPacket));
+    return TRUE;
+}
+
 void
 RTMP_Close(RTMP *r)
 {
@@ -4533,6 +4748,30 @@ RTMPSockBuf_Send(RTMPSockBuf *sb, const char *buf, int len)
     return rc;
 }
 
+int
+RTMPSockBuf_SendV(RTMPSockBuf *sb, RTMP_IOVEC *iov, int cnt)
+{
+    int rc;
+
+#if defined(RTMP_NETSTACK_DUMP)
+    for (int i = 0; i < cnt; i++)
+        fwrite(RTMP_IOVEC_BASE(&iov[i]), 1, RTMP_IOVEC_LEN(&iov[i]), netstackdump);
+#endif
+
+#ifdef _WIN32
+    DWORD sent = 0;
+    rc = WSASend(sb->sb_socket, iov, cnt, &sent, 0, NULL, NULL);
+    if (rc == 0)
+        rc = (int)sent;
+#else
+    struct msghdr msg = {0};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = cnt;
+    rc = (int)sendmsg(sb->sb_socket, &msg, MSG_NOSIGNAL);
+#endif
+    return rc;
+}
+
 int
 RTMPSockBuf_Close(RTMPSockBuf *sb)
 {
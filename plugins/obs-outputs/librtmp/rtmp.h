@@ -43,6 +43,7 @@
 #include <ws2tcpip.h>
 #else
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #define SOCKET int
 #endif
@@ -275,6 +276,23 @@ extern "C"
         void *sb_ssl;
     } RTMPSockBuf;
 
+    /* a buffer of an RTMP message body, see RTMP_WriteMessage */
+    typedef struct RTMPBuf
+    {
+        const char *buf;
+        int len;
+    } RTMPBuf;
+
+#ifdef _WIN32
+    typedef WSABUF RTMP_IOVEC;
+#define RTMP_IOVEC_BASE(v)	((v)->buf)
+#define RTMP_IOVEC_LEN(v)	((v)->len)
+#else
+    typedef struct iovec RTMP_IOVEC;
+#define RTMP_IOVEC_BASE(v)	((v)->iov_base)
+#define RTMP_IOVEC_LEN(v)	((v)->iov_len)
+#endif
+
     void RTMPPacket_Reset(RTMPPacket *p);
     void RTMPPacket_Dump(RTMPPacket *p);
     int RTMPPacket_Alloc(RTMPPacket *p, uint32_t nSize);
@@ -534,6 +552,7 @@ extern "C"
 
     int RTMPSockBuf_Fill(RTMPSockBuf *sb);
     int RTMPSockBuf_Send(RTMPSockBuf *sb, const char *buf, int len);
+    int RTMPSockBuf_SendV(RTMPSockBuf *sb, RTMP_IOVEC *iov, int cnt);
     int RTMPSockBuf_Close(RTMPSockBuf *sb);
 
     int RTMP_SendCreateStream(RTMP *r);
@@ -543,6 +562,8 @@ extern "C"
     void RTMP_DropRequest(RTMP *r, int i, int freeit);
     int RTMP_Read(RTMP *r, char *buf, int size);
     int RTMP_Write(RTMP *r, const char *buf, int size, int streamIdx);
+    int RTMP_WriteMessage(RTMP *r, uint8_t packetType, uint32_t timestamp,
+                          const RTMPBuf *body, int nBody, int streamIdx);
 
 #ifdef USE_HASHSWF
     /* hashswf.c */
@@ -0,0 +1,460 @@
+#include "rtmp-dbr.h"
+
+#include <util/bmem.h>
+#include <util/deque.h>
+#include <util/platform.h>
+
+#include <math.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <mstcpip.h>
+#elif defined(__APPLE__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#else
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#ifdef __FreeBSD__
+#include <sys/filio.h>
+#endif
+#endif
+
+#define SEC_TO_NSEC 1000000000ULL
+#define MSEC_TO_NSEC 1000000ULL
+#define MSEC_TO_USEC 1000ULL
+
+#define MIN_BITRATE 50
+
+/* ------------------------------------------------------------------------- */
+/* Threshold controller: the original dynamic bitrate algorithm.  Estimates
+ * throughput from how long sends took and falls back to that estimate once
+ * the output has buffered more than DBR_TRIGGER_USEC, then climbs back up in
+ * steps of a tenth of the original bitrate every DBR_INC_TIMER. */
+
+#define DBR_INC_TIMER (4ULL * SEC_TO_NSEC)
+#define DBR_TRIGGER_USEC (200ULL * MSEC_TO_USEC)
+#define MIN_ESTIMATE_DURATION_MS 1000
+#define MAX_ESTIMATE_DURATION_MS 2000
+
+struct dbr_threshold {
+	struct deque frames;
+	size_t data_size;
+	uint64_t inc_timeout;
+
+	long audio_bitrate;
+	long orig_bitrate;
+	long est_bitrate;
+	long prev_bitrate;
+	long inc_bitrate;
+};
+
+static void *dbr_threshold_create(long video_bitrate, long audio_bitrate)
+{
+	struct dbr_threshold *dbr = bzalloc(sizeof(*dbr));
+	dbr->audio_bitrate = audio_bitrate;
+	dbr->orig_bitrate = video_bitrate;
+	dbr->inc_bitrate = video_bitrate / 10;
+	return dbr;
+}
+
+static void dbr_threshold_destroy(void *data)
+{
+	struct dbr_threshold *dbr = data;
+	deque_free(&dbr->frames);
+	bfree(dbr);
+}
+
+static void dbr_threshold_frame_sent(void *data, const struct dbr_frame *back)
+{
+	struct dbr_threshold *dbr = data;
+	struct dbr_frame front;
+	uint64_t dur;
+
+	deque_push_back(&dbr->frames, back, sizeof(*back));
+	deque_peek_front(&dbr->frames, &front, sizeof(front));
+
+	dbr->data_size += back->size;
+
+	dur = (back->send_end - front.send_beg) / 1000000;
+
+	if (dur >= MAX_ESTIMATE_DURATION_MS) {
+		dbr->data_size -= front.size;
+		deque_pop_front(&dbr->frames, NULL, sizeof(front));
+	}
+
+	dbr->est_bitrate = (dur >= MIN_ESTIMATE_DURATION_MS) ? (long)(dbr->data_size * 1000 / dur) : 0;
+	dbr->est_bitrate *= 8;
+	dbr->est_bitrate /= 1000;
+
+	if (dbr->est_bitrate) {
+		dbr->est_bitrate -= dbr->audio_bitrate;
+		if (dbr->est_bitrate < MIN_BITRATE)
+			dbr->est_bitrate = MIN_BITRATE;
+	}
+}
+
+static long dbr_threshold_lower(struct dbr_threshold *dbr, uint64_t ts, long cur_bitrate)
+{
+	long est_bitrate = 0;
+	long new_bitrate;
+
+	if (dbr->est_bitrate && dbr->est_bitrate < cur_bitrate) {
+		dbr->data_size = 0;
+		deque_pop_front(&dbr->frames, NULL, dbr->frames.size);
+		est_bitrate = dbr->est_bitrate / 100 * 100;
+		if (est_bitrate < MIN_BITRATE) {
+			est_bitrate = MIN_BITRATE;
+		}
+	}
+
+	if (est_bitrate) {
+		new_bitrate = est_bitrate;
+
+	} else if (dbr->prev_bitrate) {
+		/* going back to the previous bitrate */
+		new_bitrate = dbr->prev_bitrate;
+
+	} else {
+		return cur_bitrate;
+	}
+
+	if (new_bitrate == cur_bitrate) {
+		return cur_bitrate;
+	}
+
+	dbr->prev_bitrate = 0;
+	dbr->inc_timeout = ts + DBR_INC_TIMER;
+	return new_bitrate;
+}
+
+static long dbr_threshold_update(void *data, uint64_t ts, int64_t buffer_duration_usec, long cur_bitrate)
+{
+	struct dbr_threshold *dbr = data;
+	long bitrate = cur_bitrate;
+
+	if (dbr->inc_timeout && ts >= dbr->inc_timeout) {
+		dbr->inc_timeout = 0;
+		dbr->prev_bitrate = bitrate;
+		bitrate += dbr->inc_bitrate;
+
+		if (bitrate >= dbr->orig_bitrate)
+			bitrate = dbr->orig_bitrate;
+		else
+			dbr->inc_timeout = ts + DBR_INC_TIMER;
+	}
+
+	if ((uint64_t)buffer_duration_usec >= DBR_TRIGGER_USEC)
+		bitrate = dbr_threshold_lower(dbr, ts, bitrate);
+
+	return bitrate;
+}
+
+static const struct dbr_controller_info dbr_threshold_info = {
+	.id = DBR_ALGORITHM_THRESHOLD,
+	.create = dbr_threshold_create,
+	.destroy = dbr_threshold_destroy,
+	.frame_sent = dbr_threshold_frame_sent,
+	.update = dbr_threshold_update,
+};
+
+/* ------------------------------------------------------------------------- */
+/* Delay controller.  Estimates how long newly written data waits before it
+ * is delivered: the time needed to drain the socket send queue (unsent and
+ * unacknowledged bytes) at the measured delivery rate, or the round trip time
+ * above its recent minimum, whichever is larger.
+ *
+ * The bitrate follows AIMD with hysteresis: above DELAY_HIGH_MS it is cut
+ * multiplicatively (bounded by the measured bottleneck rate, but never by
+ * more than MAX_DECREASE per step) unless the delay is already shrinking
+ * after the previous cut; below DELAY_LOW_MS it grows additively once the
+ * delay has stayed low for CLEAR_HOLD_NS, and jumps halfway towards the
+ * measured bottleneck rate when that has headroom.  In between, the bitrate
+ * is held. */
+
+#define DELAY_HIGH_MS 150.0
+#define DELAY_LOW_MS 40.0
+#define DECREASE_FACTOR 0.85
+#define MAX_DECREASE 0.7
+#define DECREASE_COOLDOWN_NS (500ULL * MSEC_TO_NSEC)
+#define INCREASE_INTERVAL_NS (1ULL * SEC_TO_NSEC)
+#define CLEAR_HOLD_NS (2ULL * SEC_TO_NSEC)
+#define MIN_RTT_WINDOW_NS (10ULL * SEC_TO_NSEC)
+#define RATE_SAMPLES 20 /* two seconds of socket samples */
+
+struct dbr_delay {
+	long audio_bitrate;
+	long orig_bitrate;
+	long min_bitrate;
+
+	/* send thread */
+	uint64_t bytes_sent;
+	uint64_t last_sample_ts;
+	uint64_t prev_queued_bytes;
+
+	double rates[RATE_SAMPLES];
+	size_t rate_idx;
+	double btl_kbps;
+
+	uint32_t min_rtt_usec;
+	uint64_t min_rtt_ts;
+
+	double queue_delay_ms;
+
+	/* encoder thread */
+	uint64_t last_change_ts;
+	uint64_t clear_since_ts;
+	double decrease_delay_ms;
+};
+
+static void *dbr_delay_create(long video_bitrate, long audio_bitrate)
+{
+	struct dbr_delay *dbr = bzalloc(sizeof(*dbr));
+	dbr->audio_bitrate = audio_bitrate;
+	dbr->orig_bitrate = video_bitrate;
+	dbr->min_bitrate = video_bitrate / 10;
+	if (dbr->min_bitrate < MIN_BITRATE)
+		dbr->min_bitrate = MIN_BITRATE;
+	return dbr;
+}
+
+static void dbr_delay_destroy(void *data)
+{
+	bfree(data);
+}
+
+static void dbr_delay_frame_sent(void *data, const struct dbr_frame *frame)
+{
+	struct dbr_delay *dbr = data;
+	dbr->bytes_sent += frame->size;
+}
+
+static void dbr_delay_socket_stats(void *data, uint64_t ts, const struct dbr_socket_stats *stats)
+{
+	struct dbr_delay *dbr = data;
+	uint64_t queued = stats->has_queued_bytes ? stats->queued_bytes : 0;
+
+	if (dbr->last_sample_ts) {
+		double elapsed_ms = (double)(ts - dbr->last_sample_ts) / (double)MSEC_TO_NSEC;
+		double delivered = (double)dbr->bytes_sent - ((double)queued - (double)dbr->prev_queued_bytes);
+
+		if (delivered < 0.0)
+			delivered = 0.0;
+
+		/* bytes per millisecond times eight is kbps; the bottleneck
+		 * rate is the windowed maximum of the delivery rate */
+		dbr->rates[dbr->rate_idx] = delivered * 8.0 / elapsed_ms;
+		dbr->rate_idx = (dbr->rate_idx + 1) % RATE_SAMPLES;
+
+		dbr->btl_kbps = 0.0;
+		for (size_t i = 0; i < RATE_SAMPLES; i++)
+			dbr->btl_kbps = fmax(dbr->btl_kbps, dbr->rates[i]);
+	}
+
+	dbr->bytes_sent = 0;
+	dbr->prev_queued_bytes = queued;
+	dbr->last_sample_ts = ts;
+
+	double rtt_delay_ms = 0.0;
+
+	if (stats->has_rtt && stats->rtt_usec) {
+		if (!dbr->min_rtt_usec || stats->rtt_usec <= dbr->min_rtt_usec ||
+		    ts - dbr->min_rtt_ts > MIN_RTT_WINDOW_NS) {
+			dbr->min_rtt_usec = stats->rtt_usec;
+			dbr->min_rtt_ts = ts;
+		}
+
+		rtt_delay_ms = (double)(stats->rtt_usec - dbr->min_rtt_usec) / 1000.0;
+	}
+
+	double drain_ms = dbr->btl_kbps > 0.0 ? (double)queued * 8.0 / dbr->btl_kbps : 0.0;
+	dbr->queue_delay_ms = fmax(rtt_delay_ms, drain_ms);
+}
+
+static long dbr_delay_decrease(struct dbr_delay *dbr, double delay_ms, long cur_bitrate)
+{
+	/* the last cut is still draining the queue */
+	if (dbr->decrease_delay_ms && delay_ms < dbr->decrease_delay_ms)
+		return cur_bitrate;
+
+	double target = (double)cur_bitrate * DECREASE_FACTOR;
+	double btl = dbr->btl_kbps - (double)dbr->audio_bitrate;
+
+	if (btl > 0.0 && btl < target)
+		target = btl;
+	target = fmax(target, (double)cur_bitrate * MAX_DECREASE);
+
+	dbr->decrease_delay_ms = delay_ms;
+	return (long)target / 100 * 100;
+}
+
+static long dbr_delay_increase(struct dbr_delay *dbr, uint64_t ts, long cur_bitrate)
+{
+	if (!dbr->clear_since_ts)
+		dbr->clear_since_ts = ts;
+
+	if (cur_bitrate >= dbr->orig_bitrate || ts - dbr->clear_since_ts < CLEAR_HOLD_NS ||
+	    ts - dbr->last_change_ts < INCREASE_INTERVAL_NS)
+		return cur_bitrate;
+
+	long step = dbr->orig_bitrate / 20;
+	long headroom = (long)(dbr->btl_kbps - (double)dbr->audio_bitrate) - cur_bitrate;
+
+	/* probe: the link has delivered more than we are sending */
+	if (headroom > cur_bitrate / 10 && headroom / 2 > step)
+		step = headroom / 2;
+
+	return cur_bitrate + step;
+}
+
+static long dbr_delay_update(void *data, uint64_t ts, int64_t buffer_duration_usec, long cur_bitrate)
+{
+	struct dbr_delay *dbr = data;
+	double delay_ms = fmax(dbr->queue_delay_ms, (double)buffer_duration_usec / 1000.0);
+	long bitrate = cur_bitrate;
+
+	if (delay_ms > DELAY_HIGH_MS) {
+		dbr->clear_since_ts = 0;
+		if (ts - dbr->last_change_ts >= DECREASE_COOLDOWN_NS)
+			bitrate = dbr_delay_decrease(dbr, delay_ms, cur_bitrate);
+
+	} else if (delay_ms < DELAY_LOW_MS) {
+		dbr->decrease_delay_ms = 0.0;
+		bitrate = dbr_delay_increase(dbr, ts, cur_bitrate);
+
+	} else {
+		dbr->decrease_delay_ms = 0.0;
+		dbr->clear_since_ts = 0;
+	}
+
+	if (bitrate > dbr->orig_bitrate)
+		bitrate = dbr->orig_bitrate;
+	if (bitrate < dbr->min_bitrate)
+		bitrate = dbr->min_bitrate;
+
+	if (bitrate != cur_bitrate)
+		dbr->last_change_ts = ts;
+	return bitrate;
+}
+
+static const struct dbr_controller_info dbr_delay_info = {
+	.id = DBR_ALGORITHM_DELAY,
+	.create = dbr_delay_create,
+	.destroy = dbr_delay_destroy,
+	.frame_sent = dbr_delay_frame_sent,
+	.socket_stats = dbr_delay_socket_stats,
+	.update = dbr_delay_update,
+};
+
+/* ------------------------------------------------------------------------- */
+
+static const struct dbr_controller_info *controllers[] = {
+	&dbr_threshold_info,
+	&dbr_delay_info,
+};
+
+bool dbr_controller_init(struct dbr_controller *dbr, const char *id, long video_bitrate, long audio_bitrate)
+{
+	memset(dbr, 0, sizeof(*dbr));
+
+	if (!id || !*id)
+		id = DBR_ALGORITHM_THRESHOLD;
+
+	for (size_t i = 0; i < sizeof(controllers) / sizeof(controllers[0]); i++) {
+		if (strcmp(controllers[i]->id, id) == 0) {
+			dbr->info = controllers[i];
+			dbr->data = dbr->info->create(video_bitrate, audio_bitrate);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void dbr_controller_free(struct dbr_controller *dbr)
+{
+	if (dbr->info)
+		dbr->info->destroy(dbr->data);
+	memset(dbr, 0, sizeof(*dbr));
+}
+
+void dbr_controller_frame_sent(struct dbr_controller *dbr, const struct dbr_frame *frame, SOCKET socket)
+{
+	dbr->info->frame_sent(dbr->data, frame);
+
+	if (dbr->info->socket_stats && frame->send_end >= dbr->next_socket_sample) {
+		struct dbr_socket_stats stats;
+
+		if (dbr_get_socket_stats(socket, &stats))
+			dbr->info->socket_stats(dbr->data, frame->send_end, &stats);
+		dbr->next_socket_sample = frame->send_end + DBR_SOCKET_SAMPLE_INTERVAL_NS;
+	}
+}
+
+long dbr_controller_update(struct dbr_controller *dbr, uint64_t ts, int64_t buffer_duration_usec, long cur_bitrate)
+{
+	return dbr->info->update(dbr->data, ts, buffer_duration_usec, cur_bitrate);
+}
+
+bool dbr_get_socket_stats(SOCKET socket, struct dbr_socket_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+
+#if defined(_WIN32)
+#ifdef SIO_TCP_INFO
+	DWORD version = 0;
+	TCP_INFO_v0 info;
+	DWORD bytes = 0;
+
+	if (WSAIoctl(socket, SIO_TCP_INFO, &version, sizeof(version), &info, sizeof(info), &bytes, NULL, NULL) ==
+	    0) {
+		stats->has_queued_bytes = true;
+		stats->queued_bytes = info.BytesOut;
+		stats->has_rtt = true;
+		stats->rtt_usec = (uint32_t)info.RttUs;
+	}
+#else
+	UNUSED_PARAMETER(socket);
+#endif
+
+#elif defined(__APPLE__)
+	int nwrite = 0;
+	socklen_t size = sizeof(nwrite);
+	if (getsockopt(socket, SOL_SOCKET, SO_NWRITE, &nwrite, &size) == 0) {
+		stats->has_queued_bytes = true;
+		stats->queued_bytes = (uint64_t)nwrite;
+	}
+
+	struct tcp_connection_info info;
+	size = sizeof(info);
+	if (getsockopt(socket, IPPROTO_TCP, TCP_CONNECTION_INFO, &info, &size) == 0) {
+		stats->has_rtt = true;
+		stats->rtt_usec = info.tcpi_srtt * 1000;
+	}
+
+#else
+	int outq = 0;
+#ifdef __FreeBSD__
+	if (ioctl(socket, FIONWRITE, &outq) == 0) {
+#else
+	if (ioctl(socket, TIOCOUTQ, &outq) == 0) {
+#endif
+		stats->has_queued_bytes = true;
+		stats->queued_bytes = (uint64_t)outq;
+	}
+
+#ifdef TCP_INFO
+	struct tcp_info info;
+	socklen_t size = sizeof(info);
+	if (getsockopt(socket, IPPROTO_TCP, TCP_INFO, &info, &size) == 0) {
+		stats->has_rtt = true;
+		stats->rtt_usec = info.tcpi_rtt;
+	}
+#endif
+#endif
+
+	return stats->has_queued_bytes || stats->has_rtt;
+}
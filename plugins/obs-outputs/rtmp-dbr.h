@@ -0,0 +1,57 @@
+#pragma once
+
+#include <util/c99defs.h>
+#include "librtmp/rtmp.h"
+
+#define DBR_ALGORITHM_THRESHOLD "threshold"
+#define DBR_ALGORITHM_DELAY "delay"
+
+struct dbr_frame {
+	uint64_t send_beg;
+	uint64_t send_end;
+	size_t size;
+};
+
+struct dbr_socket_stats {
+	bool has_queued_bytes;
+	bool has_rtt;
+
+	uint64_t queued_bytes; /* written but not yet acknowledged */
+	uint32_t rtt_usec;     /* smoothed round trip time */
+};
+
+/* A congestion controller decides the total video bitrate of a stream.
+ *
+ * frame_sent and socket_stats are called from the send thread, update from
+ * the encoder thread for every video packet; the stream serializes them.
+ * update returns the new bitrate in kbps, or the current one to keep it. */
+struct dbr_controller_info {
+	const char *id;
+
+	void *(*create)(long video_bitrate, long audio_bitrate);
+	void (*destroy)(void *data);
+
+	void (*frame_sent)(void *data, const struct dbr_frame *frame);
+
+	/* optional, sampled at most every DBR_SOCKET_SAMPLE_INTERVAL_NS */
+	void (*socket_stats)(void *data, uint64_t ts, const struct dbr_socket_stats *stats);
+
+	long (*update)(void *data, uint64_t ts, int64_t buffer_duration_usec, long cur_bitrate);
+};
+
+#define DBR_SOCKET_SAMPLE_INTERVAL_NS 100000000ULL
+
+struct dbr_controller {
+	const struct dbr_controller_info *info;
+	void *data;
+	uint64_t next_socket_sample;
+};
+
+extern bool dbr_controller_init(struct dbr_controller *dbr, const char *id, long video_bitrate, long audio_bitrate);
+extern void dbr_controller_free(struct dbr_controller *dbr);
+
+extern void dbr_controller_frame_sent(struct dbr_controller *dbr, const struct dbr_frame *frame, SOCKET socket);
+extern long dbr_controller_update(struct dbr_controller *dbr, uint64_t ts, int64_t buffer_duration_usec,
+				  long cur_bitrate);
+
+extern bool dbr_get_socket_stats(SOCKET socket, struct dbr_socket_stats *stats);
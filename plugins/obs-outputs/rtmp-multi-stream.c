@@ -0,0 +1,568 @@
+#include "rtmp-stream.h"
+
+/* Sends the same encoders to several RTMP destinations.  Packets are
+ * interleaved by libobs and parsed once, each destination then only takes a
+ * reference to the parsed packet.  Every destination is an rtmp_stream with
+ * its own connection, send thread, frame dropping and statistics, and is
+ * reconnected independently of the others. */
+
+#undef do_log
+#define do_log(level, format, ...) \
+	blog(level, "[rtmp multi stream: '%s'] " format, obs_output_get_name(multi->output), ##__VA_ARGS__)
+
+#define OPT_DESTINATIONS "destinations"
+
+#define RECONNECT_DELAY_SEC 2
+#define RECONNECT_MAX_DELAY_SEC 30
+
+extern struct obs_output_info rtmp_output_info;
+
+struct rtmp_destination {
+	struct rtmp_stream *stream;
+
+	bool connected;
+	bool attempted;
+	bool failed;
+	uint64_t reconnect_ts;
+	int retry_sec;
+	int reconnects;
+
+	/* totals of previous connections, the stream resets its own on connect */
+	uint64_t prev_bytes_sent;
+	int prev_dropped_frames;
+};
+
+struct rtmp_multi_stream {
+	obs_output_t *output;
+
+	pthread_mutex_t mutex;
+	DARRAY(struct rtmp_destination) destinations;
+	enum video_id_t video_codec[MAX_OUTPUT_VIDEO_ENCODERS];
+
+	os_event_t *stop_event;
+	pthread_t reconnect_thread;
+	bool reconnect_thread_active;
+
+	bool capturing;
+	bool stopping;
+	bool stop_pending;
+	int stop_code;
+};
+
+static const char *rtmp_multi_stream_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return obs_module_text("RTMPMultiStream");
+}
+
+static void stop_reconnect_thread(struct rtmp_multi_stream *multi)
+{
+	if (!multi->reconnect_thread_active)
+		return;
+
+	os_event_signal(multi->stop_event);
+	pthread_join(multi->reconnect_thread, NULL);
+	multi->reconnect_thread_active = false;
+}
+
+/* the threads of a destination report back to the output until they exit,
+ * and look up their destination in the array, so all of them are joined
+ * before any destination is freed */
+static void join_destinations(struct rtmp_multi_stream *multi)
+{
+	for (size_t i = 0; i < multi->destinations.num; i++)
+		rtmp_destination_join(multi->destinations.array[i].stream);
+}
+
+static void free_destinations(struct rtmp_multi_stream *multi)
+{
+	join_destinations(multi);
+
+	for (size_t i = 0; i < multi->destinations.num; i++)
+		rtmp_destination_destroy(multi->destinations.array[i].stream);
+	da_free(multi->destinations);
+}
+
+static bool create_destinations(struct rtmp_multi_stream *multi)
+{
+	obs_data_t *settings = obs_output_get_settings(multi->output);
+	obs_data_array_t *array = obs_data_get_array(settings, OPT_DESTINATIONS);
+	size_t count = obs_data_array_count(array);
+	bool success = true;
+
+	da_reserve(multi->destinations, count);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+		struct rtmp_destination *dest = da_push_back_new(multi->destinations);
+
+		dest->stream = rtmp_destination_create(multi->output, multi, i, item);
+		obs_data_release(item);
+
+		if (!dest->stream) {
+			warn("Failed to create destination %zu", i);
+			da_pop_back(multi->destinations);
+			success = false;
+			break;
+		}
+	}
+
+	obs_data_array_release(array);
+	obs_data_release(settings);
+	return success;
+}
+
+static void rtmp_multi_stream_destroy(void *data)
+{
+	struct rtmp_multi_stream *multi = data;
+
+	pthread_mutex_lock(&multi->mutex);
+	multi->stopping = true;
+	multi->stop_pending = false;
+	pthread_mutex_unlock(&multi->mutex);
+
+	stop_reconnect_thread(multi);
+	free_destinations(multi);
+
+	os_event_destroy(multi->stop_event);
+	pthread_mutex_destroy(&multi->mutex);
+	bfree(multi);
+}
+
+static void get_destination_count_proc(void *data, calldata_t *cd)
+{
+	struct rtmp_multi_stream *multi = data;
+
+	pthread_mutex_lock(&multi->mutex);
+	calldata_set_int(cd, "count", (long long)multi->destinations.num);
+	pthread_mutex_unlock(&multi->mutex);
+}
+
+static void get_destination_stats_proc(void *data, calldata_t *cd)
+{
+	struct rtmp_multi_stream *multi = data;
+	long long idx = calldata_int(cd, "index");
+
+	pthread_mutex_lock(&multi->mutex);
+
+	if (idx >= 0 && (size_t)idx < multi->destinations.num) {
+		struct rtmp_destination *dest = &multi->destinations.array[idx];
+		struct rtmp_stream *stream = dest->stream;
+		uint64_t bytes_sent = dest->prev_bytes_sent;
+		int dropped_frames = dest->prev_dropped_frames;
+
+		if (dest->connected) {
+			bytes_sent += rtmp_output_info.get_total_bytes(stream);
+			dropped_frames += rtmp_output_info.get_dropped_frames(stream);
+		}
+
+		calldata_set_string(cd, "server", obs_data_get_string(stream->destination, "server"));
+		calldata_set_bool(cd, "connected", dest->connected);
+		calldata_set_int(cd, "total_bytes", (long long)bytes_sent);
+		calldata_set_int(cd, "dropped_frames", dropped_frames);
+		calldata_set_float(cd, "congestion", dest->connected ? rtmp_output_info.get_congestion(stream) : 0.0);
+		calldata_set_int(cd, "reconnects", dest->reconnects);
+	}
+
+	pthread_mutex_unlock(&multi->mutex);
+}
+
+static void *rtmp_multi_stream_create(obs_data_t *settings, obs_output_t *output)
+{
+	struct rtmp_multi_stream *multi = bzalloc(sizeof(struct rtmp_multi_stream));
+	multi->output = output;
+	pthread_mutex_init_value(&multi->mutex);
+
+	if (pthread_mutex_init(&multi->mutex, NULL) != 0)
+		goto fail;
+	if (os_event_init(&multi->stop_event, OS_EVENT_TYPE_MANUAL) != 0)
+		goto fail;
+
+	proc_handler_t *ph = obs_output_get_proc_handler(output);
+	proc_handler_add(ph, "void get_destination_count(out int count)", get_destination_count_proc, multi);
+	proc_handler_add(ph,
+			 "void get_destination_stats(in int index, out string server, out bool connected, "
+			 "out int total_bytes, out int dropped_frames, out float congestion, out int reconnects)",
+			 get_destination_stats_proc, multi);
+
+	UNUSED_PARAMETER(settings);
+	return multi;
+
+fail:
+	rtmp_multi_stream_destroy(multi);
+	return NULL;
+}
+
+static void *reconnect_thread(void *data)
+{
+	struct rtmp_multi_stream *multi = data;
+	DARRAY(size_t) starts = {0};
+
+	os_set_thread_name("rtmp-multi-stream: reconnect_thread");
+
+	while (os_event_timedwait(multi->stop_event, 250) == ETIMEDOUT) {
+		uint64_t ts = os_gettime_ns();
+
+		pthread_mutex_lock(&multi->mutex);
+		for (size_t i = 0; i < multi->destinations.num; i++) {
+			struct rtmp_destination *dest = &multi->destinations.array[i];
+
+			if (dest->reconnect_ts && ts >= dest->reconnect_ts) {
+				dest->reconnect_ts = 0;
+				dest->reconnects++;
+				da_push_back(starts, &i);
+			}
+		}
+		pthread_mutex_unlock(&multi->mutex);
+
+		/* stopping joins this thread before stopping the destinations,
+		 * so they can be started without holding the mutex */
+		for (size_t i = 0; i < starts.num; i++) {
+			struct rtmp_destination *dest = &multi->destinations.array[starts.array[i]];
+
+			info("Reconnecting destination %zu", starts.array[i]);
+			if (!rtmp_destination_start(dest->stream))
+				warn("Failed to restart destination %zu", starts.array[i]);
+		}
+		da_resize(starts, 0);
+	}
+
+	da_free(starts);
+	return NULL;
+}
+
+static bool rtmp_multi_stream_start(void *data)
+{
+	struct rtmp_multi_stream *multi = data;
+
+	if (!obs_output_can_begin_data_capture(multi->output, 0))
+		return false;
+	if (!obs_output_initialize_encoders(multi->output, 0))
+		return false;
+
+	stop_reconnect_thread(multi);
+	free_destinations(multi);
+
+	if (!create_destinations(multi))
+		return false;
+
+	if (!multi->destinations.num) {
+		warn("No destinations set");
+		return false;
+	}
+
+	for (size_t i = 0; i < MAX_OUTPUT_VIDEO_ENCODERS; i++) {
+		obs_encoder_t *enc = obs_output_get_video_encoder2(multi->output, i);
+		multi->video_codec[i] = enc ? to_video_type(obs_encoder_get_codec(enc)) : CODEC_NONE;
+	}
+
+	multi->capturing = false;
+	multi->stopping = false;
+	multi->stop_pending = false;
+	multi->stop_code = OBS_OUTPUT_SUCCESS;
+	os_event_reset(multi->stop_event);
+
+	if (pthread_create(&multi->reconnect_thread, NULL, reconnect_thread, multi) != 0) {
+		warn("Failed to create reconnect thread");
+		return false;
+	}
+	multi->reconnect_thread_active = true;
+
+	info("Starting %zu destinations", multi->destinations.num);
+
+	for (size_t i = 0; i < multi->destinations.num; i++) {
+		if (!rtmp_destination_start(multi->destinations.array[i].stream))
+			rtmp_multi_destination_stopped(multi, i, OBS_OUTPUT_ERROR);
+	}
+
+	return true;
+}
+
+/* mutex must be held, returns true if the output is done stopping */
+static bool check_stopped(struct rtmp_multi_stream *multi)
+{
+	if (!multi->stop_pending)
+		return false;
+
+	for (size_t i = 0; i < multi->destinations.num; i++) {
+		if (multi->destinations.array[i].connected)
+			return false;
+	}
+
+	multi->stop_pending = false;
+	return true;
+}
+
+static void finish_stop(struct rtmp_multi_stream *multi)
+{
+	bool capturing = multi->capturing;
+	multi->capturing = false;
+
+	if (!capturing)
+		obs_output_signal_stop(multi->output, OBS_OUTPUT_SUCCESS);
+	else if (multi->stop_code == OBS_OUTPUT_ENCODE_ERROR)
+		obs_output_signal_stop(multi->output, OBS_OUTPUT_ENCODE_ERROR);
+	else
+		obs_output_end_data_capture(multi->output);
+}
+
+static void rtmp_multi_stream_stop(void *data, uint64_t ts)
+{
+	struct rtmp_multi_stream *multi = data;
+	bool finish;
+
+	pthread_mutex_lock(&multi->mutex);
+	multi->stopping = true;
+	pthread_mutex_unlock(&multi->mutex);
+
+	stop_reconnect_thread(multi);
+
+	for (size_t i = 0; i < multi->destinations.num; i++)
+		rtmp_destination_stop(multi->destinations.array[i].stream, ts);
+
+	/* nothing is left to send when stopping right away.  otherwise the
+	 * destinations drain first, and are joined once they are freed. */
+	if (!ts)
+		join_destinations(multi);
+
+	pthread_mutex_lock(&multi->mutex);
+	multi->stop_pending = true;
+	finish = check_stopped(multi);
+	pthread_mutex_unlock(&multi->mutex);
+
+	if (finish)
+		finish_stop(multi);
+}
+
+void rtmp_multi_destination_started(struct rtmp_multi_stream *multi, size_t idx)
+{
+	struct rtmp_destination *dest;
+	bool begin;
+
+	pthread_mutex_lock(&multi->mutex);
+	dest = &multi->destinations.array[idx];
+	dest->connected = true;
+	dest->attempted = true;
+	dest->retry_sec = 0;
+	begin = !multi->capturing;
+	multi->capturing = true;
+	pthread_mutex_unlock(&multi->mutex);
+
+	if (begin)
+		obs_output_begin_data_capture(multi->output, 0);
+}
+
+static inline bool is_permanent_failure(int code)
+{
+	return code == OBS_OUTPUT_BAD_PATH || code == OBS_OUTPUT_INVALID_STREAM || code == OBS_OUTPUT_UNSUPPORTED ||
+	       code == OBS_OUTPUT_HDR_DISABLED;
+}
+
+/* mutex must be held, true if no destination is connected or will be */
+static bool all_destinations_failed(struct rtmp_multi_stream *multi)
+{
+	for (size_t i = 0; i < multi->destinations.num; i++) {
+		struct rtmp_destination *dest = &multi->destinations.array[i];
+
+		if (dest->connected || !dest->attempted)
+			return false;
+		if (multi->capturing && !dest->failed)
+			return false;
+	}
+
+	return true;
+}
+
+void rtmp_multi_destination_stopped(struct rtmp_multi_stream *multi, size_t idx, int code)
+{
+	struct rtmp_destination *dest;
+	struct rtmp_stream *stream;
+	bool finish = false;
+	bool failed = false;
+
+	pthread_mutex_lock(&multi->mutex);
+
+	dest = &multi->destinations.array[idx];
+	stream = dest->stream;
+
+	if (dest->connected) {
+		dest->prev_bytes_sent += stream->total_bytes_sent;
+		dest->prev_dropped_frames += stream->dropped_frames;
+	}
+
+	dest->connected = false;
+	dest->attempted = true;
+
+	if (code == OBS_OUTPUT_ENCODE_ERROR)
+		multi->stop_code = code;
+
+	if (multi->stopping) {
+		finish = check_stopped(multi);
+
+	} else if (is_permanent_failure(code)) {
+		warn("Destination %zu failed (%d), not reconnecting", idx, code);
+		dest->failed = true;
+
+	} else {
+		dest->retry_sec = dest->retry_sec ? dest->retry_sec * 2 : RECONNECT_DELAY_SEC;
+		if (dest->retry_sec > RECONNECT_MAX_DELAY_SEC)
+			dest->retry_sec = RECONNECT_MAX_DELAY_SEC;
+
+		dest->reconnect_ts = os_gettime_ns() + (uint64_t)dest->retry_sec * 1000000000ULL;
+		info("Destination %zu stopped (%d), reconnecting in %d seconds", idx, code, dest->retry_sec);
+	}
+
+	/* stop the output once nothing is left to send to */
+	if (!multi->stopping && all_destinations_failed(multi)) {
+		multi->stopping = true;
+		multi->capturing = false;
+		os_event_signal(multi->stop_event);
+		failed = true;
+	}
+
+	pthread_mutex_unlock(&multi->mutex);
+
+	if (finish)
+		finish_stop(multi);
+	else if (failed)
+		obs_output_signal_stop(multi->output, code);
+}
+
+static void rtmp_multi_stream_data(void *data, struct encoder_packet *packet)
+{
+	struct rtmp_multi_stream *multi = data;
+	struct encoder_packet new_packet;
+	enum video_id_t codec = CODEC_NONE;
+
+	/* encoder fail */
+	if (!packet) {
+		for (size_t i = 0; i < multi->destinations.num; i++)
+			rtmp_destination_data(multi->destinations.array[i].stream, NULL);
+		return;
+	}
+
+	if (packet->type == OBS_ENCODER_VIDEO) {
+		codec = multi->video_codec[packet->track_idx];
+		if (codec == CODEC_NONE) {
+			do_log(LOG_ERROR, "Codec not initialized for track %zu", packet->track_idx);
+			return;
+		}
+	}
+
+	if (!rtmp_parse_packet(codec, &new_packet, packet))
+		return;
+
+	for (size_t i = 0; i < multi->destinations.num; i++)
+		rtmp_destination_data(multi->destinations.array[i].stream, &new_packet);
+
+	obs_encoder_packet_release(&new_packet);
+}
+
+static void rtmp_multi_stream_defaults(obs_data_t *defaults)
+{
+	rtmp_output_info.get_defaults(defaults);
+}
+
+static obs_properties_t *rtmp_multi_stream_properties(void *data)
+{
+	return rtmp_output_info.get_properties(data);
+}
+
+static uint64_t rtmp_multi_stream_total_bytes_sent(void *data)
+{
+	struct rtmp_multi_stream *multi = data;
+	uint64_t total = 0;
+
+	pthread_mutex_lock(&multi->mutex);
+	for (size_t i = 0; i < multi->destinations.num; i++) {
+		struct rtmp_destination *dest = &multi->destinations.array[i];
+
+		total += dest->prev_bytes_sent;
+		if (dest->connected)
+			total += rtmp_output_info.get_total_bytes(dest->stream);
+	}
+	pthread_mutex_unlock(&multi->mutex);
+
+	return total;
+}
+
+static int rtmp_multi_stream_dropped_frames(void *data)
+{
+	struct rtmp_multi_stream *multi = data;
+	int dropped = 0;
+
+	pthread_mutex_lock(&multi->mutex);
+	for (size_t i = 0; i < multi->destinations.num; i++) {
+		struct rtmp_destination *dest = &multi->destinations.array[i];
+
+		dropped += dest->prev_dropped_frames;
+		if (dest->connected)
+			dropped += rtmp_output_info.get_dropped_frames(dest->stream);
+	}
+	pthread_mutex_unlock(&multi->mutex);
+
+	return dropped;
+}
+
+static float rtmp_multi_stream_congestion(void *data)
+{
+	struct rtmp_multi_stream *multi = data;
+	float congestion = 0.0f;
+
+	pthread_mutex_lock(&multi->mutex);
+	for (size_t i = 0; i < multi->destinations.num; i++) {
+		struct rtmp_destination *dest = &multi->destinations.array[i];
+
+		if (dest->connected) {
+			float val = rtmp_output_info.get_congestion(dest->stream);
+			if (val > congestion)
+				congestion = val;
+		}
+	}
+	pthread_mutex_unlock(&multi->mutex);
+
+	return congestion;
+}
+
+static int rtmp_multi_stream_connect_time(void *data)
+{
+	struct rtmp_multi_stream *multi = data;
+	int connect_time = 0;
+
+	pthread_mutex_lock(&multi->mutex);
+	for (size_t i = 0; i < multi->destinations.num; i++) {
+		struct rtmp_destination *dest = &multi->destinations.array[i];
+
+		if (dest->connected) {
+			int val = rtmp_output_info.get_connect_time_ms(dest->stream);
+			if (val > connect_time)
+				connect_time = val;
+		}
+	}
+	pthread_mutex_unlock(&multi->mutex);
+
+	return connect_time;
+}
+
+struct obs_output_info rtmp_multi_output_info = {
+	.id = "rtmp_multi_output",
+	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK_AV,
+#ifdef ENABLE_HEVC
+	.encoded_video_codecs = "h264;hevc;av1",
+#else
+	.encoded_video_codecs = "h264;av1",
+#endif
+	.encoded_audio_codecs = "aac",
+	.get_name = rtmp_multi_stream_getname,
+	.create = rtmp_multi_stream_create,
+	.destroy = rtmp_multi_stream_destroy,
+	.start = rtmp_multi_stream_start,
+	.stop = rtmp_multi_stream_stop,
+	.encoded_packet = rtmp_multi_stream_data,
+	.get_defaults = rtmp_multi_stream_defaults,
+	.get_properties = rtmp_multi_stream_properties,
+	.get_total_bytes = rtmp_multi_stream_total_bytes_sent,
+	.get_congestion = rtmp_multi_stream_congestion,
+	.get_connect_time_ms = rtmp_multi_stream_connect_time,
+	.get_dropped_frames = rtmp_multi_stream_dropped_frames,
+};
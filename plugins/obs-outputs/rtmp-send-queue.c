@@ -0,0 +1,135 @@
+#include "rtmp-send-queue.h"
+
+struct send_queue_entry {
+	struct encoder_packet packet;
+	bool dropped;
+};
+
+static inline struct send_queue_entry *get_entry(struct rtmp_send_queue *queue, uint64_t seq)
+{
+	size_t idx = (size_t)(seq - queue->head_seq);
+	return deque_data(&queue->entries, idx * sizeof(struct send_queue_entry));
+}
+
+static inline size_t num_entries(const struct rtmp_send_queue *queue)
+{
+	return queue->entries.size / sizeof(struct send_queue_entry);
+}
+
+static inline bool is_droppable(const struct encoder_packet *packet)
+{
+	return packet->type == OBS_ENCODER_VIDEO && packet->drop_priority >= 0 &&
+	       packet->drop_priority < RTMP_SEND_QUEUE_PRIORITIES;
+}
+
+void rtmp_send_queue_free(struct rtmp_send_queue *queue)
+{
+	rtmp_send_queue_clear(queue);
+
+	deque_free(&queue->entries);
+	for (size_t i = 0; i < RTMP_SEND_QUEUE_PRIORITIES; i++)
+		deque_free(&queue->droppable[i]);
+	deque_free(&queue->delta_frames);
+}
+
+void rtmp_send_queue_clear(struct rtmp_send_queue *queue)
+{
+	while (queue->entries.size) {
+		struct send_queue_entry entry;
+		deque_pop_front(&queue->entries, &entry, sizeof(entry));
+		if (!entry.dropped)
+			obs_encoder_packet_release(&entry.packet);
+	}
+
+	for (size_t i = 0; i < RTMP_SEND_QUEUE_PRIORITIES; i++)
+		deque_pop_front(&queue->droppable[i], NULL, queue->droppable[i].size);
+	deque_pop_front(&queue->delta_frames, NULL, queue->delta_frames.size);
+
+	queue->head_seq = 0;
+	queue->count = 0;
+}
+
+void rtmp_send_queue_push(struct rtmp_send_queue *queue, struct encoder_packet *packet)
+{
+	struct send_queue_entry entry = {.packet = *packet};
+	uint64_t seq = queue->head_seq + num_entries(queue);
+
+	deque_push_back(&queue->entries, &entry, sizeof(entry));
+	queue->count++;
+
+	if (packet->type != OBS_ENCODER_VIDEO)
+		return;
+
+	if (is_droppable(packet))
+		deque_push_back(&queue->droppable[packet->drop_priority], &seq, sizeof(seq));
+	if (!packet->keyframe)
+		deque_push_back(&queue->delta_frames, &seq, sizeof(seq));
+}
+
+bool rtmp_send_queue_pop(struct rtmp_send_queue *queue, struct encoder_packet *packet)
+{
+	while (queue->entries.size) {
+		struct send_queue_entry entry;
+		deque_pop_front(&queue->entries, &entry, sizeof(entry));
+		queue->head_seq++;
+
+		if (entry.dropped)
+			continue;
+
+		/* the front of the FIFO is always the oldest packet of its
+		 * priority, since drops empty a priority entirely */
+		if (is_droppable(&entry.packet))
+			deque_pop_front(&queue->droppable[entry.packet.drop_priority], NULL, sizeof(uint64_t));
+
+		queue->count--;
+		*packet = entry.packet;
+		return true;
+	}
+
+	return false;
+}
+
+size_t rtmp_send_queue_drop(struct rtmp_send_queue *queue, int highest_priority)
+{
+	size_t dropped = 0;
+
+	if (highest_priority > RTMP_SEND_QUEUE_PRIORITIES)
+		highest_priority = RTMP_SEND_QUEUE_PRIORITIES;
+
+	for (int priority = 0; priority < highest_priority; priority++) {
+		struct deque *seqs = &queue->droppable[priority];
+
+		while (seqs->size) {
+			uint64_t seq;
+			deque_pop_front(seqs, &seq, sizeof(seq));
+
+			struct send_queue_entry *entry = get_entry(queue, seq);
+			obs_encoder_packet_release(&entry->packet);
+			entry->dropped = true;
+			dropped++;
+		}
+	}
+
+	queue->count -= dropped;
+	return dropped;
+}
+
+bool rtmp_send_queue_first_delta_dts(struct rtmp_send_queue *queue, int64_t *dts_usec)
+{
+	while (queue->delta_frames.size) {
+		uint64_t seq;
+		deque_peek_front(&queue->delta_frames, &seq, sizeof(seq));
+
+		if (seq >= queue->head_seq) {
+			struct send_queue_entry *entry = get_entry(queue, seq);
+			if (!entry->dropped) {
+				*dts_usec = entry->packet.dts_usec;
+				return true;
+			}
+		}
+
+		deque_pop_front(&queue->delta_frames, NULL, sizeof(seq));
+	}
+
+	return false;
+}
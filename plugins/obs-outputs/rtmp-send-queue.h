@@ -0,0 +1,50 @@
+#pragma once
+
+#include <obs.h>
+#include <obs-nal.h>
+#include <util/deque.h>
+
+/* FIFO of encoder packets waiting to be sent, indexed by drop priority.
+ *
+ * Video packets below OBS_NAL_PRIORITY_HIGHEST are additionally tracked per
+ * priority, so dropping every packet below a priority only touches the
+ * packets being dropped.  Dropped packets are released immediately and leave
+ * a hole in the FIFO that is skipped when it reaches the front.
+ *
+ * Not thread safe; the stream guards it with its packets mutex. */
+
+#define RTMP_SEND_QUEUE_PRIORITIES OBS_NAL_PRIORITY_HIGHEST
+
+struct rtmp_send_queue {
+	struct deque entries;
+	uint64_t head_seq; /* sequence number of the first entry */
+	size_t count;      /* packets that have not been dropped */
+
+	/* sequence numbers of droppable video packets, per drop priority */
+	struct deque droppable[RTMP_SEND_QUEUE_PRIORITIES];
+
+	/* sequence numbers of video packets that are not keyframes; entries
+	 * that were sent or dropped are pruned when the front is queried */
+	struct deque delta_frames;
+};
+
+extern void rtmp_send_queue_free(struct rtmp_send_queue *queue);
+
+/* releases every queued packet but keeps the allocations */
+extern void rtmp_send_queue_clear(struct rtmp_send_queue *queue);
+
+/* takes ownership of the packet */
+extern void rtmp_send_queue_push(struct rtmp_send_queue *queue, struct encoder_packet *packet);
+extern bool rtmp_send_queue_pop(struct rtmp_send_queue *queue, struct encoder_packet *packet);
+
+/* releases every video packet with a drop priority below highest_priority
+ * and returns how many were dropped */
+extern size_t rtmp_send_queue_drop(struct rtmp_send_queue *queue, int highest_priority);
+
+/* dts of the oldest queued video packet that is not a keyframe */
+extern bool rtmp_send_queue_first_delta_dts(struct rtmp_send_queue *queue, int64_t *dts_usec);
+
+static inline size_t rtmp_send_queue_count(const struct rtmp_send_queue *queue)
+{
+	return queue->count;
+}
@@ -40,12 +40,6 @@
 #define MSEC_TO_NSEC 1000000ULL
 #endif
 
-/* dynamic bitrate coefficients */
-#define DBR_INC_TIMER (4ULL * SEC_TO_NSEC)
-#define DBR_TRIGGER_USEC (200ULL * MSEC_TO_USEC)
-#define MIN_ESTIMATE_DURATION_MS 1000
-#define MAX_ESTIMATE_DURATION_MS 2000
-
 static const char *rtmp_stream_getname(void *unused)
 {
 	UNUSED_PARAMETER(unused);
@@ -72,11 +66,7 @@ static inline void free_packets(struct rtmp_stream *stream)
 	if (num_packets)
 		info("Freeing %d remaining packets", (int)num_packets);
 
-	while (stream->packets.size) {
-		struct encoder_packet packet;
-		deque_pop_front(&stream->packets, &packet, sizeof(packet));
-		obs_encoder_packet_release(&packet);
-	}
+	rtmp_send_queue_clear(&stream->packets);
 	pthread_mutex_unlock(&stream->packets_mutex);
 }
 
@@ -100,24 +90,58 @@ static inline bool disconnected(struct rtmp_stream *stream)
 	return os_atomic_load_bool(&stream->disconnected);
 }
 
+/* destinations of a multi-destination output report to it instead */
+static void signal_stop(struct rtmp_stream *stream, int code)
+{
+	if (stream->multi)
+		rtmp_multi_destination_stopped(stream->multi, stream->multi_idx, code);
+	else
+		obs_output_signal_stop(stream->output, code);
+}
+
+static void join_connect_thread(struct rtmp_stream *stream)
+{
+	if (!stream->multi) {
+		if (connecting(stream))
+			pthread_join(stream->connect_thread, NULL);
+		return;
+	}
+
+	if (stream->connect_thread_joinable)
+		pthread_join(stream->connect_thread, NULL);
+	stream->connect_thread_joinable = false;
+}
+
+static void join_send_thread(struct rtmp_stream *stream)
+{
+	if (!stream->multi) {
+		pthread_join(stream->send_thread, NULL);
+		return;
+	}
+
+	if (stream->send_thread_joinable)
+		pthread_join(stream->send_thread, NULL);
+	stream->send_thread_joinable = false;
+}
+
 static void rtmp_stream_destroy(void *data)
 {
 	struct rtmp_stream *stream = data;
 
 	if (stopping(stream) && !connecting(stream)) {
-		pthread_join(stream->send_thread, NULL);
+		join_send_thread(stream);
 
 	} else if (connecting(stream) || active(stream)) {
-		if (stream->connecting)
-			pthread_join(stream->connect_thread, NULL);
+		join_connect_thread(stream);
 
 		stream->stop_ts = 0;
 		os_event_signal(stream->stop_event);
 
 		if (active(stream)) {
 			os_sem_post(stream->send_sem);
-			obs_output_end_data_capture(stream->output);
-			pthread_join(stream->send_thread, NULL);
+			if (!stream->multi)
+				obs_output_end_data_capture(stream->output);
+			join_send_thread(stream);
 		}
 	}
 
@@ -129,14 +153,15 @@ static void rtmp_stream_destroy(void *data)
 	dstr_free(&stream->password);
 	dstr_free(&stream->encoder_name);
 	dstr_free(&stream->bind_ip);
+	obs_data_release(stream->destination);
 	os_event_destroy(stream->stop_event);
 	os_sem_destroy(stream->send_sem);
 	pthread_mutex_destroy(&stream->packets_mutex);
-	deque_free(&stream->packets);
+	rtmp_send_queue_free(&stream->packets);
 #ifdef TEST_FRAMEDROPS
 	deque_free(&stream->droptest_info);
 #endif
-	deque_free(&stream->dbr_frames);
+	dbr_controller_free(&stream->dbr);
 	da_free(stream->dbr_interpolation_table);
 	pthread_mutex_destroy(&stream->dbr_mutex);
 
@@ -207,8 +232,7 @@ static void rtmp_stream_stop(void *data, uint64_t ts)
 	if (stopping(stream) && ts != 0)
 		return;
 
-	if (connecting(stream))
-		pthread_join(stream->connect_thread, NULL);
+	join_connect_thread(stream);
 
 	stream->stop_ts = ts / 1000ULL;
 
@@ -220,7 +244,7 @@ static void rtmp_stream_stop(void *data, uint64_t ts)
 		if (stream->stop_ts == 0)
 			os_sem_post(stream->send_sem);
 	} else {
-		obs_output_signal_stop(stream->output, OBS_OUTPUT_SUCCESS);
+		signal_stop(stream, OBS_OUTPUT_SUCCESS);
 	}
 }
 
@@ -236,10 +260,7 @@ static inline bool get_next_packet(struct rtmp_stream *stream, struct encoder_pa
 	bool new_packet = false;
 
 	pthread_mutex_lock(&stream->packets_mutex);
-	if (stream->packets.size) {
-		deque_pop_front(&stream->packets, packet, sizeof(struct encoder_packet));
-		new_packet = true;
-	}
+	new_packet = rtmp_send_queue_pop(&stream->packets, packet);
 	pthread_mutex_unlock(&stream->packets_mutex);
 
 	return new_packet;
@@ -399,23 +420,38 @@ static int handle_socket_read(struct rtmp_stream *stream)
 	return 0;
 }
 
+/* Sends the tag body straight from the packet data, RTMP_WriteMessage only
+ * adds the chunk headers around it */
+static int send_flv_tag(struct rtmp_stream *stream, const struct flv_tag *tag, struct encoder_packet *packet,
+			size_t *size)
+{
+	RTMPBuf body[2] = {
+		{(const char *)tag->prefix, (int)tag->prefix_size},
+		{(const char *)packet->data, (int)packet->size},
+	};
+
+	*size = tag->prefix_size + packet->size;
+
+#ifdef TEST_FRAMEDROPS
+	droptest_cap_data_rate(stream, *size);
+#endif
+
+	if (!RTMP_WriteMessage(&stream->rtmp, tag->type, (uint32_t)tag->time_ms & 0x7FFFFFFF, body, 2, 0))
+		return -1;
+	return (int)*size;
+}
+
 static int send_packet(struct rtmp_stream *stream, struct encoder_packet *packet, bool is_header)
 {
-	uint8_t *data;
-	size_t size;
+	struct flv_tag tag;
+	size_t size = 0;
 	int ret = 0;
 
 	if (handle_socket_read(stream))
 		return -1;
 
-	flv_packet_mux(packet, is_header ? 0 : stream->start_dts_offset, &data, &size, is_header);
-
-#ifdef TEST_FRAMEDROPS
-	droptest_cap_data_rate(stream, size);
-#endif
-
-	ret = RTMP_Write(&stream->rtmp, (char *)data, (int)size, 0);
-	bfree(data);
+	if (flv_tag_mux(packet, is_header ? 0 : stream->start_dts_offset, &tag, is_header))
+		ret = send_flv_tag(stream, &tag, packet, &size);
 
 	if (is_header)
 		bfree(packet->data);
@@ -429,7 +465,7 @@ static int send_packet(struct rtmp_stream *stream, struct encoder_packet *packet
 static int send_packet_ex(struct rtmp_stream *stream, struct encoder_packet *packet, bool is_header, bool is_footer,
 			  size_t idx)
 {
-	uint8_t *data;
+	struct flv_tag tag;
 	size_t size = 0;
 	int ret = 0;
 
@@ -437,19 +473,14 @@ static int send_packet_ex(struct rtmp_stream *stream, struct encoder_packet *pac
 		return -1;
 
 	if (is_header) {
-		flv_packet_start(packet, stream->video_codec[idx], &data, &size, idx);
+		flv_tag_start(packet, stream->video_codec[idx], &tag, idx);
 	} else if (is_footer) {
-		flv_packet_end(packet, stream->video_codec[idx], &data, &size, idx);
+		flv_tag_end(packet, stream->video_codec[idx], &tag, idx);
 	} else {
-		flv_packet_frames(packet, stream->video_codec[idx], stream->start_dts_offset, &data, &size, idx);
+		flv_tag_frames(packet, stream->video_codec[idx], stream->start_dts_offset, &tag, idx);
 	}
 
-#ifdef TEST_FRAMEDROPS
-	droptest_cap_data_rate(stream, size);
-#endif
-
-	ret = RTMP_Write(&stream->rtmp, (char *)data, (int)size, 0);
-	bfree(data);
+	ret = send_flv_tag(stream, &tag, packet, &size);
 
 	if (is_header || is_footer) // manually created packets
 		bfree(packet->data);
@@ -462,21 +493,22 @@ static int send_packet_ex(struct rtmp_stream *stream, struct encoder_packet *pac
 
 static int send_audio_packet_ex(struct rtmp_stream *stream, struct encoder_packet *packet, bool is_header, size_t idx)
 {
-	uint8_t *data;
+	struct flv_tag tag;
 	size_t size = 0;
+	bool has_tag;
 	int ret = 0;
 
 	if (handle_socket_read(stream))
 		return -1;
 
 	if (is_header) {
-		flv_packet_audio_start(packet, stream->audio_codec[idx], &data, &size, idx);
+		has_tag = flv_tag_audio_start(packet, stream->audio_codec[idx], &tag, idx);
 	} else {
-		flv_packet_audio_frames(packet, stream->audio_codec[idx], stream->start_dts_offset, &data, &size, idx);
+		has_tag = flv_tag_audio_frames(packet, stream->audio_codec[idx], stream->start_dts_offset, &tag, idx);
 	}
 
-	ret = RTMP_Write(&stream->rtmp, (char *)data, (int)size, 0);
-	bfree(data);
+	if (has_tag)
+		ret = send_flv_tag(stream, &tag, packet, &size);
 
 	if (is_header)
 		bfree(packet->data);
@@ -585,34 +617,6 @@ static void set_output_error(struct rtmp_stream *stream)
 		obs_output_set_last_error(stream->output, msg);
 }
 
-static void dbr_add_frame(struct rtmp_stream *stream, struct dbr_frame *back)
-{
-	struct dbr_frame front;
-	uint64_t dur;
-
-	deque_push_back(&stream->dbr_frames, back, sizeof(*back));
-	deque_peek_front(&stream->dbr_frames, &front, sizeof(front));
-
-	stream->dbr_data_size += back->size;
-
-	dur = (back->send_end - front.send_beg) / 1000000;
-
-	if (dur >= MAX_ESTIMATE_DURATION_MS) {
-		stream->dbr_data_size -= front.size;
-		deque_pop_front(&stream->dbr_frames, NULL, sizeof(front));
-	}
-
-	stream->dbr_est_bitrate = (dur >= MIN_ESTIMATE_DURATION_MS) ? (long)(stream->dbr_data_size * 1000 / dur) : 0;
-	stream->dbr_est_bitrate *= 8;
-	stream->dbr_est_bitrate /= 1000;
-
-	if (stream->dbr_est_bitrate) {
-		stream->dbr_est_bitrate -= stream->audio_bitrate;
-		if (stream->dbr_est_bitrate < 50)
-			stream->dbr_est_bitrate = 50;
-	}
-}
-
 static void dbr_set_bitrate(struct rtmp_stream *stream);
 
 #ifdef _WIN32
@@ -689,7 +693,7 @@ static void *send_thread(void *data)
 			dbr_frame.send_end = os_gettime_ns();
 
 			pthread_mutex_lock(&stream->dbr_mutex);
-			dbr_add_frame(stream, &dbr_frame);
+			dbr_controller_frame_sent(&stream->dbr, &dbr_frame, stream->rtmp.m_sb.sb_socket);
 			pthread_mutex_unlock(&stream->dbr_mutex);
 		}
 	}
@@ -730,13 +734,21 @@ static void *send_thread(void *data)
 		}
 	}
 
+	int code = OBS_OUTPUT_SUCCESS;
+
 	if (!stopping(stream)) {
-		pthread_detach(stream->send_thread);
-		obs_output_signal_stop(stream->output, OBS_OUTPUT_DISCONNECTED);
+		if (!stream->multi)
+			pthread_detach(stream->send_thread);
+		code = OBS_OUTPUT_DISCONNECTED;
 	} else if (encode_error) {
-		obs_output_signal_stop(stream->output, OBS_OUTPUT_ENCODE_ERROR);
-	} else {
-		obs_output_end_data_capture(stream->output);
+		code = OBS_OUTPUT_ENCODE_ERROR;
+	}
+
+	if (!stream->multi) {
+		if (code == OBS_OUTPUT_SUCCESS)
+			obs_output_end_data_capture(stream->output);
+		else
+			obs_output_signal_stop(stream->output, code);
 	}
 
 	free_packets(stream);
@@ -744,6 +756,10 @@ static void *send_thread(void *data)
 	os_atomic_set_bool(&stream->active, false);
 	stream->sent_headers = false;
 
+	/* only report once the stream can be restarted */
+	if (stream->multi)
+		rtmp_multi_destination_stopped(stream->multi, stream->multi_idx, code);
+
 	return NULL;
 }
 
@@ -988,6 +1004,7 @@ static int init_send(struct rtmp_stream *stream)
 		warn("Failed to create send thread");
 		return OBS_OUTPUT_ERROR;
 	}
+	stream->send_thread_joinable = true;
 
 	if (stream->new_socket_loop) {
 		int one = 1;
@@ -1085,7 +1102,10 @@ static int init_send(struct rtmp_stream *stream)
 		return OBS_OUTPUT_DISCONNECTED;
 	}
 
-	obs_output_begin_data_capture(stream->output, 0);
+	if (stream->multi)
+		rtmp_multi_destination_started(stream->multi, stream->multi_idx);
+	else
+		obs_output_begin_data_capture(stream->output, 0);
 
 	return OBS_OUTPUT_SUCCESS;
 }
@@ -1333,13 +1353,13 @@ static bool init_connect(struct rtmp_stream *stream)
 	int64_t drop_b;
 
 	if (stopping(stream)) {
-		pthread_join(stream->send_thread, NULL);
+		join_send_thread(stream);
 	}
 
 	free_packets(stream);
 
 	service = obs_output_get_service(stream->output);
-	if (!service)
+	if (!service && !stream->multi)
 		return false;
 
 	os_atomic_set_bool(&stream->disconnected, false);
@@ -1350,10 +1370,19 @@ static bool init_connect(struct rtmp_stream *stream)
 	stream->got_first_packet = false;
 
 	settings = obs_output_get_settings(stream->output);
-	dstr_copy(&stream->path, obs_service_get_connect_info(service, OBS_SERVICE_CONNECT_INFO_SERVER_URL));
-	dstr_copy(&stream->key, obs_service_get_connect_info(service, OBS_SERVICE_CONNECT_INFO_STREAM_KEY));
-	dstr_copy(&stream->username, obs_service_get_connect_info(service, OBS_SERVICE_CONNECT_INFO_USERNAME));
-	dstr_copy(&stream->password, obs_service_get_connect_info(service, OBS_SERVICE_CONNECT_INFO_PASSWORD));
+	if (stream->multi) {
+		dstr_copy(&stream->path, obs_data_get_string(stream->destination, "server"));
+		dstr_copy(&stream->key, obs_data_get_string(stream->destination, "key"));
+		dstr_copy(&stream->username, obs_data_get_string(stream->destination, "username"));
+		dstr_copy(&stream->password, obs_data_get_string(stream->destination, "password"));
+	} else {
+		dstr_copy(&stream->path, obs_service_get_connect_info(service, OBS_SERVICE_CONNECT_INFO_SERVER_URL));
+		dstr_copy(&stream->key, obs_service_get_connect_info(service, OBS_SERVICE_CONNECT_INFO_STREAM_KEY));
+		dstr_copy(&stream->username,
+			  obs_service_get_connect_info(service, OBS_SERVICE_CONNECT_INFO_USERNAME));
+		dstr_copy(&stream->password,
+			  obs_service_get_connect_info(service, OBS_SERVICE_CONNECT_INFO_PASSWORD));
+	}
 	dstr_depad(&stream->path);
 	dstr_depad(&stream->key);
 	drop_b = (int64_t)obs_data_get_int(settings, OPT_DROP_THRESHOLD);
@@ -1425,14 +1454,9 @@ static bool init_connect(struct rtmp_stream *stream)
 		obs_data_release(settings);
 	}
 
-	deque_free(&stream->dbr_frames);
-	stream->audio_bitrate = (long)overall_audio_bitrate;
-	stream->dbr_data_size = 0;
+	dbr_controller_free(&stream->dbr);
 	stream->dbr_orig_bitrate = (long)overall_video_bitrate;
 	stream->dbr_cur_bitrate = stream->dbr_orig_bitrate;
-	stream->dbr_est_bitrate = 0;
-	stream->dbr_inc_bitrate = stream->dbr_orig_bitrate / 10;
-	stream->dbr_inc_timeout = 0;
 	stream->dbr_enabled = dbr_capable && obs_data_get_bool(settings, OPT_DYN_BITRATE);
 
 	if (obs_output_get_delay(stream->output) != 0) {
@@ -1440,6 +1464,10 @@ static bool init_connect(struct rtmp_stream *stream)
 		stream->dbr_enabled = false;
 	}
 
+	/* the encoders are shared with the other destinations */
+	if (stream->multi)
+		stream->dbr_enabled = false;
+
 	if (stream->dbr_enabled && !obs_data_has_user_value(settings, OPT_DYN_BITRATE_INTERPOLATION_TABLE_DATA)) {
 		info("Dynamic bitrate using default interpolation");
 	} else if (obs_data_has_user_value(settings, OPT_DYN_BITRATE_INTERPOLATION_TABLE_DATA)) {
@@ -1454,7 +1482,16 @@ static bool init_connect(struct rtmp_stream *stream)
 	}
 
 	if (stream->dbr_enabled) {
-		info("Dynamic bitrate enabled.  Dropped frames begone!");
+		const char *algorithm = obs_data_get_string(settings, OPT_DYN_BITRATE_ALGORITHM);
+
+		if (!dbr_controller_init(&stream->dbr, algorithm, stream->dbr_orig_bitrate,
+					 (long)overall_audio_bitrate)) {
+			warn("Unknown dynamic bitrate algorithm '%s', using '%s'", algorithm, DBR_ALGORITHM_THRESHOLD);
+			dbr_controller_init(&stream->dbr, DBR_ALGORITHM_THRESHOLD, stream->dbr_orig_bitrate,
+					    (long)overall_audio_bitrate);
+		}
+
+		info("Dynamic bitrate enabled (%s).  Dropped frames begone!", stream->dbr.info->id);
 	}
 
 	if (drop_p < (drop_b + 200))
@@ -1504,7 +1541,7 @@ static void *connect_thread(void *data)
 	os_set_thread_name("rtmp-stream: connect_thread");
 
 	if (!init_connect(stream)) {
-		obs_output_signal_stop(stream->output, OBS_OUTPUT_BAD_PATH);
+		signal_stop(stream, OBS_OUTPUT_BAD_PATH);
 		return NULL;
 	}
 
@@ -1517,7 +1554,7 @@ static void *connect_thread(void *data)
 			const struct video_output_info *info = video_output_get_info(video);
 
 			if (info->colorspace == VIDEO_CS_2100_HLG || info->colorspace == VIDEO_CS_2100_PQ) {
-				obs_output_signal_stop(stream->output, OBS_OUTPUT_HDR_DISABLED);
+				signal_stop(stream, OBS_OUTPUT_HDR_DISABLED);
 				return NULL;
 			}
 		}
@@ -1526,11 +1563,11 @@ static void *connect_thread(void *data)
 	ret = try_connect(stream);
 
 	if (ret != OBS_OUTPUT_SUCCESS) {
-		obs_output_signal_stop(stream->output, ret);
+		signal_stop(stream, ret);
 		info("Connection to %s failed: %d", stream->path.array, ret);
 	}
 
-	if (!stopping(stream))
+	if (!stopping(stream) && !stream->multi)
 		pthread_detach(stream->connect_thread);
 
 	os_atomic_set_bool(&stream->connecting, false);
@@ -1552,46 +1589,27 @@ static bool rtmp_stream_start(void *data)
 
 static inline bool add_packet(struct rtmp_stream *stream, struct encoder_packet *packet)
 {
-	deque_push_back(&stream->packets, packet, sizeof(struct encoder_packet));
+	rtmp_send_queue_push(&stream->packets, packet);
 	return true;
 }
 
 static inline size_t num_buffered_packets(struct rtmp_stream *stream)
 {
-	return stream->packets.size / sizeof(struct encoder_packet);
+	return rtmp_send_queue_count(&stream->packets);
 }
 
 static void drop_frames(struct rtmp_stream *stream, const char *name, int highest_priority, bool pframes)
 {
 	UNUSED_PARAMETER(pframes);
 
-	struct deque new_buf = {0};
-	int num_frames_dropped = 0;
-
 #ifdef _DEBUG
 	int start_packets = (int)num_buffered_packets(stream);
 #else
 	UNUSED_PARAMETER(name);
 #endif
 
-	deque_reserve(&new_buf, sizeof(struct encoder_packet) * 8);
-
-	while (stream->packets.size) {
-		struct encoder_packet packet;
-		deque_pop_front(&stream->packets, &packet, sizeof(packet));
-
-		/* do not drop audio data or video keyframes */
-		if (packet.type == OBS_ENCODER_AUDIO || packet.drop_priority >= highest_priority) {
-			deque_push_back(&new_buf, &packet, sizeof(packet));
-
-		} else {
-			num_frames_dropped++;
-			obs_encoder_packet_release(&packet);
-		}
-	}
-
-	deque_free(&stream->packets);
-	stream->packets = new_buf;
+	/* audio data and video keyframes are never dropped */
+	int num_frames_dropped = (int)rtmp_send_queue_drop(&stream->packets, highest_priority);
 
 	if (stream->min_priority < highest_priority)
 		stream->min_priority = highest_priority;
@@ -1605,82 +1623,6 @@ static void drop_frames(struct rtmp_stream *stream, const char *name, int highes
 #endif
 }
 
-static bool find_first_video_packet(struct rtmp_stream *stream, struct encoder_packet *first)
-{
-	size_t count = stream->packets.size / sizeof(*first);
-
-	for (size_t i = 0; i < count; i++) {
-		struct encoder_packet *cur = deque_data(&stream->packets, i * sizeof(*first));
-		if (cur->type == OBS_ENCODER_VIDEO && !cur->keyframe) {
-			*first = *cur;
-			return true;
-		}
-	}
-
-	return false;
-}
-
-static bool dbr_bitrate_lowered(struct rtmp_stream *stream)
-{
-	long prev_bitrate = stream->dbr_prev_bitrate;
-	long est_bitrate = 0;
-	long new_bitrate;
-
-	if (stream->dbr_est_bitrate && stream->dbr_est_bitrate < stream->dbr_cur_bitrate) {
-		stream->dbr_data_size = 0;
-		deque_pop_front(&stream->dbr_frames, NULL, stream->dbr_frames.size);
-		est_bitrate = stream->dbr_est_bitrate / 100 * 100;
-		if (est_bitrate < 50) {
-			est_bitrate = 50;
-		}
-	}
-
-#if 0
-	if (prev_bitrate && est_bitrate) {
-		if (prev_bitrate < est_bitrate) {
-			blog(LOG_INFO, "going back to prev bitrate: "
-					"prev_bitrate (%d) < est_bitrate (%d)",
-					prev_bitrate,
-					est_bitrate);
-			new_bitrate = prev_bitrate;
-		} else {
-			new_bitrate = est_bitrate;
-		}
-		new_bitrate = est_bitrate;
-	} else if (prev_bitrate) {
-		new_bitrate = prev_bitrate;
-		info("going back to prev bitrate");
-
-	} else if (est_bitrate) {
-		new_bitrate = est_bitrate;
-
-	} else {
-		return false;
-	}
-#else
-	if (est_bitrate) {
-		new_bitrate = est_bitrate;
-
-	} else if (prev_bitrate) {
-		new_bitrate = prev_bitrate;
-		info("going back to prev bitrate");
-
-	} else {
-		return false;
-	}
-
-	if (new_bitrate == stream->dbr_cur_bitrate) {
-		return false;
-	}
-#endif
-
-	stream->dbr_prev_bitrate = 0;
-	stream->dbr_cur_bitrate = new_bitrate;
-	stream->dbr_inc_timeout = os_gettime_ns() + DBR_INC_TIMER;
-	info("bitrate decreased to: %ld", stream->dbr_cur_bitrate);
-	return true;
-}
-
 static void dbr_set_bitrate(struct rtmp_stream *stream)
 {
 	if (stream->dbr_interpolation_table.array == NULL || stream->dbr_interpolation_table.num == 0)
@@ -1735,83 +1677,60 @@ static void dbr_set_bitrate(struct rtmp_stream *stream)
 	}
 }
 
-static void dbr_inc_bitrate(struct rtmp_stream *stream)
+static void dbr_update(struct rtmp_stream *stream, int64_t buffer_duration_usec)
 {
-	stream->dbr_prev_bitrate = stream->dbr_cur_bitrate;
-	stream->dbr_cur_bitrate += stream->dbr_inc_bitrate;
+	pthread_mutex_lock(&stream->dbr_mutex);
+	long new_bitrate =
+		dbr_controller_update(&stream->dbr, os_gettime_ns(), buffer_duration_usec, stream->dbr_cur_bitrate);
+	pthread_mutex_unlock(&stream->dbr_mutex);
 
-	if (stream->dbr_cur_bitrate >= stream->dbr_orig_bitrate) {
-		stream->dbr_cur_bitrate = stream->dbr_orig_bitrate;
-		info("bitrate increased to: %ld, done", stream->dbr_cur_bitrate);
-	} else if (stream->dbr_cur_bitrate < stream->dbr_orig_bitrate) {
-		stream->dbr_inc_timeout = os_gettime_ns() + DBR_INC_TIMER;
-		info("bitrate increased to: %ld, waiting", stream->dbr_cur_bitrate);
+	if (new_bitrate == stream->dbr_cur_bitrate)
+		return;
+
+	if (new_bitrate < stream->dbr_cur_bitrate) {
+		debug("buffer_duration_msec: %" PRId64, buffer_duration_usec / 1000);
+		info("bitrate decreased to: %ld", new_bitrate);
+	} else if (new_bitrate < stream->dbr_orig_bitrate) {
+		info("bitrate increased to: %ld, waiting", new_bitrate);
+	} else {
+		info("bitrate increased to: %ld, done", new_bitrate);
 	}
+
+	stream->dbr_cur_bitrate = new_bitrate;
+	dbr_set_bitrate(stream);
 }
 
 static void check_to_drop_frames(struct rtmp_stream *stream, bool pframes)
 {
-	struct encoder_packet first;
-	int64_t buffer_duration_usec;
+	int64_t first_dts_usec;
+	int64_t buffer_duration_usec = 0;
 	size_t num_packets = num_buffered_packets(stream);
 	const char *name = pframes ? "p-frames" : "b-frames";
 	int priority = pframes ? OBS_NAL_PRIORITY_HIGHEST : OBS_NAL_PRIORITY_HIGH;
 	int64_t drop_threshold = pframes ? stream->pframe_drop_threshold_usec : stream->drop_threshold_usec;
-
-	if (!pframes && stream->dbr_enabled) {
-		if (stream->dbr_inc_timeout) {
-			uint64_t t = os_gettime_ns();
-
-			if (t >= stream->dbr_inc_timeout) {
-				stream->dbr_inc_timeout = 0;
-				dbr_inc_bitrate(stream);
-				dbr_set_bitrate(stream);
-			}
-		}
-	}
-
-	if (num_packets < 5) {
-		if (!pframes)
-			stream->congestion = 0.0f;
-		return;
-	}
-
-	if (!find_first_video_packet(stream, &first))
-		return;
+	bool buffered = num_packets >= 5 && rtmp_send_queue_first_delta_dts(&stream->packets, &first_dts_usec);
 
 	/* if the amount of time stored in the buffered packets waiting to be
 	 * sent is higher than threshold, drop frames */
-	buffer_duration_usec = stream->last_dts_usec - first.dts_usec;
+	if (buffered)
+		buffer_duration_usec = stream->last_dts_usec - first_dts_usec;
 
 	if (!pframes) {
-		stream->congestion = (float)buffer_duration_usec / (float)drop_threshold;
+		if (num_packets < 5)
+			stream->congestion = 0.0f;
+		else if (buffered)
+			stream->congestion = (float)buffer_duration_usec / (float)drop_threshold;
 	}
 
-	/* alternatively, drop only pframes:
-	 * (!pframes && stream->dbr_enabled)
-	 * but let's test without dropping frames
-	 * at all first */
+	/* with dynamic bitrate the controller reacts to congestion instead of
+	 * dropping frames */
 	if (stream->dbr_enabled) {
-		bool bitrate_changed = false;
-
-		if (pframes) {
-			return;
-		}
-
-		if ((uint64_t)buffer_duration_usec >= DBR_TRIGGER_USEC) {
-			pthread_mutex_lock(&stream->dbr_mutex);
-			bitrate_changed = dbr_bitrate_lowered(stream);
-			pthread_mutex_unlock(&stream->dbr_mutex);
-		}
-
-		if (bitrate_changed) {
-			debug("buffer_duration_msec: %" PRId64, buffer_duration_usec / 1000);
-			dbr_set_bitrate(stream);
-		}
+		if (!pframes)
+			dbr_update(stream, buffer_duration_usec);
 		return;
 	}
 
-	if (buffer_duration_usec > drop_threshold) {
+	if (buffered && buffer_duration_usec > drop_threshold) {
 		debug("buffer_duration_usec: %" PRId64, buffer_duration_usec);
 		drop_frames(stream, name, priority, pframes);
 	}
@@ -1835,11 +1754,64 @@ static bool add_video_packet(struct rtmp_stream *stream, struct encoder_packet *
 	return add_packet(stream, packet);
 }
 
+bool rtmp_parse_packet(enum video_id_t codec, struct encoder_packet *new_packet, struct encoder_packet *packet)
+{
+	if (packet->type != OBS_ENCODER_VIDEO) {
+		obs_encoder_packet_ref(new_packet, packet);
+		return true;
+	}
+
+	switch (codec) {
+	case CODEC_NONE:
+		return false;
+
+	case CODEC_H264:
+		obs_parse_avc_packet(new_packet, packet);
+		return true;
+	case CODEC_HEVC:
+#ifdef ENABLE_HEVC
+		obs_parse_hevc_packet(new_packet, packet);
+		return true;
+#else
+		return false;
+#endif
+	case CODEC_AV1:
+		obs_parse_av1_packet(new_packet, packet);
+		return true;
+	}
+
+	return false;
+}
+
+/* takes ownership of the packet */
+static void queue_packet(struct rtmp_stream *stream, struct encoder_packet *packet)
+{
+	bool added_packet = false;
+
+	if (!stream->got_first_packet) {
+		stream->start_dts_offset = get_ms_time(packet, packet->dts);
+		stream->got_first_packet = true;
+	}
+
+	pthread_mutex_lock(&stream->packets_mutex);
+
+	if (!disconnected(stream)) {
+		added_packet = (packet->type == OBS_ENCODER_VIDEO) ? add_video_packet(stream, packet)
+								  : add_packet(stream, packet);
+	}
+
+	pthread_mutex_unlock(&stream->packets_mutex);
+
+	if (added_packet)
+		os_sem_post(stream->send_sem);
+	else
+		obs_encoder_packet_release(packet);
+}
+
 static void rtmp_stream_data(void *data, struct encoder_packet *packet)
 {
 	struct rtmp_stream *stream = data;
 	struct encoder_packet new_packet;
-	bool added_packet = false;
 
 	if (disconnected(stream) || !active(stream))
 		return;
@@ -1851,53 +1823,94 @@ static void rtmp_stream_data(void *data, struct encoder_packet *packet)
 		return;
 	}
 
-	if (packet->type == OBS_ENCODER_VIDEO) {
-		if (!stream->got_first_packet) {
-			stream->start_dts_offset = get_ms_time(packet, packet->dts);
-			stream->got_first_packet = true;
-		}
+	enum video_id_t codec = packet->type == OBS_ENCODER_VIDEO ? stream->video_codec[packet->track_idx] : CODEC_NONE;
 
-		switch (stream->video_codec[packet->track_idx]) {
-		case CODEC_NONE:
-			do_log(LOG_ERROR, "Codec not initialized for track %zu", packet->track_idx);
-			return;
+	if (packet->type == OBS_ENCODER_VIDEO && codec == CODEC_NONE) {
+		do_log(LOG_ERROR, "Codec not initialized for track %zu", packet->track_idx);
+		return;
+	}
 
-		case CODEC_H264:
-			obs_parse_avc_packet(&new_packet, packet);
-			break;
-		case CODEC_HEVC:
-#ifdef ENABLE_HEVC
-			obs_parse_hevc_packet(&new_packet, packet);
-			break;
-#else
-			return;
-#endif
-		case CODEC_AV1:
-			obs_parse_av1_packet(&new_packet, packet);
-			break;
-		}
-	} else {
-		if (!stream->got_first_packet) {
-			stream->start_dts_offset = get_ms_time(packet, packet->dts);
-			stream->got_first_packet = true;
-		}
+	if (!rtmp_parse_packet(codec, &new_packet, packet))
+		return;
+
+	queue_packet(stream, &new_packet);
+}
 
-		obs_encoder_packet_ref(&new_packet, packet);
+struct rtmp_stream *rtmp_destination_create(obs_output_t *output, struct rtmp_multi_stream *multi, size_t idx,
+					    obs_data_t *destination)
+{
+	struct rtmp_stream *stream = rtmp_stream_create(NULL, output);
+	if (!stream)
+		return NULL;
+
+	stream->multi = multi;
+	stream->multi_idx = idx;
+	stream->destination = destination;
+	obs_data_addref(destination);
+	return stream;
+}
+
+void rtmp_destination_destroy(struct rtmp_stream *stream)
+{
+	rtmp_stream_destroy(stream);
+}
+
+bool rtmp_destination_start(struct rtmp_stream *stream)
+{
+	/* the threads of the previous connection have already reported that
+	 * they stopped, so they are about to exit */
+	join_connect_thread(stream);
+	join_send_thread(stream);
+
+	os_atomic_set_bool(&stream->connecting, true);
+	if (pthread_create(&stream->connect_thread, NULL, connect_thread, stream) != 0) {
+		os_atomic_set_bool(&stream->connecting, false);
+		return false;
 	}
+	stream->connect_thread_joinable = true;
+	return true;
+}
 
-	pthread_mutex_lock(&stream->packets_mutex);
+void rtmp_destination_stop(struct rtmp_stream *stream, uint64_t ts)
+{
+	rtmp_stream_stop(stream, ts);
+}
 
-	if (!disconnected(stream)) {
-		added_packet = (packet->type == OBS_ENCODER_VIDEO) ? add_video_packet(stream, &new_packet)
-								   : add_packet(stream, &new_packet);
+/* stops the destination without draining and waits for its threads */
+void rtmp_destination_join(struct rtmp_stream *stream)
+{
+	join_connect_thread(stream);
+
+	if (active(stream)) {
+		stream->stop_ts = 0;
+		os_event_signal(stream->stop_event);
+		os_sem_post(stream->send_sem);
 	}
 
-	pthread_mutex_unlock(&stream->packets_mutex);
+	join_send_thread(stream);
+}
 
-	if (added_packet)
+/* packet has already been parsed by rtmp_parse_packet, the destination only
+ * takes a reference to it */
+void rtmp_destination_data(struct rtmp_stream *stream, struct encoder_packet *packet)
+{
+	struct encoder_packet new_packet;
+
+	if (disconnected(stream) || !active(stream))
+		return;
+
+	if (!packet) {
+		os_atomic_set_bool(&stream->encode_error, true);
 		os_sem_post(stream->send_sem);
-	else
-		obs_encoder_packet_release(&new_packet);
+		return;
+	}
+
+	/* destinations that connect mid-stream start at a keyframe */
+	if (!stream->got_first_packet && (packet->type != OBS_ENCODER_VIDEO || !packet->keyframe))
+		return;
+
+	obs_encoder_packet_ref(&new_packet, packet);
+	queue_packet(stream, &new_packet);
 }
 
 static void rtmp_stream_defaults(obs_data_t *defaults)
@@ -1906,6 +1919,7 @@ static void rtmp_stream_defaults(obs_data_t *defaults)
 	obs_data_set_default_int(defaults, OPT_PFRAME_DROP_THRESHOLD, 900);
 	obs_data_set_default_int(defaults, OPT_MAX_SHUTDOWN_TIME_SEC, 30);
 	obs_data_set_default_string(defaults, OPT_BIND_IP, "default");
+	obs_data_set_default_string(defaults, OPT_DYN_BITRATE_ALGORITHM, DBR_ALGORITHM_THRESHOLD);
 #ifdef _WIN32
 	obs_data_set_default_bool(defaults, OPT_NEWSOCKETLOOP_ENABLED, false);
 	obs_data_set_default_bool(defaults, OPT_LOWLATENCY_ENABLED, false);
@@ -1924,6 +1938,13 @@ static obs_properties_t *rtmp_stream_properties(void *unused)
 				   100);
 	obs_property_int_set_suffix(p, " ms");
 
+	p = obs_properties_add_list(props, OPT_DYN_BITRATE_ALGORITHM, obs_module_text("RTMPStream.DynBitrateAlgorithm"),
+				    OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+
+	obs_property_list_add_string(p, obs_module_text("RTMPStream.DynBitrateAlgorithm.Threshold"),
+				     DBR_ALGORITHM_THRESHOLD);
+	obs_property_list_add_string(p, obs_module_text("RTMPStream.DynBitrateAlgorithm.Delay"), DBR_ALGORITHM_DELAY);
+
 	p = obs_properties_add_list(props, OPT_IP_FAMILY, obs_module_text("IPFamily"), OBS_COMBO_TYPE_LIST,
 				    OBS_COMBO_FORMAT_STRING);
 
@@ -7,6 +7,8 @@
 #include "librtmp/rtmp.h"
 #include "librtmp/log.h"
 #include "flv-mux.h"
+#include "rtmp-dbr.h"
+#include "rtmp-send-queue.h"
 #include "net-if.h"
 
 #ifdef _WIN32
@@ -23,6 +25,7 @@
 #define debug(format, ...) do_log(LOG_DEBUG, format, ##__VA_ARGS__)
 
 #define OPT_DYN_BITRATE "dyn_bitrate"
+#define OPT_DYN_BITRATE_ALGORITHM "dyn_bitrate_algorithm"
 #define OPT_DYN_BITRATE_INTERPOLATION_TABLE_DATA "interpolation_table_data"
 #define OPT_DROP_THRESHOLD "drop_threshold_ms"
 #define OPT_PFRAME_DROP_THRESHOLD "pframe_drop_threshold_ms"
@@ -47,12 +50,6 @@ struct droptest_info {
 };
 #endif
 
-struct dbr_frame {
-	uint64_t send_beg;
-	uint64_t send_end;
-	size_t size;
-};
-
 struct dbr_interpolation_point {
 	long bitrates[MAX_OUTPUT_VIDEO_ENCODERS];
 };
@@ -61,7 +58,7 @@ struct rtmp_stream {
 	obs_output_t *output;
 
 	pthread_mutex_t packets_mutex;
-	struct deque packets;
+	struct rtmp_send_queue packets;
 	bool sent_headers;
 
 	bool got_first_packet;
@@ -107,15 +104,9 @@ struct rtmp_stream {
 #endif
 
 	pthread_mutex_t dbr_mutex;
-	struct deque dbr_frames;
-	size_t dbr_data_size;
-	uint64_t dbr_inc_timeout;
-	long audio_bitrate;
-	long dbr_est_bitrate;
+	struct dbr_controller dbr;
 	long dbr_orig_bitrate;
-	long dbr_prev_bitrate;
 	long dbr_cur_bitrate;
-	long dbr_inc_bitrate;
 	bool dbr_enabled;
 	DARRAY(struct dbr_interpolation_point) dbr_interpolation_table;
 
@@ -137,12 +128,34 @@ struct rtmp_stream {
 	os_event_t *buffer_has_data_event;
 	os_event_t *socket_available_event;
 	os_event_t *send_thread_signaled_exit;
+
+	/* set if this stream is a destination of a multi-destination output.
+	 * its threads are never detached then, and are joined before the
+	 * output frees the state they report to. */
+	struct rtmp_multi_stream *multi;
+	size_t multi_idx;
+	obs_data_t *destination;
+	bool connect_thread_joinable;
+	bool send_thread_joinable;
 };
 
 #ifdef _WIN32
 void *socket_thread_windows(void *data);
 #endif
 
+/* destinations of the multi-destination output, see rtmp-multi-stream.c */
+extern struct rtmp_stream *rtmp_destination_create(obs_output_t *output, struct rtmp_multi_stream *multi, size_t idx,
+						   obs_data_t *destination);
+extern void rtmp_destination_destroy(struct rtmp_stream *stream);
+extern bool rtmp_destination_start(struct rtmp_stream *stream);
+extern void rtmp_destination_stop(struct rtmp_stream *stream, uint64_t ts);
+extern void rtmp_destination_join(struct rtmp_stream *stream);
+extern void rtmp_destination_data(struct rtmp_stream *stream, struct encoder_packet *packet);
+extern bool rtmp_parse_packet(enum video_id_t codec, struct encoder_packet *new_packet, struct encoder_packet *packet);
+
+extern void rtmp_multi_destination_started(struct rtmp_multi_stream *multi, size_t idx);
+extern void rtmp_multi_destination_stopped(struct rtmp_multi_stream *multi, size_t idx, int code);
+
 /* Adapted from FFmpeg's libavutil/pixfmt.h
  *
  * Renamed to make it apparent that these are not imported as this module does
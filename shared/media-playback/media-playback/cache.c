@@ -16,6 +16,7 @@
 
 #include <media-io/audio-io.h>
 #include <util/platform.h>
+#include <libavutil/imgutils.h>
 
 #include "media-playback.h"
 #include "cache.h"
@@ -32,8 +33,8 @@ static bool mp_cache_reset(mp_cache_t *c);
 
 static int64_t base_sys_ts = 0;
 
-#define v_eof(c) (c->cur_v_idx == c->video_frames.num)
-#define a_eof(c) (c->cur_a_idx == c->audio_segments.num)
+#define v_eof(c) (c->cur_v_idx == c->clip->video_frames.num)
+#define a_eof(c) (c->cur_a_idx == c->clip->audio_segments.num)
 
 static inline int64_t mp_cache_get_next_min_pts(mp_cache_t *c)
 {
@@ -131,10 +132,6 @@ bool mp_cache_decode(mp_cache_t *c)
 
 	success = true;
 
-	c->start_time = c->m.fmt->start_time;
-	if (c->start_time == AV_NOPTS_VALUE)
-		c->start_time = 0;
-
 fail:
 	mp_media_free(m);
 	return success;
@@ -153,8 +150,8 @@ static void seek_to(mp_cache_t *c, int64_t pos)
 	if (c->has_video) {
 		struct obs_source_frame *v;
 
-		for (size_t i = 0; i < c->video_frames.num; i++) {
-			v = &c->video_frames.array[i];
+		for (size_t i = 0; i < c->clip->video_frames.num; i++) {
+			v = &c->clip->video_frames.array[i];
 			new_v_idx = i;
 			if ((int64_t)v->timestamp >= pos) {
 				break;
@@ -162,17 +159,17 @@ static void seek_to(mp_cache_t *c, int64_t pos)
 		}
 
 		size_t next_idx = new_v_idx + 1;
-		if (next_idx == c->video_frames.num) {
-			c->next_v_ts = (int64_t)v->timestamp + c->final_v_duration;
+		if (next_idx == c->clip->video_frames.num) {
+			c->next_v_ts = (int64_t)v->timestamp + c->clip->final_v_duration;
 		} else {
-			struct obs_source_frame *next = &c->video_frames.array[next_idx];
+			struct obs_source_frame *next = &c->clip->video_frames.array[next_idx];
 			c->next_v_ts = (int64_t)next->timestamp;
 		}
 	}
 	if (c->has_audio) {
 		struct obs_source_audio *a;
-		for (size_t i = 0; i < c->audio_segments.num; i++) {
-			a = &c->audio_segments.array[i];
+		for (size_t i = 0; i < c->clip->audio_segments.num; i++) {
+			a = &c->clip->audio_segments.array[i];
 			new_a_idx = i;
 			if ((int64_t)a->timestamp >= pos) {
 				break;
@@ -180,10 +177,10 @@ static void seek_to(mp_cache_t *c, int64_t pos)
 		}
 
 		size_t next_idx = new_a_idx + 1;
-		if (next_idx == c->audio_segments.num) {
-			c->next_a_ts = (int64_t)a->timestamp + c->final_a_duration;
+		if (next_idx == c->clip->audio_segments.num) {
+			c->next_a_ts = (int64_t)a->timestamp + c->clip->final_a_duration;
 		} else {
-			struct obs_source_audio *next = &c->audio_segments.array[next_idx];
+			struct obs_source_audio *next = &c->clip->audio_segments.array[next_idx];
 			c->next_a_ts = (int64_t)next->timestamp;
 		}
 	}
@@ -208,11 +205,11 @@ static inline bool mp_media_can_play_audio(mp_cache_t *c)
 static inline void calc_next_v_ts(mp_cache_t *c, struct obs_source_frame *frame)
 {
 	int64_t offset;
-	if (c->next_v_idx < c->video_frames.num) {
-		struct obs_source_frame *next = &c->video_frames.array[c->next_v_idx];
+	if (c->next_v_idx < c->clip->video_frames.num) {
+		struct obs_source_frame *next = &c->clip->video_frames.array[c->next_v_idx];
 		offset = (int64_t)(next->timestamp - frame->timestamp);
 	} else {
-		offset = c->final_v_duration;
+		offset = c->clip->final_v_duration;
 	}
 
 	c->next_v_ts += offset;
@@ -221,11 +218,11 @@ static inline void calc_next_v_ts(mp_cache_t *c, struct obs_source_frame *frame)
 static inline void calc_next_a_ts(mp_cache_t *c, struct obs_source_audio *audio)
 {
 	int64_t offset;
-	if (c->next_a_idx < c->audio_segments.num) {
-		struct obs_source_audio *next = &c->audio_segments.array[c->next_a_idx];
+	if (c->next_a_idx < c->clip->audio_segments.num) {
+		struct obs_source_audio *next = &c->clip->audio_segments.array[c->next_a_idx];
 		offset = (int64_t)(next->timestamp - audio->timestamp);
 	} else {
-		offset = c->final_a_duration;
+		offset = c->clip->final_a_duration;
 	}
 
 	c->next_a_ts += offset;
@@ -234,16 +231,17 @@ static inline void calc_next_a_ts(mp_cache_t *c, struct obs_source_audio *audio)
 static void mp_cache_next_video(mp_cache_t *c, bool preload)
 {
 	/* eof check */
-	if (c->next_v_idx == c->video_frames.num) {
+	if (c->next_v_idx == c->clip->video_frames.num) {
 		if (mp_media_can_play_video(c))
 			c->cur_v_idx = c->next_v_idx;
 		return;
 	}
 
-	struct obs_source_frame *frame = &c->video_frames.array[c->next_v_idx];
+	struct obs_source_frame *frame = &c->clip->video_frames.array[c->next_v_idx];
 	struct obs_source_frame dup = *frame;
 
 	dup.timestamp = c->base_ts + dup.timestamp - c->start_ts + c->play_sys_ts - base_sys_ts;
+	dup.flags = c->is_linear_alpha ? OBS_SOURCE_FRAME_LINEAR_ALPHA : 0;
 
 	if (!preload) {
 		if (!mp_media_can_play_video(c))
@@ -268,7 +266,7 @@ static void mp_cache_next_video(mp_cache_t *c, bool preload)
 static void mp_cache_next_audio(mp_cache_t *c)
 {
 	/* eof check */
-	if (c->next_a_idx == c->audio_segments.num) {
+	if (c->next_a_idx == c->clip->audio_segments.num) {
 		if (mp_media_can_play_audio(c))
 			c->cur_a_idx = c->next_a_idx;
 		return;
@@ -277,7 +275,7 @@ static void mp_cache_next_audio(mp_cache_t *c)
 	if (!mp_media_can_play_audio(c))
 		return;
 
-	struct obs_source_audio *audio = &c->audio_segments.array[c->next_a_idx];
+	struct obs_source_audio *audio = &c->clip->audio_segments.array[c->next_a_idx];
 	struct obs_source_audio dup = *audio;
 
 	dup.timestamp = c->base_ts + dup.timestamp - c->start_ts + c->play_sys_ts - base_sys_ts;
@@ -312,14 +310,14 @@ static bool mp_cache_reset(mp_cache_t *c)
 	pthread_mutex_unlock(&c->mutex);
 
 	if (c->has_video) {
-		size_t next_idx = c->video_frames.num > 1 ? 1 : 0;
+		size_t next_idx = c->clip->video_frames.num > 1 ? 1 : 0;
 		c->cur_v_idx = c->next_v_idx = 0;
-		c->next_v_ts = c->video_frames.array[next_idx].timestamp;
+		c->next_v_ts = c->clip->video_frames.array[next_idx].timestamp;
 	}
 	if (c->has_audio) {
-		size_t next_idx = c->audio_segments.num > 1 ? 1 : 0;
+		size_t next_idx = c->clip->audio_segments.num > 1 ? 1 : 0;
 		c->cur_a_idx = c->next_a_idx = 0;
-		c->next_a_ts = c->audio_segments.array[next_idx].timestamp;
+		c->next_a_ts = c->clip->audio_segments.array[next_idx].timestamp;
 	}
 
 	if (active) {
@@ -365,12 +363,37 @@ static void mp_cache_calc_next_ns(mp_cache_t *c)
 	c->next_pts_ns = min_next_ns;
 }
 
+/* another source is decoding the clip, wait for it unless killed first */
+static bool mp_cache_wait_for_clip(mp_cache_t *c)
+{
+	while (!mp_clip_wait(c->clip, 100)) {
+		bool kill;
+
+		pthread_mutex_lock(&c->mutex);
+		kill = c->kill;
+		pthread_mutex_unlock(&c->mutex);
+
+		if (kill)
+			return false;
+	}
+
+	return true;
+}
+
 static inline bool mp_cache_thread(mp_cache_t *c)
 {
 	os_set_thread_name("mp_cache_thread");
 
-	if (!mp_cache_decode(c)) {
-		return false;
+	if (c->decode_clip) {
+		bool success = mp_cache_decode(c);
+		mp_clip_finish(c->clip, success);
+		if (!success)
+			return false;
+	} else {
+		if (!mp_cache_wait_for_clip(c))
+			return true;
+		if (c->clip->failed)
+			return false;
 	}
 
 	for (;;) {
@@ -432,8 +455,11 @@ static inline bool mp_cache_thread(mp_cache_t *c)
 		if (pause)
 			continue;
 
-		if (preload_frame)
-			c->v_preload_cb(c->opaque, &c->video_frames.array[0]);
+		if (preload_frame && c->clip->video_frames.num) {
+			struct obs_source_frame dup = c->clip->video_frames.array[0];
+			dup.flags = c->is_linear_alpha ? OBS_SOURCE_FRAME_LINEAR_ALPHA : 0;
+			c->v_preload_cb(c->opaque, &dup);
+		}
 
 		/* frames are ready */
 		if (is_active && !timeout) {
@@ -475,9 +501,9 @@ static void fill_video(void *data, struct obs_source_frame *frame)
 
 	dup.timestamp = frame->timestamp;
 
-	c->final_v_duration = c->m.v.last_duration;
+	c->clip->final_v_duration = c->m.v.last_duration;
 
-	da_push_back(c->video_frames, &dup);
+	da_push_back(c->clip->video_frames, &dup);
 }
 
 static void fill_audio(void *data, struct obs_source_audio *audio)
@@ -504,9 +530,9 @@ static void fill_audio(void *data, struct obs_source_audio *audio)
 		memcpy((uint8_t *)dup.data[0], audio->data[0], size);
 	}
 
-	c->final_a_duration = c->m.a.last_duration;
+	c->clip->final_a_duration = c->m.a.last_duration;
 
-	da_push_back(c->audio_segments, &dup);
+	da_push_back(c->clip->audio_segments, &dup);
 }
 
 static inline bool mp_cache_init_internal(mp_cache_t *c, const struct mp_media_info *info)
@@ -532,6 +558,33 @@ static inline bool mp_cache_init_internal(mp_cache_t *c, const struct mp_media_i
 	return true;
 }
 
+/* what the decoded clip will take, to check it against the clip cache budget
+ * before decoding anything */
+static uint64_t estimate_clip_size(mp_media_t *m)
+{
+	double duration = m->fmt->duration > 0 ? (double)m->fmt->duration / AV_TIME_BASE : 0.0;
+	uint64_t size = 0;
+
+	if (m->has_video) {
+		AVCodecContext *ctx = m->v.decoder;
+		double fps = av_q2d(m->v.stream->avg_frame_rate);
+		int frame_size = av_image_get_buffer_size(ctx->pix_fmt, ctx->width, ctx->height, 1);
+
+		if (frame_size <= 0)
+			frame_size = ctx->width * ctx->height * 4;
+		if (fps <= 0.0)
+			fps = 60.0;
+
+		size += (uint64_t)(frame_size * fps * duration) + (uint64_t)frame_size;
+	}
+	if (m->has_audio) {
+		AVCodecContext *ctx = m->a.decoder;
+		size += (uint64_t)(duration * ctx->sample_rate * ctx->ch_layout.nb_channels * sizeof(float));
+	}
+
+	return size;
+}
+
 bool mp_cache_init(mp_cache_t *c, const struct mp_media_info *info)
 {
 	struct mp_media_info info2 = *info;
@@ -574,6 +627,22 @@ bool mp_cache_init(mp_cache_t *c, const struct mp_media_info *info)
 	if (!base_sys_ts)
 		base_sys_ts = (int64_t)os_gettime_ns();
 
+	c->is_linear_alpha = info->is_linear_alpha;
+
+	c->start_time = m->fmt->start_time;
+	if (c->start_time == AV_NOPTS_VALUE)
+		c->start_time = 0;
+
+	c->clip = mp_clip_acquire(info, estimate_clip_size(m), &c->decode_clip);
+	if (!c->clip) {
+		mp_cache_free(c);
+		return false;
+	}
+
+	/* someone else is decoding it, no need to keep the file open */
+	if (!c->decode_clip)
+		mp_media_free(m);
+
 	if (!mp_cache_init_internal(c, info)) {
 		mp_cache_free(c);
 		return false;
@@ -605,16 +674,7 @@ void mp_cache_free(mp_cache_t *c)
 	if (c->m.fmt)
 		mp_media_free(&c->m);
 
-	for (size_t i = 0; i < c->video_frames.num; i++) {
-		struct obs_source_frame *f = &c->video_frames.array[i];
-		obs_source_frame_free(f);
-	}
-	for (size_t i = 0; i < c->audio_segments.num; i++) {
-		struct obs_source_audio *a = &c->audio_segments.array[i];
-		bfree((void *)a->data[0]);
-	}
-	da_free(c->video_frames);
-	da_free(c->audio_segments);
+	mp_clip_release(c->clip);
 
 	bfree(c->path);
 	bfree(c->format_name);
@@ -692,7 +752,7 @@ void mp_cache_seek(mp_cache_t *c, int64_t pos)
 
 int64_t mp_cache_get_frames(mp_cache_t *c)
 {
-	return c->video_frames.num;
+	return c->clip ? c->clip->video_frames.num : 0;
 }
 
 int64_t mp_cache_get_duration(mp_cache_t *c)
@@ -21,6 +21,7 @@
 #include <obs.h>
 
 #include "media.h"
+#include "clip-cache.h"
 
 struct mp_cache {
 	mp_video_cb v_preload_cb;
@@ -32,6 +33,7 @@ struct mp_cache {
 	bool request_preload;
 	bool has_video;
 	bool has_audio;
+	bool is_linear_alpha;
 
 	char *path;
 	char *format_name;
@@ -51,8 +53,8 @@ struct mp_cache {
 	bool thread_valid;
 	pthread_t thread;
 
-	DARRAY(struct obs_source_frame) video_frames;
-	DARRAY(struct obs_source_audio) audio_segments;
+	struct mp_clip *clip;
+	bool decode_clip;
 
 	size_t cur_v_idx;
 	size_t cur_a_idx;
@@ -61,9 +63,6 @@ struct mp_cache {
 	int64_t next_v_ts;
 	int64_t next_a_ts;
 
-	int64_t final_v_duration;
-	int64_t final_a_duration;
-
 	int64_t play_sys_ts;
 	int64_t next_pts_ns;
 	uint64_t next_ns;
@@ -0,0 +1,126 @@
+#include <util/bmem.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <sys/stat.h>
+
+#include "clip-cache.h"
+
+/* Decoded frames are raw, so a few seconds of 1080p already take hundreds of
+ * megabytes.  Clips that would go past this are played from the file. */
+#define CLIP_CACHE_BUDGET (2048ULL * 1024ULL * 1024ULL)
+
+static pthread_mutex_t clips_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct mp_clip *) clips;
+static uint64_t clips_size = 0;
+
+static char *make_key(const struct mp_media_info *info)
+{
+	struct dstr key = {0};
+	struct stat stats = {0};
+
+	/* a file replaced under the same name must not hit the old clip */
+	if (!info->path || os_stat(info->path, &stats) != 0)
+		memset(&stats, 0, sizeof(stats));
+
+	dstr_printf(&key, "%s|%lld|%lld|%s|%s|%d|%d", info->path ? info->path : "", (long long)stats.st_mtime,
+		    (long long)stats.st_size, info->format ? info->format : "",
+		    info->ffmpeg_options ? info->ffmpeg_options : "", (int)info->hardware_decoding,
+		    (int)info->force_range);
+	return key.array;
+}
+
+static void mp_clip_destroy(struct mp_clip *clip)
+{
+	for (size_t i = 0; i < clip->video_frames.num; i++)
+		obs_source_frame_free(&clip->video_frames.array[i]);
+	for (size_t i = 0; i < clip->audio_segments.num; i++)
+		bfree((void *)clip->audio_segments.array[i].data[0]);
+
+	da_free(clip->video_frames);
+	da_free(clip->audio_segments);
+	os_event_destroy(clip->ready);
+	bfree(clip->key);
+	bfree(clip);
+}
+
+struct mp_clip *mp_clip_acquire(const struct mp_media_info *info, uint64_t estimated_size, bool *decode)
+{
+	struct mp_clip *clip = NULL;
+	char *key = make_key(info);
+
+	pthread_mutex_lock(&clips_mutex);
+
+	for (size_t i = 0; i < clips.num; i++) {
+		struct mp_clip *cur = clips.array[i];
+		if (!cur->failed && strcmp(cur->key, key) == 0) {
+			clip = cur;
+			clip->refs++;
+			*decode = false;
+			break;
+		}
+	}
+
+	if (!clip && clips_size + estimated_size <= CLIP_CACHE_BUDGET) {
+		clip = bzalloc(sizeof(*clip));
+
+		if (os_event_init(&clip->ready, OS_EVENT_TYPE_MANUAL) == 0) {
+			clip->key = key;
+			clip->refs = 1;
+			clip->size = estimated_size;
+			key = NULL;
+
+			clips_size += estimated_size;
+			da_push_back(clips, &clip);
+			*decode = true;
+		} else {
+			bfree(clip);
+			clip = NULL;
+		}
+	}
+
+	pthread_mutex_unlock(&clips_mutex);
+
+	if (!clip)
+		blog(LOG_INFO, "MP: Not enough room in the clip cache for '%s', playing it from the file",
+		     info->path);
+
+	bfree(key);
+	return clip;
+}
+
+void mp_clip_release(struct mp_clip *clip)
+{
+	bool destroy;
+
+	if (!clip)
+		return;
+
+	pthread_mutex_lock(&clips_mutex);
+
+	destroy = --clip->refs == 0;
+	if (destroy) {
+		da_erase_item(clips, &clip);
+		clips_size -= clip->size;
+		if (!clips.num)
+			da_free(clips);
+	}
+
+	pthread_mutex_unlock(&clips_mutex);
+
+	if (destroy)
+		mp_clip_destroy(clip);
+}
+
+void mp_clip_finish(struct mp_clip *clip, bool success)
+{
+	pthread_mutex_lock(&clips_mutex);
+	clip->failed = !success;
+	pthread_mutex_unlock(&clips_mutex);
+
+	os_event_signal(clip->ready);
+}
+
+bool mp_clip_wait(struct mp_clip *clip, unsigned long timeout_ms)
+{
+	return os_event_timedwait(clip->ready, timeout_ms) == 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <util/threading.h>
+#include <util/darray.h>
+#include <obs.h>
+
+#include "media-playback.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A fully decoded clip, shared by every cached media source playing the same
+ * file with the same decode settings.  One of them decodes it, the others
+ * wait for it to be ready; from then on it is read only. */
+struct mp_clip {
+	char *key;
+	long refs;
+	uint64_t size;
+
+	os_event_t *ready;
+	bool failed;
+
+	DARRAY(struct obs_source_frame) video_frames;
+	DARRAY(struct obs_source_audio) audio_segments;
+
+	int64_t final_v_duration;
+	int64_t final_a_duration;
+};
+
+/* Returns the clip for this file, or a new empty one to decode, in which case
+ * decode is set.  Returns NULL if a new clip of estimated_size would not fit
+ * the cache's memory budget. */
+extern struct mp_clip *mp_clip_acquire(const struct mp_media_info *info, uint64_t estimated_size, bool *decode);
+extern void mp_clip_release(struct mp_clip *clip);
+
+/* called by the source that decoded the clip, wakes up the others */
+extern void mp_clip_finish(struct mp_clip *clip, bool success);
+
+/* returns true once the clip is ready, or failed to decode */
+extern bool mp_clip_wait(struct mp_clip *clip, unsigned long timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,8 +31,11 @@ media_playback_t *media_playback_create(const struct mp_media_info *info)
 	media_playback_t *mp = bzalloc(sizeof(*mp));
 	mp->is_cached = info->is_local_file && info->full_decode;
 
-	if ((mp->is_cached && !mp_cache_init(&mp->cache, info)) ||
-	    (!mp->is_cached && !mp_media_init(&mp->media, info))) {
+	/* clips too large for the clip cache are played from the file */
+	if (mp->is_cached && !mp_cache_init(&mp->cache, info))
+		mp->is_cached = false;
+
+	if (!mp->is_cached && !mp_media_init(&mp->media, info)) {
 		bfree(mp);
 		return NULL;
 	}
@@ -96,7 +99,7 @@ void media_playback_set_looping(media_playback_t *mp, bool looping)
 void media_playback_set_is_linear_alpha(media_playback_t *mp, bool is_linear_alpha)
 {
 	if (mp->is_cached)
-		mp->cache.m.is_linear_alpha = is_linear_alpha;
+		mp->cache.is_linear_alpha = is_linear_alpha;
 	else
 		mp->media.is_linear_alpha = is_linear_alpha;
 }
@@ -174,3 +177,11 @@ bool media_playback_has_audio(media_playback_t *mp)
 	else
 		return mp->media.has_audio;
 }
+
+void media_playback_set_next(media_playback_t *mp, const char *path)
+{
+	if (!mp || mp->is_cached)
+		return;
+
+	mp_media_set_next(&mp->media, path);
+}
@@ -24,21 +24,25 @@ typedef struct media_playback media_playback_t;
 typedef void (*mp_video_cb)(void *opaque, struct obs_source_frame *frame);
 typedef void (*mp_audio_cb)(void *opaque, struct obs_source_audio *audio);
 typedef void (*mp_stop_cb)(void *opaque);
+typedef void (*mp_next_cb)(void *opaque, bool success);
 
 struct mp_media_info {
 	void *opaque;
+	obs_source_t *source; /* optional, for source profiler statistics */
 
 	mp_video_cb v_cb;
 	mp_video_cb v_preload_cb;
 	mp_video_cb v_seek_cb;
 	mp_audio_cb a_cb;
 	mp_stop_cb stop_cb;
+	mp_next_cb next_cb; /* the next item started, or could not be opened */
 
 	const char *path;
 	const char *format;
 	char *ffmpeg_options;
 	int buffering;
 	int speed;
+	int decode_ahead; /* video frames to decode ahead of local file playback */
 	enum video_range_type force_range;
 	bool is_linear_alpha;
 	bool hardware_decoding;
@@ -63,3 +67,8 @@ extern int64_t media_playback_get_frames(media_playback_t *mp);
 extern int64_t media_playback_get_duration(media_playback_t *mp);
 extern bool media_playback_has_video(media_playback_t *mp);
 extern bool media_playback_has_audio(media_playback_t *mp);
+
+/* Opens path in the background and plays it right after the current item ends
+ * instead of stopping or looping.  Pass NULL to cancel.  Local files only, and
+ * not supported for fully decoded media. */
+extern void media_playback_set_next(media_playback_t *mp, const char *path);
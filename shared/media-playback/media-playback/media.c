@@ -22,11 +22,14 @@
 #include "media.h"
 #include "closest-format.h"
 
+#include <util/source-profiler.h>
+
 #include <libavdevice/avdevice.h>
-#include <libavutil/imgutils.h>
 
 static int64_t base_sys_ts = 0;
 
+#define MAX_DECODE_AHEAD 60
+
 static inline enum video_format convert_pixel_format(int f)
 {
 	switch (f) {
@@ -194,9 +197,9 @@ static int mp_media_next_packet(mp_media_t *media)
 
 static inline bool mp_media_ready_to_start(mp_media_t *m)
 {
-	if (m->has_audio && !m->a.eof && !m->a.frame_ready)
+	if (m->has_audio && !m->a.eof && !m->a.frame_ready && !m->a_out.cur)
 		return false;
-	if (m->has_video && !m->v.eof && !m->v.frame_ready)
+	if (m->has_video && !m->v.eof && !m->v.frame_ready && !m->v_out.cur)
 		return false;
 	return true;
 }
@@ -250,21 +253,152 @@ static bool mp_media_init_scaling(mp_media_t *m)
 	}
 
 	sws_setColorspaceDetails(m->swscale, coeff, range, coeff, range, 0, FIXED_1_0, FIXED_1_0);
+	return true;
+}
 
-	int ret = av_image_alloc(m->scale_pic, m->scale_linesizes, m->v.frame->width, m->v.frame->height,
-				 m->scale_format, 32);
-	if (ret < 0) {
-		blog(LOG_WARNING, "MP: Failed to create scale pic data");
-		return false;
+/* ------------------------------------------------------------------------- */
+/* decoded frames, pooled so their buffers are reused                        */
+
+static struct mp_frame *mp_media_get_frame(mp_media_t *m)
+{
+	struct mp_frame *frame = NULL;
+
+	pthread_mutex_lock(&m->frames_mutex);
+	struct mp_frame **const cached = da_end(m->frame_pool);
+	if (cached) {
+		frame = *cached;
+		da_pop_back(m->frame_pool);
 	}
+	pthread_mutex_unlock(&m->frames_mutex);
 
-	return true;
+	if (!frame) {
+		frame = bzalloc(sizeof(*frame));
+		frame->frame = av_frame_alloc();
+		frame->scaled = av_frame_alloc();
+	}
+
+	return frame;
 }
 
+static void mp_media_release_frame(mp_media_t *m, struct mp_frame *frame)
+{
+	if (!frame)
+		return;
+
+	/* the decoded frame goes back to the decoder, the scaled buffers are
+	 * kept for the next frame of the same size */
+	av_frame_unref(frame->frame);
+
+	pthread_mutex_lock(&m->frames_mutex);
+	da_push_back(m->frame_pool, &frame);
+	pthread_mutex_unlock(&m->frames_mutex);
+}
+
+static void mp_frame_destroy(struct mp_frame *frame)
+{
+	av_frame_free(&frame->frame);
+	av_frame_free(&frame->scaled);
+	bfree(frame);
+}
+
+static bool mp_media_scale_frame(mp_media_t *m, struct mp_frame *frame)
+{
+	AVFrame *f = frame->frame;
+	AVFrame *scaled = frame->scaled;
+
+	if (scaled->format != m->scale_format || scaled->width != f->width || scaled->height != f->height) {
+		av_frame_unref(scaled);
+		scaled->format = m->scale_format;
+		scaled->width = f->width;
+		scaled->height = f->height;
+
+		if (av_frame_get_buffer(scaled, 32) < 0) {
+			blog(LOG_WARNING, "MP: Failed to create scale pic data");
+			av_frame_unref(scaled);
+			return false;
+		}
+	}
+
+	int ret = sws_scale(m->swscale, (const uint8_t *const *)f->data, f->linesize, 0, f->height, scaled->data,
+			    scaled->linesize);
+	return ret >= 0;
+}
+
+/* takes the frame the decoder has ready, converting it if needed */
+static struct mp_frame *mp_media_take_frame(mp_media_t *m, struct mp_decode *d)
+{
+	if (!d->audio && !m->swscale) {
+		m->scale_format = closest_format(d->frame->format);
+		if (m->scale_format != d->frame->format) {
+			if (!mp_media_init_scaling(m)) {
+				return NULL;
+			}
+		}
+	}
+
+	struct mp_frame *frame = mp_media_get_frame(m);
+
+	av_frame_move_ref(frame->frame, d->frame);
+	frame->format = frame->frame->format;
+	frame->pts = d->frame_pts;
+	frame->next_pts = d->next_pts;
+	d->frame_ready = false;
+
+	if (!d->audio && m->swscale)
+		frame->format = mp_media_scale_frame(m, frame) ? m->scale_format : AV_PIX_FMT_NONE;
+
+	return frame;
+}
+
+static inline size_t mp_track_queued(const struct mp_track *t)
+{
+	return t->queue.size / sizeof(struct mp_frame *);
+}
+
+static inline void mp_track_set_cur(struct mp_track *t, struct mp_frame *frame)
+{
+	t->cur = frame;
+	t->next_pts = frame->next_pts;
+}
+
+static void mp_track_clear(mp_media_t *m, struct mp_track *t)
+{
+	pthread_mutex_lock(&m->frames_mutex);
+	while (t->queue.size) {
+		struct mp_frame *frame;
+		deque_pop_front(&t->queue, &frame, sizeof(frame));
+		av_frame_unref(frame->frame);
+		da_push_back(m->frame_pool, &frame);
+	}
+	t->queue_eof = false;
+	pthread_mutex_unlock(&m->frames_mutex);
+
+	mp_media_release_frame(m, t->cur);
+	t->cur = NULL;
+	t->next_pts = 0;
+}
+
+static void mp_media_clear_video(mp_media_t *m)
+{
+	mp_track_clear(m, &m->v_out);
+	mp_media_release_frame(m, m->shown_v);
+	m->shown_v = NULL;
+
+	/* the preload frame pointed to one of the frames just released */
+	m->obsframe.data[0] = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static bool mp_media_prepare_queued_frames(mp_media_t *m);
+
 bool mp_media_prepare_frames(mp_media_t *m)
 {
 	bool actively_seeking = m->seek_next_ts && m->pause;
 
+	if (m->decode_running)
+		return mp_media_prepare_queued_frames(m);
+
 	while (!mp_media_ready_to_start(m)) {
 		if (!m->eof) {
 			int ret = mp_media_next_packet(m);
@@ -279,27 +413,23 @@ bool mp_media_prepare_frames(mp_media_t *m)
 			}
 		}
 
-		/* kind of a cheap fix, but because a stinger might be
-		 * interrupted and restart playback, the request_preload signal
-		 * might happen when the current frame is invalid, so clear out
-		 * these pointers to signify they're not valid. (the obsframe
-		 * structure is only used in the media thread, so this isn't a
-		 * threading issue) */
-		m->obsframe.data[0] = NULL;
-
-		if (m->has_video && !mp_decode_frame(&m->v))
+		if (m->has_video && !m->v_out.cur && !mp_decode_frame(&m->v))
 			return false;
-		if (m->has_audio && !mp_decode_frame(&m->a))
+		if (m->has_audio && !m->a_out.cur && !mp_decode_frame(&m->a))
 			return false;
 	}
 
-	if (m->has_video && m->v.frame_ready && !m->swscale) {
-		m->scale_format = closest_format(m->v.frame->format);
-		if (m->scale_format != m->v.frame->format) {
-			if (!mp_media_init_scaling(m)) {
-				return false;
-			}
-		}
+	if (m->has_video && m->v.frame_ready && !m->v_out.cur) {
+		struct mp_frame *frame = mp_media_take_frame(m, &m->v);
+		if (!frame)
+			return false;
+		mp_track_set_cur(&m->v_out, frame);
+	}
+	if (m->has_audio && m->a.frame_ready && !m->a_out.cur) {
+		struct mp_frame *frame = mp_media_take_frame(m, &m->a);
+		if (!frame)
+			return false;
+		mp_track_set_cur(&m->a_out, frame);
 	}
 
 	return true;
@@ -309,13 +439,13 @@ static inline int64_t mp_media_get_next_min_pts(mp_media_t *m)
 {
 	int64_t min_next_ns = 0x7FFFFFFFFFFFFFFFLL;
 
-	if (m->has_video && m->v.frame_ready) {
-		if (m->v.frame_pts < min_next_ns)
-			min_next_ns = m->v.frame_pts;
+	if (m->has_video && m->v_out.cur) {
+		if (m->v_out.cur->pts < min_next_ns)
+			min_next_ns = m->v_out.cur->pts;
 	}
-	if (m->has_audio && m->a.frame_ready) {
-		if (m->a.frame_pts < min_next_ns)
-			min_next_ns = m->a.frame_pts;
+	if (m->has_audio && m->a_out.cur) {
+		if (m->a_out.cur->pts < min_next_ns)
+			min_next_ns = m->a_out.cur->pts;
 	}
 
 	return min_next_ns;
@@ -325,10 +455,10 @@ static inline int64_t mp_media_get_base_pts(mp_media_t *m)
 {
 	int64_t base_ts = 0;
 
-	if (m->has_video && m->v.next_pts > base_ts)
-		base_ts = m->v.next_pts;
-	if (m->has_audio && m->a.next_pts > base_ts)
-		base_ts = m->a.next_pts;
+	if (m->has_video && m->v_out.next_pts > base_ts)
+		base_ts = m->v_out.next_pts;
+	if (m->has_audio && m->a_out.next_pts > base_ts)
+		base_ts = m->a_out.next_pts;
 
 	return base_ts;
 }
@@ -336,25 +466,27 @@ static inline int64_t mp_media_get_base_pts(mp_media_t *m)
 /* maximum timestamp variance in nanoseconds */
 #define MAX_TS_VAR 2000000000LL
 
-static inline bool mp_media_can_play_frame(mp_media_t *m, struct mp_decode *d)
+static inline bool mp_media_can_play_frame(mp_media_t *m, struct mp_track *t)
 {
 	if (m->full_decode)
-		return d->frame_ready;
-	return d->frame_ready && (d->frame_pts <= m->next_pts_ns || (d->frame_pts - m->next_pts_ns > MAX_TS_VAR));
+		return !!t->cur;
+	return t->cur && (t->cur->pts <= m->next_pts_ns || (t->cur->pts - m->next_pts_ns > MAX_TS_VAR));
 }
 
 void mp_media_next_audio(mp_media_t *m)
 {
-	struct mp_decode *d = &m->a;
+	struct mp_track *t = &m->a_out;
 	struct obs_source_audio audio = {0};
-	AVFrame *f = d->frame;
 
-	if (!mp_media_can_play_frame(m, d))
+	if (!mp_media_can_play_frame(m, t))
 		return;
 
-	d->frame_ready = false;
+	struct mp_frame *frame = t->cur;
+	AVFrame *f = frame->frame;
+
+	t->cur = NULL;
 	if (!m->a_cb)
-		return;
+		goto done;
 
 	for (size_t i = 0; i < MAX_AV_PLANES; i++)
 		audio.data[i] = f->data[i];
@@ -363,68 +495,85 @@ void mp_media_next_audio(mp_media_t *m)
 	audio.speakers = convert_speaker_layout(f->ch_layout.nb_channels);
 	audio.format = convert_sample_format(f->format);
 	audio.frames = f->nb_samples;
-	audio.timestamp = m->full_decode ? d->frame_pts
-					 : m->base_ts + d->frame_pts - m->start_ts + m->play_sys_ts - base_sys_ts;
+	audio.timestamp = m->full_decode ? frame->pts
+					 : m->base_ts + frame->pts - m->start_ts + m->play_sys_ts - base_sys_ts;
 
 	if (audio.format == AUDIO_FORMAT_UNKNOWN)
-		return;
+		goto done;
 
 	m->a_cb(m->opaque, &audio);
+
+done:
+	mp_media_release_frame(m, frame);
+}
+
+/* frames output more than a frame duration after they were due are late */
+static void mp_media_profile_video(mp_media_t *m, const struct mp_frame *frame)
+{
+	uint64_t ts = os_gettime_ns();
+	uint64_t late_ns = 0;
+	uint32_t queued = 0;
+
+	if (!m->source || m->full_decode)
+		return;
+
+	if (m->next_ns && ts > m->next_ns + (uint64_t)(frame->next_pts - frame->pts))
+		late_ns = ts - m->next_ns;
+
+	if (m->decode_running) {
+		pthread_mutex_lock(&m->frames_mutex);
+		queued = (uint32_t)mp_track_queued(&m->v_out);
+		pthread_mutex_unlock(&m->frames_mutex);
+	}
+
+	source_profiler_async_frame_stats(m->source, late_ns, queued);
 }
 
 void mp_media_next_video(mp_media_t *m, bool preload)
 {
-	struct mp_decode *d = &m->v;
+	struct mp_track *t = &m->v_out;
 	struct obs_source_frame *frame = &m->obsframe;
 	enum video_format new_format;
 	enum video_colorspace new_space;
 	enum video_range_type new_range;
-	AVFrame *f = d->frame;
 
 	if (!preload) {
-		if (!mp_media_can_play_frame(m, d))
+		if (!mp_media_can_play_frame(m, t))
 			return;
 
-		d->frame_ready = false;
+		/* keep the frame around until the next one, the preload
+		 * frame may still point to it */
+		mp_media_release_frame(m, m->shown_v);
+		m->shown_v = t->cur;
+		t->cur = NULL;
 
 		if (!m->v_cb)
 			return;
-	} else if (!d->frame_ready) {
+	} else if (!t->cur) {
 		return;
 	}
 
+	struct mp_frame *mpf = preload ? t->cur : m->shown_v;
+	AVFrame *f = mpf->frame;
+
 	if (!f->width || !f->height) {
 		blog(LOG_ERROR, "MP: media frame width or height are zero ('%s': %" PRIu32 "x%" PRIu32 ")", m->path,
 		     f->width, f->height);
 		return;
 	}
 
-	bool flip = false;
-	if (m->swscale) {
-		int ret = sws_scale(m->swscale, (const uint8_t *const *)f->data, f->linesize, 0, f->height,
-				    m->scale_pic, m->scale_linesizes);
-		if (ret < 0)
-			return;
-
-		flip = m->scale_linesizes[0] < 0 && m->scale_linesizes[1] == 0;
-		for (size_t i = 0; i < 4; i++) {
-			frame->data[i] = m->scale_pic[i];
-			frame->linesize[i] = abs(m->scale_linesizes[i]);
-		}
-
-	} else {
-		flip = f->linesize[0] < 0 && f->linesize[1] == 0;
+	AVFrame *out = mpf->format != f->format ? mpf->scaled : f;
+	bool flip = out->linesize[0] < 0 && out->linesize[1] == 0;
 
-		for (size_t i = 0; i < MAX_AV_PLANES; i++) {
-			frame->data[i] = f->data[i];
-			frame->linesize[i] = abs(f->linesize[i]);
-		}
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		frame->data[i] = out->data[i];
+		frame->linesize[i] = abs(out->linesize[i]);
 	}
 
 	if (flip)
 		frame->data[0] -= frame->linesize[0] * ((size_t)f->height - 1);
 
-	new_format = convert_pixel_format(m->scale_format);
+	new_format = convert_pixel_format(mpf->format);
 	new_space = convert_color_space(f->colorspace, f->color_trc, f->color_primaries);
 	new_range = m->force_range == VIDEO_RANGE_DEFAULT ? convert_color_range(f->color_range) : m->force_range;
 
@@ -450,12 +599,12 @@ void mp_media_next_video(mp_media_t *m, bool preload)
 	if (frame->format == VIDEO_FORMAT_NONE)
 		return;
 
-	frame->timestamp = m->full_decode ? d->frame_pts
-					  : (m->base_ts + d->frame_pts - m->start_ts + m->play_sys_ts - base_sys_ts);
+	frame->timestamp = m->full_decode ? mpf->pts
+					  : (m->base_ts + mpf->pts - m->start_ts + m->play_sys_ts - base_sys_ts);
 
 	frame->width = f->width;
 	frame->height = f->height;
-	frame->max_luminance = d->max_luminance;
+	frame->max_luminance = m->v.max_luminance;
 	frame->flip = flip;
 	frame->flags = m->is_linear_alpha ? OBS_SOURCE_FRAME_LINEAR_ALPHA : 0;
 	switch (f->color_trc) {
@@ -477,11 +626,11 @@ void mp_media_next_video(mp_media_t *m, bool preload)
 		frame->trc = VIDEO_TRC_DEFAULT;
 	}
 
-	if (!m->is_local_file && !d->got_first_keyframe) {
+	if (!m->is_local_file && !m->v.got_first_keyframe) {
 		if (!(f->flags & AV_FRAME_FLAG_KEY))
 			return;
 
-		d->got_first_keyframe = true;
+		m->v.got_first_keyframe = true;
 	}
 
 	if (preload) {
@@ -491,6 +640,7 @@ void mp_media_next_video(mp_media_t *m, bool preload)
 			m->v_preload_cb(m->opaque, frame);
 		}
 	} else {
+		mp_media_profile_video(m, mpf);
 		m->v_cb(m->opaque, frame);
 	}
 }
@@ -541,29 +691,58 @@ static void seek_to(mp_media_t *m, int64_t pos)
 
 	if (m->has_video && m->is_local_file) {
 		mp_decode_flush(&m->v);
+		mp_media_clear_video(m);
 		if (m->seek_next_ts && m->pause && m->v_preload_cb && mp_media_prepare_frames(m))
 			mp_media_next_video(m, true);
 	}
-	if (m->has_audio && m->is_local_file)
+	if (m->has_audio && m->is_local_file) {
 		mp_decode_flush(&m->a);
+		mp_track_clear(m, &m->a_out);
+	}
 }
 
-bool mp_media_reset(mp_media_t *m)
+static void mp_media_park_decode_thread(mp_media_t *m);
+static void mp_media_resume_decode_thread(mp_media_t *m);
+static bool mp_media_advance(mp_media_t *m);
+
+/* starts the current item over, or when advance is set, continues with the
+ * prerolled next item */
+static bool mp_media_restart(mp_media_t *m, bool advance)
 {
 	bool stopping;
 	bool active;
+	bool success;
+
+	mp_media_park_decode_thread(m);
 
 	int64_t next_ts = mp_media_get_base_pts(m);
 	int64_t offset = next_ts - m->next_pts_ns;
-	int64_t start_time = m->fmt->start_time;
-	if (start_time == AV_NOPTS_VALUE)
-		start_time = 0;
 
 	m->eof = false;
-	m->base_ts += next_ts;
 	m->seek_next_ts = false;
 
-	seek_to(m, start_time);
+	if (advance && !mp_media_advance(m)) {
+		pthread_mutex_lock(&m->mutex);
+		if (!m->looping) {
+			m->active = false;
+			m->stopping = true;
+		}
+		pthread_mutex_unlock(&m->mutex);
+		advance = false;
+	}
+
+	if (advance) {
+		/* the next item's first frame goes out exactly where this
+		 * one's last frame ended */
+		m->base_ts += next_ts - m->start_ts;
+	} else {
+		int64_t start_time = m->fmt->start_time;
+		if (start_time == AV_NOPTS_VALUE)
+			start_time = 0;
+
+		m->base_ts += next_ts;
+		seek_to(m, start_time);
+	}
 
 	pthread_mutex_lock(&m->mutex);
 	stopping = m->stopping;
@@ -571,7 +750,9 @@ bool mp_media_reset(mp_media_t *m)
 	m->stopping = false;
 	pthread_mutex_unlock(&m->mutex);
 
-	if (!mp_media_prepare_frames(m))
+	success = mp_media_prepare_frames(m);
+	mp_media_resume_decode_thread(m);
+	if (!success)
 		return false;
 
 	if (active) {
@@ -595,6 +776,11 @@ bool mp_media_reset(mp_media_t *m)
 	return true;
 }
 
+bool mp_media_reset(mp_media_t *m)
+{
+	return mp_media_restart(m, false);
+}
+
 static inline bool mp_media_sleep(mp_media_t *m)
 {
 	bool timeout = false;
@@ -618,22 +804,27 @@ static inline bool mp_media_sleep(mp_media_t *m)
 
 bool mp_media_eof(mp_media_t *m)
 {
-	bool v_ended = !m->has_video || !m->v.frame_ready;
-	bool a_ended = !m->has_audio || !m->a.frame_ready;
+	bool v_ended = !m->has_video || !m->v_out.cur;
+	bool a_ended = !m->has_audio || !m->a_out.cur;
 	bool eof = v_ended && a_ended;
 
 	if (eof) {
 		bool looping;
+		bool has_next;
+
+		pthread_mutex_lock(&m->next_mutex);
+		has_next = !!m->next;
+		pthread_mutex_unlock(&m->next_mutex);
 
 		pthread_mutex_lock(&m->mutex);
 		looping = m->looping;
-		if (!looping) {
+		if (!looping && !has_next) {
 			m->active = false;
 			m->stopping = true;
 		}
 		pthread_mutex_unlock(&m->mutex);
 
-		mp_media_reset(m);
+		mp_media_restart(m, has_next);
 	}
 
 	return eof;
@@ -737,6 +928,375 @@ bool mp_media_init2(mp_media_t *m)
 	return true;
 }
 
+/* ------------------------------------------------------------------------- */
+/* decode thread                                                             */
+
+/* audio frames are small, this only bounds how far audio gets ahead when the
+ * video queue is what's holding things up */
+#define MAX_QUEUED_AUDIO 32
+
+static inline bool mp_media_wants_video(mp_media_t *m)
+{
+	return m->has_video && !m->v_out.queue_eof && mp_track_queued(&m->v_out) < (size_t)m->decode_ahead;
+}
+
+static inline bool mp_media_wants_audio(mp_media_t *m)
+{
+	return m->has_audio && !m->a_out.queue_eof && mp_track_queued(&m->a_out) < MAX_QUEUED_AUDIO;
+}
+
+static bool mp_media_queue_frame(mp_media_t *m, struct mp_decode *d, struct mp_track *t)
+{
+	struct mp_frame *frame = NULL;
+
+	if (d->frame_ready) {
+		frame = mp_media_take_frame(m, d);
+		if (!frame)
+			return false;
+	} else if (!d->eof) {
+		return true;
+	}
+
+	pthread_mutex_lock(&m->frames_mutex);
+	if (frame)
+		deque_push_back(&t->queue, &frame, sizeof(frame));
+	else
+		t->queue_eof = true;
+	pthread_cond_broadcast(&m->frames_cond);
+	pthread_mutex_unlock(&m->frames_mutex);
+	return true;
+}
+
+/* decodes the next frame of each stream that has room in its queue */
+static bool mp_media_decode_ahead(mp_media_t *m, bool want_video, bool want_audio)
+{
+	while ((want_video && !m->v.frame_ready && !m->v.eof) || (want_audio && !m->a.frame_ready && !m->a.eof)) {
+		if (!m->eof) {
+			int ret = mp_media_next_packet(m);
+			if (ret == AVERROR_EOF || ret == AVERROR_EXIT)
+				m->eof = true;
+			else if (ret < 0)
+				return false;
+		}
+
+		if (want_video && !mp_decode_frame(&m->v))
+			return false;
+		if (want_audio && !mp_decode_frame(&m->a))
+			return false;
+	}
+
+	if (want_video && !mp_media_queue_frame(m, &m->v, &m->v_out))
+		return false;
+	if (want_audio && !mp_media_queue_frame(m, &m->a, &m->a_out))
+		return false;
+	return true;
+}
+
+static void *mp_media_decode_thread(void *opaque)
+{
+	mp_media_t *m = opaque;
+
+	os_set_thread_name("mp_decode_thread");
+
+	pthread_mutex_lock(&m->frames_mutex);
+
+	while (!m->decode_stop) {
+		bool want_video = mp_media_wants_video(m);
+		bool want_audio = mp_media_wants_audio(m);
+
+		if (m->decode_park || m->decode_failed || (!want_video && !want_audio)) {
+			pthread_cond_wait(&m->frames_cond, &m->frames_mutex);
+			continue;
+		}
+
+		m->decode_busy = true;
+		pthread_mutex_unlock(&m->frames_mutex);
+
+		bool success = mp_media_decode_ahead(m, want_video, want_audio);
+
+		pthread_mutex_lock(&m->frames_mutex);
+		m->decode_busy = false;
+		if (!success)
+			m->decode_failed = true;
+		pthread_cond_broadcast(&m->frames_cond);
+	}
+
+	pthread_mutex_unlock(&m->frames_mutex);
+	return NULL;
+}
+
+static void mp_media_start_decode_thread(mp_media_t *m)
+{
+	if (!m->decode_ahead)
+		return;
+
+	if (pthread_cond_init(&m->frames_cond, NULL) != 0) {
+		blog(LOG_WARNING, "MP: Failed to init decode condition variable");
+		return;
+	}
+
+	m->decode_stop = false;
+	m->decode_park = false;
+	m->decode_failed = false;
+
+	if (pthread_create(&m->decode_thread, NULL, mp_media_decode_thread, m) != 0) {
+		blog(LOG_WARNING, "MP: Could not create decode thread, decoding on the media thread");
+		pthread_cond_destroy(&m->frames_cond);
+		return;
+	}
+
+	m->decode_thread_valid = true;
+	m->decode_running = true;
+}
+
+static void mp_media_stop_decode_thread(mp_media_t *m)
+{
+	if (!m->decode_thread_valid)
+		return;
+
+	pthread_mutex_lock(&m->frames_mutex);
+	m->decode_stop = true;
+	pthread_cond_broadcast(&m->frames_cond);
+	pthread_mutex_unlock(&m->frames_mutex);
+
+	pthread_join(m->decode_thread, NULL);
+	pthread_cond_destroy(&m->frames_cond);
+
+	m->decode_thread_valid = false;
+	m->decode_running = false;
+}
+
+/* waits for the decode thread to finish what it's doing and keeps it idle, so
+ * the media thread can seek and decode on its own */
+static void mp_media_park_decode_thread(mp_media_t *m)
+{
+	if (!m->decode_thread_valid)
+		return;
+
+	pthread_mutex_lock(&m->frames_mutex);
+	m->decode_park = true;
+	while (m->decode_busy)
+		pthread_cond_wait(&m->frames_cond, &m->frames_mutex);
+	pthread_mutex_unlock(&m->frames_mutex);
+
+	m->decode_running = false;
+}
+
+static void mp_media_resume_decode_thread(mp_media_t *m)
+{
+	if (!m->decode_thread_valid)
+		return;
+
+	pthread_mutex_lock(&m->frames_mutex);
+	m->decode_park = false;
+	m->decode_failed = false;
+	pthread_cond_broadcast(&m->frames_cond);
+	pthread_mutex_unlock(&m->frames_mutex);
+
+	m->decode_running = true;
+}
+
+static inline bool mp_track_pop(struct mp_track *t, bool has_stream)
+{
+	if (!has_stream || t->cur)
+		return true;
+
+	if (t->queue.size) {
+		struct mp_frame *frame;
+		deque_pop_front(&t->queue, &frame, sizeof(frame));
+		mp_track_set_cur(t, frame);
+		return true;
+	}
+
+	return t->queue_eof;
+}
+
+/* media thread: takes the next frames from the queues, only waiting if the
+ * decode thread has fallen behind */
+static bool mp_media_prepare_queued_frames(mp_media_t *m)
+{
+	bool success = true;
+
+	pthread_mutex_lock(&m->frames_mutex);
+
+	for (;;) {
+		bool video_ready = mp_track_pop(&m->v_out, m->has_video);
+		bool audio_ready = mp_track_pop(&m->a_out, m->has_audio);
+
+		if (video_ready && audio_ready)
+			break;
+		if (m->decode_failed) {
+			success = false;
+			break;
+		}
+
+		pthread_cond_wait(&m->frames_cond, &m->frames_mutex);
+	}
+
+	/* there's room in the queues again */
+	pthread_cond_broadcast(&m->frames_cond);
+	pthread_mutex_unlock(&m->frames_mutex);
+	return success;
+}
+
+/* ------------------------------------------------------------------------- */
+/* next playlist item                                                        */
+
+static void *mp_media_preroll_thread(void *opaque)
+{
+	mp_media_t *next = opaque;
+
+	os_set_thread_name("mp_preroll_thread");
+
+	next->prerolled = mp_media_init2(next) && mp_media_prepare_frames(next);
+	return NULL;
+}
+
+static void mp_media_free_next(mp_media_t *next, pthread_t thread, bool thread_valid)
+{
+	if (!next)
+		return;
+
+	if (thread_valid)
+		pthread_join(thread, NULL);
+
+	mp_media_free(next);
+	bfree(next);
+}
+
+void mp_media_set_next(mp_media_t *m, const char *path)
+{
+	mp_media_t *next = NULL;
+
+	if (path && *path) {
+		/* no media thread, it's only opened and decoded up to its
+		 * first frames, then swapped into this one */
+		struct mp_media_info info = {
+			.path = path,
+			.ffmpeg_options = m->ffmpeg_options,
+			.speed = m->speed,
+			.force_range = m->force_range,
+			.is_linear_alpha = m->is_linear_alpha,
+			.hardware_decoding = m->hw,
+			.is_local_file = true,
+			.full_decode = true,
+		};
+
+		next = bzalloc(sizeof(*next));
+		if (!mp_media_init(next, &info)) {
+			bfree(next);
+			next = NULL;
+		}
+	}
+
+	pthread_mutex_lock(&m->next_mutex);
+
+	mp_media_t *old = m->next;
+	pthread_t old_thread = m->next_thread;
+	bool old_thread_valid = m->next_thread_valid;
+
+	m->next = next;
+	m->next_thread_valid = false;
+
+	if (next) {
+		if (pthread_create(&m->next_thread, NULL, mp_media_preroll_thread, next) == 0)
+			m->next_thread_valid = true;
+		else
+			blog(LOG_WARNING, "MP: Could not create preroll thread");
+	}
+
+	pthread_mutex_unlock(&m->next_mutex);
+
+	mp_media_free_next(old, old_thread, old_thread_valid);
+}
+
+static void mp_media_swap_input(mp_media_t *m, mp_media_t *next)
+{
+#define SWAP_FIELD(type, field)           \
+	do {                              \
+		type swap_tmp = m->field; \
+		m->field = next->field;   \
+		next->field = swap_tmp;   \
+	} while (false)
+
+	/* the duration and frame count are queried from other threads */
+	pthread_mutex_lock(&m->mutex);
+	SWAP_FIELD(AVFormatContext *, fmt);
+	SWAP_FIELD(char *, path);
+	pthread_mutex_unlock(&m->mutex);
+
+	SWAP_FIELD(struct mp_decode, v);
+	SWAP_FIELD(struct mp_decode, a);
+	SWAP_FIELD(bool, has_video);
+	SWAP_FIELD(bool, has_audio);
+	SWAP_FIELD(bool, eof);
+	SWAP_FIELD(struct SwsContext *, swscale);
+	SWAP_FIELD(enum AVPixelFormat, scale_format);
+	SWAP_FIELD(struct mp_frame *, v_out.cur);
+	SWAP_FIELD(int64_t, v_out.next_pts);
+	SWAP_FIELD(struct mp_frame *, a_out.cur);
+	SWAP_FIELD(int64_t, a_out.next_pts);
+
+#undef SWAP_FIELD
+
+	/* the decoders point back to the media they belong to */
+	mp_media_t *medias[] = {m, next};
+	for (size_t i = 0; i < 2; i++) {
+		struct mp_decode *decoders[] = {&medias[i]->v, &medias[i]->a};
+
+		for (size_t j = 0; j < 2; j++) {
+			struct mp_decode *d = decoders[j];
+
+			d->m = medias[i];
+			if (d->decoder && d->hw)
+				d->decoder->opaque = d;
+		}
+	}
+}
+
+/* media thread, with the decode thread parked: replaces the input with the
+ * next item, skipping any that could not be opened */
+static bool mp_media_advance(mp_media_t *m)
+{
+	for (;;) {
+		pthread_mutex_lock(&m->next_mutex);
+		mp_media_t *next = m->next;
+		pthread_t thread = m->next_thread;
+		bool thread_valid = m->next_thread_valid;
+		m->next = NULL;
+		m->next_thread_valid = false;
+		pthread_mutex_unlock(&m->next_mutex);
+
+		if (!next)
+			return false;
+
+		/* only waits if the next item is still being opened */
+		if (thread_valid)
+			pthread_join(thread, NULL);
+
+		if (!next->prerolled) {
+			blog(LOG_WARNING, "MP: Could not open next item '%s'", next->path);
+			mp_media_free_next(next, thread, false);
+
+			/* the callback can queue up another item */
+			if (m->next_cb)
+				m->next_cb(m->opaque, false);
+			continue;
+		}
+
+		mp_track_clear(m, &m->v_out);
+		mp_track_clear(m, &m->a_out);
+		mp_media_swap_input(m, next);
+		mp_media_free_next(next, thread, false);
+
+		if (m->next_cb)
+			m->next_cb(m->opaque, true);
+		return true;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
 static inline bool mp_media_thread(mp_media_t *m)
 {
 	os_set_thread_name("mp_media_thread");
@@ -748,6 +1308,8 @@ static inline bool mp_media_thread(mp_media_t *m)
 		return false;
 	}
 
+	mp_media_start_decode_thread(m);
+
 	for (;;) {
 		bool reset, kill, is_active, seek, pause, reset_time, preload_frame;
 		int64_t seek_pos;
@@ -795,7 +1357,9 @@ static inline bool mp_media_thread(mp_media_t *m)
 
 		if (seek) {
 			m->seek_next_ts = true;
+			mp_media_park_decode_thread(m);
 			seek_to(m, seek_pos);
+			mp_media_resume_decode_thread(m);
 			continue;
 		}
 
@@ -807,8 +1371,9 @@ static inline bool mp_media_thread(mp_media_t *m)
 		if (pause)
 			continue;
 
-		/* see note in mp_media_prepare_frames() for context on the
-		 * pointer check */
+		/* a stinger might be interrupted and restart playback, so the
+		 * request_preload signal might come after the frames were
+		 * cleared, which is what the pointer check is for */
 		if (preload_frame && m->obsframe.data[0] && !is_active) {
 			m->v_preload_cb(m->opaque, &m->obsframe);
 		}
@@ -835,8 +1400,11 @@ static inline bool mp_media_thread(mp_media_t *m)
 static void *mp_media_thread_start(void *opaque)
 {
 	mp_media_t *m = opaque;
+	bool success = mp_media_thread(m);
+
+	mp_media_stop_decode_thread(m);
 
-	if (!mp_media_thread(m)) {
+	if (!success) {
 		if (m->stop_cb) {
 			m->stop_cb(m->opaque);
 		}
@@ -855,6 +1423,14 @@ static inline bool mp_media_init_internal(mp_media_t *m, const struct mp_media_i
 		blog(LOG_WARNING, "MP: Failed to init semaphore");
 		return false;
 	}
+	if (pthread_mutex_init(&m->frames_mutex, NULL) != 0) {
+		blog(LOG_WARNING, "MP: Failed to init frames mutex");
+		return false;
+	}
+	if (pthread_mutex_init(&m->next_mutex, NULL) != 0) {
+		blog(LOG_WARNING, "MP: Failed to init next item mutex");
+		return false;
+	}
 
 	m->path = info->path ? bstrdup(info->path) : NULL;
 	m->format_name = info->format ? bstrdup(info->format) : NULL;
@@ -876,10 +1452,14 @@ bool mp_media_init(mp_media_t *media, const struct mp_media_info *info)
 {
 	memset(media, 0, sizeof(*media));
 	pthread_mutex_init_value(&media->mutex);
+	pthread_mutex_init_value(&media->frames_mutex);
+	pthread_mutex_init_value(&media->next_mutex);
 	media->opaque = info->opaque;
+	media->source = info->source;
 	media->v_cb = info->v_cb;
 	media->a_cb = info->a_cb;
 	media->stop_cb = info->stop_cb;
+	media->next_cb = info->next_cb;
 	media->ffmpeg_options = info->ffmpeg_options;
 	media->v_seek_cb = info->v_seek_cb;
 	media->v_preload_cb = info->v_preload_cb;
@@ -894,6 +1474,10 @@ bool mp_media_init(mp_media_t *media, const struct mp_media_info *info)
 	if (!info->is_local_file || media->speed < 1 || media->speed > 200)
 		media->speed = 100;
 
+	/* network streams are paced by their own buffering */
+	if (info->is_local_file && !info->full_decode && info->decode_ahead > 0)
+		media->decode_ahead = info->decode_ahead < MAX_DECODE_AHEAD ? info->decode_ahead : MAX_DECODE_AHEAD;
+
 	static bool initialized = false;
 	if (!initialized) {
 		avdevice_register_all();
@@ -931,6 +1515,14 @@ void mp_media_free(mp_media_t *media)
 
 	mp_media_stop(media);
 	mp_kill_thread(media);
+	mp_media_free_next(media->next, media->next_thread, media->next_thread_valid);
+	mp_media_clear_video(media);
+	mp_track_clear(media, &media->a_out);
+	deque_free(&media->v_out.queue);
+	deque_free(&media->a_out.queue);
+	for (size_t i = 0; i < media->frame_pool.num; i++)
+		mp_frame_destroy(media->frame_pool.array[i]);
+	da_free(media->frame_pool);
 	mp_decode_free(&media->v);
 	mp_decode_free(&media->a);
 	for (size_t i = 0; i < media->packet_pool.num; i++)
@@ -938,13 +1530,16 @@ void mp_media_free(mp_media_t *media)
 	da_free(media->packet_pool);
 	avformat_close_input(&media->fmt);
 	pthread_mutex_destroy(&media->mutex);
+	pthread_mutex_destroy(&media->frames_mutex);
+	pthread_mutex_destroy(&media->next_mutex);
 	os_sem_destroy(media->sem);
 	sws_freeContext(media->swscale);
-	av_freep(&media->scale_pic[0]);
 	bfree(media->path);
 	bfree(media->format_name);
 	memset(media, 0, sizeof(*media));
 	pthread_mutex_init_value(&media->mutex);
+	pthread_mutex_init_value(&media->frames_mutex);
+	pthread_mutex_init_value(&media->next_mutex);
 }
 
 void mp_media_play(mp_media_t *m, bool loop, bool reconnecting)
@@ -1003,7 +1598,7 @@ int64_t mp_media_get_current_time(mp_media_t *m)
 	return mp_media_get_base_pts(m) * (int64_t)m->speed / 100000000LL;
 }
 
-int64_t mp_media_get_frames(mp_media_t *m)
+static int64_t get_frames(mp_media_t *m)
 {
 	int64_t frames = 0;
 
@@ -1034,9 +1629,21 @@ int64_t mp_media_get_frames(mp_media_t *m)
 	return frames;
 }
 
+/* the input changes when a playlist advances, so these lock the mutex */
+int64_t mp_media_get_frames(mp_media_t *m)
+{
+	pthread_mutex_lock(&m->mutex);
+	int64_t frames = get_frames(m);
+	pthread_mutex_unlock(&m->mutex);
+	return frames;
+}
+
 int64_t mp_media_get_duration(mp_media_t *m)
 {
-	return m->fmt ? m->fmt->duration : 0;
+	pthread_mutex_lock(&m->mutex);
+	int64_t duration = m->fmt ? m->fmt->duration : 0;
+	pthread_mutex_unlock(&m->mutex);
+	return duration;
 }
 
 void mp_media_seek(mp_media_t *m, int64_t pos)
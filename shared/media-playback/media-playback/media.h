@@ -38,8 +38,28 @@ extern "C" {
 #pragma warning(pop)
 #endif
 
+/* a decoded frame that is ready to be output */
+struct mp_frame {
+	AVFrame *frame;
+	AVFrame *scaled; /* frame converted to scale_format, buffers are kept */
+	enum AVPixelFormat format;
+	int64_t pts;
+	int64_t next_pts;
+};
+
+/* frames of a stream on their way to output */
+struct mp_track {
+	struct mp_frame *cur; /* next frame to output */
+	int64_t next_pts;
+
+	/* frames decoded ahead by the decode thread, guarded by frames_mutex */
+	struct deque queue;
+	bool queue_eof;
+};
+
 struct mp_media {
 	AVFormatContext *fmt;
+	obs_source_t *source;
 
 	mp_video_cb v_preload_cb;
 	mp_video_cb v_seek_cb;
@@ -56,8 +76,6 @@ struct mp_media {
 
 	enum AVPixelFormat scale_format;
 	struct SwsContext *swscale;
-	int scale_linesizes[4];
-	uint8_t *scale_pic[4];
 
 	DARRAY(AVPacket *) packet_pool;
 	struct mp_decode v;
@@ -71,6 +89,10 @@ struct mp_media {
 	bool eof;
 	bool hw;
 
+	struct mp_track v_out;
+	struct mp_track a_out;
+	struct mp_frame *shown_v; /* last video frame output, obsframe points to it */
+
 	struct obs_source_frame obsframe;
 	enum video_colorspace cur_space;
 	enum video_range_type cur_range;
@@ -98,6 +120,31 @@ struct mp_media {
 	bool thread_valid;
 	pthread_t thread;
 
+	/* decode thread, used when decode_ahead is non-zero.  It decodes and
+	 * converts up to decode_ahead video frames ahead of playback, so the
+	 * media thread only paces out frames that are already there. */
+	int decode_ahead;
+	pthread_mutex_t frames_mutex;
+	pthread_cond_t frames_cond;
+	DARRAY(struct mp_frame *) frame_pool;
+	bool decode_thread_valid;
+	pthread_t decode_thread;
+	bool decode_running; /* media thread only, frames come from the queues */
+	bool decode_park;
+	bool decode_busy;
+	bool decode_stop;
+	bool decode_failed;
+
+	/* playlist: the next item is opened and decoded up to its first frames
+	 * on its own thread while this one plays, then swapped in at the end so
+	 * there is no gap between the two */
+	pthread_mutex_t next_mutex;
+	struct mp_media *next;
+	pthread_t next_thread;
+	bool next_thread_valid;
+	bool prerolled; /* set on the next item once it's ready to play */
+	mp_next_cb next_cb;
+
 	bool pause;
 	bool reset_ts;
 	bool seek;
@@ -118,6 +165,7 @@ extern int64_t mp_media_get_current_time(mp_media_t *m);
 extern int64_t mp_media_get_frames(mp_media_t *m);
 extern int64_t mp_media_get_duration(mp_media_t *m);
 extern void mp_media_seek(mp_media_t *m, int64_t pos);
+extern void mp_media_set_next(mp_media_t *m, const char *path);
 
 /* #define DETAILED_DEBUG_INFO */
 
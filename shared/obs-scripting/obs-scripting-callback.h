@@ -31,6 +31,7 @@ struct script_callback {
 
 	void (*on_remove)(void *p_cb);
 	obs_script_t *script;
+	enum obs_script_callback_type type;
 	calldata_t extra;
 
 	volatile bool removed;
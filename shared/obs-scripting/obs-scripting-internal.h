@@ -21,6 +21,19 @@
 #include <callback/calldata.h>
 #include "obs-scripting.h"
 
+/* 4 buckets per power of two of nanoseconds, enough to cover any uint64_t */
+#define SCRIPT_TIMING_BUCKETS 256
+
+struct script_callback_timing {
+	uint64_t calls;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t over_budget_calls;
+	uint32_t buckets[SCRIPT_TIMING_BUCKETS];
+
+	const char *profile_name;
+};
+
 struct obs_script {
 	enum obs_script_lang type;
 	bool loaded;
@@ -30,6 +43,9 @@ struct obs_script {
 	struct dstr path;
 	struct dstr file;
 	struct dstr desc;
+
+	struct script_callback_timing timing[OBS_SCRIPT_CALLBACK_COUNT];
+	bool over_budget;
 };
 
 struct script_callback;
@@ -37,6 +53,11 @@ typedef void (*defer_call_cb)(void *param);
 
 extern void defer_call_post(defer_call_cb call, void *cb);
 
+/* brackets a call into the script, the script's mutex (or the GIL) must be
+ * held for the whole call */
+extern uint64_t script_timing_begin(obs_script_t *script, enum obs_script_callback_type type);
+extern void script_timing_end(obs_script_t *script, enum obs_script_callback_type type, uint64_t start);
+
 extern void script_log(obs_script_t *script, int level, const char *format, ...);
 extern void script_log_va(obs_script_t *script, int level, const char *format, va_list args);
 
@@ -239,6 +239,7 @@ static int add_event_callback(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 1);
+	cb->base.type = OBS_SCRIPT_CALLBACK_FRONTEND;
 	defer_call_post(add_event_callback_defer, cb);
 	return 0;
 }
@@ -287,6 +288,7 @@ static int add_save_callback(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 1);
+	cb->base.type = OBS_SCRIPT_CALLBACK_FRONTEND;
 	defer_call_post(add_save_callback_defer, cb);
 	return 0;
 }
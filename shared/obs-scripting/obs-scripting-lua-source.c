@@ -165,9 +165,11 @@ struct obs_lua_data {
 	struct obs_lua_script *__data = ls->data;                  \
 	struct obs_lua_script *__prev_script = current_lua_script; \
 	current_lua_script = __data;                               \
-	pthread_mutex_lock(&__data->mutex);
-#define unlock_script()                       \
-	pthread_mutex_unlock(&__data->mutex); \
+	pthread_mutex_lock(&__data->mutex);                        \
+	uint64_t __timing_start = script_timing_begin(&__data->base, OBS_SCRIPT_CALLBACK_SOURCE);
+#define unlock_script()                                                               \
+	script_timing_end(&__data->base, OBS_SCRIPT_CALLBACK_SOURCE, __timing_start); \
+	pthread_mutex_unlock(&__data->mutex);                                         \
 	current_lua_script = __prev_script;
 
 static const char *obs_lua_source_get_name(void *type_data)
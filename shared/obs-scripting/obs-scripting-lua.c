@@ -314,6 +314,7 @@ static int timer_add(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback_extra(script, 1, sizeof(struct lua_obs_timer));
+	cb->base.type = OBS_SCRIPT_CALLBACK_TIMER;
 	struct lua_obs_timer *timer = lua_obs_callback_extra_data(cb);
 
 	timer->interval = (uint64_t)ms * 1000000ULL;
@@ -366,6 +367,7 @@ static int obs_lua_add_main_render_callback(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 1);
+	cb->base.type = OBS_SCRIPT_CALLBACK_RENDER;
 	defer_call_post(defer_add_render, cb);
 	return 0;
 }
@@ -412,6 +414,7 @@ static int obs_lua_add_tick_callback(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 1);
+	cb->base.type = OBS_SCRIPT_CALLBACK_TICK;
 	defer_call_post(defer_add_tick, cb);
 	return 0;
 }
@@ -488,6 +491,7 @@ static int obs_lua_signal_handler_connect(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 3);
+	cb->base.type = OBS_SCRIPT_CALLBACK_SIGNAL;
 	calldata_set_ptr(&cb->base.extra, "handler", handler);
 	calldata_set_string(&cb->base.extra, "signal", signal);
 	defer_call_post(defer_connect, cb);
@@ -557,6 +561,7 @@ static int obs_lua_signal_handler_connect_global(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 2);
+	cb->base.type = OBS_SCRIPT_CALLBACK_SIGNAL;
 	calldata_set_ptr(&cb->base.extra, "handler", handler);
 	defer_call_post(defer_connect_global, cb);
 	return 0;
@@ -728,6 +733,7 @@ static int hotkey_register_frontend(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 3);
+	cb->base.type = OBS_SCRIPT_CALLBACK_HOTKEY;
 	cb->base.on_remove = on_remove_hotkey;
 	id = obs_hotkey_register_frontend(name, desc, hotkey_callback, cb);
 	calldata_set_int(&cb->base.extra, "id", id);
@@ -785,6 +791,7 @@ static int properties_add_button(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 4);
+	cb->base.type = OBS_SCRIPT_CALLBACK_PROPERTY;
 	p = obs_properties_add_button2(props, name, text, button_prop_clicked, cb);
 
 	if (!p || !ls_push_libobs_obj(obs_property_t, p, false))
@@ -835,6 +842,7 @@ static int property_set_modified_callback(lua_State *script)
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 2);
+	cb->base.type = OBS_SCRIPT_CALLBACK_PROPERTY;
 	obs_property_set_modified_callback2(p, modified_callback, cb);
 	return 0;
 }
@@ -1052,10 +1060,12 @@ static void lua_tick(void *param, float seconds)
 		current_lua_script = data;
 
 		pthread_mutex_lock(&data->mutex);
+		uint64_t start = script_timing_begin(&data->base, OBS_SCRIPT_CALLBACK_TICK);
 
 		lua_pushnumber(script, (double)seconds);
 		call_func_(script, data->tick, 1, 0, "tick", __FUNCTION__);
 
+		script_timing_end(&data->base, OBS_SCRIPT_CALLBACK_TICK, start);
 		pthread_mutex_unlock(&data->mutex);
 
 		data = data->next_tick;
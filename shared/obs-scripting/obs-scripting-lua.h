@@ -91,10 +91,14 @@ struct obs_lua_script {
 	struct lua_obs_callback *__last_callback = current_lua_cb;     \
 	current_lua_cb = cb;                                           \
 	current_lua_script = (struct obs_lua_script *)cb->base.script; \
-	pthread_mutex_lock(&current_lua_script->mutex);
-#define unlock_callback()                                 \
-	pthread_mutex_unlock(&current_lua_script->mutex); \
-	current_lua_script = __last_script;               \
+	pthread_mutex_lock(&current_lua_script->mutex);                \
+	obs_script_t *__timed_script = &current_lua_script->base;      \
+	enum obs_script_callback_type __timed_type = cb->base.type;    \
+	uint64_t __timing_start = script_timing_begin(__timed_script, __timed_type);
+#define unlock_callback()                                                \
+	script_timing_end(__timed_script, __timed_type, __timing_start); \
+	pthread_mutex_unlock(&current_lua_script->mutex);                \
+	current_lua_script = __last_script;                              \
 	current_lua_cb = __last_callback;
 
 /* ------------------------------------------------ */
@@ -292,11 +292,14 @@ static void frontend_save_callback(obs_data_t *save_data, bool saving, void *pri
 		struct python_obs_callback *last_cb = cur_python_cb;
 		cur_python_cb = cb;
 		cur_python_script = (struct obs_python_script *)cb->base.script;
+		uint64_t start = script_timing_begin(cb->base.script, OBS_SCRIPT_CALLBACK_FRONTEND);
 
 		PyObject *py_ret = PyObject_CallObject(cb->func, args);
 		Py_XDECREF(py_ret);
 		py_error();
 
+		script_timing_end(cb->base.script, OBS_SCRIPT_CALLBACK_FRONTEND, start);
+
 		cur_python_script = NULL;
 		cur_python_cb = last_cb;
 
@@ -343,6 +346,7 @@ static PyObject *add_save_callback(PyObject *self, PyObject *args)
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	cb->base.type = OBS_SCRIPT_CALLBACK_FRONTEND;
 	defer_call_post(add_save_callback_defer, cb);
 	return python_none();
 }
@@ -363,11 +367,14 @@ static void frontend_event_callback(enum obs_frontend_event event, void *priv)
 	struct python_obs_callback *last_cb = cur_python_cb;
 	cur_python_cb = cb;
 	cur_python_script = (struct obs_python_script *)cb->base.script;
+	uint64_t start = script_timing_begin(cb->base.script, OBS_SCRIPT_CALLBACK_FRONTEND);
 
 	PyObject *py_ret = PyObject_CallObject(cb->func, args);
 	Py_XDECREF(py_ret);
 	py_error();
 
+	script_timing_end(cb->base.script, OBS_SCRIPT_CALLBACK_FRONTEND, start);
+
 	cur_python_script = NULL;
 	cur_python_cb = last_cb;
 
@@ -412,6 +419,7 @@ static PyObject *add_event_callback(PyObject *self, PyObject *args)
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	cb->base.type = OBS_SCRIPT_CALLBACK_FRONTEND;
 	defer_call_post(add_event_callback_defer, cb);
 	return python_none();
 }
@@ -112,10 +112,14 @@ bool libobs_to_py_(const char *type, void *libobs_in, bool ownership, PyObject *
 	struct obs_python_script *__last_script = cur_python_script;     \
 	struct python_obs_callback *__last_cb = cur_python_cb;           \
 	cur_python_script = (struct obs_python_script *)cb->base.script; \
-	cur_python_cb = cb
-#define unlock_callback()                  \
-	cur_python_cb = __last_cb;         \
-	cur_python_script = __last_script; \
+	cur_python_cb = cb;                                              \
+	obs_script_t *__timed_script = cb->base.script;                  \
+	enum obs_script_callback_type __timed_type = cb->base.type;      \
+	uint64_t __timing_start = script_timing_begin(__timed_script, __timed_type)
+#define unlock_callback()                                                \
+	script_timing_end(__timed_script, __timed_type, __timing_start); \
+	cur_python_cb = __last_cb;                                       \
+	cur_python_script = __last_script;                               \
 	unlock_python()
 
 /* ========================================================================= */
@@ -449,6 +453,7 @@ static PyObject *timer_add(PyObject *self, PyObject *args)
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback_extra(script, py_cb, sizeof(struct python_obs_timer));
+	cb->base.type = OBS_SCRIPT_CALLBACK_TIMER;
 	struct python_obs_timer *timer = python_obs_callback_extra_data(cb);
 
 	timer->interval = (uint64_t)ms * 1000000ULL;
@@ -521,6 +526,7 @@ static PyObject *obs_python_add_tick_callback(PyObject *self, PyObject *args)
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	cb->base.type = OBS_SCRIPT_CALLBACK_TICK;
 	obs_add_tick_callback(obs_python_tick_callback, cb);
 	return python_none();
 }
@@ -616,6 +622,7 @@ static PyObject *obs_python_signal_handler_connect(PyObject *self, PyObject *arg
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	cb->base.type = OBS_SCRIPT_CALLBACK_SIGNAL;
 	calldata_set_ptr(&cb->base.extra, "handler", handler);
 	calldata_set_string(&cb->base.extra, "signal", signal);
 	signal_handler_connect(handler, signal, calldata_signal_callback, cb);
@@ -711,6 +718,7 @@ static PyObject *obs_python_signal_handler_connect_global(PyObject *self, PyObje
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	cb->base.type = OBS_SCRIPT_CALLBACK_SIGNAL;
 	calldata_set_ptr(&cb->base.extra, "handler", handler);
 	signal_handler_connect_global(handler, calldata_signal_callback_global, cb);
 	return python_none();
@@ -820,6 +828,7 @@ static PyObject *hotkey_register_frontend(PyObject *self, PyObject *args)
 		return py_invalid_hotkey_id();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	cb->base.type = OBS_SCRIPT_CALLBACK_HOTKEY;
 	cb->base.on_remove = on_remove_hotkey;
 	id = obs_hotkey_register_frontend(name, desc, hotkey_callback, cb);
 	calldata_set_int(&cb->base.extra, "id", id);
@@ -883,6 +892,7 @@ static PyObject *properties_add_button(PyObject *self, PyObject *args)
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	cb->base.type = OBS_SCRIPT_CALLBACK_PROPERTY;
 	p = obs_properties_add_button2(props, name, text, button_prop_clicked, cb);
 
 	if (!p || !libobs_to_py(obs_property_t, p, false, &py_ret))
@@ -943,6 +953,7 @@ static PyObject *property_set_modified_callback(PyObject *self, PyObject *args)
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	cb->base.type = OBS_SCRIPT_CALLBACK_PROPERTY;
 	obs_property_set_modified_callback2(p, modified_callback, cb);
 
 	UNUSED_PARAMETER(self);
@@ -1506,11 +1517,14 @@ static void python_tick(void *param, float seconds)
 
 		while (data) {
 			cur_python_script = data;
+			uint64_t start = script_timing_begin(&data->base, OBS_SCRIPT_CALLBACK_TICK);
 
 			PyObject *py_ret = PyObject_CallObject(data->tick, args);
 			Py_XDECREF(py_ret);
 			py_error();
 
+			script_timing_end(&data->base, OBS_SCRIPT_CALLBACK_TICK, start);
+
 			data = data->next_tick;
 		}
 
@@ -18,6 +18,7 @@
 #include <obs.h>
 #include <util/dstr.h>
 #include <util/platform.h>
+#include <util/profiler.h>
 #include <util/threading.h>
 #include <util/deque.h>
 
@@ -129,6 +130,182 @@ void defer_call_post(defer_call_cb call, void *cb)
 
 /* -------------------------------------------- */
 
+/* p99 is only meaningful once a callback has been called a few times, which
+ * also keeps one slow first call (module imports, JIT) from flagging it */
+#define BUDGET_MIN_CALLS 100
+
+static pthread_mutex_t timing_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t callback_budget_ns = 5000000;
+
+static const char *callback_type_names[OBS_SCRIPT_CALLBACK_COUNT] = {
+	"tick", "timer", "render", "signal", "hotkey", "property", "frontend", "source",
+};
+
+static inline unsigned int timing_msb(uint64_t val)
+{
+	unsigned int msb = 0;
+	while (val >>= 1)
+		msb++;
+	return msb;
+}
+
+static inline size_t timing_bucket(uint64_t ns)
+{
+	if (ns < 4)
+		return (size_t)ns;
+
+	unsigned int msb = timing_msb(ns);
+	return (size_t)(msb - 1) * 4 + (size_t)((ns >> (msb - 2)) & 3);
+}
+
+static inline uint64_t timing_bucket_max(size_t bucket)
+{
+	if (bucket < 4)
+		return bucket;
+
+	unsigned int shift = (unsigned int)(bucket / 4) - 1;
+	uint64_t low = (uint64_t)(4 + bucket % 4) << shift;
+	return low + ((1ULL << shift) - 1);
+}
+
+uint64_t script_timing_begin(obs_script_t *script, enum obs_script_callback_type type)
+{
+	struct script_callback_timing *timing = &script->timing[type];
+	const char *name;
+
+	pthread_mutex_lock(&timing_mutex);
+	name = timing->profile_name;
+	if (!name) {
+		name = profile_store_name(obs_get_profiler_name_store(), "script_%s(%s)", callback_type_names[type],
+					  script->file.array);
+		timing->profile_name = name;
+	}
+	pthread_mutex_unlock(&timing_mutex);
+
+	profile_start(name);
+	return os_gettime_ns();
+}
+
+void script_timing_end(obs_script_t *script, enum obs_script_callback_type type, uint64_t start)
+{
+	uint64_t elapsed = os_gettime_ns() - start;
+	struct script_callback_timing *timing = &script->timing[type];
+	uint64_t budget;
+	bool flagged = false;
+
+	profile_end(timing->profile_name);
+
+	pthread_mutex_lock(&timing_mutex);
+	budget = callback_budget_ns;
+
+	timing->calls++;
+	timing->total_ns += elapsed;
+	if (elapsed > timing->max_ns)
+		timing->max_ns = elapsed;
+	timing->buckets[timing_bucket(elapsed)]++;
+
+	if (budget && elapsed > budget)
+		timing->over_budget_calls++;
+
+	if (!script->over_budget && timing->calls >= BUDGET_MIN_CALLS &&
+	    timing->over_budget_calls * 100 > timing->calls) {
+		script->over_budget = true;
+		flagged = true;
+	}
+	pthread_mutex_unlock(&timing_mutex);
+
+	if (flagged)
+		script_warn(script, "More than 1%% of its %s callbacks take longer than %.1f ms, this slows down OBS",
+			    callback_type_names[type], (double)budget / 1000000.0);
+}
+
+const char *obs_script_callback_type_name(enum obs_script_callback_type type)
+{
+	if ((size_t)type >= OBS_SCRIPT_CALLBACK_COUNT)
+		return NULL;
+	return callback_type_names[type];
+}
+
+bool obs_script_get_callback_stats(const obs_script_t *script, enum obs_script_callback_type type,
+				   struct obs_script_callback_stats *stats)
+{
+	if (!script || !stats || (size_t)type >= OBS_SCRIPT_CALLBACK_COUNT)
+		return false;
+
+	const struct script_callback_timing *timing = &script->timing[type];
+
+	pthread_mutex_lock(&timing_mutex);
+	stats->calls = timing->calls;
+	stats->total_ns = timing->total_ns;
+	stats->max_ns = timing->max_ns;
+	stats->p99_ns = 0;
+
+	uint64_t target = (timing->calls * 99 + 99) / 100;
+	uint64_t count = 0;
+
+	for (size_t i = 0; target && i < SCRIPT_TIMING_BUCKETS; i++) {
+		count += timing->buckets[i];
+		if (count >= target) {
+			stats->p99_ns = timing_bucket_max(i);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&timing_mutex);
+
+	if (stats->p99_ns > stats->max_ns)
+		stats->p99_ns = stats->max_ns;
+	return true;
+}
+
+void obs_script_reset_callback_stats(obs_script_t *script)
+{
+	if (!script)
+		return;
+
+	pthread_mutex_lock(&timing_mutex);
+	for (size_t i = 0; i < OBS_SCRIPT_CALLBACK_COUNT; i++) {
+		struct script_callback_timing *timing = &script->timing[i];
+		const char *name = timing->profile_name;
+
+		memset(timing, 0, sizeof(*timing));
+		timing->profile_name = name;
+	}
+	script->over_budget = false;
+	pthread_mutex_unlock(&timing_mutex);
+}
+
+bool obs_script_over_budget(const obs_script_t *script)
+{
+	bool over_budget;
+
+	if (!script)
+		return false;
+
+	pthread_mutex_lock(&timing_mutex);
+	over_budget = script->over_budget;
+	pthread_mutex_unlock(&timing_mutex);
+	return over_budget;
+}
+
+void obs_scripting_set_callback_budget(uint64_t budget_ns)
+{
+	pthread_mutex_lock(&timing_mutex);
+	callback_budget_ns = budget_ns;
+	pthread_mutex_unlock(&timing_mutex);
+}
+
+uint64_t obs_scripting_get_callback_budget(void)
+{
+	uint64_t budget;
+
+	pthread_mutex_lock(&timing_mutex);
+	budget = callback_budget_ns;
+	pthread_mutex_unlock(&timing_mutex);
+	return budget;
+}
+
+/* -------------------------------------------- */
+
 bool obs_scripting_load(void)
 {
 	deque_init(&defer_call_queue);
@@ -399,6 +576,8 @@ bool obs_script_reload(obs_script_t *script)
 	if (!ptr_valid(script))
 		return false;
 
+	obs_script_reset_callback_stats(script);
+
 #if defined(LUAJIT_FOUND)
 	if (script->type == OBS_SCRIPT_LANG_LUA) {
 		obs_lua_script_unload(script);
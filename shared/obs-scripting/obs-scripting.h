@@ -32,6 +32,25 @@ typedef struct obs_script obs_script_t;
 
 enum obs_script_lang { OBS_SCRIPT_LANG_UNKNOWN, OBS_SCRIPT_LANG_LUA, OBS_SCRIPT_LANG_PYTHON };
 
+enum obs_script_callback_type {
+	OBS_SCRIPT_CALLBACK_TICK,
+	OBS_SCRIPT_CALLBACK_TIMER,
+	OBS_SCRIPT_CALLBACK_RENDER,
+	OBS_SCRIPT_CALLBACK_SIGNAL,
+	OBS_SCRIPT_CALLBACK_HOTKEY,
+	OBS_SCRIPT_CALLBACK_PROPERTY,
+	OBS_SCRIPT_CALLBACK_FRONTEND,
+	OBS_SCRIPT_CALLBACK_SOURCE,
+	OBS_SCRIPT_CALLBACK_COUNT,
+};
+
+struct obs_script_callback_stats {
+	uint64_t calls;
+	uint64_t total_ns;
+	uint64_t p99_ns;
+	uint64_t max_ns;
+};
+
 EXPORT void obs_scripting_set_module(obs_module_t *module);
 EXPORT bool obs_scripting_load(void);
 EXPORT void obs_scripting_unload(void);
@@ -62,6 +81,18 @@ EXPORT void obs_script_update(obs_script_t *script, obs_data_t *settings);
 EXPORT bool obs_script_loaded(const obs_script_t *script);
 EXPORT bool obs_script_reload(obs_script_t *script);
 
+/* Time spent in a script's callbacks, per kind of callback.  A script is
+ * flagged as over budget once more than 1% of the calls of any kind take
+ * longer than the callback budget (0 disables the budget). */
+EXPORT const char *obs_script_callback_type_name(enum obs_script_callback_type type);
+EXPORT bool obs_script_get_callback_stats(const obs_script_t *script, enum obs_script_callback_type type,
+					  struct obs_script_callback_stats *stats);
+EXPORT void obs_script_reset_callback_stats(obs_script_t *script);
+EXPORT bool obs_script_over_budget(const obs_script_t *script);
+
+EXPORT void obs_scripting_set_callback_budget(uint64_t budget_ns);
+EXPORT uint64_t obs_scripting_get_callback_budget(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,161 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <media-io/audio-headroom.h>
+#include <media-io/audio-io.h>
+
+#define SAMPLE_RATE 48000
+#define TICKS_PER_SEC (SAMPLE_RATE / AUDIO_OUTPUT_FRAMES)
+#define WINDOW_TICKS (TICKS_PER_SEC * 5)
+
+struct test_source {
+	size_t lead_ticks; /* buffered ticks past the rendered block */
+	bool starving;     /* active, but nothing buffered */
+	bool late;         /* data only starts after the rendered block */
+};
+
+static uint64_t tick_ns(uint64_t ticks)
+{
+	return audio_frames_to_ns(SAMPLE_RATE, ticks * AUDIO_OUTPUT_FRAMES);
+}
+
+/* renders ticks blocks starting at block *pos, returns how many ticks of
+ * buffering the controller drained */
+static int render(struct audio_headroom *hr, uint64_t *pos, size_t ticks, struct test_source *sources,
+		  size_t num_sources, int *buffering_ticks)
+{
+	int drained = 0;
+
+	for (size_t i = 0; i < ticks; i++, (*pos)++) {
+		uint64_t start = tick_ns(*pos);
+		uint64_t end = tick_ns(*pos + 1);
+
+		for (size_t j = 0; j < num_sources; j++) {
+			struct test_source *src = &sources[j];
+			size_t frames = (src->lead_ticks + 1) * AUDIO_OUTPUT_FRAMES;
+
+			if (src->starving)
+				frames = 0;
+
+			audio_headroom_add_source(hr, SAMPLE_RATE, src->late ? end : start, frames, end);
+		}
+
+		if (audio_headroom_tick(hr, SAMPLE_RATE, *buffering_ticks)) {
+			(*buffering_ticks)--;
+			audio_headroom_drained(hr, SAMPLE_RATE);
+			drained++;
+
+			/* draining eats into the lead of every source */
+			for (size_t j = 0; j < num_sources; j++) {
+				if (sources[j].lead_ticks)
+					sources[j].lead_ticks--;
+			}
+		}
+	}
+
+	return drained;
+}
+
+static void drain_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct audio_headroom hr;
+	struct test_source source = {.lead_ticks = 4};
+	int buffering_ticks = 10;
+	uint64_t pos = 0;
+
+	audio_headroom_reset(&hr);
+
+	/* nothing is drained before the first window is over */
+	assert_int_equal(render(&hr, &pos, WINDOW_TICKS - 1, &source, 1, &buffering_ticks), 0);
+
+	/* then one tick a second, keeping a spare tick */
+	assert_int_equal(render(&hr, &pos, 1, &source, 1, &buffering_ticks), 1);
+	assert_int_equal(render(&hr, &pos, TICKS_PER_SEC - 1, &source, 1, &buffering_ticks), 0);
+	assert_int_equal(render(&hr, &pos, 1, &source, 1, &buffering_ticks), 1);
+	assert_int_equal(render(&hr, &pos, TICKS_PER_SEC, &source, 1, &buffering_ticks), 1);
+
+	assert_int_equal(render(&hr, &pos, WINDOW_TICKS * 3, &source, 1, &buffering_ticks), 0);
+	assert_int_equal(source.lead_ticks, 1);
+	assert_int_equal(buffering_ticks, 7);
+}
+
+static void starving_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct audio_headroom hr;
+	struct test_source sources[] = {
+		{.lead_ticks = 4},
+		{.lead_ticks = 4, .starving = true},
+	};
+	int buffering_ticks = 10;
+	uint64_t pos = 0;
+
+	audio_headroom_reset(&hr);
+
+	/* an active source without data holds the buffering it needs */
+	assert_int_equal(render(&hr, &pos, WINDOW_TICKS * 3, sources, 2, &buffering_ticks), 0);
+	assert_int_equal(buffering_ticks, 10);
+
+	/* and once it is fed again, buffering drains as usual */
+	sources[1].starving = false;
+	assert_int_equal(render(&hr, &pos, WINDOW_TICKS * 3, sources, 2, &buffering_ticks), 3);
+	assert_int_equal(buffering_ticks, 7);
+}
+
+static void late_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct audio_headroom hr;
+	struct test_source sources[] = {
+		{.lead_ticks = 4},
+		{.lead_ticks = 4, .late = true},
+	};
+	int buffering_ticks = 10;
+	uint64_t pos = 0;
+
+	audio_headroom_reset(&hr);
+
+	assert_int_equal(render(&hr, &pos, WINDOW_TICKS * 3, sources, 2, &buffering_ticks), 0);
+	assert_int_equal(buffering_ticks, 10);
+}
+
+static void bounds_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct audio_headroom hr;
+	struct test_source source = {.lead_ticks = 8};
+	int buffering_ticks = 2;
+	uint64_t pos = 0;
+
+	audio_headroom_reset(&hr);
+
+	/* never drain more buffering than was added */
+	assert_int_equal(render(&hr, &pos, WINDOW_TICKS * 3, &source, 1, &buffering_ticks), 2);
+	assert_int_equal(buffering_ticks, 0);
+
+	/* a pending drain is cancelled when buffering is added again */
+	source.lead_ticks = 4;
+	buffering_ticks = 10;
+	render(&hr, &pos, WINDOW_TICKS, &source, 1, &buffering_ticks);
+	audio_headroom_reset(&hr);
+	assert_int_equal(render(&hr, &pos, WINDOW_TICKS - 1, &source, 1, &buffering_ticks), 0);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(drain_test),
+		cmocka_unit_test(starving_test),
+		cmocka_unit_test(late_test),
+		cmocka_unit_test(bounds_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,228 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <util/bmem.h>
+#include <util/platform.h>
+#include <media-io/format-conversion.h>
+#include <media-io/video-slice-pool.h>
+
+/* not a multiple of 8, so the AVX2 kernels also run their SSE2 tail */
+#define WIDTH 1924
+#define HEIGHT 1080
+
+#define BENCH_FRAMES 20
+
+static uint8_t *alloc_random(size_t size)
+{
+	uint8_t *data = bmalloc(size);
+	uint32_t seed = 0x12345678;
+
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (uint8_t)(seed >> 16);
+	}
+
+	return data;
+}
+
+static void print_throughput(const char *name, uint64_t start, size_t bytes_per_frame)
+{
+	double sec = (double)(os_gettime_ns() - start) / 1000000000.0;
+	double mb = (double)bytes_per_frame * BENCH_FRAMES / (1024.0 * 1024.0);
+
+	print_message("%-24s %8.1f MB/s\n", name, mb / sec);
+}
+
+/* scalar references for packed UYVX */
+
+static inline uint8_t uyvx_u(const uint8_t *px)
+{
+	return px[0];
+}
+
+static inline uint8_t uyvx_y(const uint8_t *px)
+{
+	return px[1];
+}
+
+static inline uint8_t uyvx_v(const uint8_t *px)
+{
+	return px[2];
+}
+
+static void ref_uyvx_to_420(const uint8_t *input, uint32_t in_linesize, uint8_t *lum, uint8_t *u, uint8_t *v,
+			    uint8_t *uv)
+{
+	for (uint32_t y = 0; y < HEIGHT; y++) {
+		for (uint32_t x = 0; x < WIDTH; x++)
+			lum[y * WIDTH + x] = uyvx_y(input + y * in_linesize + x * 4);
+	}
+
+	for (uint32_t y = 0; y < HEIGHT / 2; y++) {
+		for (uint32_t x = 0; x < WIDTH / 2; x++) {
+			const uint8_t *p0 = input + y * 2 * in_linesize + x * 8;
+			const uint8_t *p1 = p0 + in_linesize;
+			uint8_t u_avg = (uyvx_u(p0) + uyvx_u(p0 + 4) + uyvx_u(p1) + uyvx_u(p1 + 4)) >> 2;
+			uint8_t v_avg = (uyvx_v(p0) + uyvx_v(p0 + 4) + uyvx_v(p1) + uyvx_v(p1 + 4)) >> 2;
+
+			u[y * (WIDTH / 2) + x] = u_avg;
+			v[y * (WIDTH / 2) + x] = v_avg;
+			uv[y * WIDTH + x * 2] = u_avg;
+			uv[y * WIDTH + x * 2 + 1] = v_avg;
+		}
+	}
+}
+
+static void run_uyvx_test(const char *kernel)
+{
+	char name[64];
+	const uint32_t in_linesize = WIDTH * 4;
+	const size_t lum_size = WIDTH * HEIGHT;
+	uint8_t *input = alloc_random((size_t)in_linesize * HEIGHT);
+
+	uint8_t *ref_lum = bmalloc(lum_size);
+	uint8_t *ref_u = bmalloc(lum_size / 4);
+	uint8_t *ref_v = bmalloc(lum_size / 4);
+	uint8_t *ref_uv = bmalloc(lum_size / 2);
+	ref_uyvx_to_420(input, in_linesize, ref_lum, ref_u, ref_v, ref_uv);
+
+	uint8_t *planes[3] = {bzalloc(lum_size), bzalloc(lum_size), bzalloc(lum_size)};
+	uint32_t i420_linesize[3] = {WIDTH, WIDTH / 2, WIDTH / 2};
+	uint32_t nv12_linesize[2] = {WIDTH, WIDTH};
+	uint32_t i444_linesize[3] = {WIDTH, WIDTH, WIDTH};
+
+	compress_uyvx_to_i420(input, in_linesize, 0, HEIGHT, planes, i420_linesize);
+	assert_memory_equal(planes[0], ref_lum, lum_size);
+	assert_memory_equal(planes[1], ref_u, lum_size / 4);
+	assert_memory_equal(planes[2], ref_v, lum_size / 4);
+
+	compress_uyvx_to_nv12(input, in_linesize, 0, HEIGHT, planes, nv12_linesize);
+	assert_memory_equal(planes[0], ref_lum, lum_size);
+	assert_memory_equal(planes[1], ref_uv, lum_size / 2);
+
+	convert_uyvx_to_i444(input, in_linesize, 0, HEIGHT, planes, i444_linesize);
+	for (uint32_t y = 0; y < HEIGHT; y++) {
+		for (uint32_t x = 0; x < WIDTH; x++) {
+			const uint8_t *px = input + y * in_linesize + x * 4;
+			assert_int_equal(planes[0][y * WIDTH + x], uyvx_y(px));
+			assert_int_equal(planes[1][y * WIDTH + x], uyvx_u(px));
+			assert_int_equal(planes[2][y * WIDTH + x], uyvx_v(px));
+		}
+	}
+
+	uint64_t start = os_gettime_ns();
+	for (int i = 0; i < BENCH_FRAMES; i++)
+		compress_uyvx_to_i420(input, in_linesize, 0, HEIGHT, planes, i420_linesize);
+	snprintf(name, sizeof(name), "uyvx -> i420 (%s)", kernel);
+	print_throughput(name, start, (size_t)in_linesize * HEIGHT);
+
+	start = os_gettime_ns();
+	for (int i = 0; i < BENCH_FRAMES; i++)
+		compress_uyvx_to_nv12(input, in_linesize, 0, HEIGHT, planes, nv12_linesize);
+	snprintf(name, sizeof(name), "uyvx -> nv12 (%s)", kernel);
+	print_throughput(name, start, (size_t)in_linesize * HEIGHT);
+
+	start = os_gettime_ns();
+	for (int i = 0; i < BENCH_FRAMES; i++)
+		convert_uyvx_to_i444(input, in_linesize, 0, HEIGHT, planes, i444_linesize);
+	snprintf(name, sizeof(name), "uyvx -> i444 (%s)", kernel);
+	print_throughput(name, start, (size_t)in_linesize * HEIGHT);
+
+	for (size_t i = 0; i < 3; i++)
+		bfree(planes[i]);
+	bfree(ref_lum);
+	bfree(ref_u);
+	bfree(ref_v);
+	bfree(ref_uv);
+	bfree(input);
+}
+
+/* The test is built a second time with FORMAT_CONVERSION_SSE2_ONLY, which
+ * makes the SSE2 kernels run in full on CPUs that have AVX2 too */
+#ifdef FORMAT_CONVERSION_SSE2_ONLY
+#define KERNEL "sse2"
+#else
+#define KERNEL "default"
+#endif
+
+static void uyvx_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	run_uyvx_test(KERNEL);
+}
+
+struct nv12_job {
+	const uint8_t *input;
+	uint8_t **planes;
+	const uint32_t *linesize;
+	uint8_t coverage[HEIGHT];
+};
+
+static void nv12_slice(void *param, uint32_t start_y, uint32_t end_y)
+{
+	struct nv12_job *job = param;
+
+	assert_int_equal(start_y % 2, 0);
+	compress_uyvx_to_nv12(job->input, WIDTH * 4, start_y, end_y, job->planes, job->linesize);
+	for (uint32_t y = start_y; y < end_y; y++)
+		job->coverage[y]++;
+}
+
+static void slice_pool_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	const size_t lum_size = WIDTH * HEIGHT;
+	uint8_t *input = alloc_random((size_t)WIDTH * 4 * HEIGHT);
+	uint8_t *ref[2] = {bmalloc(lum_size), bmalloc(lum_size / 2)};
+	uint8_t *planes[2] = {bzalloc(lum_size), bzalloc(lum_size / 2)};
+	uint32_t linesize[2] = {WIDTH, WIDTH};
+
+	compress_uyvx_to_nv12(input, WIDTH * 4, 0, HEIGHT, ref, linesize);
+
+	const uint32_t thread_counts[] = {1, 2, 4, 0};
+
+	for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+		video_slice_pool_t *pool = video_slice_pool_create(thread_counts[i]);
+		struct nv12_job job = {input, planes, linesize, {0}};
+		char name[64];
+
+		memset(planes[0], 0, lum_size);
+		memset(planes[1], 0, lum_size / 2);
+
+		video_slice_pool_run(pool, nv12_slice, &job, HEIGHT, 2);
+		for (uint32_t y = 0; y < HEIGHT; y++)
+			assert_int_equal(job.coverage[y], 1);
+		assert_memory_equal(planes[0], ref[0], lum_size);
+		assert_memory_equal(planes[1], ref[1], lum_size / 2);
+
+		uint64_t start = os_gettime_ns();
+		for (int j = 0; j < BENCH_FRAMES; j++)
+			video_slice_pool_run(pool, nv12_slice, &job, HEIGHT, 2);
+		snprintf(name, sizeof(name), "uyvx -> nv12, %u threads", video_slice_pool_threads(pool));
+		print_throughput(name, start, (size_t)WIDTH * 4 * HEIGHT);
+
+		video_slice_pool_destroy(pool);
+	}
+
+	bfree(ref[0]);
+	bfree(ref[1]);
+	bfree(planes[0]);
+	bfree(planes[1]);
+	bfree(input);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(uyvx_test),
+		cmocka_unit_test(slice_pool_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,176 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <obs-data.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+
+static void json_round_trip_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	const char *json = "{\"name\":\"test \xc3\xa9\\n\\\"\",\"int\":-42,\"real\":0.5,\"bool\":true,"
+			   "\"null\":null,\"obj\":{\"nested\":{}},\"array\":[{\"a\":1},{\"b\":[]}]}";
+
+	obs_data_t *data = obs_data_create_from_json(json);
+	assert_non_null(data);
+
+	assert_string_equal(obs_data_get_string(data, "name"), "test \xc3\xa9\n\"");
+	assert_int_equal(obs_data_get_int(data, "int"), -42);
+	assert_true(obs_data_get_double(data, "real") == 0.5);
+	assert_true(obs_data_get_bool(data, "bool"));
+
+	assert_string_equal(obs_data_get_json(data), json);
+
+	obs_data_release(data);
+}
+
+static void json_pretty_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *data = obs_data_create_from_json("{\"a\":{\"b\":1},\"c\":[{}],\"d\":[],\"e\":2.0}");
+	assert_non_null(data);
+
+	assert_string_equal(obs_data_get_json_pretty(data), "{\n"
+							    "    \"a\": {\n"
+							    "        \"b\": 1\n"
+							    "    },\n"
+							    "    \"c\": [\n"
+							    "        {}\n"
+							    "    ],\n"
+							    "    \"d\": [],\n"
+							    "    \"e\": 2.0\n"
+							    "}");
+
+	obs_data_release(data);
+}
+
+static void json_invalid_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	const char *invalid[] = {
+		"",
+		"1",
+		"{\"a\":1,\"a\":2}",
+		"{\"a\":1,}",
+		"{\"a\":01}",
+		"{\"a\":\"\\u0000\"}",
+		"{\"a\":\"\\ud800\"}",
+		"{\"a\":\"\xff\"}",
+		"{\"a\":99999999999999999999}",
+		"{\"a\":1} 1",
+	};
+
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+		assert_null(obs_data_create_from_json(invalid[i]));
+}
+
+static void json_subtree_lifetime_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *data = obs_data_create_from_json("{\"settings\":{\"file\":\"a.png\"},\"items\":[{\"id\":1}]}");
+	assert_non_null(data);
+
+	obs_data_t *settings = obs_data_get_obj(data, "settings");
+	obs_data_array_t *items = obs_data_get_array(data, "items");
+	obs_data_release(data);
+
+	/* growing an item that was loaded from JSON moves it off the arena */
+	obs_data_set_string(settings, "file", "a considerably longer file name than the one that was loaded.png");
+	assert_string_equal(obs_data_get_string(settings, "file"),
+			    "a considerably longer file name than the one that was loaded.png");
+
+	obs_data_t *item = obs_data_array_item(items, 0);
+	assert_int_equal(obs_data_get_int(item, "id"), 1);
+
+	obs_data_release(item);
+	obs_data_array_release(items);
+	obs_data_release(settings);
+}
+
+#define BENCHMARK_SOURCES 5000
+
+static void json_large_collection_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *collection = obs_data_create();
+	obs_data_array_t *sources = obs_data_array_create();
+
+	for (int i = 0; i < BENCHMARK_SOURCES; i++) {
+		obs_data_t *source = obs_data_create();
+		obs_data_t *settings = obs_data_create();
+		obs_data_array_t *filters = obs_data_array_create();
+		struct dstr name = {0};
+
+		dstr_printf(&name, "Source %d", i);
+		obs_data_set_string(source, "name", name.array);
+		obs_data_set_string(source, "id", "image_source");
+		obs_data_set_int(source, "mixers", 255);
+		obs_data_set_double(source, "volume", 1.0);
+		obs_data_set_bool(source, "enabled", true);
+
+		obs_data_set_string(settings, "file", "/home/user/Pictures/some/long/path/to/an/image.png");
+		obs_data_set_int(settings, "width", 1920);
+		obs_data_set_int(settings, "height", 1080);
+		obs_data_set_obj(source, "settings", settings);
+
+		for (int j = 0; j < 3; j++) {
+			obs_data_t *filter = obs_data_create();
+			obs_data_set_string(filter, "id", "color_filter");
+			obs_data_set_double(filter, "opacity", 0.25 * j);
+			obs_data_array_push_back(filters, filter);
+			obs_data_release(filter);
+		}
+
+		obs_data_set_array(source, "filters", filters);
+		obs_data_array_push_back(sources, source);
+
+		dstr_free(&name);
+		obs_data_array_release(filters);
+		obs_data_release(settings);
+		obs_data_release(source);
+	}
+
+	obs_data_set_array(collection, "sources", sources);
+	obs_data_array_release(sources);
+
+	char *json = bstrdup(obs_data_get_json_pretty(collection));
+	size_t json_size = strlen(json);
+	obs_data_release(collection);
+
+	uint64_t load_start = os_gettime_ns();
+	obs_data_t *loaded = obs_data_create_from_json(json);
+	uint64_t load_end = os_gettime_ns();
+	assert_non_null(loaded);
+
+	uint64_t save_start = os_gettime_ns();
+	const char *saved = obs_data_get_json_pretty(loaded);
+	uint64_t save_end = os_gettime_ns();
+
+	assert_string_equal(saved, json);
+
+	print_message("%zu byte collection: load %.2f ms, save %.2f ms\n", json_size,
+		      (double)(load_end - load_start) / 1000000.0, (double)(save_end - save_start) / 1000000.0);
+
+	obs_data_release(loaded);
+	bfree(json);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(json_round_trip_test),
+		cmocka_unit_test(json_pretty_test),
+		cmocka_unit_test(json_invalid_test),
+		cmocka_unit_test(json_subtree_lifetime_test),
+		cmocka_unit_test(json_large_collection_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
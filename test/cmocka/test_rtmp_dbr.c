@@ -0,0 +1,233 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "rtmp-dbr.h"
+
+#define MSEC_TO_NSEC 1000000ULL
+#define SEC_TO_NSEC 1000000000ULL
+#define FPS 30
+
+#define VIDEO_BITRATE 2500
+#define AUDIO_BITRATE 160
+
+/* one second and a bit of frames that take 1 ms each to send, so the
+ * threshold controller estimates the throughput from their total size */
+static uint64_t send_frames(struct dbr_controller *dbr, uint64_t ts, long total_kbps)
+{
+	size_t size = (size_t)total_kbps * 125 / FPS;
+
+	for (int i = 0; i < FPS * 3 / 2; i++) {
+		struct dbr_frame frame = {
+			.send_beg = ts,
+			.send_end = ts + MSEC_TO_NSEC,
+			.size = size,
+		};
+
+		dbr->info->frame_sent(dbr->data, &frame);
+		ts += SEC_TO_NSEC / FPS;
+	}
+
+	return ts;
+}
+
+static void socket_stats(struct dbr_controller *dbr, uint64_t ts, uint64_t queued_bytes, uint32_t rtt_usec)
+{
+	struct dbr_socket_stats stats = {
+		.has_queued_bytes = true,
+		.has_rtt = true,
+		.queued_bytes = queued_bytes,
+		.rtt_usec = rtt_usec,
+	};
+
+	dbr->info->socket_stats(dbr->data, ts, &stats);
+}
+
+static void init_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct dbr_controller dbr;
+
+	assert_true(dbr_controller_init(&dbr, NULL, VIDEO_BITRATE, AUDIO_BITRATE));
+	assert_string_equal(dbr.info->id, DBR_ALGORITHM_THRESHOLD);
+	dbr_controller_free(&dbr);
+
+	assert_true(dbr_controller_init(&dbr, DBR_ALGORITHM_DELAY, VIDEO_BITRATE, AUDIO_BITRATE));
+	assert_string_equal(dbr.info->id, DBR_ALGORITHM_DELAY);
+	dbr_controller_free(&dbr);
+
+	assert_false(dbr_controller_init(&dbr, "unknown", VIDEO_BITRATE, AUDIO_BITRATE));
+	assert_null(dbr.info);
+}
+
+static void threshold_congestion_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct dbr_controller dbr;
+	long bitrate = VIDEO_BITRATE;
+
+	assert_true(dbr_controller_init(&dbr, DBR_ALGORITHM_THRESHOLD, VIDEO_BITRATE, AUDIO_BITRATE));
+
+	/* the link only carries 1000 kbps of audio and video */
+	uint64_t ts = send_frames(&dbr, SEC_TO_NSEC, 1000);
+
+	/* a buffer below the trigger keeps the bitrate */
+	bitrate = dbr_controller_update(&dbr, ts, 100000, bitrate);
+	assert_int_equal(bitrate, VIDEO_BITRATE);
+
+	/* above it, fall back to the estimate minus audio, in 100 kbps steps */
+	bitrate = dbr_controller_update(&dbr, ts, 300000, bitrate);
+	assert_int_equal(bitrate, 800);
+
+	/* increase by a tenth of the original bitrate every four seconds,
+	 * but never past the original bitrate */
+	bitrate = dbr_controller_update(&dbr, ts + 3 * SEC_TO_NSEC, 0, bitrate);
+	assert_int_equal(bitrate, 800);
+
+	for (long expected = 1050; expected < VIDEO_BITRATE; expected += VIDEO_BITRATE / 10) {
+		ts += 4 * SEC_TO_NSEC;
+		bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+		assert_int_equal(bitrate, expected);
+	}
+
+	ts += 4 * SEC_TO_NSEC;
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, VIDEO_BITRATE);
+
+	ts += 4 * SEC_TO_NSEC;
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, VIDEO_BITRATE);
+
+	dbr_controller_free(&dbr);
+}
+
+static void threshold_bounds_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct dbr_controller dbr;
+	long bitrate = VIDEO_BITRATE;
+
+	assert_true(dbr_controller_init(&dbr, DBR_ALGORITHM_THRESHOLD, VIDEO_BITRATE, AUDIO_BITRATE));
+
+	/* less throughput than the audio alone still leaves the minimum */
+	uint64_t ts = send_frames(&dbr, SEC_TO_NSEC, 100);
+	bitrate = dbr_controller_update(&dbr, ts, 1000000, bitrate);
+	assert_int_equal(bitrate, 50);
+
+	dbr_controller_free(&dbr);
+}
+
+static void delay_congestion_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct dbr_controller dbr;
+	long bitrate = VIDEO_BITRATE;
+	uint64_t ts = SEC_TO_NSEC;
+
+	assert_true(dbr_controller_init(&dbr, DBR_ALGORITHM_DELAY, VIDEO_BITRATE, AUDIO_BITRATE));
+
+	socket_stats(&dbr, ts, 0, 20000);
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, VIDEO_BITRATE);
+
+	/* the round trip time grows 200 ms above its minimum */
+	ts += 100 * MSEC_TO_NSEC;
+	socket_stats(&dbr, ts, 0, 220000);
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, 2100);
+
+	/* no second cut during the cooldown */
+	ts += 100 * MSEC_TO_NSEC;
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, 2100);
+
+	/* nor once the cooldown is over while the delay is shrinking */
+	ts += 500 * MSEC_TO_NSEC;
+	socket_stats(&dbr, ts, 0, 180000);
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, 2100);
+
+	/* the output's own buffer counts as delay as well */
+	ts += 100 * MSEC_TO_NSEC;
+	socket_stats(&dbr, ts, 0, 20000);
+	bitrate = dbr_controller_update(&dbr, ts, 300000, bitrate);
+	assert_int_equal(bitrate, 1700);
+
+	/* recovery waits for the delay to stay low, then adds a twentieth
+	 * of the original bitrate at most every second */
+	ts += 100 * MSEC_TO_NSEC;
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, 1700);
+
+	ts += 1900 * MSEC_TO_NSEC;
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, 1700);
+
+	ts += 100 * MSEC_TO_NSEC;
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, 1825);
+
+	ts += 500 * MSEC_TO_NSEC;
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, 1825);
+
+	for (int i = 0; i < 20; i++) {
+		ts += SEC_TO_NSEC;
+		bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	}
+	assert_int_equal(bitrate, VIDEO_BITRATE);
+
+	dbr_controller_free(&dbr);
+}
+
+static void delay_bounds_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct dbr_controller dbr;
+	long bitrate = VIDEO_BITRATE;
+	uint64_t ts = SEC_TO_NSEC;
+
+	assert_true(dbr_controller_init(&dbr, DBR_ALGORITHM_DELAY, VIDEO_BITRATE, 0));
+
+	/* 1000 kbps delivered with 50 KB queued takes 400 ms to drain */
+	socket_stats(&dbr, ts, 0, 0);
+	for (int i = 0; i < 3; i++) {
+		struct dbr_frame frame = {.send_beg = ts, .send_end = ts, .size = 12500};
+		dbr.info->frame_sent(dbr.data, &frame);
+		ts += 100 * MSEC_TO_NSEC;
+		socket_stats(&dbr, ts, i == 2 ? 50000 : 0, 0);
+	}
+
+	/* the bottleneck rate would be a larger cut than allowed per step */
+	bitrate = dbr_controller_update(&dbr, ts, 0, bitrate);
+	assert_int_equal(bitrate, 1700);
+
+	/* persistent congestion never goes below a tenth of the original */
+	for (int i = 0; i < 20; i++) {
+		ts += SEC_TO_NSEC;
+		bitrate = dbr_controller_update(&dbr, ts, 1000000 + i * 100000, bitrate);
+		assert_true(bitrate >= VIDEO_BITRATE / 10);
+	}
+	assert_int_equal(bitrate, VIDEO_BITRATE / 10);
+
+	dbr_controller_free(&dbr);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(init_test),
+		cmocka_unit_test(threshold_congestion_test),
+		cmocka_unit_test(threshold_bounds_test),
+		cmocka_unit_test(delay_congestion_test),
+		cmocka_unit_test(delay_bounds_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
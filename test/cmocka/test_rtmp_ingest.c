@@ -0,0 +1,233 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <util/bmem.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+
+#include <librtmp/rtmp.h>
+
+#include "rtmp-ingest.h"
+
+#define FPS 30
+#define KEYINT FPS
+
+/* Small send buffer so that a stalled ingest blocks the sender quickly, the
+ * same way a congested link backs up the rtmp-stream send thread. */
+#define SEND_BUFFER_SIZE (8 * 1024)
+
+struct publisher {
+	RTMP rtmp;
+	struct dstr url;
+
+	/* frames in [skip_begin, skip_end) are left out like a sender would
+	 * drop them, so the ingest sees a gap in the timestamps */
+	size_t skip_begin;
+	size_t skip_end;
+	size_t sent_frames;
+};
+
+static void publisher_connect(struct publisher *pub, rtmp_ingest_t *ingest)
+{
+	int buf_size = SEND_BUFFER_SIZE;
+
+	memset(pub, 0, sizeof(*pub));
+	dstr_printf(&pub->url, "rtmp://127.0.0.1:%d/live", (int)rtmp_ingest_get_port(ingest));
+
+	RTMP_Init(&pub->rtmp);
+	assert_true(RTMP_SetupURL(&pub->rtmp, pub->url.array));
+	RTMP_EnableWrite(&pub->rtmp);
+	RTMP_AddStream(&pub->rtmp, "test");
+
+	pub->rtmp.m_outChunkSize = 4096;
+	pub->rtmp.m_bSendChunkSizeInfo = true;
+
+	assert_true(RTMP_Connect(&pub->rtmp, NULL));
+	assert_true(RTMP_ConnectStream(&pub->rtmp, 0));
+	assert_true(rtmp_ingest_wait_publish(ingest, 1000));
+
+	setsockopt(RTMP_Socket(&pub->rtmp), SOL_SOCKET, SO_SNDBUF, (const char *)&buf_size, sizeof(buf_size));
+}
+
+static void publisher_close(struct publisher *pub, rtmp_ingest_t *ingest)
+{
+	RTMP_Close(&pub->rtmp);
+	dstr_free(&pub->url);
+
+	/* RTMP_Close keeps the playpaths of publishing streams unless
+	 * RTMP_PUB_CLEAN is set, so free the one RTMP_AddStream parsed */
+	for (int i = 0; i < pub->rtmp.Link.nStreams; i++) {
+		free(pub->rtmp.Link.streams[i].playpath.av_val);
+		pub->rtmp.Link.streams[i].playpath.av_val = NULL;
+	}
+	pub->rtmp.Link.nStreams = 0;
+	pub->rtmp.Link.curStreamIdx = 0;
+
+	assert_true(rtmp_ingest_wait_disconnect(ingest, 5000));
+}
+
+/* Sends video frames of the given bitrate.  Paced publishing sends them in
+ * real time so that the phases of the ingest profile apply, otherwise they are
+ * sent as fast as the socket takes them. */
+static void publish(struct publisher *pub, size_t frames, uint32_t kbps, bool paced)
+{
+	size_t frame_size = (size_t)kbps * 125 / FPS;
+	uint8_t *frame = bzalloc(frame_size);
+	uint64_t start = os_gettime_ns();
+
+	for (size_t i = 0; i < frames; i++) {
+		bool keyframe = i % KEYINT == 0;
+
+		if (i >= pub->skip_begin && i < pub->skip_end)
+			continue;
+		if (paced)
+			os_sleepto_ns(start + (uint64_t)i * 1000000000 / FPS);
+
+		RTMPBuf body = {(const char *)frame, (int)frame_size};
+		frame[0] = keyframe ? 0x17 : 0x27;
+		frame[1] = 1;
+
+		assert_true(RTMP_WriteMessage(&pub->rtmp, RTMP_PACKET_TYPE_VIDEO, (uint32_t)(i * 1000 / FPS), &body,
+					      1, 0));
+		pub->sent_frames++;
+	}
+
+	bfree(frame);
+}
+
+/* Delivery times depend on the load of the machine, so the tests below only
+ * check what the ingest records and print the shaped measurements. */
+
+static void publish_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct rtmp_ingest_report report;
+	struct rtmp_ingest_sample *samples;
+	struct publisher pub;
+
+	rtmp_ingest_t *ingest = rtmp_ingest_create(0);
+	assert_non_null(ingest);
+
+	publisher_connect(&pub, ingest);
+	publish(&pub, FPS, 1000, false);
+	publisher_close(&pub, ingest);
+
+	size_t count = rtmp_ingest_get_samples(ingest, &samples);
+	assert_int_equal(count, FPS);
+
+	for (size_t i = 0; i < count; i++) {
+		assert_int_equal(samples[i].type, RTMP_PACKET_TYPE_VIDEO);
+		assert_int_equal(samples[i].timestamp, i * 1000 / FPS);
+		assert_int_equal(samples[i].size, 1000 * 125 / FPS);
+		assert_true(samples[i].keyframe == (i % KEYINT == 0));
+		assert_true(samples[i].deliver_ns >= samples[i].recv_ns);
+	}
+
+	rtmp_ingest_get_report(ingest, 1000.0 / FPS, &report);
+	assert_int_equal(report.video_frames, FPS);
+	assert_int_equal(report.dropped_frames, 0);
+
+	bfree(samples);
+	rtmp_ingest_destroy(ingest);
+}
+
+static void dropped_frames_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct rtmp_ingest_report report;
+	struct publisher pub;
+
+	rtmp_ingest_t *ingest = rtmp_ingest_create(0);
+	assert_non_null(ingest);
+
+	/* drop from the middle of the first GOP up to the next keyframe */
+	publisher_connect(&pub, ingest);
+	pub.skip_begin = 10;
+	pub.skip_end = KEYINT;
+	publish(&pub, KEYINT * 2, 1000, false);
+	publisher_close(&pub, ingest);
+
+	rtmp_ingest_get_report(ingest, 1000.0 / FPS, &report);
+	assert_int_equal(report.video_frames, pub.sent_frames);
+	assert_int_equal(report.dropped_frames, KEYINT - 10);
+
+	/* without a nominal interval the smallest one is used */
+	rtmp_ingest_get_report(ingest, 0.0, &report);
+	assert_int_equal(report.dropped_frames, KEYINT - 10);
+
+	rtmp_ingest_destroy(ingest);
+}
+
+static void bandwidth_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct rtmp_ingest_phase profile[] = {
+		{.duration_ms = 0, .bandwidth_kbps = 400, .latency_ms = 50},
+	};
+	struct rtmp_ingest_report report;
+	struct publisher pub;
+
+	rtmp_ingest_t *ingest = rtmp_ingest_create(0);
+	assert_non_null(ingest);
+	rtmp_ingest_set_profile(ingest, profile, 1);
+
+	/* twice the available bandwidth without dropping, so the backlog
+	 * shows up as latency */
+	publisher_connect(&pub, ingest);
+	publish(&pub, FPS, 800, true);
+	publisher_close(&pub, ingest);
+
+	rtmp_ingest_get_report(ingest, 1000.0 / FPS, &report);
+	assert_int_equal(report.video_frames, FPS);
+	assert_int_equal(report.dropped_frames, 0);
+
+	print_message("800 kbps over 400 kbps: %.0f kbps received, latency %.0f ms average, %.0f ms max\n",
+		      report.avg_kbps, report.avg_latency_ms, report.max_latency_ms);
+
+	rtmp_ingest_destroy(ingest);
+}
+
+static void stall_recovery_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct rtmp_ingest_report report;
+	struct publisher pub;
+
+	rtmp_ingest_t *ingest = rtmp_ingest_create(0);
+	assert_non_null(ingest);
+
+	/* one second of normal delivery, one second of nothing, then normal */
+	assert_true(rtmp_ingest_load_profile(ingest, "{\"phases\":[{\"duration_ms\":1000},"
+						     "{\"duration_ms\":1000,\"stall\":true},{\"duration_ms\":0}]}"));
+
+	publisher_connect(&pub, ingest);
+	publish(&pub, FPS * 7 / 2, 2000, true);
+	publisher_close(&pub, ingest);
+
+	rtmp_ingest_get_report(ingest, 1000.0 / FPS, &report);
+	assert_int_equal(report.video_frames, pub.sent_frames);
+	assert_int_equal(report.dropped_frames, 0);
+
+	print_message("1 s stall: max latency %.0f ms, recovered after %.0f ms\n", report.max_latency_ms,
+		      report.recovery_ms);
+
+	rtmp_ingest_destroy(ingest);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(publish_test),
+		cmocka_unit_test(dropped_frames_test),
+		cmocka_unit_test(bandwidth_test),
+		cmocka_unit_test(stall_recovery_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,119 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "rtmp-send-queue.h"
+
+static void push(struct rtmp_send_queue *queue, enum obs_encoder_type type, int64_t dts, int priority, bool keyframe)
+{
+	struct encoder_packet packet = {
+		.type = type,
+		.dts = dts,
+		.dts_usec = dts * 1000,
+		.drop_priority = priority,
+		.priority = priority,
+		.keyframe = keyframe,
+	};
+
+	rtmp_send_queue_push(queue, &packet);
+}
+
+/* key, b, p, audio, b, p, audio, ... like an encoder with one b-frame */
+static void push_gop(struct rtmp_send_queue *queue, int64_t start, int frames)
+{
+	push(queue, OBS_ENCODER_VIDEO, start, OBS_NAL_PRIORITY_HIGHEST, true);
+
+	for (int i = 1; i < frames; i++) {
+		bool bframe = i % 2 == 1;
+		push(queue, OBS_ENCODER_VIDEO, start + i, bframe ? OBS_NAL_PRIORITY_DISPOSABLE : OBS_NAL_PRIORITY_HIGH,
+		     false);
+		push(queue, OBS_ENCODER_AUDIO, start + i, 0, false);
+	}
+}
+
+static void fifo_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct rtmp_send_queue queue = {0};
+	struct encoder_packet packet;
+
+	push_gop(&queue, 0, 5);
+	assert_int_equal(rtmp_send_queue_count(&queue), 9);
+
+	for (int64_t i = 0; i < 9; i++) {
+		assert_true(rtmp_send_queue_pop(&queue, &packet));
+		assert_int_equal(packet.dts, (i + 1) / 2);
+	}
+
+	assert_false(rtmp_send_queue_pop(&queue, &packet));
+	assert_int_equal(rtmp_send_queue_count(&queue), 0);
+
+	rtmp_send_queue_free(&queue);
+}
+
+static void drop_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct rtmp_send_queue queue = {0};
+	struct encoder_packet packet;
+	int64_t dts_usec;
+
+	push_gop(&queue, 0, 5);
+	push_gop(&queue, 5, 5);
+
+	assert_true(rtmp_send_queue_first_delta_dts(&queue, &dts_usec));
+	assert_int_equal(dts_usec, 1000);
+
+	/* b-frames only */
+	assert_int_equal(rtmp_send_queue_drop(&queue, OBS_NAL_PRIORITY_HIGH), 4);
+	assert_int_equal(rtmp_send_queue_count(&queue), 14);
+	assert_int_equal(rtmp_send_queue_drop(&queue, OBS_NAL_PRIORITY_HIGH), 0);
+
+	assert_true(rtmp_send_queue_first_delta_dts(&queue, &dts_usec));
+	assert_int_equal(dts_usec, 2000);
+
+	/* the first p-frame goes out, then the rest are dropped */
+	assert_true(rtmp_send_queue_pop(&queue, &packet));
+	assert_true(packet.keyframe);
+	assert_true(rtmp_send_queue_pop(&queue, &packet));
+	assert_int_equal(packet.type, OBS_ENCODER_AUDIO);
+	assert_true(rtmp_send_queue_pop(&queue, &packet));
+	assert_int_equal(packet.dts, 2);
+
+	assert_int_equal(rtmp_send_queue_drop(&queue, OBS_NAL_PRIORITY_HIGHEST), 3);
+	assert_false(rtmp_send_queue_first_delta_dts(&queue, &dts_usec));
+
+	/* what remains is audio and the second keyframe, in order */
+	int64_t expected[] = {2, 3, 4, 5, 6, 7, 8, 9};
+	for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		assert_true(rtmp_send_queue_pop(&queue, &packet));
+		assert_int_equal(packet.dts, expected[i]);
+		assert_true(packet.type == OBS_ENCODER_AUDIO || packet.keyframe);
+	}
+
+	assert_false(rtmp_send_queue_pop(&queue, &packet));
+
+	/* the queue is reusable after being drained through drops */
+	push_gop(&queue, 10, 3);
+	assert_true(rtmp_send_queue_first_delta_dts(&queue, &dts_usec));
+	assert_int_equal(dts_usec, 11000);
+
+	rtmp_send_queue_clear(&queue);
+	assert_int_equal(rtmp_send_queue_count(&queue), 0);
+	assert_false(rtmp_send_queue_pop(&queue, &packet));
+
+	rtmp_send_queue_free(&queue);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(fifo_test),
+		cmocka_unit_test(drop_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
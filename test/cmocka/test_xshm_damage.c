@@ -0,0 +1,194 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <stdlib.h>
+#include <xcb/xcb.h>
+#include <xcb/xfixes.h>
+
+#include "xshm-damage.h"
+
+/* capture area on the root window, the rest of the screen is outside it */
+#define AREA_X 16
+#define AREA_Y 16
+#define AREA_WIDTH 64
+#define AREA_HEIGHT 64
+
+#define COLOR 0x123456
+
+/* Runs under Xvfb with a 24 bit screen, see CMakeLists.txt.  Without a usable
+ * display the tests that need one are skipped. */
+static xcb_connection_t *x_connect(xcb_screen_t **screen)
+{
+	xcb_connection_t *xcb = xcb_connect(NULL, NULL);
+
+	if (xcb_connection_has_error(xcb)) {
+		xcb_disconnect(xcb);
+		return NULL;
+	}
+
+	*screen = xcb_setup_roots_iterator(xcb_get_setup(xcb)).data;
+
+	if ((*screen)->root_depth != 24 || !xcb_get_extension_data(xcb, &xcb_shm_id)->present ||
+	    !xcb_get_extension_data(xcb, &xcb_xfixes_id)->present) {
+		xcb_disconnect(xcb);
+		return NULL;
+	}
+
+	xcb_xfixes_query_version_cookie_t xfix_c =
+		xcb_xfixes_query_version_unchecked(xcb, XCB_XFIXES_MAJOR_VERSION, XCB_XFIXES_MINOR_VERSION);
+	free(xcb_xfixes_query_version_reply(xcb, xfix_c, NULL));
+	return xcb;
+}
+
+/* draws a rectangle onto the root window and waits until the server has
+ * processed it, so its damage event has arrived */
+static void fill(xcb_connection_t *xcb, xcb_screen_t *screen, int16_t x, int16_t y, uint16_t width,
+		 uint16_t height)
+{
+	xcb_gcontext_t gc = xcb_generate_id(xcb);
+	uint32_t foreground = COLOR;
+	xcb_rectangle_t rect = {x, y, width, height};
+
+	xcb_create_gc(xcb, gc, screen->root, XCB_GC_FOREGROUND, &foreground);
+	xcb_poly_fill_rectangle(xcb, screen->root, gc, 1, &rect);
+	xcb_free_gc(xcb, gc);
+
+	free(xcb_get_input_focus_reply(xcb, xcb_get_input_focus(xcb), NULL));
+}
+
+static void assert_filled(const struct xshm_frame *frame, const struct xshm_region *region, int_fast32_t stride)
+{
+	const uint32_t *pixels = (const uint32_t *)(frame->shm->data + region->offset);
+
+	for (uint16_t y = 0; y < region->height; y++) {
+		for (uint16_t x = 0; x < region->width; x++)
+			assert_int_equal(pixels[y * stride + x] & 0xffffff, COLOR);
+	}
+}
+
+static void add_region_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct xshm_damage damage = {.width = 4, .height = 4};
+	struct xshm_frame frame = {0};
+
+	/* regions are packed one after another until the area is used up */
+	assert_true(xshm_damage_add_region(&damage, &frame, (struct xshm_region){.width = 2, .height = 2}));
+	assert_true(xshm_damage_add_region(&damage, &frame, (struct xshm_region){.x = 2, .width = 2, .height = 2}));
+	assert_true(xshm_damage_add_region(&damage, &frame, (struct xshm_region){.y = 2, .width = 4, .height = 2}));
+	assert_false(xshm_damage_add_region(&damage, &frame, (struct xshm_region){.width = 1, .height = 1}));
+
+	assert_int_equal(frame.regions.num, 3);
+	assert_int_equal(frame.regions.array[0].offset, 0);
+	assert_int_equal(frame.regions.array[1].offset, 16);
+	assert_int_equal(frame.regions.array[2].offset, 32);
+
+	da_free(frame.regions);
+}
+
+static void damaged_regions_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct xshm_damage damage;
+	struct xshm_frame frame = {0};
+	xcb_screen_t *screen;
+
+	xcb_connection_t *xcb = x_connect(&screen);
+	if (!xcb)
+		skip();
+
+	assert_true(xshm_damage_init(&damage, xcb, screen->root, AREA_X, AREA_Y, AREA_WIDTH, AREA_HEIGHT));
+
+	frame.shm = xshm_xcb_attach(xcb, AREA_WIDTH, AREA_HEIGHT);
+	assert_non_null(frame.shm);
+
+	/* nothing was drawn yet */
+	assert_true(xshm_damage_fetch(&damage, &frame));
+	assert_int_equal(frame.regions.num, 0);
+
+	/* only the damaged rectangle is fetched, relative to the area */
+	fill(xcb, screen, AREA_X + 16, AREA_Y + 24, 8, 6);
+	assert_true(xshm_damage_fetch(&damage, &frame));
+	assert_int_equal(frame.regions.num, 1);
+	assert_int_equal(frame.regions.array[0].x, 16);
+	assert_int_equal(frame.regions.array[0].y, 24);
+	assert_int_equal(frame.regions.array[0].width, 8);
+	assert_int_equal(frame.regions.array[0].height, 6);
+
+	assert_true(xshm_damage_fetch_regions(&damage, &frame));
+	assert_filled(&frame, &frame.regions.array[0], 8);
+
+	/* damage is subtracted once it was fetched */
+	da_resize(frame.regions, 0);
+	frame.used = 0;
+	assert_true(xshm_damage_fetch(&damage, &frame));
+	assert_int_equal(frame.regions.num, 0);
+
+	/* damage outside of the area is ignored, partial overlaps clipped */
+	fill(xcb, screen, 0, 0, AREA_X, AREA_Y);
+	assert_true(xshm_damage_fetch(&damage, &frame));
+	assert_int_equal(frame.regions.num, 0);
+
+	fill(xcb, screen, AREA_X + AREA_WIDTH - 4, AREA_Y - 4, 8, 8);
+	assert_true(xshm_damage_fetch(&damage, &frame));
+	assert_int_equal(frame.regions.num, 1);
+	assert_int_equal(frame.regions.array[0].x, AREA_WIDTH - 4);
+	assert_int_equal(frame.regions.array[0].y, 0);
+	assert_int_equal(frame.regions.array[0].width, 4);
+	assert_int_equal(frame.regions.array[0].height, 4);
+
+	da_free(frame.regions);
+	xshm_xcb_detach(frame.shm);
+	xshm_damage_free(&damage);
+	xcb_disconnect(xcb);
+}
+
+static void full_frame_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct xshm_damage damage;
+	struct xshm_frame frame = {0};
+	xcb_screen_t *screen;
+
+	xcb_connection_t *xcb = x_connect(&screen);
+	if (!xcb)
+		skip();
+
+	assert_true(xshm_damage_init(&damage, xcb, screen->root, AREA_X, AREA_Y, AREA_WIDTH, AREA_HEIGHT));
+
+	frame.shm = xshm_xcb_attach(xcb, AREA_WIDTH, AREA_HEIGHT);
+	assert_non_null(frame.shm);
+
+	fill(xcb, screen, AREA_X, AREA_Y, AREA_WIDTH, AREA_HEIGHT);
+
+	struct xshm_region area = {.width = AREA_WIDTH, .height = AREA_HEIGHT};
+	assert_true(xshm_damage_fetch_full(&damage, &frame));
+	assert_true(frame.full);
+	assert_int_equal(frame.regions.num, 0);
+	assert_filled(&frame, &area, AREA_WIDTH);
+
+	/* a full capture covers all damage up to that point */
+	assert_true(xshm_damage_fetch(&damage, &frame));
+	assert_int_equal(frame.regions.num, 0);
+
+	da_free(frame.regions);
+	xshm_xcb_detach(frame.shm);
+	xshm_damage_free(&damage);
+	xcb_disconnect(xcb);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(add_region_test),
+		cmocka_unit_test(damaged_regions_test),
+		cmocka_unit_test(full_frame_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,93 @@
+#include "rtmp-ingest.h"
+
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void usage(const char *name)
+{
+	printf("usage: %s [--port PORT] [--profile FILE] [--frame-interval MS]\n\n"
+	       "Accepts RTMP publishes on 127.0.0.1, shapes them with the phases\n"
+	       "from the JSON profile and prints a report when the publisher\n"
+	       "disconnects.  Profile format:\n\n"
+	       "  {\"phases\": [{\"duration_ms\": 10000},\n"
+	       "              {\"duration_ms\": 5000, \"bandwidth_kbps\": 1500},\n"
+	       "              {\"duration_ms\": 2000, \"stall\": true},\n"
+	       "              {\"duration_ms\": 0, \"latency_ms\": 80}]}\n",
+	       name);
+}
+
+static void print_report(rtmp_ingest_t *ingest, double frame_interval_ms)
+{
+	struct rtmp_ingest_report report;
+	rtmp_ingest_get_report(ingest, frame_interval_ms, &report);
+
+	printf("video frames:   %zu\n"
+	       "audio frames:   %zu\n"
+	       "dropped frames: %zu\n"
+	       "latency:        %.1f ms avg, %.1f ms max\n"
+	       "bitrate:        %.0f kbps\n",
+	       report.video_frames, report.audio_frames, report.dropped_frames, report.avg_latency_ms,
+	       report.max_latency_ms, report.avg_kbps);
+
+	if (report.recovery_ms >= 0.0)
+		printf("recovery:       %.0f ms\n", report.recovery_ms);
+	else
+		printf("recovery:       n/a\n");
+
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *profile = NULL;
+	double frame_interval_ms = 0.0;
+	int port = 1935;
+
+	for (int i = 1; i < argc; i++) {
+		bool has_value = i + 1 < argc;
+
+		if (strcmp(argv[i], "--port") == 0 && has_value) {
+			port = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--profile") == 0 && has_value) {
+			profile = argv[++i];
+		} else if (strcmp(argv[i], "--frame-interval") == 0 && has_value) {
+			frame_interval_ms = atof(argv[++i]);
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	rtmp_ingest_t *ingest = rtmp_ingest_create((uint16_t)port);
+	if (!ingest)
+		return 1;
+
+	if (profile) {
+		char *json = os_quick_read_utf8_file(profile);
+		bool success = json && rtmp_ingest_load_profile(ingest, json);
+		bfree(json);
+
+		if (!success) {
+			fprintf(stderr, "Failed to load profile '%s'\n", profile);
+			rtmp_ingest_destroy(ingest);
+			return 1;
+		}
+	}
+
+	for (;;) {
+		if (!rtmp_ingest_wait_publish(ingest, 1000))
+			continue;
+		while (!rtmp_ingest_wait_disconnect(ingest, 1000))
+			;
+
+		print_report(ingest, frame_interval_ms);
+
+		/* both events stay signaled until the next publisher connects */
+		while (rtmp_ingest_wait_disconnect(ingest, 0))
+			os_sleep_ms(100);
+	}
+}
@@ -0,0 +1,988 @@
+#include "rtmp-ingest.h"
+
+#include <obs-data.h>
+#include <util/array-serializer.h>
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <util/base.h>
+
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define close_socket closesocket
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int socket_t;
+#define INVALID_SOCKET -1
+#define close_socket close
+#endif
+
+/* the publisher may hang up while a reply is in flight */
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+#define do_log(level, format, ...) blog(level, "[rtmp-ingest] " format, ##__VA_ARGS__)
+#define warn(format, ...) do_log(LOG_WARNING, format, ##__VA_ARGS__)
+#define info(format, ...) do_log(LOG_INFO, format, ##__VA_ARGS__)
+
+#define RTMP_SIG_SIZE 1536
+#define DEFAULT_CHUNK_SIZE 128
+#define OUT_CHUNK_SIZE 4096
+#define MAX_MESSAGE_SIZE (16 * 1024 * 1024)
+
+/* Keep the kernel from buffering much more than a shaping step's worth of
+ * data, otherwise stalls and bandwidth limits only reach the sender once
+ * several megabytes have piled up in the socket buffers. */
+#define RECV_BUFFER_SIZE (16 * 1024)
+#define READ_SIZE 4096
+#define POLL_MS 50
+
+#define MSG_SET_CHUNK_SIZE 1
+#define MSG_WINDOW_ACK_SIZE 5
+#define MSG_SET_PEER_BANDWIDTH 6
+#define MSG_AUDIO 8
+#define MSG_VIDEO 9
+#define MSG_DATA_AMF0 18
+#define MSG_COMMAND_AMF0 20
+
+#define AMF_NUMBER 0x00
+#define AMF_STRING 0x02
+#define AMF_OBJECT 0x03
+#define AMF_NULL 0x05
+#define AMF_UNDEFINED 0x06
+
+struct chunk_stream {
+	uint32_t csid;
+	uint32_t timestamp;
+	uint32_t delta;
+	uint32_t length;
+	uint32_t stream_id;
+	uint8_t type;
+	bool extended;
+
+	DARRAY(uint8_t) payload;
+};
+
+enum conn_state {
+	CONN_HANDSHAKE_C0C1,
+	CONN_HANDSHAKE_C2,
+	CONN_CHUNKS,
+};
+
+struct ingest_conn {
+	socket_t fd;
+	enum conn_state state;
+	uint32_t chunk_size;
+
+	DARRAY(uint8_t) in;
+	DARRAY(struct chunk_stream) streams;
+};
+
+struct rtmp_ingest {
+	socket_t listen_fd;
+	uint16_t port;
+
+	pthread_t thread;
+	bool thread_active;
+	os_event_t *stop_event;
+
+	os_event_t *publish_event;
+	os_event_t *disconnect_event;
+
+	pthread_mutex_t mutex;
+	DARRAY(struct rtmp_ingest_phase) profile;
+	DARRAY(struct rtmp_ingest_sample) samples;
+	uint64_t publish_ns;
+};
+
+/* ------------------------------------------------------------------------- */
+/* Profile                                                                    */
+
+/* Gets the phase active at 'now' and the milliseconds left until it ends, or
+ * 0 if it lasts until the ingest is stopped. */
+static void get_phase(struct rtmp_ingest *ingest, uint64_t now, struct rtmp_ingest_phase *phase,
+		      uint64_t *remaining_ms)
+{
+	memset(phase, 0, sizeof(*phase));
+	*remaining_ms = 0;
+
+	pthread_mutex_lock(&ingest->mutex);
+
+	if (ingest->publish_ns) {
+		uint64_t elapsed_ms = (now - ingest->publish_ns) / 1000000;
+		uint64_t end_ms = 0;
+
+		for (size_t i = 0; i < ingest->profile.num; i++) {
+			const struct rtmp_ingest_phase *cur = &ingest->profile.array[i];
+			bool last = i == ingest->profile.num - 1;
+
+			end_ms += cur->duration_ms;
+			if (elapsed_ms < end_ms || (last && !cur->duration_ms)) {
+				*phase = *cur;
+				if (cur->duration_ms)
+					*remaining_ms = end_ms - elapsed_ms;
+				break;
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&ingest->mutex);
+}
+
+void rtmp_ingest_set_profile(rtmp_ingest_t *ingest, const struct rtmp_ingest_phase *phases, size_t count)
+{
+	pthread_mutex_lock(&ingest->mutex);
+	da_resize(ingest->profile, 0);
+	da_push_back_array(ingest->profile, phases, count);
+	pthread_mutex_unlock(&ingest->mutex);
+}
+
+bool rtmp_ingest_load_profile(rtmp_ingest_t *ingest, const char *json)
+{
+	obs_data_t *data = obs_data_create_from_json(json);
+	if (!data)
+		return false;
+
+	obs_data_array_t *array = obs_data_get_array(data, "phases");
+	DARRAY(struct rtmp_ingest_phase) phases = {0};
+
+	for (size_t i = 0; i < obs_data_array_count(array); i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+		struct rtmp_ingest_phase *phase = da_push_back_new(phases);
+
+		phase->duration_ms = (uint32_t)obs_data_get_int(item, "duration_ms");
+		phase->bandwidth_kbps = (uint32_t)obs_data_get_int(item, "bandwidth_kbps");
+		phase->latency_ms = (uint32_t)obs_data_get_int(item, "latency_ms");
+		phase->stall = obs_data_get_bool(item, "stall");
+
+		obs_data_release(item);
+	}
+
+	rtmp_ingest_set_profile(ingest, phases.array, phases.num);
+
+	da_free(phases);
+	obs_data_array_release(array);
+	obs_data_release(data);
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Output                                                                     */
+
+static bool send_all(socket_t fd, const uint8_t *data, size_t size)
+{
+	while (size) {
+		int ret = send(fd, (const char *)data, (int)size, SEND_FLAGS);
+		if (ret <= 0)
+			return false;
+
+		data += ret;
+		size -= ret;
+	}
+
+	return true;
+}
+
+static bool send_message(struct ingest_conn *conn, uint8_t csid, uint8_t type, uint32_t stream_id,
+			 const uint8_t *body, size_t size)
+{
+	struct array_output_data out;
+	struct serializer s;
+	array_output_serializer_init(&s, &out);
+
+	s_w8(&s, csid);
+	s_wb24(&s, 0);
+	s_wb24(&s, (uint32_t)size);
+	s_w8(&s, type);
+	s_wl32(&s, stream_id);
+
+	for (size_t pos = 0; pos < size; pos += OUT_CHUNK_SIZE) {
+		if (pos)
+			s_w8(&s, 0xC0 | csid);
+		s_write(&s, body + pos, size - pos < OUT_CHUNK_SIZE ? size - pos : OUT_CHUNK_SIZE);
+	}
+
+	bool success = send_all(conn->fd, out.bytes.array, out.bytes.num);
+	array_output_serializer_free(&out);
+	return success;
+}
+
+static bool send_control(struct ingest_conn *conn, uint8_t type, uint32_t value, int extra)
+{
+	uint8_t body[5] = {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value,
+			   (uint8_t)extra};
+	return send_message(conn, 2, type, 0, body, extra < 0 ? 4 : 5);
+}
+
+static void amf_string(struct serializer *s, const char *str)
+{
+	size_t len = strlen(str);
+	s_w8(s, AMF_STRING);
+	s_wb16(s, (uint16_t)len);
+	s_write(s, str, len);
+}
+
+static void amf_number(struct serializer *s, double val)
+{
+	s_w8(s, AMF_NUMBER);
+	s_wbd(s, val);
+}
+
+static void amf_prop_name(struct serializer *s, const char *name)
+{
+	size_t len = strlen(name);
+	s_wb16(s, (uint16_t)len);
+	s_write(s, name, len);
+}
+
+static void amf_status(struct serializer *s, const char *code, const char *description)
+{
+	s_w8(s, AMF_OBJECT);
+	amf_prop_name(s, "level");
+	amf_string(s, "status");
+	amf_prop_name(s, "code");
+	amf_string(s, code);
+	amf_prop_name(s, "description");
+	amf_string(s, description);
+	s_wb24(s, 0x000009);
+}
+
+static bool send_connect_result(struct ingest_conn *conn, double txn)
+{
+	struct array_output_data out;
+	struct serializer s;
+	array_output_serializer_init(&s, &out);
+
+	amf_string(&s, "_result");
+	amf_number(&s, txn);
+	s_w8(&s, AMF_OBJECT);
+	amf_prop_name(&s, "fmsVer");
+	amf_string(&s, "FMS/3,0,1,123");
+	amf_prop_name(&s, "capabilities");
+	amf_number(&s, 31.0);
+	s_wb24(&s, 0x000009);
+	amf_status(&s, "NetConnection.Connect.Success", "Connection succeeded.");
+
+	bool success = send_control(conn, MSG_WINDOW_ACK_SIZE, 2500000, -1) &&
+		       send_control(conn, MSG_SET_PEER_BANDWIDTH, 2500000, 2) &&
+		       send_control(conn, MSG_SET_CHUNK_SIZE, OUT_CHUNK_SIZE, -1) &&
+		       send_message(conn, 3, MSG_COMMAND_AMF0, 0, out.bytes.array, out.bytes.num);
+
+	array_output_serializer_free(&out);
+	return success;
+}
+
+static bool send_result(struct ingest_conn *conn, double txn, bool stream_id)
+{
+	struct array_output_data out;
+	struct serializer s;
+	array_output_serializer_init(&s, &out);
+
+	amf_string(&s, "_result");
+	amf_number(&s, txn);
+	s_w8(&s, AMF_NULL);
+	if (stream_id)
+		amf_number(&s, 1.0);
+	else
+		s_w8(&s, AMF_UNDEFINED);
+
+	bool success = send_message(conn, 3, MSG_COMMAND_AMF0, 0, out.bytes.array, out.bytes.num);
+	array_output_serializer_free(&out);
+	return success;
+}
+
+static bool send_publish_start(struct ingest_conn *conn)
+{
+	struct array_output_data out;
+	struct serializer s;
+	array_output_serializer_init(&s, &out);
+
+	amf_string(&s, "onStatus");
+	amf_number(&s, 0.0);
+	s_w8(&s, AMF_NULL);
+	amf_status(&s, "NetStream.Publish.Start", "Start publishing");
+
+	bool success = send_message(conn, 5, MSG_COMMAND_AMF0, 1, out.bytes.array, out.bytes.num);
+	array_output_serializer_free(&out);
+	return success;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Input                                                                      */
+
+static inline uint32_t rb24(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+static inline uint32_t rb32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | rb24(p + 1);
+}
+
+static inline uint32_t rl32(const uint8_t *p)
+{
+	return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool read_command(const uint8_t *data, size_t size, char *name, size_t name_size, double *txn)
+{
+	if (size < 3 || data[0] != AMF_STRING)
+		return false;
+
+	size_t len = ((size_t)data[1] << 8) | data[2];
+	if (3 + len + 9 > size || len >= name_size)
+		return false;
+
+	memcpy(name, data + 3, len);
+	name[len] = 0;
+
+	data += 3 + len;
+	if (data[0] != AMF_NUMBER)
+		return false;
+
+	uint64_t bits = ((uint64_t)rb32(data + 1) << 32) | rb32(data + 5);
+	memcpy(txn, &bits, sizeof(*txn));
+	return true;
+}
+
+static bool handle_command(struct rtmp_ingest *ingest, struct ingest_conn *conn, const struct chunk_stream *cs)
+{
+	char name[64];
+	double txn;
+
+	if (!read_command(cs->payload.array, cs->payload.num, name, sizeof(name), &txn))
+		return true;
+
+	if (strcmp(name, "connect") == 0)
+		return send_connect_result(conn, txn);
+	if (strcmp(name, "createStream") == 0)
+		return send_result(conn, txn, true);
+
+	if (strcmp(name, "publish") == 0) {
+		pthread_mutex_lock(&ingest->mutex);
+		ingest->publish_ns = os_gettime_ns();
+		pthread_mutex_unlock(&ingest->mutex);
+
+		info("Publish started");
+		os_event_signal(ingest->publish_event);
+		return send_publish_start(conn);
+	}
+
+	/* releaseStream, FCPublish and friends only need an acknowledgement */
+	if (txn > 0.0)
+		return send_result(conn, txn, false);
+	return true;
+}
+
+static void record_sample(struct rtmp_ingest *ingest, const struct chunk_stream *cs, uint32_t latency_ms)
+{
+	struct rtmp_ingest_sample sample = {0};
+	sample.type = cs->type;
+	sample.timestamp = cs->timestamp;
+	sample.size = (uint32_t)cs->payload.num;
+	sample.recv_ns = os_gettime_ns();
+	sample.deliver_ns = sample.recv_ns + (uint64_t)latency_ms * 1000000;
+
+	/* works for both legacy and enhanced RTMP video headers */
+	if (cs->type == MSG_VIDEO && cs->payload.num)
+		sample.keyframe = ((cs->payload.array[0] >> 4) & 0x7) == 1;
+
+	pthread_mutex_lock(&ingest->mutex);
+	if (ingest->publish_ns)
+		da_push_back(ingest->samples, &sample);
+	pthread_mutex_unlock(&ingest->mutex);
+}
+
+static bool handle_message(struct rtmp_ingest *ingest, struct ingest_conn *conn, const struct chunk_stream *cs,
+			   uint32_t latency_ms)
+{
+	switch (cs->type) {
+	case MSG_SET_CHUNK_SIZE:
+		if (cs->payload.num >= 4)
+			conn->chunk_size = rb32(cs->payload.array) & 0x7FFFFFFF;
+		return conn->chunk_size != 0;
+
+	case MSG_COMMAND_AMF0:
+		return handle_command(ingest, conn, cs);
+
+	case MSG_AUDIO:
+	case MSG_VIDEO:
+	case MSG_DATA_AMF0:
+		record_sample(ingest, cs, latency_ms);
+		return true;
+	}
+
+	return true;
+}
+
+static struct chunk_stream *get_chunk_stream(struct ingest_conn *conn, uint32_t csid)
+{
+	for (size_t i = 0; i < conn->streams.num; i++) {
+		if (conn->streams.array[i].csid == csid)
+			return &conn->streams.array[i];
+	}
+
+	struct chunk_stream *cs = da_push_back_new(conn->streams);
+	cs->csid = csid;
+	return cs;
+}
+
+/* Parses a single chunk.  Returns the number of bytes consumed, 0 if the
+ * chunk is not complete yet, or -1 on a protocol error. */
+static ptrdiff_t parse_chunk(struct rtmp_ingest *ingest, struct ingest_conn *conn, const uint8_t *data, size_t size,
+			     uint32_t latency_ms)
+{
+	static const size_t header_sizes[] = {11, 7, 3, 0};
+	size_t pos = 1;
+
+	if (size < 1)
+		return 0;
+
+	uint8_t fmt = data[0] >> 6;
+	uint32_t csid = data[0] & 0x3F;
+
+	if (csid == 0) {
+		if (size < 2)
+			return 0;
+		csid = 64 + data[1];
+		pos = 2;
+	} else if (csid == 1) {
+		if (size < 3)
+			return 0;
+		csid = 64 + data[1] + ((uint32_t)data[2] << 8);
+		pos = 3;
+	}
+
+	if (size < pos + header_sizes[fmt])
+		return 0;
+
+	struct chunk_stream *cs = get_chunk_stream(conn, csid);
+	const uint8_t *header = data + pos;
+	uint32_t ts_field = fmt <= 2 ? rb24(header) : 0;
+	uint32_t length = fmt <= 1 ? rb24(header + 3) : cs->length;
+	bool extended = fmt <= 2 ? ts_field == 0xFFFFFF : cs->extended;
+	bool continuation = fmt == 3 && cs->payload.num;
+
+	pos += header_sizes[fmt];
+
+	if (extended) {
+		if (size < pos + 4)
+			return 0;
+		ts_field = rb32(data + pos);
+		pos += 4;
+	}
+
+	if (length > MAX_MESSAGE_SIZE) {
+		warn("Message of %u bytes on chunk stream %u is too large", length, csid);
+		return -1;
+	}
+
+	size_t received = continuation ? cs->payload.num : 0;
+	size_t chunk = length - received;
+	if (chunk > conn->chunk_size)
+		chunk = conn->chunk_size;
+	if (size < pos + chunk)
+		return 0;
+
+	if (fmt <= 2) {
+		if (fmt == 0)
+			cs->timestamp = ts_field;
+		else
+			cs->timestamp += ts_field;
+		cs->delta = ts_field;
+		cs->extended = extended;
+	} else if (!continuation) {
+		cs->timestamp += cs->delta;
+	}
+
+	if (fmt <= 1) {
+		cs->length = length;
+		cs->type = header[6];
+	}
+	if (fmt == 0)
+		cs->stream_id = rl32(header + 7);
+	if (!continuation)
+		da_resize(cs->payload, 0);
+
+	da_push_back_array(cs->payload, data + pos, chunk);
+	pos += chunk;
+
+	if (cs->payload.num == cs->length) {
+		bool success = handle_message(ingest, conn, cs, latency_ms);
+		da_resize(cs->payload, 0);
+		if (!success)
+			return -1;
+	}
+
+	return (ptrdiff_t)pos;
+}
+
+static bool handle_handshake(struct ingest_conn *conn, const uint8_t *data)
+{
+	if (conn->state == CONN_HANDSHAKE_C2) {
+		conn->state = CONN_CHUNKS;
+		return true;
+	}
+
+	if (data[0] != 3) {
+		warn("Unsupported RTMP version %d", data[0]);
+		return false;
+	}
+
+	/* zeroed version bytes make clients fall back to the simple handshake */
+	uint8_t reply[1 + RTMP_SIG_SIZE * 2] = {3};
+	for (size_t i = 9; i < 1 + RTMP_SIG_SIZE; i++)
+		reply[i] = (uint8_t)rand();
+	memcpy(reply + 1 + RTMP_SIG_SIZE, data + 1, RTMP_SIG_SIZE);
+
+	conn->state = CONN_HANDSHAKE_C2;
+	return send_all(conn->fd, reply, sizeof(reply));
+}
+
+static bool process_input(struct rtmp_ingest *ingest, struct ingest_conn *conn, const uint8_t *data, size_t size,
+			  uint32_t latency_ms)
+{
+	size_t pos = 0;
+
+	da_push_back_array(conn->in, data, size);
+
+	while (pos < conn->in.num) {
+		const uint8_t *cur = conn->in.array + pos;
+		size_t left = conn->in.num - pos;
+
+		if (conn->state != CONN_CHUNKS) {
+			size_t need = conn->state == CONN_HANDSHAKE_C0C1 ? 1 + RTMP_SIG_SIZE : RTMP_SIG_SIZE;
+			if (left < need)
+				break;
+			if (!handle_handshake(conn, cur))
+				return false;
+
+			pos += need;
+			continue;
+		}
+
+		ptrdiff_t ret = parse_chunk(ingest, conn, cur, left, latency_ms);
+		if (ret < 0)
+			return false;
+		if (ret == 0)
+			break;
+
+		pos += (size_t)ret;
+	}
+
+	if (pos)
+		da_erase_range(conn->in, 0, pos);
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Connection handling                                                        */
+
+static bool wait_readable(socket_t fd, int timeout_ms)
+{
+	struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+	fd_set set;
+
+	FD_ZERO(&set);
+	FD_SET(fd, &set);
+	return select((int)fd + 1, &set, NULL, NULL, &tv) > 0;
+}
+
+static inline bool stopping(struct rtmp_ingest *ingest)
+{
+	return os_event_try(ingest->stop_event) != EAGAIN;
+}
+
+static void serve_connection(struct rtmp_ingest *ingest, socket_t fd)
+{
+	struct ingest_conn conn = {0};
+	uint8_t buf[READ_SIZE];
+	uint64_t last_refill = os_gettime_ns();
+	double tokens = 0.0;
+
+	conn.fd = fd;
+	conn.chunk_size = DEFAULT_CHUNK_SIZE;
+
+	while (!stopping(ingest)) {
+		struct rtmp_ingest_phase phase;
+		uint64_t now = os_gettime_ns();
+		uint64_t remaining_ms;
+		size_t want = sizeof(buf);
+
+		get_phase(ingest, now, &phase, &remaining_ms);
+
+		/* block until the stall is over, unless the ingest is stopped */
+		if (phase.stall) {
+			tokens = 0.0;
+			last_refill = now;
+			os_event_timedwait(ingest->stop_event, remaining_ms ? (unsigned long)remaining_ms : POLL_MS);
+			continue;
+		}
+
+		/* token bucket with a burst of 20 ms worth of data */
+		if (phase.bandwidth_kbps) {
+			double bytes_per_ns = (double)phase.bandwidth_kbps * 125.0 / 1000000000.0;
+			double burst = fmax(bytes_per_ns * 20000000.0, 1500.0);
+
+			tokens = fmin(tokens + (double)(now - last_refill) * bytes_per_ns, burst);
+			last_refill = now;
+
+			/* block until the bucket holds at least one byte */
+			if (tokens < 1.0) {
+				double wait_ms = ceil((1.0 - tokens) / bytes_per_ns / 1000000.0);
+				os_event_timedwait(ingest->stop_event, (unsigned long)fmax(wait_ms, 1.0));
+				continue;
+			}
+			if (tokens < (double)want)
+				want = (size_t)tokens;
+		} else {
+			tokens = 0.0;
+			last_refill = now;
+		}
+
+		if (!wait_readable(fd, POLL_MS))
+			continue;
+
+		int ret = recv(fd, (char *)buf, (int)want, 0);
+		if (ret <= 0)
+			break;
+
+		tokens -= (double)ret;
+
+		if (!process_input(ingest, &conn, buf, (size_t)ret, phase.latency_ms))
+			break;
+	}
+
+	for (size_t i = 0; i < conn.streams.num; i++)
+		da_free(conn.streams.array[i].payload);
+	da_free(conn.streams);
+	da_free(conn.in);
+}
+
+static void *ingest_thread(void *data)
+{
+	struct rtmp_ingest *ingest = data;
+
+	os_set_thread_name("rtmp-ingest");
+
+	while (!stopping(ingest)) {
+		if (!wait_readable(ingest->listen_fd, POLL_MS))
+			continue;
+
+		socket_t fd = accept(ingest->listen_fd, NULL, NULL);
+		if (fd == INVALID_SOCKET)
+			continue;
+
+#ifdef SO_NOSIGPIPE
+		int no_sigpipe = 1;
+		setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+		pthread_mutex_lock(&ingest->mutex);
+		da_resize(ingest->samples, 0);
+		ingest->publish_ns = 0;
+		pthread_mutex_unlock(&ingest->mutex);
+
+		os_event_reset(ingest->publish_event);
+		os_event_reset(ingest->disconnect_event);
+
+		info("Publisher connected");
+		serve_connection(ingest, fd);
+		close_socket(fd);
+		info("Publisher disconnected");
+
+		os_event_signal(ingest->disconnect_event);
+	}
+
+	return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+rtmp_ingest_t *rtmp_ingest_create(uint16_t port)
+{
+	struct rtmp_ingest *ingest = bzalloc(sizeof(*ingest));
+	struct sockaddr_in addr = {0};
+	socklen_t addr_len = sizeof(addr);
+	int buf_size = RECV_BUFFER_SIZE;
+	int reuse = 1;
+
+#ifdef _WIN32
+	WSADATA wsad;
+	WSAStartup(MAKEWORD(2, 2), &wsad);
+#endif
+
+	ingest->listen_fd = INVALID_SOCKET;
+
+	pthread_mutex_init_value(&ingest->mutex);
+	if (pthread_mutex_init(&ingest->mutex, NULL) != 0)
+		goto fail;
+	if (os_event_init(&ingest->publish_event, OS_EVENT_TYPE_MANUAL) != 0)
+		goto fail;
+	if (os_event_init(&ingest->disconnect_event, OS_EVENT_TYPE_MANUAL) != 0)
+		goto fail;
+	if (os_event_init(&ingest->stop_event, OS_EVENT_TYPE_MANUAL) != 0)
+		goto fail;
+
+	ingest->listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (ingest->listen_fd == INVALID_SOCKET)
+		goto fail;
+
+	/* accepted sockets inherit the receive buffer size */
+	setsockopt(ingest->listen_fd, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+	setsockopt(ingest->listen_fd, SOL_SOCKET, SO_RCVBUF, (const char *)&buf_size, sizeof(buf_size));
+
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+
+	if (bind(ingest->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		warn("Failed to bind to port %d", (int)port);
+		goto fail;
+	}
+	if (listen(ingest->listen_fd, 1) != 0)
+		goto fail;
+	if (getsockname(ingest->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0)
+		goto fail;
+
+	ingest->port = ntohs(addr.sin_port);
+
+	if (pthread_create(&ingest->thread, NULL, ingest_thread, ingest) != 0)
+		goto fail;
+
+	ingest->thread_active = true;
+	info("Listening on rtmp://127.0.0.1:%d", (int)ingest->port);
+	return ingest;
+
+fail:
+	rtmp_ingest_destroy(ingest);
+	return NULL;
+}
+
+void rtmp_ingest_destroy(rtmp_ingest_t *ingest)
+{
+	if (!ingest)
+		return;
+
+	if (ingest->thread_active) {
+		os_event_signal(ingest->stop_event);
+		pthread_join(ingest->thread, NULL);
+	}
+
+	if (ingest->listen_fd != INVALID_SOCKET)
+		close_socket(ingest->listen_fd);
+
+	os_event_destroy(ingest->publish_event);
+	os_event_destroy(ingest->disconnect_event);
+	os_event_destroy(ingest->stop_event);
+	pthread_mutex_destroy(&ingest->mutex);
+	da_free(ingest->profile);
+	da_free(ingest->samples);
+	bfree(ingest);
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+uint16_t rtmp_ingest_get_port(rtmp_ingest_t *ingest)
+{
+	return ingest->port;
+}
+
+bool rtmp_ingest_wait_publish(rtmp_ingest_t *ingest, uint32_t timeout_ms)
+{
+	return os_event_timedwait(ingest->publish_event, timeout_ms) == 0;
+}
+
+bool rtmp_ingest_wait_disconnect(rtmp_ingest_t *ingest, uint32_t timeout_ms)
+{
+	return os_event_timedwait(ingest->disconnect_event, timeout_ms) == 0;
+}
+
+size_t rtmp_ingest_get_samples(rtmp_ingest_t *ingest, struct rtmp_ingest_sample **samples)
+{
+	pthread_mutex_lock(&ingest->mutex);
+	size_t count = ingest->samples.num;
+	*samples = bmemdup(ingest->samples.array, count * sizeof(**samples));
+	pthread_mutex_unlock(&ingest->mutex);
+
+	return count;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Report                                                                     */
+
+static bool is_restricted(const struct rtmp_ingest_phase *phase)
+{
+	return phase->stall || phase->bandwidth_kbps;
+}
+
+static double get_recovery_ms(const struct rtmp_ingest_phase *phases, size_t num_phases,
+			      const struct rtmp_ingest_sample *samples, size_t count)
+{
+	uint64_t restricted_end = 0;
+	uint64_t offset = 0;
+
+	if (!num_phases || is_restricted(&phases[0]) || !phases[0].duration_ms)
+		return -1.0;
+
+	for (size_t i = 0; i < num_phases; i++) {
+		offset += phases[i].duration_ms;
+		if (is_restricted(&phases[i]))
+			restricted_end = phases[i].duration_ms ? offset : UINT64_MAX;
+	}
+
+	if (!restricted_end)
+		return 0.0;
+	if (restricted_end == UINT64_MAX)
+		return -1.0;
+
+	/* media timestamps are relative to the first video frame, which the
+	 * sender produces right after publishing */
+	const struct rtmp_ingest_sample *video = NULL;
+	uint64_t baseline_bytes = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (samples[i].type != MSG_VIDEO)
+			continue;
+		if (!video)
+			video = &samples[i];
+		if (samples[i].timestamp - video->timestamp < phases[0].duration_ms)
+			baseline_bytes += samples[i].size;
+	}
+
+	if (!video || !baseline_bytes)
+		return -1.0;
+
+	double baseline = (double)baseline_bytes / (double)phases[0].duration_ms;
+	uint64_t window_bytes = 0;
+	size_t end = 0;
+
+	/* slide a one second window over the frames after the restriction */
+	for (size_t i = 0; i < count; i++) {
+		uint64_t start_ts = samples[i].timestamp - video->timestamp;
+		if (samples[i].type != MSG_VIDEO || start_ts < restricted_end)
+			continue;
+
+		if (end < i) {
+			end = i;
+			window_bytes = 0;
+		}
+
+		while (end < count && samples[end].timestamp - video->timestamp < start_ts + 1000) {
+			if (samples[end].type == MSG_VIDEO)
+				window_bytes += samples[end].size;
+			end++;
+		}
+
+		if (end == count)
+			break;
+		if ((double)window_bytes / 1000.0 >= baseline * 0.9)
+			return (double)(start_ts - restricted_end);
+
+		window_bytes -= samples[i].size;
+	}
+
+	return -1.0;
+}
+
+void rtmp_ingest_get_report(rtmp_ingest_t *ingest, double frame_interval_ms, struct rtmp_ingest_report *report)
+{
+	struct rtmp_ingest_sample *samples;
+	size_t count = rtmp_ingest_get_samples(ingest, &samples);
+
+	memset(report, 0, sizeof(*report));
+	report->recovery_ms = -1.0;
+
+	if (!count) {
+		bfree(samples);
+		return;
+	}
+
+	int64_t base_ns = INT64_MAX;
+	uint32_t prev_ts = 0;
+	uint32_t min_interval = UINT32_MAX;
+	uint64_t media_bytes = 0;
+	bool first = true;
+
+	for (size_t i = 0; i < count; i++) {
+		const struct rtmp_ingest_sample *sample = &samples[i];
+		if (sample->type != MSG_VIDEO)
+			continue;
+
+		int64_t offset = (int64_t)sample->recv_ns - (int64_t)sample->timestamp * 1000000;
+		if (offset < base_ns)
+			base_ns = offset;
+
+		if (!first && sample->timestamp > prev_ts && sample->timestamp - prev_ts < min_interval)
+			min_interval = sample->timestamp - prev_ts;
+		prev_ts = sample->timestamp;
+		first = false;
+	}
+
+	if (frame_interval_ms <= 0.0)
+		frame_interval_ms = min_interval != UINT32_MAX ? (double)min_interval : 0.0;
+
+	double latency_sum = 0.0;
+	first = true;
+
+	for (size_t i = 0; i < count; i++) {
+		const struct rtmp_ingest_sample *sample = &samples[i];
+
+		if (sample->type == MSG_AUDIO) {
+			report->audio_frames++;
+			media_bytes += sample->size;
+		}
+		if (sample->type != MSG_VIDEO)
+			continue;
+
+		report->video_frames++;
+		media_bytes += sample->size;
+
+		int64_t latency_ns = (int64_t)sample->deliver_ns - (int64_t)sample->timestamp * 1000000 - base_ns;
+		double latency_ms = (double)latency_ns / 1000000.0;
+
+		latency_sum += latency_ms;
+		if (latency_ms > report->max_latency_ms)
+			report->max_latency_ms = latency_ms;
+
+		if (!first && frame_interval_ms > 0.0 && sample->timestamp > prev_ts) {
+			double frames = floor((double)(sample->timestamp - prev_ts) / frame_interval_ms + 0.5);
+			if (frames > 1.0)
+				report->dropped_frames += (size_t)frames - 1;
+		}
+
+		prev_ts = sample->timestamp;
+		first = false;
+	}
+
+	if (report->video_frames)
+		report->avg_latency_ms = latency_sum / (double)report->video_frames;
+
+	uint64_t duration_ns = samples[count - 1].recv_ns - samples[0].recv_ns;
+	if (duration_ns)
+		report->avg_kbps = (double)media_bytes * 8.0 * 1000000.0 / (double)duration_ns;
+
+	pthread_mutex_lock(&ingest->mutex);
+	report->recovery_ms = get_recovery_ms(ingest->profile.array, ingest->profile.num, samples, count);
+	pthread_mutex_unlock(&ingest->mutex);
+
+	bfree(samples);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <util/c99defs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Minimal RTMP ingest used to stress the rtmp-stream output locally.
+ *
+ * The server accepts one publisher at a time, answers just enough of the
+ * NetConnection/NetStream handshake for librtmp to start publishing, and
+ * records the timestamp and arrival time of every media message it receives.
+ * Reads are shaped by a profile of consecutive phases, so congestion can be
+ * reproduced without a real ingest or the TEST_FRAMEDROPS hack. */
+
+typedef struct rtmp_ingest rtmp_ingest_t;
+
+struct rtmp_ingest_phase {
+	uint32_t duration_ms;    /* 0 for the final phase means "until stopped" */
+	uint32_t bandwidth_kbps; /* 0 means unlimited */
+	uint32_t latency_ms;     /* one-way delay added to every delivery */
+	bool stall;              /* stop reading from the socket entirely */
+};
+
+struct rtmp_ingest_sample {
+	uint8_t type; /* RTMP message type: 8 audio, 9 video, 18 data */
+	bool keyframe;
+	uint32_t timestamp; /* RTMP timestamp in milliseconds */
+	uint32_t size;
+	uint64_t recv_ns;    /* when the last byte was read from the socket */
+	uint64_t deliver_ns; /* recv_ns plus the latency of the active phase */
+};
+
+struct rtmp_ingest_report {
+	size_t video_frames;
+	size_t audio_frames;
+
+	/* video frames missing from the timestamp sequence, i.e. dropped by
+	 * the sender */
+	size_t dropped_frames;
+
+	/* delivery delay relative to the fastest delivered video frame */
+	double avg_latency_ms;
+	double max_latency_ms;
+
+	/* received media bitrate over the whole publish */
+	double avg_kbps;
+
+	/* media time between the end of the last restricted phase and the
+	 * point where the video bitrate is back to 90% of the bitrate of the
+	 * first phase, or -1 if it never recovered */
+	double recovery_ms;
+};
+
+rtmp_ingest_t *rtmp_ingest_create(uint16_t port);
+void rtmp_ingest_destroy(rtmp_ingest_t *ingest);
+
+uint16_t rtmp_ingest_get_port(rtmp_ingest_t *ingest);
+
+/* The profile starts when the publisher sends "publish" and applies to every
+ * following connection until it is replaced. */
+void rtmp_ingest_set_profile(rtmp_ingest_t *ingest, const struct rtmp_ingest_phase *phases, size_t count);
+bool rtmp_ingest_load_profile(rtmp_ingest_t *ingest, const char *json);
+
+bool rtmp_ingest_wait_publish(rtmp_ingest_t *ingest, uint32_t timeout_ms);
+bool rtmp_ingest_wait_disconnect(rtmp_ingest_t *ingest, uint32_t timeout_ms);
+
+/* Returns a copy of the samples of the current or last publish, to be freed
+ * with bfree. */
+size_t rtmp_ingest_get_samples(rtmp_ingest_t *ingest, struct rtmp_ingest_sample **samples);
+
+/* frame_interval_ms is the nominal video frame duration used to detect
+ * dropped frames; pass 0 to use the smallest observed interval. */
+void rtmp_ingest_get_report(rtmp_ingest_t *ingest, double frame_interval_ms, struct rtmp_ingest_report *report);
+
+#ifdef __cplusplus
+}
+#endif